@@ -0,0 +1,92 @@
+/*
+ * This file is part of sc4-resource-loading-hooks, a DLL Plugin for SimCity 4
+ * that allows other DLLs to modify resources as the game loads them.
+ *
+ * Copyright (C) 2024, 2025 Nicholas Hayes
+ *
+ * sc4-resource-loading-hooks is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * sc4-resource-loading-hooks is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with sc4-resource-loading-hooks.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ExemplarTypeReader.h"
+#include "cIGZVariant.h"
+#include "cISCProperty.h"
+#include "cISCPropertyHolder.h"
+
+static constexpr uint32_t kExemplarTypePropertyId = 0x10;
+
+ExemplarTypeReader::ExemplarTypeReader(const cISCPropertyHolder* pPropertyHolder)
+	: pPropertyHolder(pPropertyHolder),
+	  exemplarType(0),
+	  hasExemplarType(false),
+	  read(false)
+{
+}
+
+bool ExemplarTypeReader::TryGetExemplarType(uint32_t& exemplarType)
+{
+	if (!read)
+	{
+		read = true;
+		hasExemplarType = pPropertyHolder
+			&& TryGetFirstValue(pPropertyHolder, kExemplarTypePropertyId, this->exemplarType);
+	}
+
+	exemplarType = this->exemplarType;
+	return hasExemplarType;
+}
+
+bool ExemplarTypeReader::TryGetFirstValue(const cISCPropertyHolder* pPropertyHolder, uint32_t id, uint32_t& value)
+{
+	const cISCProperty* property = pPropertyHolder->GetProperty(id);
+
+	if (!property)
+	{
+		return false;
+	}
+
+	const cIGZVariant* variant = property->GetPropertyValue();
+
+	if (!variant || variant->GetCount() == 0)
+	{
+		return false;
+	}
+
+	switch (variant->GetType() & ~0x80)
+	{
+	case cIGZVariant::Type::Bool:
+		value = *variant->RefBool() ? 1 : 0;
+		return true;
+	case cIGZVariant::Type::Uint8:
+		value = *variant->RefUint8();
+		return true;
+	case cIGZVariant::Type::Sint8:
+		value = static_cast<uint32_t>(*variant->RefSint8());
+		return true;
+	case cIGZVariant::Type::Uint16:
+		value = *variant->RefUint16();
+		return true;
+	case cIGZVariant::Type::Sint16:
+		value = static_cast<uint32_t>(*variant->RefSint16());
+		return true;
+	case cIGZVariant::Type::Uint32:
+		value = *variant->RefUint32();
+		return true;
+	case cIGZVariant::Type::Sint32:
+		value = static_cast<uint32_t>(*variant->RefSint32());
+		return true;
+	default:
+		return false;
+	}
+}
@@ -0,0 +1,47 @@
+/*
+ * This file is part of sc4-resource-loading-hooks, a DLL Plugin for SimCity 4
+ * that allows other DLLs to modify resources as the game loads them.
+ *
+ * Copyright (C) 2024, 2025 Nicholas Hayes
+ *
+ * sc4-resource-loading-hooks is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * sc4-resource-loading-hooks is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with sc4-resource-loading-hooks.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#include <cstdint>
+
+class cISCPropertyHolder;
+
+// Reads the Exemplar Type property of an exemplar the first time it is requested.
+class ExemplarTypeReader
+{
+public:
+
+	explicit ExemplarTypeReader(const cISCPropertyHolder* pPropertyHolder);
+
+	// Returns false if the exemplar does not have an Exemplar Type property.
+	bool TryGetExemplarType(uint32_t& exemplarType);
+
+	// Gets the first value of an integer or boolean property as an unsigned 32-bit value.
+	// The Exemplar Type and the exemplar patch type target conditions use the same conversion.
+	static bool TryGetFirstValue(const cISCPropertyHolder* pPropertyHolder, uint32_t id, uint32_t& value);
+
+private:
+
+	const cISCPropertyHolder* pPropertyHolder;
+	uint32_t exemplarType;
+	bool hasExemplarType;
+	bool read;
+};
@@ -20,12 +20,17 @@
  */
 
 #include "FileSystem.h"
+#ifdef _WIN32
 #include <Windows.h>
 #include "wil/resource.h"
 #include "wil/win32_helpers.h"
+#else
+#include <dlfcn.h>
+#endif // _WIN32
 
 namespace
 {
+#ifdef _WIN32
 	std::filesystem::path GetDllFolderPathCore()
 	{
 		wil::unique_cotaskmem_string modulePath = wil::GetModuleFileNameW(wil::GetModuleInstanceHandle());
@@ -34,6 +39,29 @@ namespace
 
 		return temp.parent_path();
 	}
+#else
+	std::filesystem::path GetDllFolderPathCore()
+	{
+		// The address of this function identifies the shared object or executable
+		// that the code was linked into.
+		Dl_info info{};
+
+		if (dladdr(reinterpret_cast<const void*>(&GetDllFolderPathCore), &info) == 0 || !info.dli_fname)
+		{
+			return std::filesystem::current_path();
+		}
+
+		std::error_code ec;
+		std::filesystem::path temp = std::filesystem::canonical(info.dli_fname, ec);
+
+		if (ec)
+		{
+			temp = std::filesystem::absolute(info.dli_fname, ec);
+		}
+
+		return temp.parent_path();
+	}
+#endif // _WIN32
 }
 
 std::filesystem::path FileSystem::GetDllFolderPath()
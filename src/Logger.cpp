@@ -20,17 +20,21 @@
  */
 
 #include "Logger.h"
+#include "PerformanceCounters.h"
+#include <cstdarg>
+#ifdef _WIN32
 #include <Windows.h>
+#endif // _WIN32
 
 namespace
 {
-#ifdef _DEBUG
+#if defined(_DEBUG) && defined(_WIN32)
 	void PrintLineToDebugOutput(const char* line)
 	{
 		OutputDebugStringA(line);
 		OutputDebugStringA("\n");
 	}
-#endif // _DEBUG
+#endif // defined(_DEBUG) && defined(_WIN32)
 }
 
 Logger& Logger::GetInstance()
@@ -43,7 +47,8 @@ Logger& Logger::GetInstance()
 Logger::Logger()
 	: initialized(false),
 	  logFile(),
-	  logLevel(LogLevel::Error)
+	  logLevel(LogLevel::Error),
+	  writeMutex()
 {
 }
 
@@ -58,7 +63,7 @@ void Logger::Init(std::filesystem::path logFilePath, LogLevel level)
 	{
 		initialized = true;
 
-		logFile.open(logFilePath, std::ofstream::out | std::ofstream::trunc);
+		logFile.Open(logFilePath);
 		logLevel = level;
 	}
 }
@@ -73,11 +78,34 @@ void Logger::SetLogLevel(LogLevel level)
 	logLevel = level;
 }
 
+void Logger::SetRotationOptions(const LogRotationOptions& options)
+{
+	std::lock_guard<std::mutex> lock(writeMutex);
+
+	logFile.SetRotationOptions(options);
+}
+
+void Logger::Shutdown()
+{
+	if (initialized)
+	{
+		std::lock_guard<std::mutex> lock(writeMutex);
+
+		logFile.Shutdown();
+	}
+}
+
 void Logger::WriteLogFileHeader(const char* const text)
 {
-	if (initialized && logFile)
+	if (initialized)
 	{
-		logFile << text << std::endl;
+		std::lock_guard<std::mutex> lock(writeMutex);
+
+		if (logFile.IsOpen())
+		{
+			// The header is repeated at the start of each rotated log file.
+			logFile.SetFileHeader(text);
+		}
 	}
 }
 
@@ -98,6 +126,8 @@ void Logger::WriteLineFormatted(LogLevel level, const char* const format, ...)
 		return;
 	}
 
+	ScopedPerformanceTimer timer(PerformanceCounter::LogWrite);
+
 	va_list args;
 	va_start(args, format);
 
@@ -137,12 +167,19 @@ void Logger::WriteLineFormatted(LogLevel level, const char* const format, ...)
 
 void Logger::WriteLineCore(const char* const message)
 {
-	if (initialized && logFile)
+	if (initialized)
 	{
-#ifdef _DEBUG
-		PrintLineToDebugOutput(message);
-#endif // _DEBUG
+		// The log file is closed and reopened when it is rotated, so the
+		// open check and the write must both be done under the lock.
+		std::lock_guard<std::mutex> lock(writeMutex);
+
+		if (logFile.IsOpen())
+		{
+#if defined(_DEBUG) && defined(_WIN32)
+			PrintLineToDebugOutput(message);
+#endif // defined(_DEBUG) && defined(_WIN32)
 
-		logFile << message << "\n";
+			logFile.WriteLine(message);
+		}
 	}
 }
\ No newline at end of file
@@ -20,8 +20,9 @@
  */
 
 #pragma once
+#include "RotatingLogFile.h"
 #include <filesystem>
-#include <fstream>
+#include <mutex>
 
 enum class LogLevel : int32_t
 {
@@ -43,6 +44,11 @@ public:
 
 	void SetLogLevel(LogLevel level);
 
+	void SetRotationOptions(const LogRotationOptions& options);
+
+	// Flushes the log and waits for the rotated log files to be compressed.
+	void Shutdown();
+
 	void WriteLogFileHeader(const char* const message);
 
 	void WriteLine(LogLevel level, const char* const message);
@@ -58,6 +64,8 @@ private:
 
 	bool initialized;
 	LogLevel logLevel;
-	std::ofstream logFile;
+	RotatingLogFile logFile;
+	// The exemplar patch scans can write to the log from a background thread.
+	std::mutex writeMutex;
 };
 
@@ -0,0 +1,136 @@
+/*
+ * This file is part of sc4-resource-loading-hooks, a DLL Plugin for SimCity 4
+ * that allows other DLLs to modify resources as the game loads them.
+ *
+ * Copyright (C) 2024, 2025 Nicholas Hayes
+ *
+ * sc4-resource-loading-hooks is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * sc4-resource-loading-hooks is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with sc4-resource-loading-hooks.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "PerformanceCounters.h"
+#include "version.h"
+#include <array>
+#include <atomic>
+#include <fstream>
+
+namespace
+{
+	struct CounterData
+	{
+		std::atomic<uint64_t> count;
+		std::atomic<uint64_t> totalNanoseconds;
+		std::atomic<uint64_t> maxNanoseconds;
+	};
+
+	static constexpr size_t CounterCount = static_cast<size_t>(PerformanceCounter::Count);
+
+	static constexpr std::array<const char*, CounterCount> CounterNames =
+	{
+		"exemplarPatchScan",
+		"exemplarPatchLookupHit",
+		"exemplarPatchLookupMiss",
+		"exemplarPatchApply",
+		"exemplarLoadDispatch",
+		"logWrite",
+	};
+
+	std::atomic<bool> countersEnabled = false;
+	std::array<CounterData, CounterCount> counters{};
+}
+
+void PerformanceCounters::Enable()
+{
+	countersEnabled.store(true, std::memory_order_relaxed);
+}
+
+bool PerformanceCounters::IsEnabled()
+{
+	return countersEnabled.load(std::memory_order_relaxed);
+}
+
+void PerformanceCounters::Add(PerformanceCounter counter, uint64_t elapsedNanoseconds)
+{
+	CounterData& data = counters[static_cast<size_t>(counter)];
+
+	data.count.fetch_add(1, std::memory_order_relaxed);
+	data.totalNanoseconds.fetch_add(elapsedNanoseconds, std::memory_order_relaxed);
+
+	uint64_t currentMax = data.maxNanoseconds.load(std::memory_order_relaxed);
+
+	while (elapsedNanoseconds > currentMax
+		&& !data.maxNanoseconds.compare_exchange_weak(currentMax, elapsedNanoseconds, std::memory_order_relaxed))
+	{
+	}
+}
+
+bool PerformanceCounters::WriteReport(const std::filesystem::path& path)
+{
+	std::ofstream stream(path, std::ofstream::out | std::ofstream::trunc);
+
+	if (!stream)
+	{
+		return false;
+	}
+
+	stream << "{\n  \"pluginVersion\": \"" PLUGIN_VERSION_STR "\",\n  \"counters\": {";
+
+	for (size_t i = 0; i < CounterCount; i++)
+	{
+		const CounterData& data = counters[i];
+
+		const uint64_t count = data.count.load(std::memory_order_relaxed);
+		const uint64_t totalNanoseconds = data.totalNanoseconds.load(std::memory_order_relaxed);
+
+		stream << (i == 0 ? "\n" : ",\n")
+			<< "    \"" << CounterNames[i] << "\": { "
+			<< "\"count\": " << count
+			<< ", \"totalNs\": " << totalNanoseconds
+			<< ", \"meanNs\": " << (count > 0 ? totalNanoseconds / count : 0)
+			<< ", \"maxNs\": " << data.maxNanoseconds.load(std::memory_order_relaxed)
+			<< " }";
+	}
+
+	stream << "\n  }\n}\n";
+
+	return !stream.fail();
+}
+
+ScopedPerformanceTimer::ScopedPerformanceTimer(PerformanceCounter counter)
+	: counter(counter),
+	  start(),
+	  enabled(PerformanceCounters::IsEnabled())
+{
+	if (enabled)
+	{
+		start = std::chrono::steady_clock::now();
+	}
+}
+
+ScopedPerformanceTimer::~ScopedPerformanceTimer()
+{
+	if (enabled)
+	{
+		const auto elapsed = std::chrono::steady_clock::now() - start;
+
+		PerformanceCounters::Add(
+			counter,
+			static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()));
+	}
+}
+
+void ScopedPerformanceTimer::SetCounter(PerformanceCounter counter)
+{
+	this->counter = counter;
+}
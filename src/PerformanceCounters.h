@@ -0,0 +1,72 @@
+/*
+ * This file is part of sc4-resource-loading-hooks, a DLL Plugin for SimCity 4
+ * that allows other DLLs to modify resources as the game loads them.
+ *
+ * Copyright (C) 2024, 2025 Nicholas Hayes
+ *
+ * sc4-resource-loading-hooks is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * sc4-resource-loading-hooks is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with sc4-resource-loading-hooks.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+
+enum class PerformanceCounter : uint32_t
+{
+	ExemplarPatchScan = 0,
+	ExemplarPatchLookupHit,
+	ExemplarPatchLookupMiss,
+	ExemplarPatchApply,
+	ExemplarLoadDispatch,
+	LogWrite,
+	Count
+};
+
+// Records the call count and elapsed time of the resource loading hot paths.
+// The counters are disabled by default, and the timers do nothing until
+// Enable is called.
+namespace PerformanceCounters
+{
+	void Enable();
+
+	bool IsEnabled();
+
+	void Add(PerformanceCounter counter, uint64_t elapsedNanoseconds);
+
+	// Writes the counter values to a JSON file.
+	bool WriteReport(const std::filesystem::path& path);
+}
+
+class ScopedPerformanceTimer
+{
+public:
+
+	explicit ScopedPerformanceTimer(PerformanceCounter counter);
+	~ScopedPerformanceTimer();
+
+	ScopedPerformanceTimer(const ScopedPerformanceTimer&) = delete;
+	ScopedPerformanceTimer& operator=(const ScopedPerformanceTimer&) = delete;
+
+	// Changes the counter that the elapsed time is added to, this is used when
+	// the result of the timed operation is only known after it finishes.
+	void SetCounter(PerformanceCounter counter);
+
+private:
+
+	PerformanceCounter counter;
+	std::chrono::steady_clock::time_point start;
+	bool enabled;
+};
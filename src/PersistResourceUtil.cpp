@@ -0,0 +1,74 @@
+/*
+ * This file is part of sc4-resource-loading-hooks, a DLL Plugin for SimCity 4
+ * that allows other DLLs to modify resources as the game loads them.
+ *
+ * Copyright (C) 2024, 2025 Nicholas Hayes
+ *
+ * sc4-resource-loading-hooks is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * sc4-resource-loading-hooks is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with sc4-resource-loading-hooks.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "PersistResourceUtil.h"
+#include "cIGZPersistDBSegment.h"
+#include "cIGZPersistDBSegmentMultiPackedFiles.h"
+#include "cIGZPersistResourceManager.h"
+#include "cRZAutoRefCount.h"
+#include "GZServPtrs.h"
+
+bool PersistResourceUtil::GetResourceFilePath(const cGZPersistResourceKey& key, cIGZString& path)
+{
+	cIGZPersistResourceManagerPtr pResMan;
+
+	return GetResourceFilePath(pResMan, key, path);
+}
+
+bool PersistResourceUtil::GetResourceFilePath(
+	cIGZPersistResourceManager* pResMan,
+	const cGZPersistResourceKey& key,
+	cIGZString& path)
+{
+	bool result = false;
+
+	if (pResMan)
+	{
+		cRZAutoRefCount<cIGZPersistDBSegment> pSegment;
+
+		if (pResMan->FindDBSegment(key, pSegment.AsPPObj()))
+		{
+			cRZAutoRefCount<cIGZPersistDBSegmentMultiPackedFiles> pMultiPackedFile;
+
+			if (pSegment->QueryInterface(GZIID_cIGZPersistDBSegmentMultiPackedFiles, pMultiPackedFile.AsPPVoid()))
+			{
+				// cIGZPersistDBSegmentMultiPackedFiles is a collection of DAT files in a specific folder
+				// and its sub-folders.
+				// Call its FindDBSegment method to get the actual file.
+
+				cRZAutoRefCount<cIGZPersistDBSegment> pMultiPackedSegment;
+
+				if (pMultiPackedFile->FindDBSegment(key, pMultiPackedSegment.AsPPObj()))
+				{
+					pMultiPackedSegment->GetPath(path);
+					result = true;
+				}
+			}
+			else
+			{
+				pSegment->GetPath(path);
+				result = true;
+			}
+		}
+	}
+
+	return result;
+}
@@ -22,7 +22,9 @@
 #include "version.h"
 #include "FileSystem.h"
 #include "Logger.h"
+#include "PerformanceCounters.h"
 #include "ExemplarLoadLogger.h"
+#include "ExemplarLoadTraceRecorder.h"
 #include "ExemplarPatchingServer.h"
 #include "ExemplarResourceFactoryProxy.h"
 #include "cIGZApp.h"
@@ -38,6 +40,7 @@
 
 #include <algorithm>
 #include <cctype>
+#include <charconv>
 #include <filesystem>
 #include <functional>
 #include <memory>
@@ -48,6 +51,7 @@ static constexpr uint32_t kResourceLoadingHooksDirectorID = 0x512B0315;
 using namespace std::string_view_literals;
 
 static constexpr std::string_view PluginLogFileName = "SC4ResourceLoadingHooks.log"sv;
+static constexpr std::string_view PerformanceReportFileName = "SC4ResourceLoadingHooks.perf.json"sv;
 
 static cIGZUnknown* CreateExemplarResourceProxy()
 {
@@ -93,6 +97,66 @@ static bool QueryForExemplarPatchingServerInterface(uint32_t riid, void** ppvObj
 	return result;
 }
 
+static LogRotationOptions GetLogRotationOptions(cIGZFrameWork* const pFrameWork)
+{
+	LogRotationOptions options;
+
+	cIGZCmdLine* pCmdLine = pFrameWork->CommandLine();
+
+	if (pCmdLine)
+	{
+		cRZBaseString value;
+
+		if (pCmdLine->IsSwitchPresent(cRZBaseString("log-max-size"), value, true))
+		{
+			const std::string_view text(value.ToChar(), value.Strlen());
+			uint64_t sizeInMiB = 0;
+
+			// The size is limited to 1 TiB, which also keeps the conversion to bytes from overflowing.
+			constexpr uint64_t MaxSizeInMiB = 1024 * 1024;
+
+			const auto result = std::from_chars(text.data(), text.data() + text.size(), sizeInMiB);
+
+			if (result.ec == std::errc()
+				&& result.ptr == text.data() + text.size()
+				&& sizeInMiB <= MaxSizeInMiB)
+			{
+				options.maxFileSize = sizeInMiB * 1024 * 1024;
+			}
+			else
+			{
+				Logger::GetInstance().WriteLineFormatted(
+					LogLevel::Error,
+					"Invalid -log-max-size value '%s', expected a size in MiB from 0 to %llu.",
+					value.ToChar(),
+					static_cast<unsigned long long>(MaxSizeInMiB));
+			}
+		}
+
+		if (pCmdLine->IsSwitchPresent(cRZBaseString("log-max-files"), value, true))
+		{
+			const std::string_view text(value.ToChar(), value.Strlen());
+			uint32_t maxFileCount = 0;
+
+			const auto result = std::from_chars(text.data(), text.data() + text.size(), maxFileCount);
+
+			if (result.ec == std::errc() && result.ptr == text.data() + text.size())
+			{
+				options.maxFileCount = maxFileCount;
+			}
+			else
+			{
+				Logger::GetInstance().WriteLineFormatted(
+					LogLevel::Error,
+					"Invalid -log-max-files value '%s', expected a number.",
+					value.ToChar());
+			}
+		}
+	}
+
+	return options;
+}
+
 class ResourceLoadingHooksDllDirector : public cRZCOMDllDirector
 {
 public:
@@ -156,7 +220,44 @@ public:
 		// before our exemplar resource factory proxy is registered.
 		AddExemplarPatchingService();
 		RegisterExemplarResourceFactoryProxy();
-		exemplarLoadLogger.Init(mpFrameWork);
+
+		cIGZCmdLine* const pCmdLine = mpFrameWork->CommandLine();
+
+		if (pCmdLine && pCmdLine->IsSwitchPresent(cRZBaseString("resource-loading-perf-stats")))
+		{
+			PerformanceCounters::Enable();
+		}
+
+		const LogRotationOptions rotationOptions = GetLogRotationOptions(mpFrameWork);
+
+		Logger::GetInstance().SetRotationOptions(rotationOptions);
+		exemplarLoadLogger.Init(mpFrameWork, rotationOptions);
+		exemplarLoadTraceRecorder.Init(mpFrameWork);
+
+		mpFrameWork->AddHook(this);
+
+		return true;
+	}
+
+	bool PostAppShutdown()
+	{
+		exemplarLoadLogger.Shutdown();
+		exemplarLoadTraceRecorder.Shutdown();
+
+		if (PerformanceCounters::IsEnabled())
+		{
+			std::filesystem::path reportPath = FileSystem::GetDllFolderPath();
+			reportPath /= PerformanceReportFileName;
+
+			if (!PerformanceCounters::WriteReport(reportPath))
+			{
+				Logger::GetInstance().WriteLine(
+					LogLevel::Error,
+					"Failed to write the performance counter report.");
+			}
+		}
+
+		Logger::GetInstance().Shutdown();
 
 		return true;
 	}
@@ -164,6 +265,7 @@ public:
 private:
 
 	ExemplarLoadLogger exemplarLoadLogger;
+	ExemplarLoadTraceRecorder exemplarLoadTraceRecorder;
 };
 
 cRZCOMDllDirector* RZGetCOMDllDirector() {
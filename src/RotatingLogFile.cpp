@@ -0,0 +1,378 @@
+/*
+ * This file is part of sc4-resource-loading-hooks, a DLL Plugin for SimCity 4
+ * that allows other DLLs to modify resources as the game loads them.
+ *
+ * Copyright (C) 2024, 2025 Nicholas Hayes
+ *
+ * sc4-resource-loading-hooks is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * sc4-resource-loading-hooks is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with sc4-resource-loading-hooks.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "RotatingLogFile.h"
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include "zlib.h"
+
+namespace
+{
+	static constexpr size_t CompressionBufferSize = 64 * 1024;
+
+	struct RotatedLogSegment
+	{
+		std::filesystem::path logFilePath;
+		std::filesystem::path segmentPath;
+		uint32_t maxFileCount;
+	};
+
+	bool CompressFile(const std::filesystem::path& source, const std::filesystem::path& destination)
+	{
+		std::ifstream input(source, std::ifstream::in | std::ifstream::binary);
+		std::ofstream output(destination, std::ofstream::out | std::ofstream::binary | std::ofstream::trunc);
+
+		if (!input || !output)
+		{
+			return false;
+		}
+
+		z_stream zs{};
+
+		// Adding 16 to the window bits makes zlib write a gzip header.
+		if (deflateInit2(&zs, Z_DEFAULT_COMPRESSION, Z_DEFLATED, MAX_WBITS + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+		{
+			return false;
+		}
+
+		std::unique_ptr<char[]> inputBuffer = std::make_unique_for_overwrite<char[]>(CompressionBufferSize);
+		std::unique_ptr<char[]> outputBuffer = std::make_unique_for_overwrite<char[]>(CompressionBufferSize);
+
+		bool result = true;
+		int flush = Z_NO_FLUSH;
+
+		do
+		{
+			input.read(inputBuffer.get(), CompressionBufferSize);
+
+			if (input.bad())
+			{
+				result = false;
+				break;
+			}
+
+			zs.next_in = reinterpret_cast<Bytef*>(inputBuffer.get());
+			zs.avail_in = static_cast<uInt>(input.gcount());
+			flush = input.eof() ? Z_FINISH : Z_NO_FLUSH;
+
+			do
+			{
+				zs.next_out = reinterpret_cast<Bytef*>(outputBuffer.get());
+				zs.avail_out = static_cast<uInt>(CompressionBufferSize);
+
+				if (deflate(&zs, flush) == Z_STREAM_ERROR)
+				{
+					result = false;
+					break;
+				}
+
+				output.write(outputBuffer.get(), CompressionBufferSize - zs.avail_out);
+			} while (zs.avail_out == 0);
+
+		} while (result && flush != Z_FINISH);
+
+		deflateEnd(&zs);
+		output.close();
+
+		return result && !output.fail();
+	}
+
+	std::filesystem::path GetSegmentPath(
+		const std::filesystem::path& logFilePath,
+		uint32_t index,
+		bool compressed)
+	{
+		std::filesystem::path fileName = logFilePath.stem();
+		fileName += ".";
+		fileName += std::to_string(index);
+		fileName += logFilePath.extension();
+
+		if (compressed)
+		{
+			fileName += ".gz";
+		}
+
+		return logFilePath.parent_path() / fileName;
+	}
+
+	void ProcessRotatedSegment(const RotatedLogSegment& segment)
+	{
+		std::error_code ec;
+
+		if (segment.maxFileCount == 0)
+		{
+			std::filesystem::remove(segment.segmentPath, ec);
+			return;
+		}
+
+		std::filesystem::path compressedPath = segment.segmentPath;
+		compressedPath += ".gz";
+
+		const bool compressed = CompressFile(segment.segmentPath, compressedPath);
+
+		if (compressed)
+		{
+			std::filesystem::remove(segment.segmentPath, ec);
+		}
+		else
+		{
+			std::filesystem::remove(compressedPath, ec);
+		}
+
+		// Shift the existing segments up by one, the oldest segment is deleted.
+		// A segment is left uncompressed if the compression failed, so both
+		// variants of the file name are checked.
+		for (const bool variant : { true, false })
+		{
+			std::filesystem::remove(GetSegmentPath(segment.logFilePath, segment.maxFileCount, variant), ec);
+
+			for (uint32_t i = segment.maxFileCount - 1; i >= 1; i--)
+			{
+				const std::filesystem::path source = GetSegmentPath(segment.logFilePath, i, variant);
+
+				if (std::filesystem::exists(source, ec))
+				{
+					std::filesystem::rename(source, GetSegmentPath(segment.logFilePath, i + 1, variant), ec);
+				}
+			}
+		}
+
+		std::filesystem::rename(
+			compressed ? compressedPath : segment.segmentPath,
+			GetSegmentPath(segment.logFilePath, 1, compressed),
+			ec);
+	}
+}
+
+struct RotatingLogFile::CompressionQueue
+{
+	std::mutex mutex;
+	std::condition_variable condition;
+	std::deque<RotatedLogSegment> segments;
+	bool stopRequested = false;
+
+	static void ThreadProc(std::shared_ptr<CompressionQueue> queue)
+	{
+		std::unique_lock<std::mutex> lock(queue->mutex);
+
+		while (true)
+		{
+			queue->condition.wait(lock, [&] { return queue->stopRequested || !queue->segments.empty(); });
+
+			if (queue->segments.empty())
+			{
+				// The pending segments are always processed before the thread exits.
+				break;
+			}
+
+			RotatedLogSegment segment = std::move(queue->segments.front());
+			queue->segments.pop_front();
+
+			lock.unlock();
+			ProcessRotatedSegment(segment);
+			lock.lock();
+		}
+	}
+};
+
+RotatingLogFile::RotatingLogFile(size_t streamBufferSize)
+	: logFilePath(),
+	  streamBuffer(),
+	  streamBufferSize(streamBufferSize),
+	  stream(),
+	  fileHeader(),
+	  bytesWritten(0),
+	  rotationCount(0),
+	  rotationOptions(),
+	  compressionQueue(std::make_shared<CompressionQueue>()),
+	  compressionThread()
+{
+	if (streamBufferSize > 0)
+	{
+		streamBuffer = std::make_unique_for_overwrite<char[]>(streamBufferSize);
+	}
+}
+
+RotatingLogFile::~RotatingLogFile()
+{
+	if (compressionThread.joinable())
+	{
+		// Joining a thread when the DLL is being unloaded can deadlock on the
+		// loader lock. The compression thread owns a reference to the queue,
+		// so it can safely finish its work after this object is destroyed.
+		{
+			std::lock_guard<std::mutex> lock(compressionQueue->mutex);
+			compressionQueue->stopRequested = true;
+		}
+		compressionQueue->condition.notify_one();
+		compressionThread.detach();
+	}
+}
+
+bool RotatingLogFile::Open(const std::filesystem::path& path)
+{
+	logFilePath = path;
+
+	return OpenCore();
+}
+
+bool RotatingLogFile::IsOpen() const
+{
+	return stream.is_open() && stream.good();
+}
+
+void RotatingLogFile::SetRotationOptions(const LogRotationOptions& options)
+{
+	rotationOptions = options;
+}
+
+void RotatingLogFile::SetFileHeader(const std::string_view& header)
+{
+	fileHeader = header;
+	fileHeader.push_back('\n');
+
+	if (stream)
+	{
+		stream.write(fileHeader.data(), static_cast<std::streamsize>(fileHeader.size()));
+		stream.flush();
+		bytesWritten += fileHeader.size();
+	}
+}
+
+void RotatingLogFile::Write(const std::string_view& text)
+{
+	RotateIfRequired();
+
+	if (stream)
+	{
+		stream.write(text.data(), static_cast<std::streamsize>(text.size()));
+		bytesWritten += text.size();
+	}
+}
+
+void RotatingLogFile::WriteLine(const std::string_view& line)
+{
+	RotateIfRequired();
+
+	if (stream)
+	{
+		stream.write(line.data(), static_cast<std::streamsize>(line.size()));
+		stream.put('\n');
+		bytesWritten += line.size() + 1;
+	}
+}
+
+void RotatingLogFile::Flush()
+{
+	if (stream)
+	{
+		stream.flush();
+	}
+}
+
+void RotatingLogFile::Shutdown()
+{
+	Flush();
+
+	if (compressionThread.joinable())
+	{
+		{
+			std::lock_guard<std::mutex> lock(compressionQueue->mutex);
+			compressionQueue->stopRequested = true;
+		}
+		compressionQueue->condition.notify_one();
+		compressionThread.join();
+	}
+}
+
+bool RotatingLogFile::OpenCore()
+{
+	if (streamBuffer)
+	{
+		// The stream buffer must be set before the file is opened.
+		stream.rdbuf()->pubsetbuf(streamBuffer.get(), static_cast<std::streamsize>(streamBufferSize));
+	}
+
+	stream.open(logFilePath, std::ofstream::out | std::ofstream::trunc);
+	bytesWritten = 0;
+
+	return stream.is_open();
+}
+
+void RotatingLogFile::RotateIfRequired()
+{
+	if (rotationOptions.maxFileSize == 0 || bytesWritten < rotationOptions.maxFileSize)
+	{
+		return;
+	}
+
+	stream.close();
+
+	// The log file is renamed to a unique temporary name so that the game can keep writing
+	// to a new log file while the old one is compressed.
+	std::filesystem::path segmentPath = logFilePath;
+	segmentPath.replace_extension();
+	segmentPath += ".rotating-";
+	segmentPath += std::to_string(++rotationCount);
+	segmentPath += logFilePath.extension();
+
+	std::error_code ec;
+	std::filesystem::rename(logFilePath, segmentPath, ec);
+
+	OpenCore();
+
+	if (!fileHeader.empty() && stream)
+	{
+		stream.write(fileHeader.data(), static_cast<std::streamsize>(fileHeader.size()));
+		bytesWritten += fileHeader.size();
+	}
+
+	if (ec)
+	{
+		// The old log file could not be renamed, its contents are discarded
+		// when the file is reopened.
+		return;
+	}
+
+	RotatedLogSegment segment{ logFilePath, segmentPath, rotationOptions.maxFileCount };
+
+	{
+		std::lock_guard<std::mutex> lock(compressionQueue->mutex);
+
+		if (!compressionQueue->stopRequested)
+		{
+			compressionQueue->segments.push_back(std::move(segment));
+
+			if (!compressionThread.joinable())
+			{
+				compressionThread = std::thread(CompressionQueue::ThreadProc, compressionQueue);
+			}
+
+			compressionQueue->condition.notify_one();
+			return;
+		}
+	}
+
+	// The compression thread has been stopped, process the segment on this thread.
+	ProcessRotatedSegment(segment);
+}
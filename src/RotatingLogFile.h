@@ -0,0 +1,91 @@
+/*
+ * This file is part of sc4-resource-loading-hooks, a DLL Plugin for SimCity 4
+ * that allows other DLLs to modify resources as the game loads them.
+ *
+ * Copyright (C) 2024, 2025 Nicholas Hayes
+ *
+ * sc4-resource-loading-hooks is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * sc4-resource-loading-hooks is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with sc4-resource-loading-hooks.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <thread>
+
+struct LogRotationOptions
+{
+	// The maximum size of the log file in bytes, a value of 0 disables rotation.
+	uint64_t maxFileSize = 0;
+	// The number of rotated log files that are kept.
+	uint32_t maxFileCount = 5;
+};
+
+// A log file that is rotated when it exceeds a size limit.
+// The rotated files are named <name>.1<ext>.gz, <name>.2<ext>.gz, etc.
+// with 1 being the most recent. They are compressed on a background thread.
+//
+// The class is not thread-safe, a write can close and reopen the stream when the file
+// is rotated. The owner must serialize every call, including IsOpen.
+class RotatingLogFile
+{
+public:
+
+	explicit RotatingLogFile(size_t streamBufferSize = 0);
+	~RotatingLogFile();
+
+	RotatingLogFile(const RotatingLogFile&) = delete;
+	RotatingLogFile& operator=(const RotatingLogFile&) = delete;
+
+	bool Open(const std::filesystem::path& path);
+
+	bool IsOpen() const;
+
+	void SetRotationOptions(const LogRotationOptions& options);
+
+	// Writes the header text and repeats it at the start of every
+	// new log file after a rotation.
+	void SetFileHeader(const std::string_view& header);
+
+	void Write(const std::string_view& text);
+
+	void WriteLine(const std::string_view& line);
+
+	void Flush();
+
+	// Flushes the log file and waits for the pending compression work to finish.
+	void Shutdown();
+
+private:
+
+	struct CompressionQueue;
+
+	bool OpenCore();
+	void RotateIfRequired();
+
+	std::filesystem::path logFilePath;
+	std::unique_ptr<char[]> streamBuffer;
+	size_t streamBufferSize;
+	std::ofstream stream;
+	std::string fileHeader;
+	uint64_t bytesWritten;
+	uint32_t rotationCount;
+	LogRotationOptions rotationOptions;
+	std::shared_ptr<CompressionQueue> compressionQueue;
+	std::thread compressionThread;
+};
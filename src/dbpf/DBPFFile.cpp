@@ -0,0 +1,187 @@
+/*
+ * This file is part of sc4-resource-loading-hooks, a DLL Plugin for SimCity 4
+ * that allows other DLLs to modify resources as the game loads them.
+ *
+ * Copyright (C) 2024, 2025 Nicholas Hayes
+ *
+ * sc4-resource-loading-hooks is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * sc4-resource-loading-hooks is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with sc4-resource-loading-hooks.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "DBPFFile.h"
+#include "DBPFFormat.h"
+#include "RefPackDecompressor.h"
+
+DBPFFile::DBPFFile()
+	: path(),
+	  file(),
+	  indexData(nullptr),
+	  indexEntryCount(0),
+	  indexEntrySize(DBPF::IndexEntrySize),
+	  compressedRecordSizes()
+{
+}
+
+bool DBPFFile::Open(const std::filesystem::path& path)
+{
+	this->path = path;
+	indexData = nullptr;
+	indexEntryCount = 0;
+	compressedRecordSizes.clear();
+
+	if (!file.Open(path))
+	{
+		return false;
+	}
+
+	const uint8_t* const data = file.GetData();
+	const size_t size = file.GetSize();
+
+	if (size < DBPF::HeaderSize
+		|| DBPF::ReadUint32(data) != DBPF::HeaderMagic
+		|| DBPF::ReadUint32(data + DBPF::MajorVersionOffset) != DBPF::MajorVersion
+		|| DBPF::ReadUint32(data + DBPF::IndexMajorVersionOffset) != DBPF::IndexMajorVersion)
+	{
+		file.Close();
+		return false;
+	}
+
+	// DBPF 1.1 files can use the 7.1 index format.
+	const uint32_t indexMinorVersion = DBPF::ReadUint32(data + DBPF::MinorVersionOffset) >= 1
+		? DBPF::ReadUint32(data + DBPF::IndexMinorVersionOffset)
+		: 0;
+
+	indexEntrySize = indexMinorVersion == 1 ? DBPF::IndexEntrySizeV71 : DBPF::IndexEntrySize;
+
+	const uint64_t entryCount = DBPF::ReadUint32(data + DBPF::IndexEntryCountOffset);
+	const uint64_t indexOffset = DBPF::ReadUint32(data + DBPF::IndexOffsetOffset);
+
+	if (indexOffset + (entryCount * indexEntrySize) > size)
+	{
+		file.Close();
+		return false;
+	}
+
+	indexData = data + indexOffset;
+	indexEntryCount = static_cast<size_t>(entryCount);
+
+	ReadDirectory();
+
+	return true;
+}
+
+const std::filesystem::path& DBPFFile::GetPath() const
+{
+	return path;
+}
+
+size_t DBPFFile::GetIndexEntryCount() const
+{
+	return indexEntryCount;
+}
+
+DBPFFile::IndexEntry DBPFFile::GetIndexEntry(size_t index) const
+{
+	return ReadIndexEntry(indexData + (index * indexEntrySize));
+}
+
+std::span<const uint8_t> DBPFFile::GetRecordData(const IndexEntry& entry) const
+{
+	const uint64_t end = static_cast<uint64_t>(entry.offset) + entry.size;
+
+	if (end > file.GetSize())
+	{
+		return {};
+	}
+
+	return std::span<const uint8_t>(file.GetData() + entry.offset, entry.size);
+}
+
+bool DBPFFile::ReadRecord(const IndexEntry& entry, std::vector<uint8_t>& buffer, std::span<const uint8_t>& data) const
+{
+	data = GetRecordData(entry);
+
+	if (data.size() != entry.size)
+	{
+		return false;
+	}
+
+	uint32_t uncompressedSize = 0;
+
+	if (TryGetUncompressedSize(entry.key, uncompressedSize))
+	{
+		buffer.resize(uncompressedSize);
+
+		if (!RefPackDecompressor::Decompress(data.data(), data.size(), buffer.data(), buffer.size()))
+		{
+			return false;
+		}
+
+		data = buffer;
+	}
+
+	return true;
+}
+
+bool DBPFFile::TryGetUncompressedSize(const cGZPersistResourceKey& key, uint32_t& uncompressedSize) const
+{
+	const auto item = compressedRecordSizes.find(key);
+
+	if (item != compressedRecordSizes.end())
+	{
+		uncompressedSize = item->second;
+		return true;
+	}
+
+	return false;
+}
+
+DBPFFile::IndexEntry DBPFFile::ReadIndexEntry(const uint8_t* entry) const
+{
+	// The 7.1 index format has an extra field after the instance ID.
+	const size_t locationOffset = indexEntrySize - 8;
+
+	return IndexEntry
+	{
+		cGZPersistResourceKey(DBPF::ReadUint32(entry), DBPF::ReadUint32(entry + 4), DBPF::ReadUint32(entry + 8)),
+		DBPF::ReadUint32(entry + locationOffset),
+		DBPF::ReadUint32(entry + locationOffset + 4)
+	};
+}
+
+void DBPFFile::ReadDirectory()
+{
+	FindIndexEntries(DBPF::DirectoryType, DBPF::DirectoryGroup, [&](const IndexEntry& entry)
+	{
+		if (entry.key.instance != DBPF::DirectoryInstance)
+		{
+			return;
+		}
+
+		const std::span<const uint8_t> directory = GetRecordData(entry);
+		const size_t directoryEntrySize = indexEntrySize - 4;
+		const size_t count = directory.size() / directoryEntrySize;
+
+		compressedRecordSizes.reserve(count);
+
+		for (size_t i = 0; i < count; i++)
+		{
+			const uint8_t* item = directory.data() + (i * directoryEntrySize);
+
+			compressedRecordSizes.emplace(
+				cGZPersistResourceKey(DBPF::ReadUint32(item), DBPF::ReadUint32(item + 4), DBPF::ReadUint32(item + 8)),
+				DBPF::ReadUint32(item + directoryEntrySize - 4));
+		}
+	});
+}
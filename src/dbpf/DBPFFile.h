@@ -0,0 +1,96 @@
+/*
+ * This file is part of sc4-resource-loading-hooks, a DLL Plugin for SimCity 4
+ * that allows other DLLs to modify resources as the game loads them.
+ *
+ * Copyright (C) 2024, 2025 Nicholas Hayes
+ *
+ * sc4-resource-loading-hooks is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * sc4-resource-loading-hooks is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with sc4-resource-loading-hooks.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#include "cGZPersistResourceKey.h"
+#include "DBPFFormat.h"
+#include "MemoryMappedFile.h"
+#include "PersistResourceKeyBoostHash.h"
+#include <cstdint>
+#include <filesystem>
+#include <span>
+#include <vector>
+
+#include "boost/unordered/unordered_flat_map.hpp"
+
+// Reads the index and records of a DBPF file directly from a memory mapping.
+// The index entries are parsed in place, nothing is copied when the file is opened.
+class DBPFFile
+{
+public:
+
+	struct IndexEntry
+	{
+		cGZPersistResourceKey key;
+		uint32_t offset;
+		uint32_t size;
+	};
+
+	DBPFFile();
+
+	bool Open(const std::filesystem::path& path);
+
+	const std::filesystem::path& GetPath() const;
+
+	size_t GetIndexEntryCount() const;
+
+	IndexEntry GetIndexEntry(size_t index) const;
+
+	// Calls the callback for every index entry with the specified type and group.
+	template <typename Callback>
+	void FindIndexEntries(uint32_t type, uint32_t group, Callback&& callback) const
+	{
+		const uint8_t* entry = indexData;
+
+		for (size_t i = 0; i < indexEntryCount; i++, entry += indexEntrySize)
+		{
+			if (DBPF::ReadUint32(entry) == type && DBPF::ReadUint32(entry + 4) == group)
+			{
+				callback(ReadIndexEntry(entry));
+			}
+		}
+	}
+
+	// Returns the stored record data, which may be compressed.
+	std::span<const uint8_t> GetRecordData(const IndexEntry& entry) const;
+
+	// Gets the uncompressed record data. Compressed records are decompressed into
+	// the buffer, uncompressed records are returned without copying them.
+	// Returns false if the record data is not valid.
+	bool ReadRecord(const IndexEntry& entry, std::vector<uint8_t>& buffer, std::span<const uint8_t>& data) const;
+
+	// Gets the uncompressed size of a record from the directory record.
+	// Returns false if the record is not compressed.
+	bool TryGetUncompressedSize(const cGZPersistResourceKey& key, uint32_t& uncompressedSize) const;
+
+private:
+
+	IndexEntry ReadIndexEntry(const uint8_t* entry) const;
+
+	void ReadDirectory();
+
+	std::filesystem::path path;
+	MemoryMappedFile file;
+	const uint8_t* indexData;
+	size_t indexEntryCount;
+	size_t indexEntrySize;
+	boost::unordered_flat_map<const cGZPersistResourceKey, uint32_t> compressedRecordSizes;
+};
@@ -0,0 +1,81 @@
+/*
+ * This file is part of sc4-resource-loading-hooks, a DLL Plugin for SimCity 4
+ * that allows other DLLs to modify resources as the game loads them.
+ *
+ * Copyright (C) 2024, 2025 Nicholas Hayes
+ *
+ * sc4-resource-loading-hooks is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * sc4-resource-loading-hooks is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with sc4-resource-loading-hooks.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+// The DBPF 1.0 file format used by SimCity 4, with the version 7.0 index.
+// All values are stored in little-endian byte order.
+namespace DBPF
+{
+	static_assert(std::endian::native == std::endian::little, "The DBPF reader and writer require a little-endian platform.");
+
+	static constexpr uint32_t HeaderMagic = 0x46504244; // DBPF
+	static constexpr size_t HeaderSize = 96;
+	static constexpr uint32_t MajorVersion = 1;
+	static constexpr uint32_t MinorVersion = 0;
+	static constexpr uint32_t IndexMajorVersion = 7;
+
+	// The header field offsets.
+	static constexpr size_t MajorVersionOffset = 4;
+	static constexpr size_t MinorVersionOffset = 8;
+	static constexpr size_t DateCreatedOffset = 24;
+	static constexpr size_t DateModifiedOffset = 28;
+	static constexpr size_t IndexMajorVersionOffset = 32;
+	static constexpr size_t IndexEntryCountOffset = 36;
+	static constexpr size_t IndexOffsetOffset = 40;
+	static constexpr size_t IndexSizeOffset = 44;
+	static constexpr size_t IndexMinorVersionOffset = 60;
+
+	// An index entry contains the type, group, instance, offset and size.
+	// DBPF 1.1 files with index version 7.1 add a resource ID after the instance.
+	static constexpr size_t IndexEntrySize = 20;
+	static constexpr size_t IndexEntrySizeV71 = 24;
+
+	// The directory record lists the uncompressed size of every compressed record.
+	static constexpr uint32_t DirectoryType = 0xE86B1EEF;
+	static constexpr uint32_t DirectoryGroup = 0xE86B1EEF;
+	static constexpr uint32_t DirectoryInstance = 0x286B1F03;
+	static constexpr size_t DirectoryEntrySize = 16;
+
+	// A compressed record starts with the compressed size, the QFS signature
+	// and the 24-bit big-endian uncompressed size.
+	static constexpr size_t QfsHeaderSize = 9;
+	static constexpr uint8_t QfsSignature0 = 0x10;
+	static constexpr uint8_t QfsSignature1 = 0xFB;
+	static constexpr uint32_t QfsMaxUncompressedSize = 0xFFFFFF;
+
+	inline uint32_t ReadUint32(const uint8_t* data)
+	{
+		uint32_t value;
+		std::memcpy(&value, data, sizeof(value));
+
+		return value;
+	}
+
+	inline void WriteUint32(uint8_t* data, uint32_t value)
+	{
+		std::memcpy(data, &value, sizeof(value));
+	}
+}
@@ -0,0 +1,177 @@
+/*
+ * This file is part of sc4-resource-loading-hooks, a DLL Plugin for SimCity 4
+ * that allows other DLLs to modify resources as the game loads them.
+ *
+ * Copyright (C) 2024, 2025 Nicholas Hayes
+ *
+ * sc4-resource-loading-hooks is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * sc4-resource-loading-hooks is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with sc4-resource-loading-hooks.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "DBPFWriter.h"
+#include "DBPFFormat.h"
+#include "RefPackCompressor.h"
+#include <ctime>
+
+DBPFWriter::DBPFWriter()
+	: stream(),
+	  index(),
+	  directory(),
+	  compressionBuffer(),
+	  currentOffset(0)
+{
+}
+
+DBPFWriter::~DBPFWriter()
+{
+	if (stream.is_open())
+	{
+		Close();
+	}
+}
+
+bool DBPFWriter::Open(const std::filesystem::path& path)
+{
+	stream.open(path, std::ofstream::out | std::ofstream::binary | std::ofstream::trunc);
+
+	if (!stream)
+	{
+		return false;
+	}
+
+	index.clear();
+	directory.clear();
+
+	// The header is written when the file is closed.
+	const uint8_t emptyHeader[DBPF::HeaderSize]{};
+	stream.write(reinterpret_cast<const char*>(emptyHeader), sizeof(emptyHeader));
+	currentOffset = DBPF::HeaderSize;
+
+	return stream.good();
+}
+
+bool DBPFWriter::AddRecord(const cGZPersistResourceKey& key, const uint8_t* data, size_t size, bool compress)
+{
+	if (!stream.is_open())
+	{
+		return false;
+	}
+
+	if (compress && RefPackCompressor::Compress(data, size, compressionBuffer))
+	{
+		directory.push_back(DirectoryEntry{ key, static_cast<uint32_t>(size) });
+
+		return WriteRecordData(key, compressionBuffer.data(), compressionBuffer.size());
+	}
+
+	return WriteRecordData(key, data, size);
+}
+
+bool DBPFWriter::Close()
+{
+	if (!stream.is_open())
+	{
+		return false;
+	}
+
+	bool result = true;
+
+	if (!directory.empty())
+	{
+		std::vector<uint8_t> directoryData(directory.size() * DBPF::DirectoryEntrySize);
+		uint8_t* entry = directoryData.data();
+
+		for (const DirectoryEntry& item : directory)
+		{
+			DBPF::WriteUint32(entry, item.key.type);
+			DBPF::WriteUint32(entry + 4, item.key.group);
+			DBPF::WriteUint32(entry + 8, item.key.instance);
+			DBPF::WriteUint32(entry + 12, item.uncompressedSize);
+
+			entry += DBPF::DirectoryEntrySize;
+		}
+
+		result = WriteRecordData(
+			cGZPersistResourceKey(DBPF::DirectoryType, DBPF::DirectoryGroup, DBPF::DirectoryInstance),
+			directoryData.data(),
+			directoryData.size());
+	}
+
+	const uint64_t indexOffset = currentOffset;
+	const uint64_t indexSize = static_cast<uint64_t>(index.size()) * DBPF::IndexEntrySize;
+
+	if (result && indexOffset + indexSize <= UINT32_MAX)
+	{
+		std::vector<uint8_t> indexData(indexSize);
+		uint8_t* entry = indexData.data();
+
+		for (const IndexEntry& item : index)
+		{
+			DBPF::WriteUint32(entry, item.key.type);
+			DBPF::WriteUint32(entry + 4, item.key.group);
+			DBPF::WriteUint32(entry + 8, item.key.instance);
+			DBPF::WriteUint32(entry + 12, item.offset);
+			DBPF::WriteUint32(entry + 16, item.size);
+
+			entry += DBPF::IndexEntrySize;
+		}
+
+		stream.write(reinterpret_cast<const char*>(indexData.data()), static_cast<std::streamsize>(indexData.size()));
+
+		const uint32_t timestamp = static_cast<uint32_t>(std::time(nullptr));
+
+		uint8_t header[DBPF::HeaderSize]{};
+		DBPF::WriteUint32(header, DBPF::HeaderMagic);
+		DBPF::WriteUint32(header + DBPF::MajorVersionOffset, DBPF::MajorVersion);
+		DBPF::WriteUint32(header + DBPF::MinorVersionOffset, DBPF::MinorVersion);
+		DBPF::WriteUint32(header + DBPF::DateCreatedOffset, timestamp);
+		DBPF::WriteUint32(header + DBPF::DateModifiedOffset, timestamp);
+		DBPF::WriteUint32(header + DBPF::IndexMajorVersionOffset, DBPF::IndexMajorVersion);
+		DBPF::WriteUint32(header + DBPF::IndexEntryCountOffset, static_cast<uint32_t>(index.size()));
+		DBPF::WriteUint32(header + DBPF::IndexOffsetOffset, static_cast<uint32_t>(indexOffset));
+		DBPF::WriteUint32(header + DBPF::IndexSizeOffset, static_cast<uint32_t>(indexSize));
+
+		stream.seekp(0);
+		stream.write(reinterpret_cast<const char*>(header), sizeof(header));
+	}
+	else
+	{
+		result = false;
+	}
+
+	stream.close();
+
+	return result && !stream.fail();
+}
+
+size_t DBPFWriter::GetRecordCount() const
+{
+	return index.size();
+}
+
+bool DBPFWriter::WriteRecordData(const cGZPersistResourceKey& key, const uint8_t* data, size_t size)
+{
+	// DBPF 1.0 uses 32-bit file offsets.
+	if (currentOffset + size > UINT32_MAX)
+	{
+		return false;
+	}
+
+	index.push_back(IndexEntry{ key, static_cast<uint32_t>(currentOffset), static_cast<uint32_t>(size) });
+
+	stream.write(reinterpret_cast<const char*>(data), static_cast<std::streamsize>(size));
+	currentOffset += size;
+
+	return stream.good();
+}
@@ -0,0 +1,73 @@
+/*
+ * This file is part of sc4-resource-loading-hooks, a DLL Plugin for SimCity 4
+ * that allows other DLLs to modify resources as the game loads them.
+ *
+ * Copyright (C) 2024, 2025 Nicholas Hayes
+ *
+ * sc4-resource-loading-hooks is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * sc4-resource-loading-hooks is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with sc4-resource-loading-hooks.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#include "cGZPersistResourceKey.h"
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+// Writes a DBPF 1.0 file. The records are written as they are added,
+// the directory record, index and header are written by Close.
+class DBPFWriter
+{
+public:
+
+	DBPFWriter();
+	~DBPFWriter();
+
+	DBPFWriter(const DBPFWriter&) = delete;
+	DBPFWriter& operator=(const DBPFWriter&) = delete;
+
+	bool Open(const std::filesystem::path& path);
+
+	// Adds a record to the file. When compression is requested the record
+	// is stored uncompressed if it does not get smaller.
+	bool AddRecord(const cGZPersistResourceKey& key, const uint8_t* data, size_t size, bool compress);
+
+	bool Close();
+
+	size_t GetRecordCount() const;
+
+private:
+
+	struct IndexEntry
+	{
+		cGZPersistResourceKey key;
+		uint32_t offset;
+		uint32_t size;
+	};
+
+	struct DirectoryEntry
+	{
+		cGZPersistResourceKey key;
+		uint32_t uncompressedSize;
+	};
+
+	bool WriteRecordData(const cGZPersistResourceKey& key, const uint8_t* data, size_t size);
+
+	std::ofstream stream;
+	std::vector<IndexEntry> index;
+	std::vector<DirectoryEntry> directory;
+	std::vector<uint8_t> compressionBuffer;
+	uint64_t currentOffset;
+};
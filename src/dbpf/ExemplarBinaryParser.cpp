@@ -0,0 +1,186 @@
+/*
+ * This file is part of sc4-resource-loading-hooks, a DLL Plugin for SimCity 4
+ * that allows other DLLs to modify resources as the game loads them.
+ *
+ * Copyright (C) 2024, 2025 Nicholas Hayes
+ *
+ * sc4-resource-loading-hooks is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * sc4-resource-loading-hooks is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with sc4-resource-loading-hooks.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ExemplarBinaryParser.h"
+#include "DBPFFormat.h"
+#include <string_view>
+
+namespace
+{
+	uint16_t ReadUint16(const uint8_t* data)
+	{
+		uint16_t value;
+		std::memcpy(&value, data, sizeof(value));
+
+		return value;
+	}
+}
+
+ExemplarBinaryParser::ExemplarBinaryParser()
+	: properties(nullptr),
+	  end(nullptr),
+	  propertyCount(0),
+	  parentCohortKey(),
+	  isCohort(false)
+{
+}
+
+bool ExemplarBinaryParser::Open(const uint8_t* data, size_t size)
+{
+	properties = nullptr;
+	end = nullptr;
+	propertyCount = 0;
+
+	if (!data || size < ExemplarFormat::BinaryHeaderSize)
+	{
+		return false;
+	}
+
+	const std::string_view signature(reinterpret_cast<const char*>(data), ExemplarFormat::SignatureLength);
+
+	if (signature == ExemplarFormat::CohortBinarySignature)
+	{
+		isCohort = true;
+	}
+	else if (signature == ExemplarFormat::ExemplarBinarySignature)
+	{
+		isCohort = false;
+	}
+	else
+	{
+		return false;
+	}
+
+	parentCohortKey.type = DBPF::ReadUint32(data + 8);
+	parentCohortKey.group = DBPF::ReadUint32(data + 12);
+	parentCohortKey.instance = DBPF::ReadUint32(data + 16);
+
+	const uint32_t count = DBPF::ReadUint32(data + 20);
+	const uint8_t* const dataEnd = data + size;
+	const uint8_t* position = data + ExemplarFormat::BinaryHeaderSize;
+	ExemplarPropertyView property{};
+
+	// Validate all of the properties up front, so that
+	// EnumProperties does not have to check the bounds.
+	for (uint32_t i = 0; i < count; i++)
+	{
+		position = ReadProperty(position, dataEnd, property);
+
+		if (!position)
+		{
+			return false;
+		}
+	}
+
+	properties = data + ExemplarFormat::BinaryHeaderSize;
+	end = dataEnd;
+	propertyCount = count;
+
+	return true;
+}
+
+bool ExemplarBinaryParser::IsCohort() const
+{
+	return isCohort;
+}
+
+const cGZPersistResourceKey& ExemplarBinaryParser::GetParentCohortKey() const
+{
+	return parentCohortKey;
+}
+
+uint32_t ExemplarBinaryParser::GetPropertyCount() const
+{
+	return propertyCount;
+}
+
+bool ExemplarBinaryParser::FindProperty(uint32_t id, ExemplarPropertyView& property) const
+{
+	const uint8_t* position = properties;
+
+	for (uint32_t i = 0; i < propertyCount; i++)
+	{
+		position = ReadProperty(position, end, property);
+
+		if (property.id == id)
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+const uint8_t* ExemplarBinaryParser::ReadProperty(
+	const uint8_t* position,
+	const uint8_t* end,
+	ExemplarPropertyView& property)
+{
+	if (static_cast<size_t>(end - position) < ExemplarFormat::BinaryPropertyHeaderSize)
+	{
+		return nullptr;
+	}
+
+	property.id = DBPF::ReadUint32(position);
+	property.type = static_cast<ExemplarFormat::ValueType>(ReadUint16(position + 4));
+
+	const uint16_t keyType = ReadUint16(position + 6);
+	const size_t valueSize = ExemplarFormat::GetValueSize(property.type);
+
+	if (valueSize == 0)
+	{
+		return nullptr;
+	}
+
+	position += ExemplarFormat::BinaryPropertyHeaderSize;
+
+	if (keyType == ExemplarFormat::MultipleValuesKeyType)
+	{
+		if (static_cast<size_t>(end - position) < sizeof(uint32_t))
+		{
+			return nullptr;
+		}
+
+		property.isArray = true;
+		property.count = DBPF::ReadUint32(position);
+		position += sizeof(uint32_t);
+	}
+	else if (keyType == ExemplarFormat::SingleValueKeyType)
+	{
+		property.isArray = false;
+		property.count = 1;
+	}
+	else
+	{
+		return nullptr;
+	}
+
+	const size_t valuesSize = static_cast<size_t>(property.count) * valueSize;
+
+	if (static_cast<size_t>(end - position) < valuesSize)
+	{
+		return nullptr;
+	}
+
+	property.values = position;
+
+	return position + valuesSize;
+}
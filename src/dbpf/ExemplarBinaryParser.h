@@ -0,0 +1,72 @@
+/*
+ * This file is part of sc4-resource-loading-hooks, a DLL Plugin for SimCity 4
+ * that allows other DLLs to modify resources as the game loads them.
+ *
+ * Copyright (C) 2024, 2025 Nicholas Hayes
+ *
+ * sc4-resource-loading-hooks is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * sc4-resource-loading-hooks is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with sc4-resource-loading-hooks.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#include "cGZPersistResourceKey.h"
+#include "ExemplarPropertyView.h"
+#include <cstddef>
+#include <cstdint>
+
+// Reads the properties of a binary exemplar or cohort file in place.
+// The file is validated when it is opened, reading the properties
+// does not allocate any memory.
+class ExemplarBinaryParser
+{
+public:
+
+	ExemplarBinaryParser();
+
+	// Returns false if the data is not a valid binary exemplar or cohort file.
+	bool Open(const uint8_t* data, size_t size);
+
+	bool IsCohort() const;
+
+	const cGZPersistResourceKey& GetParentCohortKey() const;
+
+	uint32_t GetPropertyCount() const;
+
+	// Calls the callback for every property in file order.
+	template<typename Callback>
+	void EnumProperties(Callback&& callback) const
+	{
+		const uint8_t* position = properties;
+		ExemplarPropertyView property{};
+
+		for (uint32_t i = 0; i < propertyCount; i++)
+		{
+			position = ReadProperty(position, end, property);
+			callback(property);
+		}
+	}
+
+	bool FindProperty(uint32_t id, ExemplarPropertyView& property) const;
+
+private:
+
+	// Returns the position of the next property, or nullptr if the property is not valid.
+	static const uint8_t* ReadProperty(const uint8_t* position, const uint8_t* end, ExemplarPropertyView& property);
+
+	const uint8_t* properties;
+	const uint8_t* end;
+	uint32_t propertyCount;
+	cGZPersistResourceKey parentCohortKey;
+	bool isCohort;
+};
@@ -0,0 +1,238 @@
+/*
+ * This file is part of sc4-resource-loading-hooks, a DLL Plugin for SimCity 4
+ * that allows other DLLs to modify resources as the game loads them.
+ *
+ * Copyright (C) 2024, 2025 Nicholas Hayes
+ *
+ * sc4-resource-loading-hooks is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * sc4-resource-loading-hooks is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with sc4-resource-loading-hooks.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ExemplarBinaryWriter.h"
+#include "DBPFFormat.h"
+#include "ExemplarFormat.h"
+#include "cIGZVariant.h"
+#include "cISCProperty.h"
+#include "cISCPropertyHolder.h"
+
+namespace
+{
+	struct WriteContext
+	{
+		std::vector<uint8_t>& output;
+		uint32_t propertyCount;
+		bool succeeded;
+	};
+
+	template<typename T>
+	void AppendValue(std::vector<uint8_t>& output, T value)
+	{
+		const size_t offset = output.size();
+
+		output.resize(offset + sizeof(T));
+		std::memcpy(output.data() + offset, &value, sizeof(T));
+	}
+
+	bool TryGetValueType(uint16_t variantType, ExemplarFormat::ValueType& valueType)
+	{
+		switch (variantType & ~0x80)
+		{
+		case cIGZVariant::Type::Bool:
+			valueType = ExemplarFormat::ValueType::Bool;
+			return true;
+		case cIGZVariant::Type::Uint8:
+			valueType = ExemplarFormat::ValueType::Uint8;
+			return true;
+		case cIGZVariant::Type::Uint16:
+			valueType = ExemplarFormat::ValueType::Uint16;
+			return true;
+		case cIGZVariant::Type::Uint32:
+			valueType = ExemplarFormat::ValueType::Uint32;
+			return true;
+		case cIGZVariant::Type::Sint32:
+			valueType = ExemplarFormat::ValueType::Sint32;
+			return true;
+		case cIGZVariant::Type::Sint64:
+			valueType = ExemplarFormat::ValueType::Sint64;
+			return true;
+		case cIGZVariant::Type::Float32:
+			valueType = ExemplarFormat::ValueType::Float32;
+			return true;
+		case cIGZVariant::Type::RZChar:
+			valueType = ExemplarFormat::ValueType::String;
+			return true;
+		default:
+			return false;
+		}
+	}
+
+	const void* GetValueData(const cIGZVariant* variant, ExemplarFormat::ValueType valueType)
+	{
+		switch (valueType)
+		{
+		case ExemplarFormat::ValueType::Bool:
+			return variant->RefBool();
+		case ExemplarFormat::ValueType::Uint8:
+			return variant->RefUint8();
+		case ExemplarFormat::ValueType::Uint16:
+			return variant->RefUint16();
+		case ExemplarFormat::ValueType::Uint32:
+			return variant->RefUint32();
+		case ExemplarFormat::ValueType::Sint32:
+			return variant->RefSint32();
+		case ExemplarFormat::ValueType::Sint64:
+			return variant->RefSint64();
+		case ExemplarFormat::ValueType::Float32:
+			return variant->RefFloat32();
+		case ExemplarFormat::ValueType::String:
+			return variant->RefRZChar();
+		default:
+			return nullptr;
+		}
+	}
+
+	void WritePropertyCallback(cISCProperty* pProperty, void* pContext)
+	{
+		WriteContext* context = static_cast<WriteContext*>(pContext);
+
+		if (!context->succeeded)
+		{
+			return;
+		}
+
+		const cIGZVariant* variant = pProperty->GetPropertyValue();
+		ExemplarFormat::ValueType valueType{};
+
+		if (!variant || !TryGetValueType(variant->GetType(), valueType))
+		{
+			context->succeeded = false;
+			return;
+		}
+
+		const bool isArray = (variant->GetType() & 0x80) != 0 || valueType == ExemplarFormat::ValueType::String;
+		const uint32_t count = variant->GetCount();
+		const void* values = GetValueData(variant, valueType);
+
+		if ((count > 0 && !values) || (!isArray && count != 1))
+		{
+			context->succeeded = false;
+			return;
+		}
+
+		std::vector<uint8_t>& output = context->output;
+
+		AppendValue<uint32_t>(output, pProperty->GetPropertyID());
+		AppendValue<uint16_t>(output, static_cast<uint16_t>(valueType));
+		AppendValue<uint16_t>(output, isArray ? ExemplarFormat::MultipleValuesKeyType : ExemplarFormat::SingleValueKeyType);
+		output.push_back(0);
+
+		if (isArray)
+		{
+			AppendValue<uint32_t>(output, count);
+		}
+
+		const size_t valuesSize = static_cast<size_t>(count) * ExemplarFormat::GetValueSize(valueType);
+
+		if (valuesSize > 0)
+		{
+			const uint8_t* bytes = static_cast<const uint8_t*>(values);
+
+			if (valueType == ExemplarFormat::ValueType::Bool)
+			{
+				// The size of bool is implementation-defined, the file format uses 1 byte.
+				const bool* boolValues = static_cast<const bool*>(values);
+
+				for (uint32_t i = 0; i < count; i++)
+				{
+					output.push_back(boolValues[i] ? 1 : 0);
+				}
+			}
+			else
+			{
+				output.insert(output.end(), bytes, bytes + valuesSize);
+			}
+		}
+
+		context->propertyCount++;
+	}
+
+	void WriteHeader(
+		const cGZPersistResourceKey& parentCohortKey,
+		ExemplarBinaryWriter::FileKind kind,
+		std::vector<uint8_t>& output)
+	{
+		const std::string_view signature = kind == ExemplarBinaryWriter::FileKind::Cohort
+			? ExemplarFormat::CohortBinarySignature
+			: ExemplarFormat::ExemplarBinarySignature;
+
+		output.insert(output.end(), signature.begin(), signature.end());
+		AppendValue<uint32_t>(output, parentCohortKey.type);
+		AppendValue<uint32_t>(output, parentCohortKey.group);
+		AppendValue<uint32_t>(output, parentCohortKey.instance);
+		// The property count is written after the properties have been written.
+		AppendValue<uint32_t>(output, 0);
+	}
+
+	bool FinishWrite(const WriteContext& context)
+	{
+		if (context.succeeded)
+		{
+			DBPF::WriteUint32(context.output.data() + ExemplarFormat::BinaryHeaderSize - 4, context.propertyCount);
+		}
+
+		return context.succeeded;
+	}
+}
+
+bool ExemplarBinaryWriter::Write(
+	const cISCPropertyHolder* propertyHolder,
+	const cGZPersistResourceKey& parentCohortKey,
+	FileKind kind,
+	std::vector<uint8_t>& output)
+{
+	output.clear();
+
+	if (!propertyHolder)
+	{
+		return false;
+	}
+
+	WriteHeader(parentCohortKey, kind, output);
+
+	WriteContext context{ output, 0, true };
+
+	propertyHolder->EnumProperties(WritePropertyCallback, &context);
+
+	return FinishWrite(context);
+}
+
+bool ExemplarBinaryWriter::Write(
+	std::span<const cRZAutoRefCount<cISCProperty>> properties,
+	const cGZPersistResourceKey& parentCohortKey,
+	FileKind kind,
+	std::vector<uint8_t>& output)
+{
+	output.clear();
+
+	WriteHeader(parentCohortKey, kind, output);
+
+	WriteContext context{ output, 0, true };
+
+	for (const cRZAutoRefCount<cISCProperty>& property : properties)
+	{
+		WritePropertyCallback(property, &context);
+	}
+
+	return FinishWrite(context);
+}
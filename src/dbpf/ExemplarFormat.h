@@ -0,0 +1,99 @@
+/*
+ * This file is part of sc4-resource-loading-hooks, a DLL Plugin for SimCity 4
+ * that allows other DLLs to modify resources as the game loads them.
+ *
+ * Copyright (C) 2024, 2025 Nicholas Hayes
+ *
+ * sc4-resource-loading-hooks is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * sc4-resource-loading-hooks is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with sc4-resource-loading-hooks.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+// The exemplar and cohort file formats.
+//
+// The binary format starts with an 8-byte signature, the parent cohort TGI and the
+// property count. Each property starts with the property ID, the value type, the key
+// type and an unused byte. A property with the multiple values key type is followed by
+// a 32-bit value count and the values, other properties are followed by a single value.
+// String properties always use the multiple values key type with the string length
+// as the value count.
+namespace ExemplarFormat
+{
+	using namespace std::string_view_literals;
+
+	static constexpr size_t SignatureLength = 8;
+	static constexpr std::string_view ExemplarBinarySignature = "EQZB1###"sv;
+	static constexpr std::string_view CohortBinarySignature = "CQZB1###"sv;
+	static constexpr std::string_view ExemplarTextSignature = "EQZT1###"sv;
+	static constexpr std::string_view CohortTextSignature = "CQZT1###"sv;
+
+	// The signature, parent cohort TGI and property count.
+	static constexpr size_t BinaryHeaderSize = 24;
+	// The property ID, value type, key type and unused byte.
+	static constexpr size_t BinaryPropertyHeaderSize = 9;
+
+	enum class ValueType : uint16_t
+	{
+		Uint8 = 0x0100,
+		Uint16 = 0x0200,
+		Uint32 = 0x0300,
+		Sint32 = 0x0700,
+		Sint64 = 0x0800,
+		Float32 = 0x0900,
+		Bool = 0x0B00,
+		String = 0x0C00,
+	};
+
+	static constexpr uint16_t SingleValueKeyType = 0x0000;
+	static constexpr uint16_t MultipleValuesKeyType = 0x0080;
+
+	// Returns true if the data starts with the text exemplar or cohort signature.
+	inline bool IsTextFormat(const uint8_t* data, size_t size)
+	{
+		if (size < SignatureLength)
+		{
+			return false;
+		}
+
+		const std::string_view signature(reinterpret_cast<const char*>(data), SignatureLength);
+
+		return signature == ExemplarTextSignature || signature == CohortTextSignature;
+	}
+
+	// Returns the size of a single value, or 0 if the value type is not supported.
+	constexpr size_t GetValueSize(ValueType type)
+	{
+		switch (type)
+		{
+		case ValueType::Uint8:
+		case ValueType::Bool:
+		case ValueType::String:
+			return 1;
+		case ValueType::Uint16:
+			return 2;
+		case ValueType::Uint32:
+		case ValueType::Sint32:
+		case ValueType::Float32:
+			return 4;
+		case ValueType::Sint64:
+			return 8;
+		default:
+			return 0;
+		}
+	}
+}
@@ -0,0 +1,46 @@
+/*
+ * This file is part of sc4-resource-loading-hooks, a DLL Plugin for SimCity 4
+ * that allows other DLLs to modify resources as the game loads them.
+ *
+ * Copyright (C) 2024, 2025 Nicholas Hayes
+ *
+ * sc4-resource-loading-hooks is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * sc4-resource-loading-hooks is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with sc4-resource-loading-hooks.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#include "ExemplarFormat.h"
+#include <cstdint>
+#include <cstring>
+
+// A view of a property value in an exemplar or cohort file.
+// The values are not copied, the view is only valid while the file data is.
+struct ExemplarPropertyView
+{
+	uint32_t id;
+	ExemplarFormat::ValueType type;
+	bool isArray;
+	uint32_t count;
+	// The values are stored in little-endian byte order and may be unaligned.
+	const uint8_t* values;
+
+	template<typename T>
+	T GetValue(uint32_t index) const
+	{
+		T value;
+		std::memcpy(&value, values + (static_cast<size_t>(index) * sizeof(T)), sizeof(T));
+
+		return value;
+	}
+};
@@ -0,0 +1,624 @@
+/*
+ * This file is part of sc4-resource-loading-hooks, a DLL Plugin for SimCity 4
+ * that allows other DLLs to modify resources as the game loads them.
+ *
+ * Copyright (C) 2024, 2025 Nicholas Hayes
+ *
+ * sc4-resource-loading-hooks is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * sc4-resource-loading-hooks is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with sc4-resource-loading-hooks.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ExemplarTextParser.h"
+#include "StringViewUtil.h"
+#include <charconv>
+#include <limits>
+#include <string_view>
+#include <utility>
+
+namespace
+{
+	// The text format writes the properties as:
+	// 0x<ID>:{"<Name>"}=<Type>:<Reps>:{<Values>}
+	// A property with 0 reps has a single value.
+
+	bool IsWhitespace(char c)
+	{
+		return c == ' ' || c == '\t';
+	}
+
+	void SkipWhitespace(const char*& position, const char* end)
+	{
+		while (position < end && IsWhitespace(*position))
+		{
+			position++;
+		}
+	}
+
+	bool SkipChar(const char*& position, const char* end, char c)
+	{
+		SkipWhitespace(position, end);
+
+		if (position < end && *position == c)
+		{
+			position++;
+			return true;
+		}
+
+		return false;
+	}
+
+	int GetHexDigitValue(char c)
+	{
+		if (c >= '0' && c <= '9')
+		{
+			return c - '0';
+		}
+		else if (c >= 'a' && c <= 'f')
+		{
+			return c - 'a' + 10;
+		}
+		else if (c >= 'A' && c <= 'F')
+		{
+			return c - 'A' + 10;
+		}
+
+		return -1;
+	}
+
+	// Parses a hexadecimal number with the 0x prefix or a decimal number.
+	bool ParseUnsigned(const char*& position, const char* end, uint64_t& value)
+	{
+		SkipWhitespace(position, end);
+
+		const char* p = position;
+		uint64_t result = 0;
+
+		if ((end - p) > 2 && p[0] == '0' && (p[1] == 'x' || p[1] == 'X'))
+		{
+			p += 2;
+
+			const char* const digitsStart = p;
+			int digit = 0;
+
+			while (p < end && (digit = GetHexDigitValue(*p)) >= 0)
+			{
+				if ((p - digitsStart) == 16)
+				{
+					return false;
+				}
+
+				result = (result << 4) | static_cast<uint64_t>(digit);
+				p++;
+			}
+
+			if (p == digitsStart)
+			{
+				return false;
+			}
+		}
+		else
+		{
+			const char* const digitsStart = p;
+
+			while (p < end && *p >= '0' && *p <= '9')
+			{
+				const uint64_t digit = static_cast<uint64_t>(*p - '0');
+
+				if (result > (std::numeric_limits<uint64_t>::max() - digit) / 10)
+				{
+					return false;
+				}
+
+				result = (result * 10) + digit;
+				p++;
+			}
+
+			if (p == digitsStart)
+			{
+				return false;
+			}
+		}
+
+		position = p;
+		value = result;
+		return true;
+	}
+
+	// Negative numbers are written in decimal, hexadecimal numbers
+	// are the two's complement bit pattern.
+	bool ParseSigned(const char*& position, const char* end, int64_t& value)
+	{
+		SkipWhitespace(position, end);
+
+		const bool negative = position < end && *position == '-';
+		const char* p = negative ? position + 1 : position;
+		uint64_t magnitude = 0;
+
+		if (!ParseUnsigned(p, end, magnitude))
+		{
+			return false;
+		}
+
+		if (negative)
+		{
+			if (magnitude > static_cast<uint64_t>(std::numeric_limits<int64_t>::max()) + 1)
+			{
+				return false;
+			}
+
+			value = static_cast<int64_t>(0 - magnitude);
+		}
+		else
+		{
+			value = static_cast<int64_t>(magnitude);
+		}
+
+		position = p;
+		return true;
+	}
+
+	bool ParseFloat(const char*& position, const char* end, float& value)
+	{
+		SkipWhitespace(position, end);
+
+		const auto result = std::from_chars(position, end, value);
+
+		if (result.ec != std::errc{})
+		{
+			return false;
+		}
+
+		position = result.ptr;
+		return true;
+	}
+
+	bool ParseBool(const char*& position, const char* end, bool& value)
+	{
+		SkipWhitespace(position, end);
+
+		const std::string_view remaining(position, static_cast<size_t>(end - position));
+
+		if (StringViewUtil::StartsWithIgnoreCase(remaining, "true"))
+		{
+			value = true;
+			position += 4;
+			return true;
+		}
+		else if (StringViewUtil::StartsWithIgnoreCase(remaining, "false"))
+		{
+			value = false;
+			position += 5;
+			return true;
+		}
+
+		uint64_t number = 0;
+
+		if (ParseUnsigned(position, end, number))
+		{
+			value = number != 0;
+			return true;
+		}
+
+		return false;
+	}
+
+	bool TryParseValueType(const std::string_view& name, ExemplarFormat::ValueType& type)
+	{
+		static constexpr std::pair<std::string_view, ExemplarFormat::ValueType> ValueTypes[] =
+		{
+			{ "Uint8", ExemplarFormat::ValueType::Uint8 },
+			{ "Uint16", ExemplarFormat::ValueType::Uint16 },
+			{ "Uint32", ExemplarFormat::ValueType::Uint32 },
+			{ "Sint32", ExemplarFormat::ValueType::Sint32 },
+			{ "Sint64", ExemplarFormat::ValueType::Sint64 },
+			{ "Float32", ExemplarFormat::ValueType::Float32 },
+			{ "Bool", ExemplarFormat::ValueType::Bool },
+			{ "String", ExemplarFormat::ValueType::String },
+		};
+
+		for (const auto& item : ValueTypes)
+		{
+			if (StringViewUtil::EqualsIgnoreCase(name, item.first))
+			{
+				type = item.second;
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+	template<typename T>
+	void AppendValue(std::vector<uint8_t>& output, T value)
+	{
+		const size_t offset = output.size();
+
+		output.resize(offset + sizeof(T));
+		std::memcpy(output.data() + offset, &value, sizeof(T));
+	}
+
+	bool ParseValue(
+		const char*& position,
+		const char* end,
+		ExemplarFormat::ValueType type,
+		std::vector<uint8_t>& output)
+	{
+		switch (type)
+		{
+		case ExemplarFormat::ValueType::Uint8:
+		case ExemplarFormat::ValueType::Uint16:
+		case ExemplarFormat::ValueType::Uint32:
+		{
+			uint64_t value = 0;
+
+			if (!ParseUnsigned(position, end, value)
+				|| value > (UINT64_MAX >> (64 - (8 * ExemplarFormat::GetValueSize(type)))))
+			{
+				return false;
+			}
+
+			if (type == ExemplarFormat::ValueType::Uint8)
+			{
+				output.push_back(static_cast<uint8_t>(value));
+			}
+			else if (type == ExemplarFormat::ValueType::Uint16)
+			{
+				AppendValue(output, static_cast<uint16_t>(value));
+			}
+			else
+			{
+				AppendValue(output, static_cast<uint32_t>(value));
+			}
+			return true;
+		}
+		case ExemplarFormat::ValueType::Sint32:
+		{
+			int64_t value = 0;
+
+			if (!ParseSigned(position, end, value)
+				|| value < std::numeric_limits<int32_t>::min()
+				|| value > std::numeric_limits<uint32_t>::max())
+			{
+				return false;
+			}
+
+			AppendValue(output, static_cast<int32_t>(static_cast<uint32_t>(value)));
+			return true;
+		}
+		case ExemplarFormat::ValueType::Sint64:
+		{
+			int64_t value = 0;
+
+			if (!ParseSigned(position, end, value))
+			{
+				return false;
+			}
+
+			AppendValue(output, value);
+			return true;
+		}
+		case ExemplarFormat::ValueType::Float32:
+		{
+			float value = 0;
+
+			if (!ParseFloat(position, end, value))
+			{
+				return false;
+			}
+
+			AppendValue(output, value);
+			return true;
+		}
+		case ExemplarFormat::ValueType::Bool:
+		{
+			bool value = false;
+
+			if (!ParseBool(position, end, value))
+			{
+				return false;
+			}
+
+			output.push_back(value ? 1 : 0);
+			return true;
+		}
+		default:
+			return false;
+		}
+	}
+}
+
+ExemplarTextParser::ExemplarTextParser()
+	: properties(),
+	  valueOffsets(),
+	  values(),
+	  parentCohortKey(),
+	  isCohort(false)
+{
+}
+
+bool ExemplarTextParser::Open(const uint8_t* data, size_t size)
+{
+	properties.clear();
+	valueOffsets.clear();
+	values.clear();
+	parentCohortKey = cGZPersistResourceKey();
+
+	if (!data || size < ExemplarFormat::SignatureLength)
+	{
+		return false;
+	}
+
+	const char* position = reinterpret_cast<const char*>(data);
+	const char* const end = position + size;
+	const std::string_view signature(position, ExemplarFormat::SignatureLength);
+
+	if (signature == ExemplarFormat::CohortTextSignature)
+	{
+		isCohort = true;
+	}
+	else if (signature == ExemplarFormat::ExemplarTextSignature)
+	{
+		isCohort = false;
+	}
+	else
+	{
+		return false;
+	}
+
+	position += ExemplarFormat::SignatureLength;
+
+	while (position < end)
+	{
+		const char* lineEnd = position;
+
+		while (lineEnd < end && *lineEnd != '\r' && *lineEnd != '\n')
+		{
+			lineEnd++;
+		}
+
+		if (!ParseLine(position, lineEnd))
+		{
+			return false;
+		}
+
+		position = lineEnd;
+
+		while (position < end && (*position == '\r' || *position == '\n'))
+		{
+			position++;
+		}
+	}
+
+	// The value buffer is not modified after this point, so the
+	// views can point into it.
+	for (size_t i = 0; i < properties.size(); i++)
+	{
+		properties[i].values = values.data() + valueOffsets[i];
+	}
+
+	return true;
+}
+
+bool ExemplarTextParser::IsCohort() const
+{
+	return isCohort;
+}
+
+const cGZPersistResourceKey& ExemplarTextParser::GetParentCohortKey() const
+{
+	return parentCohortKey;
+}
+
+uint32_t ExemplarTextParser::GetPropertyCount() const
+{
+	return static_cast<uint32_t>(properties.size());
+}
+
+bool ExemplarTextParser::FindProperty(uint32_t id, ExemplarPropertyView& property) const
+{
+	for (const ExemplarPropertyView& item : properties)
+	{
+		if (item.id == id)
+		{
+			property = item;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+bool ExemplarTextParser::ParseLine(const char* position, const char* end)
+{
+	SkipWhitespace(position, end);
+
+	if (position == end)
+	{
+		return true;
+	}
+
+	const std::string_view line(position, static_cast<size_t>(end - position));
+
+	if (StringViewUtil::StartsWithIgnoreCase(line, "ParentCohort"))
+	{
+		// ParentCohort=Key:{0x<Type>,0x<Group>,0x<Instance>}
+		const size_t valuesStart = line.find('{');
+
+		if (valuesStart == std::string_view::npos)
+		{
+			return false;
+		}
+
+		position += valuesStart + 1;
+
+		uint64_t tgi[3]{};
+
+		for (size_t i = 0; i < 3; i++)
+		{
+			if ((i > 0 && !SkipChar(position, end, ','))
+				|| !ParseUnsigned(position, end, tgi[i])
+				|| tgi[i] > UINT32_MAX)
+			{
+				return false;
+			}
+		}
+
+		parentCohortKey.type = static_cast<uint32_t>(tgi[0]);
+		parentCohortKey.group = static_cast<uint32_t>(tgi[1]);
+		parentCohortKey.instance = static_cast<uint32_t>(tgi[2]);
+
+		return SkipChar(position, end, '}');
+	}
+	else if (StringViewUtil::StartsWithIgnoreCase(line, "PropCount"))
+	{
+		// The property count is not needed, the properties are counted as they are read.
+		return true;
+	}
+
+	return ParseProperty(position, end);
+}
+
+bool ExemplarTextParser::ParseProperty(const char* position, const char* end)
+{
+	ExemplarPropertyView property{};
+	uint64_t id = 0;
+
+	if (!ParseUnsigned(position, end, id) || id > UINT32_MAX || !SkipChar(position, end, ':'))
+	{
+		return false;
+	}
+
+	property.id = static_cast<uint32_t>(id);
+
+	// Skip the property name, it can contain any character except the closing quote.
+	if (SkipChar(position, end, '{'))
+	{
+		if (!SkipChar(position, end, '"'))
+		{
+			return false;
+		}
+
+		while (position < end && *position != '"')
+		{
+			position++;
+		}
+
+		if (!SkipChar(position, end, '"') || !SkipChar(position, end, '}'))
+		{
+			return false;
+		}
+	}
+
+	if (!SkipChar(position, end, '='))
+	{
+		return false;
+	}
+
+	SkipWhitespace(position, end);
+
+	const char* const typeStart = position;
+
+	while (position < end && *position != ':')
+	{
+		position++;
+	}
+
+	std::string_view typeName(typeStart, static_cast<size_t>(position - typeStart));
+
+	while (!typeName.empty() && IsWhitespace(typeName.back()))
+	{
+		typeName.remove_suffix(1);
+	}
+
+	uint64_t reps = 0;
+
+	if (!TryParseValueType(typeName, property.type)
+		|| !SkipChar(position, end, ':')
+		|| !ParseUnsigned(position, end, reps)
+		|| reps > UINT32_MAX
+		|| !SkipChar(position, end, ':')
+		|| !SkipChar(position, end, '{'))
+	{
+		return false;
+	}
+
+	const size_t valueOffset = values.size();
+
+	if (property.type == ExemplarFormat::ValueType::String)
+	{
+		// Strings are stored as a character array, the closing
+		// quote is the last one before the closing brace.
+		if (!SkipChar(position, end, '"'))
+		{
+			return false;
+		}
+
+		const char* stringEnd = end;
+
+		while (stringEnd > position && *(stringEnd - 1) != '}')
+		{
+			stringEnd--;
+		}
+
+		if (stringEnd == position)
+		{
+			return false;
+		}
+
+		stringEnd--;
+
+		while (stringEnd > position && IsWhitespace(*(stringEnd - 1)))
+		{
+			stringEnd--;
+		}
+
+		if (stringEnd == position || *(stringEnd - 1) != '"')
+		{
+			return false;
+		}
+
+		stringEnd--;
+
+		values.insert(values.end(), position, stringEnd);
+
+		property.isArray = true;
+		property.count = static_cast<uint32_t>(stringEnd - position);
+	}
+	else
+	{
+		const uint32_t count = reps == 0 ? 1 : static_cast<uint32_t>(reps);
+
+		for (uint32_t i = 0; i < count; i++)
+		{
+			if ((i > 0 && !SkipChar(position, end, ','))
+				|| !ParseValue(position, end, property.type, values))
+			{
+				return false;
+			}
+		}
+
+		if (!SkipChar(position, end, '}'))
+		{
+			return false;
+		}
+
+		property.isArray = reps != 0;
+		property.count = count;
+	}
+
+	properties.push_back(property);
+	valueOffsets.push_back(valueOffset);
+
+	return true;
+}
@@ -0,0 +1,73 @@
+/*
+ * This file is part of sc4-resource-loading-hooks, a DLL Plugin for SimCity 4
+ * that allows other DLLs to modify resources as the game loads them.
+ *
+ * Copyright (C) 2024, 2025 Nicholas Hayes
+ *
+ * sc4-resource-loading-hooks is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * sc4-resource-loading-hooks is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with sc4-resource-loading-hooks.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#include "cGZPersistResourceKey.h"
+#include "ExemplarPropertyView.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Reads the properties of a text exemplar or cohort file.
+//
+// The file is parsed in a single pass when it is opened. The values are
+// converted to the binary representation and stored in a buffer that is
+// reused by the next file, so the properties are exposed as the same
+// views that ExemplarBinaryParser uses.
+class ExemplarTextParser
+{
+public:
+
+	ExemplarTextParser();
+
+	// Returns false if the data is not a valid text exemplar or cohort file.
+	bool Open(const uint8_t* data, size_t size);
+
+	bool IsCohort() const;
+
+	const cGZPersistResourceKey& GetParentCohortKey() const;
+
+	uint32_t GetPropertyCount() const;
+
+	// Calls the callback for every property in file order.
+	template<typename Callback>
+	void EnumProperties(Callback&& callback) const
+	{
+		for (const ExemplarPropertyView& property : properties)
+		{
+			callback(property);
+		}
+	}
+
+	bool FindProperty(uint32_t id, ExemplarPropertyView& property) const;
+
+private:
+
+	bool ParseLine(const char* position, const char* end);
+
+	bool ParseProperty(const char* position, const char* end);
+
+	std::vector<ExemplarPropertyView> properties;
+	std::vector<size_t> valueOffsets;
+	std::vector<uint8_t> values;
+	cGZPersistResourceKey parentCohortKey;
+	bool isCohort;
+};
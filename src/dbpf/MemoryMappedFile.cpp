@@ -0,0 +1,142 @@
+/*
+ * This file is part of sc4-resource-loading-hooks, a DLL Plugin for SimCity 4
+ * that allows other DLLs to modify resources as the game loads them.
+ *
+ * Copyright (C) 2024, 2025 Nicholas Hayes
+ *
+ * sc4-resource-loading-hooks is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * sc4-resource-loading-hooks is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with sc4-resource-loading-hooks.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "MemoryMappedFile.h"
+#ifdef _WIN32
+#include <Windows.h>
+#include "wil/resource.h"
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif // _WIN32
+
+MemoryMappedFile::MemoryMappedFile()
+	: data(nullptr),
+	  size(0)
+{
+}
+
+MemoryMappedFile::~MemoryMappedFile()
+{
+	Close();
+}
+
+bool MemoryMappedFile::Open(const std::filesystem::path& path)
+{
+	Close();
+
+#ifdef _WIN32
+	wil::unique_hfile file(CreateFileW(
+		path.c_str(),
+		GENERIC_READ,
+		FILE_SHARE_READ,
+		nullptr,
+		OPEN_EXISTING,
+		FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN,
+		nullptr));
+
+	if (!file)
+	{
+		return false;
+	}
+
+	LARGE_INTEGER fileSize{};
+
+	// Empty files cannot be mapped.
+	if (!GetFileSizeEx(file.get(), &fileSize) || fileSize.QuadPart == 0 || static_cast<uint64_t>(fileSize.QuadPart) > SIZE_MAX)
+	{
+		return false;
+	}
+
+	wil::unique_handle mapping(CreateFileMappingW(file.get(), nullptr, PAGE_READONLY, 0, 0, nullptr));
+
+	if (!mapping)
+	{
+		return false;
+	}
+
+	// The view keeps the file mapping alive after the handles are closed.
+	void* view = MapViewOfFile(mapping.get(), FILE_MAP_READ, 0, 0, 0);
+
+	if (!view)
+	{
+		return false;
+	}
+
+	data = static_cast<const uint8_t*>(view);
+	size = static_cast<size_t>(fileSize.QuadPart);
+#else
+	const int fd = open(path.c_str(), O_RDONLY);
+
+	if (fd == -1)
+	{
+		return false;
+	}
+
+	struct stat fileInfo {};
+
+	if (fstat(fd, &fileInfo) != 0 || fileInfo.st_size == 0)
+	{
+		close(fd);
+		return false;
+	}
+
+	void* view = mmap(nullptr, static_cast<size_t>(fileInfo.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+
+	if (view == MAP_FAILED)
+	{
+		return false;
+	}
+
+	data = static_cast<const uint8_t*>(view);
+	size = static_cast<size_t>(fileInfo.st_size);
+#endif // _WIN32
+
+	return true;
+}
+
+void MemoryMappedFile::Close()
+{
+	if (data)
+	{
+#ifdef _WIN32
+		UnmapViewOfFile(data);
+#else
+		munmap(const_cast<uint8_t*>(data), size);
+#endif // _WIN32
+
+		data = nullptr;
+		size = 0;
+	}
+}
+
+const uint8_t* MemoryMappedFile::GetData() const
+{
+	return data;
+}
+
+size_t MemoryMappedFile::GetSize() const
+{
+	return size;
+}
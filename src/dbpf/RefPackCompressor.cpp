@@ -0,0 +1,226 @@
+/*
+ * This file is part of sc4-resource-loading-hooks, a DLL Plugin for SimCity 4
+ * that allows other DLLs to modify resources as the game loads them.
+ *
+ * Copyright (C) 2024, 2025 Nicholas Hayes
+ *
+ * sc4-resource-loading-hooks is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * sc4-resource-loading-hooks is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with sc4-resource-loading-hooks.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "RefPackCompressor.h"
+#include "DBPFFormat.h"
+#include <algorithm>
+#include <memory>
+
+namespace
+{
+	static constexpr size_t MaxOffset = 131072;
+	static constexpr size_t MaxMatchLength = 1028;
+	static constexpr size_t MaxLiteralRun = 112;
+	static constexpr size_t MaxChainLength = 64;
+
+	static constexpr size_t HashBits = 16;
+	static constexpr size_t HashSize = size_t(1) << HashBits;
+	static constexpr uint32_t NoPosition = UINT32_MAX;
+
+	uint32_t Hash3(const uint8_t* data)
+	{
+		const uint32_t value = (static_cast<uint32_t>(data[0]) << 16) | (static_cast<uint32_t>(data[1]) << 8) | data[2];
+
+		return (value * 2654435761U) >> (32 - HashBits);
+	}
+
+	// The shortest match that the copy command for an offset can encode.
+	size_t GetMinimumMatchLength(size_t offset)
+	{
+		if (offset <= 1024)
+		{
+			return 3;
+		}
+		else if (offset <= 16384)
+		{
+			return 4;
+		}
+
+		return 5;
+	}
+
+	void WriteLiteralRuns(const uint8_t* literals, size_t& count, std::vector<uint8_t>& output)
+	{
+		// A literal run must be a multiple of 4 bytes, the remaining
+		// 0 to 3 bytes are written by the next command.
+		while (count > 3)
+		{
+			const size_t runLength = std::min(count & ~size_t(3), MaxLiteralRun);
+
+			output.push_back(static_cast<uint8_t>(0xE0 + ((runLength - 4) >> 2)));
+			output.insert(output.end(), literals, literals + runLength);
+
+			literals += runLength;
+			count -= runLength;
+		}
+	}
+
+	void WriteCopyCommand(
+		const uint8_t* literals,
+		size_t literalCount,
+		size_t offset,
+		size_t length,
+		std::vector<uint8_t>& output)
+	{
+		const size_t encodedOffset = offset - 1;
+
+		if (offset <= 1024 && length <= 10)
+		{
+			output.push_back(static_cast<uint8_t>(((encodedOffset >> 3) & 0x60) | ((length - 3) << 2) | literalCount));
+			output.push_back(static_cast<uint8_t>(encodedOffset));
+		}
+		else if (offset <= 16384 && length <= 67)
+		{
+			output.push_back(static_cast<uint8_t>(0x80 | (length - 4)));
+			output.push_back(static_cast<uint8_t>((literalCount << 6) | (encodedOffset >> 8)));
+			output.push_back(static_cast<uint8_t>(encodedOffset));
+		}
+		else
+		{
+			output.push_back(static_cast<uint8_t>(0xC0 | ((encodedOffset >> 12) & 0x10) | (((length - 5) >> 6) & 0x0C) | literalCount));
+			output.push_back(static_cast<uint8_t>(encodedOffset >> 8));
+			output.push_back(static_cast<uint8_t>(encodedOffset));
+			output.push_back(static_cast<uint8_t>(length - 5));
+		}
+
+		output.insert(output.end(), literals, literals + literalCount);
+	}
+}
+
+bool RefPackCompressor::Compress(const uint8_t* data, size_t size, std::vector<uint8_t>& output)
+{
+	if (size == 0 || size > DBPF::QfsMaxUncompressedSize)
+	{
+		return false;
+	}
+
+	output.clear();
+	output.reserve(DBPF::QfsHeaderSize + size + (size / MaxLiteralRun) + 4);
+	output.resize(DBPF::QfsHeaderSize);
+
+	std::unique_ptr<uint32_t[]> head = std::make_unique_for_overwrite<uint32_t[]>(HashSize);
+	std::unique_ptr<uint32_t[]> chain = std::make_unique_for_overwrite<uint32_t[]>(MaxOffset);
+
+	std::fill_n(head.get(), HashSize, NoPosition);
+
+	auto insertPosition = [&](size_t position)
+	{
+		const uint32_t hash = Hash3(data + position);
+
+		chain[position % MaxOffset] = head[hash];
+		head[hash] = static_cast<uint32_t>(position);
+	};
+
+	size_t position = 0;
+	size_t literalStart = 0;
+
+	while (position + 3 <= size)
+	{
+		size_t bestLength = 0;
+		size_t bestOffset = 0;
+
+		const size_t maxLength = std::min(MaxMatchLength, size - position);
+		uint32_t candidate = head[Hash3(data + position)];
+
+		for (size_t i = 0; i < MaxChainLength && candidate != NoPosition; i++)
+		{
+			const size_t offset = position - candidate;
+
+			if (offset > MaxOffset)
+			{
+				break;
+			}
+
+			if (data[candidate + bestLength] == data[position + bestLength])
+			{
+				size_t length = 0;
+
+				while (length < maxLength && data[candidate + length] == data[position + length])
+				{
+					length++;
+				}
+
+				if (length > bestLength && length >= GetMinimumMatchLength(offset))
+				{
+					bestLength = length;
+					bestOffset = offset;
+
+					if (length == maxLength)
+					{
+						break;
+					}
+				}
+			}
+
+			const uint32_t next = chain[candidate % MaxOffset];
+
+			if (next == NoPosition || next >= candidate)
+			{
+				break;
+			}
+
+			candidate = next;
+		}
+
+		if (bestLength > 0)
+		{
+			size_t literalCount = position - literalStart;
+			WriteLiteralRuns(data + literalStart, literalCount, output);
+			WriteCopyCommand(data + position - literalCount, literalCount, bestOffset, bestLength, output);
+
+			const size_t matchEnd = position + bestLength;
+
+			for (; position < matchEnd && position + 3 <= size; position++)
+			{
+				insertPosition(position);
+			}
+
+			position = matchEnd;
+			literalStart = position;
+		}
+		else
+		{
+			insertPosition(position);
+			position++;
+		}
+	}
+
+	size_t literalCount = size - literalStart;
+	WriteLiteralRuns(data + literalStart, literalCount, output);
+
+	// The end of stream command can write up to 3 literal bytes.
+	output.push_back(static_cast<uint8_t>(0xFC | literalCount));
+	output.insert(output.end(), data + size - literalCount, data + size);
+
+	if (output.size() >= size)
+	{
+		return false;
+	}
+
+	DBPF::WriteUint32(output.data(), static_cast<uint32_t>(output.size()));
+	output[4] = DBPF::QfsSignature0;
+	output[5] = DBPF::QfsSignature1;
+	output[6] = static_cast<uint8_t>(size >> 16);
+	output[7] = static_cast<uint8_t>(size >> 8);
+	output[8] = static_cast<uint8_t>(size);
+
+	return true;
+}
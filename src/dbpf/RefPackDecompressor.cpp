@@ -0,0 +1,224 @@
+/*
+ * This file is part of sc4-resource-loading-hooks, a DLL Plugin for SimCity 4
+ * that allows other DLLs to modify resources as the game loads them.
+ *
+ * Copyright (C) 2024, 2025 Nicholas Hayes
+ *
+ * sc4-resource-loading-hooks is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * sc4-resource-loading-hooks is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with sc4-resource-loading-hooks.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "RefPackDecompressor.h"
+#include "DBPFFormat.h"
+#include <cstring>
+
+namespace
+{
+	static constexpr size_t WideCopySize = 16;
+
+	// Copies the data in 16-byte blocks, this may write up to 15 bytes past the end
+	// of the destination range.
+	// The source must be at least 16 bytes behind the destination when the ranges overlap.
+	inline void WideCopy(uint8_t* dst, const uint8_t* src, size_t count)
+	{
+		uint8_t* const end = dst + count;
+
+		do
+		{
+			std::memcpy(dst, src, WideCopySize);
+			dst += WideCopySize;
+			src += WideCopySize;
+		} while (dst < end);
+	}
+
+	inline void CopyLiterals(
+		uint8_t* dst,
+		size_t outputRemaining,
+		const uint8_t* src,
+		size_t inputRemaining,
+		size_t count)
+	{
+		if (count > 0)
+		{
+			if (count + WideCopySize - 1 <= outputRemaining && count + WideCopySize - 1 <= inputRemaining)
+			{
+				WideCopy(dst, src, count);
+			}
+			else
+			{
+				std::memcpy(dst, src, count);
+			}
+		}
+	}
+
+	inline void CopyMatch(uint8_t* dst, size_t outputRemaining, size_t offset, size_t length)
+	{
+		const uint8_t* src = dst - offset;
+
+		if (offset >= WideCopySize && length + WideCopySize - 1 <= outputRemaining)
+		{
+			WideCopy(dst, src, length);
+		}
+		else if (offset == 1)
+		{
+			// A run of the previous byte.
+			std::memset(dst, *src, length);
+		}
+		else
+		{
+			// The source and destination overlap, the bytes must be copied
+			// one at a time to repeat the pattern.
+			for (size_t i = 0; i < length; i++)
+			{
+				dst[i] = src[i];
+			}
+		}
+	}
+}
+
+bool RefPackDecompressor::GetUncompressedSize(const uint8_t* data, size_t size, uint32_t& uncompressedSize)
+{
+	if (size < DBPF::QfsHeaderSize
+		|| data[4] != DBPF::QfsSignature0
+		|| data[5] != DBPF::QfsSignature1)
+	{
+		return false;
+	}
+
+	uncompressedSize = (static_cast<uint32_t>(data[6]) << 16) | (static_cast<uint32_t>(data[7]) << 8) | data[8];
+
+	return true;
+}
+
+bool RefPackDecompressor::Decompress(const uint8_t* data, size_t size, uint8_t* output, size_t outputSize)
+{
+	uint32_t uncompressedSize = 0;
+
+	if (!GetUncompressedSize(data, size, uncompressedSize) || uncompressedSize != outputSize)
+	{
+		return false;
+	}
+
+	const uint8_t* in = data + DBPF::QfsHeaderSize;
+	const uint8_t* const inEnd = data + size;
+	uint8_t* out = output;
+	uint8_t* const outEnd = output + outputSize;
+
+	while (in < inEnd)
+	{
+		const size_t inputRemaining = static_cast<size_t>(inEnd - in);
+		const uint32_t control = in[0];
+
+		size_t commandSize = 1;
+		size_t literalCount = 0;
+		size_t copyLength = 0;
+		size_t copyOffset = 0;
+		bool endOfData = false;
+
+		if (control < 0x80)
+		{
+			commandSize = 2;
+
+			if (inputRemaining < commandSize)
+			{
+				return false;
+			}
+
+			literalCount = control & 0x03;
+			copyLength = ((control & 0x1C) >> 2) + 3;
+			copyOffset = ((control & 0x60) << 3) + in[1] + 1;
+		}
+		else if (control < 0xC0)
+		{
+			commandSize = 3;
+
+			if (inputRemaining < commandSize)
+			{
+				return false;
+			}
+
+			literalCount = (in[1] >> 6) & 0x03;
+			copyLength = (control & 0x3F) + 4;
+			copyOffset = ((in[1] & 0x3F) << 8) + in[2] + 1;
+		}
+		else if (control < 0xE0)
+		{
+			commandSize = 4;
+
+			if (inputRemaining < commandSize)
+			{
+				return false;
+			}
+
+			literalCount = control & 0x03;
+			copyLength = ((control & 0x0C) << 6) + in[3] + 5;
+			copyOffset = ((control & 0x10) << 12) + (in[1] << 8) + in[2] + 1;
+		}
+		else if (control < 0xFC)
+		{
+			literalCount = ((control & 0x1F) << 2) + 4;
+		}
+		else
+		{
+			literalCount = control & 0x03;
+			endOfData = true;
+		}
+
+		in += commandSize;
+
+		const size_t literalInputRemaining = inputRemaining - commandSize;
+		const size_t outputRemaining = static_cast<size_t>(outEnd - out);
+
+		if (literalCount > literalInputRemaining || literalCount + copyLength > outputRemaining)
+		{
+			return false;
+		}
+
+		CopyLiterals(out, outputRemaining, in, literalInputRemaining, literalCount);
+		in += literalCount;
+		out += literalCount;
+
+		if (copyLength > 0)
+		{
+			if (copyOffset > static_cast<size_t>(out - output))
+			{
+				return false;
+			}
+
+			CopyMatch(out, outputRemaining - literalCount, copyOffset, copyLength);
+			out += copyLength;
+		}
+
+		if (endOfData)
+		{
+			break;
+		}
+	}
+
+	return out == outEnd;
+}
+
+bool RefPackDecompressor::Decompress(const uint8_t* data, size_t size, std::vector<uint8_t>& output)
+{
+	uint32_t uncompressedSize = 0;
+
+	if (!GetUncompressedSize(data, size, uncompressedSize))
+	{
+		return false;
+	}
+
+	output.resize(uncompressedSize);
+
+	return Decompress(data, size, output.data(), output.size());
+}
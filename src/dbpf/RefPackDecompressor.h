@@ -0,0 +1,45 @@
+/*
+ * This file is part of sc4-resource-loading-hooks, a DLL Plugin for SimCity 4
+ * that allows other DLLs to modify resources as the game loads them.
+ *
+ * Copyright (C) 2024, 2025 Nicholas Hayes
+ *
+ * sc4-resource-loading-hooks is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * sc4-resource-loading-hooks is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with sc4-resource-loading-hooks.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Decompresses DBPF records that use the QFS/RefPack format.
+//
+// Every command is validated against the input and output bounds, corrupt
+// data makes the decompression fail instead of reading or writing outside
+// the buffers. Literal runs and long matches are copied in 16-byte blocks
+// when there is enough space left in both buffers, the end of the data is
+// copied byte by byte.
+namespace RefPackDecompressor
+{
+	// Reads the uncompressed size from the 9-byte DBPF QFS header.
+	// Returns false if the data does not start with a QFS header.
+	bool GetUncompressedSize(const uint8_t* data, size_t size, uint32_t& uncompressedSize);
+
+	// Decompresses the data into the output buffer, the output size must
+	// match the uncompressed size in the QFS header.
+	bool Decompress(const uint8_t* data, size_t size, uint8_t* output, size_t outputSize);
+
+	bool Decompress(const uint8_t* data, size_t size, std::vector<uint8_t>& output);
+}
@@ -0,0 +1,590 @@
+/*
+ * This file is part of sc4-resource-loading-hooks, a DLL Plugin for SimCity 4
+ * that allows other DLLs to modify resources as the game loads them.
+ *
+ * Copyright (C) 2024, 2025 Nicholas Hayes
+ *
+ * sc4-resource-loading-hooks is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * sc4-resource-loading-hooks is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with sc4-resource-loading-hooks.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ExemplarFilterExpression.h"
+#include "ExemplarTypeReader.h"
+#include "ExemplarTypes.h"
+#include "StringViewUtil.h"
+#include "cGZPersistResourceKey.h"
+#include "cISCPropertyHolder.h"
+#include <algorithm>
+#include <cctype>
+
+using namespace std::string_view_literals;
+
+namespace
+{
+	enum class TokenType
+	{
+		End,
+		Identifier,
+		Number,
+		LeftParen,
+		RightParen,
+		Comma,
+		And,
+		Or,
+		Not,
+		Equals,
+		NotEquals,
+		Invalid
+	};
+
+	struct Token
+	{
+		TokenType type;
+		std::string_view text;
+		size_t position;
+	};
+
+	// The relative cost of evaluating an instruction, used to order the operands
+	// of && and || chains.
+	enum class EvaluationCost : int32_t
+	{
+		ResourceKey = 0,
+		ExemplarType = 1,
+		PropertyLookup = 2,
+	};
+
+	bool IsIdentifierChar(char c)
+	{
+		return std::isalnum(static_cast<unsigned char>(c)) || c == '_';
+	}
+}
+
+class ExemplarFilterExpressionParser
+{
+public:
+
+	using Instruction = ExemplarFilterExpression::Instruction;
+	using OpCode = ExemplarFilterExpression::OpCode;
+
+	ExemplarFilterExpressionParser(const std::string_view& text, ExemplarFilterExpression& expression)
+		: text(text),
+		  position(0),
+		  current(),
+		  expression(expression),
+		  errorMessage()
+	{
+		Advance();
+	}
+
+	bool Parse()
+	{
+		Fragment fragment;
+
+		if (ParseOr(fragment))
+		{
+			if (current.type == TokenType::End)
+			{
+				expression.instructions = std::move(fragment.code);
+				return true;
+			}
+
+			SetUnexpectedTokenError();
+		}
+
+		return false;
+	}
+
+	const std::string& GetErrorMessage() const
+	{
+		return errorMessage;
+	}
+
+private:
+
+	struct Fragment
+	{
+		std::vector<Instruction> code;
+		EvaluationCost cost = EvaluationCost::ResourceKey;
+	};
+
+	void Advance()
+	{
+		while (position < text.size() && std::isspace(static_cast<unsigned char>(text[position])))
+		{
+			position++;
+		}
+
+		current.position = position;
+
+		if (position >= text.size())
+		{
+			current.type = TokenType::End;
+			current.text = std::string_view();
+			return;
+		}
+
+		const char c = text[position];
+		const char next = (position + 1) < text.size() ? text[position + 1] : '\0';
+		size_t length = 1;
+
+		if (IsIdentifierChar(c))
+		{
+			while ((position + length) < text.size() && IsIdentifierChar(text[position + length]))
+			{
+				length++;
+			}
+
+			current.type = std::isdigit(static_cast<unsigned char>(c)) ? TokenType::Number : TokenType::Identifier;
+		}
+		else if (c == '(')
+		{
+			current.type = TokenType::LeftParen;
+		}
+		else if (c == ')')
+		{
+			current.type = TokenType::RightParen;
+		}
+		else if (c == ',')
+		{
+			current.type = TokenType::Comma;
+		}
+		else if (c == '&' && next == '&')
+		{
+			current.type = TokenType::And;
+			length = 2;
+		}
+		else if (c == '|' && next == '|')
+		{
+			current.type = TokenType::Or;
+			length = 2;
+		}
+		else if (c == '=' && next == '=')
+		{
+			current.type = TokenType::Equals;
+			length = 2;
+		}
+		else if (c == '!' && next == '=')
+		{
+			current.type = TokenType::NotEquals;
+			length = 2;
+		}
+		else if (c == '!')
+		{
+			current.type = TokenType::Not;
+		}
+		else
+		{
+			current.type = TokenType::Invalid;
+		}
+
+		current.text = text.substr(position, length);
+		position += length;
+	}
+
+	bool Expect(TokenType type, const char* const description)
+	{
+		if (current.type != type)
+		{
+			SetError(description);
+			return false;
+		}
+
+		Advance();
+		return true;
+	}
+
+	void SetError(const char* const expected)
+	{
+		errorMessage = "expected ";
+		errorMessage += expected;
+		errorMessage += " at position ";
+		errorMessage += std::to_string(current.position);
+	}
+
+	void SetUnexpectedTokenError()
+	{
+		if (current.type == TokenType::End)
+		{
+			errorMessage = "unexpected end of expression";
+		}
+		else
+		{
+			errorMessage = "unexpected '";
+			errorMessage += current.text;
+			errorMessage += "' at position ";
+			errorMessage += std::to_string(current.position);
+		}
+	}
+
+	bool ParseNumber(uint32_t& value)
+	{
+		if (current.type != TokenType::Number || !ExemplarTypes::TryParseExemplarNumber(current.text, value))
+		{
+			SetError("a number");
+			return false;
+		}
+
+		Advance();
+		return true;
+	}
+
+	// Combines the operands of a && or || chain, the operands are sorted
+	// so that the cheapest checks are evaluated first.
+	// This is safe because none of the checks have side effects.
+	static Fragment CombineChain(std::vector<Fragment>& operands, OpCode shortCircuitJump)
+	{
+		std::stable_sort(
+			operands.begin(),
+			operands.end(),
+			[](const Fragment& lhs, const Fragment& rhs) { return lhs.cost < rhs.cost; });
+
+		Fragment result = std::move(operands.back());
+
+		for (size_t i = operands.size() - 1; i-- > 0;)
+		{
+			Fragment& operand = operands[i];
+
+			operand.code.push_back(Instruction{ shortCircuitJump, static_cast<uint32_t>(result.code.size()), 0 });
+			operand.code.insert(operand.code.end(), result.code.begin(), result.code.end());
+			operand.cost = std::max(operand.cost, result.cost);
+
+			result = std::move(operand);
+		}
+
+		return result;
+	}
+
+	bool ParseOr(Fragment& fragment)
+	{
+		std::vector<Fragment> operands(1);
+
+		if (!ParseAnd(operands.back()))
+		{
+			return false;
+		}
+
+		while (current.type == TokenType::Or)
+		{
+			Advance();
+
+			operands.emplace_back();
+
+			if (!ParseAnd(operands.back()))
+			{
+				return false;
+			}
+		}
+
+		fragment = CombineChain(operands, OpCode::JumpIfTrue);
+		return true;
+	}
+
+	bool ParseAnd(Fragment& fragment)
+	{
+		std::vector<Fragment> operands(1);
+
+		if (!ParseUnary(operands.back()))
+		{
+			return false;
+		}
+
+		while (current.type == TokenType::And)
+		{
+			Advance();
+
+			operands.emplace_back();
+
+			if (!ParseUnary(operands.back()))
+			{
+				return false;
+			}
+		}
+
+		fragment = CombineChain(operands, OpCode::JumpIfFalse);
+		return true;
+	}
+
+	bool ParseUnary(Fragment& fragment)
+	{
+		if (current.type == TokenType::Not)
+		{
+			Advance();
+
+			if (!ParseUnary(fragment))
+			{
+				return false;
+			}
+
+			fragment.code.push_back(Instruction{ OpCode::Not, 0, 0 });
+			return true;
+		}
+
+		return ParsePrimary(fragment);
+	}
+
+	bool ParsePrimary(Fragment& fragment)
+	{
+		if (current.type == TokenType::LeftParen)
+		{
+			Advance();
+
+			return ParseOr(fragment) && Expect(TokenType::RightParen, "')'");
+		}
+		else if (current.type == TokenType::Identifier)
+		{
+			const std::string_view name = current.text;
+
+			if (StringViewUtil::EqualsIgnoreCase(name, "has"sv))
+			{
+				Advance();
+
+				uint32_t propertyID = 0;
+
+				if (!Expect(TokenType::LeftParen, "'('")
+					|| !ParseNumber(propertyID)
+					|| !Expect(TokenType::RightParen, "')'"))
+				{
+					return false;
+				}
+
+				fragment.code.push_back(Instruction{ OpCode::HasProperty, propertyID, 0 });
+				fragment.cost = EvaluationCost::PropertyLookup;
+				return true;
+			}
+			else if (StringViewUtil::EqualsIgnoreCase(name, "type"sv))
+			{
+				Advance();
+				fragment.cost = EvaluationCost::ExemplarType;
+				return ParseComparison(fragment, OpCode::TypeEquals, OpCode::TypeInList);
+			}
+			else if (StringViewUtil::EqualsIgnoreCase(name, "group"sv))
+			{
+				Advance();
+				fragment.cost = EvaluationCost::ResourceKey;
+				return ParseComparison(fragment, OpCode::GroupEquals, OpCode::GroupInList);
+			}
+			else if (StringViewUtil::EqualsIgnoreCase(name, "instance"sv))
+			{
+				Advance();
+				fragment.cost = EvaluationCost::ResourceKey;
+				return ParseComparison(fragment, OpCode::InstanceEquals, OpCode::InstanceInList);
+			}
+
+			SetError("'type', 'group', 'instance' or 'has'");
+			return false;
+		}
+
+		SetError("'(', '!', 'type', 'group', 'instance' or 'has'");
+		return false;
+	}
+
+	bool ParseComparison(Fragment& fragment, OpCode equalsOpCode, OpCode inListOpCode)
+	{
+		if (current.type == TokenType::Equals || current.type == TokenType::NotEquals)
+		{
+			const bool negate = current.type == TokenType::NotEquals;
+			Advance();
+
+			uint32_t value = 0;
+
+			if (!ParseNumber(value))
+			{
+				return false;
+			}
+
+			fragment.code.push_back(Instruction{ equalsOpCode, value, 0 });
+
+			if (negate)
+			{
+				fragment.code.push_back(Instruction{ OpCode::Not, 0, 0 });
+			}
+
+			return true;
+		}
+		else if (current.type == TokenType::Identifier && StringViewUtil::EqualsIgnoreCase(current.text, "in"sv))
+		{
+			Advance();
+
+			if (!Expect(TokenType::LeftParen, "'('"))
+			{
+				return false;
+			}
+
+			std::vector<uint32_t> values;
+
+			do
+			{
+				uint32_t value = 0;
+
+				if (!ParseNumber(value))
+				{
+					return false;
+				}
+
+				values.push_back(value);
+
+				if (current.type != TokenType::Comma)
+				{
+					break;
+				}
+
+				Advance();
+			} while (true);
+
+			if (!Expect(TokenType::RightParen, "')'"))
+			{
+				return false;
+			}
+
+			std::sort(values.begin(), values.end());
+			values.erase(std::unique(values.begin(), values.end()), values.end());
+
+			if (values.size() == 1)
+			{
+				fragment.code.push_back(Instruction{ equalsOpCode, values[0], 0 });
+			}
+			else
+			{
+				std::vector<uint32_t>& valueLists = expression.valueLists;
+
+				fragment.code.push_back(Instruction{
+					inListOpCode,
+					static_cast<uint32_t>(valueLists.size()),
+					static_cast<uint32_t>(values.size()) });
+
+				valueLists.insert(valueLists.end(), values.begin(), values.end());
+			}
+
+			return true;
+		}
+
+		SetError("'==', '!=' or 'in'");
+		return false;
+	}
+
+	std::string_view text;
+	size_t position;
+	Token current;
+	ExemplarFilterExpression& expression;
+	std::string errorMessage;
+};
+
+ExemplarFilterExpression::ExemplarFilterExpression()
+	: instructions(),
+	  valueLists()
+{
+}
+
+ExemplarFilterExpression ExemplarFilterExpression::CreateExemplarTypeFilter(uint32_t exemplarType)
+{
+	ExemplarFilterExpression expression;
+	expression.instructions.push_back(Instruction{ OpCode::TypeEquals, exemplarType, 0 });
+
+	return expression;
+}
+
+bool ExemplarFilterExpression::TryParse(
+	const std::string_view& text,
+	ExemplarFilterExpression& expression,
+	std::string& errorMessage)
+{
+	ExemplarFilterExpression temp;
+	ExemplarFilterExpressionParser parser(text, temp);
+
+	if (parser.Parse())
+	{
+		expression = std::move(temp);
+		errorMessage.clear();
+		return true;
+	}
+
+	errorMessage = parser.GetErrorMessage();
+	return false;
+}
+
+bool ExemplarFilterExpression::IsMatch(const cGZPersistResourceKey& key, cISCPropertyHolder* propertyHolder) const
+{
+	bool result = false;
+
+	// The exemplar type is read at most once per evaluation.
+	ExemplarTypeReader exemplarTypeReader(propertyHolder);
+
+	const size_t instructionCount = instructions.size();
+
+	for (size_t i = 0; i < instructionCount; i++)
+	{
+		const Instruction& instruction = instructions[i];
+
+		switch (instruction.opCode)
+		{
+		case OpCode::GroupEquals:
+			result = key.group == instruction.operand;
+			break;
+		case OpCode::GroupInList:
+			result = IsInValueList(key.group, instruction);
+			break;
+		case OpCode::InstanceEquals:
+			result = key.instance == instruction.operand;
+			break;
+		case OpCode::InstanceInList:
+			result = IsInValueList(key.instance, instruction);
+			break;
+		case OpCode::TypeEquals:
+		case OpCode::TypeInList:
+		{
+			uint32_t exemplarType = 0;
+
+			if (exemplarTypeReader.TryGetExemplarType(exemplarType))
+			{
+				result = instruction.opCode == OpCode::TypeEquals
+					? exemplarType == instruction.operand
+					: IsInValueList(exemplarType, instruction);
+			}
+			else
+			{
+				result = false;
+			}
+			break;
+		}
+		case OpCode::HasProperty:
+			result = propertyHolder && propertyHolder->HasProperty(instruction.operand);
+			break;
+		case OpCode::Not:
+			result = !result;
+			break;
+		case OpCode::JumpIfFalse:
+			if (!result)
+			{
+				i += instruction.operand;
+			}
+			break;
+		case OpCode::JumpIfTrue:
+			if (result)
+			{
+				i += instruction.operand;
+			}
+			break;
+		}
+	}
+
+	return result;
+}
+
+bool ExemplarFilterExpression::IsInValueList(uint32_t value, const Instruction& instruction) const
+{
+	const auto begin = valueLists.begin() + instruction.operand;
+	const auto end = begin + instruction.count;
+
+	return std::binary_search(begin, end, value);
+}
@@ -0,0 +1,87 @@
+/*
+ * This file is part of sc4-resource-loading-hooks, a DLL Plugin for SimCity 4
+ * that allows other DLLs to modify resources as the game loads them.
+ *
+ * Copyright (C) 2024, 2025 Nicholas Hayes
+ *
+ * sc4-resource-loading-hooks is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * sc4-resource-loading-hooks is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with sc4-resource-loading-hooks.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+class cGZPersistResourceKey;
+class cISCPropertyHolder;
+
+// A compiled exemplar log filter expression, e.g.
+// type in (2,16) && group == 0x6A0F82B2 || has(0x27812810)
+//
+// The expression is compiled into a flat list of instructions that operate on
+// a single boolean register, the && and || operators short-circuit using jumps.
+// The operands of each && and || chain are reordered so that the checks that only
+// use the resource key run before the checks that read the exemplar's properties.
+
+class ExemplarFilterExpression
+{
+public:
+
+	ExemplarFilterExpression();
+
+	static ExemplarFilterExpression CreateExemplarTypeFilter(uint32_t exemplarType);
+
+	static bool TryParse(
+		const std::string_view& text,
+		ExemplarFilterExpression& expression,
+		std::string& errorMessage);
+
+	bool IsMatch(const cGZPersistResourceKey& key, cISCPropertyHolder* propertyHolder) const;
+
+	enum class OpCode : uint8_t
+	{
+		GroupEquals,
+		GroupInList,
+		InstanceEquals,
+		InstanceInList,
+		TypeEquals,
+		TypeInList,
+		HasProperty,
+		Not,
+		// Jumps are relative to the following instruction.
+		JumpIfFalse,
+		JumpIfTrue,
+	};
+
+	struct Instruction
+	{
+		OpCode opCode;
+		// The value to compare, the property id, the jump offset
+		// or the start of a value list.
+		uint32_t operand;
+		// The number of items in a value list.
+		uint32_t count;
+	};
+
+private:
+
+	friend class ExemplarFilterExpressionParser;
+
+	bool IsInValueList(uint32_t value, const Instruction& instruction) const;
+
+	std::vector<Instruction> instructions;
+	std::vector<uint32_t> valueLists;
+};
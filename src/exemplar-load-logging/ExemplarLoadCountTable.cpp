@@ -0,0 +1,142 @@
+/*
+ * This file is part of sc4-resource-loading-hooks, a DLL Plugin for SimCity 4
+ * that allows other DLLs to modify resources as the game loads them.
+ *
+ * Copyright (C) 2024, 2025 Nicholas Hayes
+ *
+ * sc4-resource-loading-hooks is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * sc4-resource-loading-hooks is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with sc4-resource-loading-hooks.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ExemplarLoadCountTable.h"
+#include "PersistResourceKeyBoostHash.h"
+#include <algorithm>
+
+namespace
+{
+	// The table is kept at or below a 50% load factor to keep
+	// the linear probe sequences short.
+	static constexpr size_t InitialSlotCount = 1024;
+
+	bool IsMatchingEntry(const ExemplarLoadCountTable::Entry& entry, const cGZPersistResourceKey& key)
+	{
+		return entry.instance == key.instance && entry.group == key.group && entry.type == key.type;
+	}
+}
+
+ExemplarLoadCountTable::ExemplarLoadCountTable()
+	: slots(InitialSlotCount),
+	  mask(0),
+	  uniqueKeyCount(0),
+	  totalLoadCount(0)
+{
+	mask = slots.size() - 1;
+}
+
+bool ExemplarLoadCountTable::AddLoad(const cGZPersistResourceKey& key)
+{
+	totalLoadCount++;
+
+	// An entry with a load count of zero is an empty slot.
+	size_t index = GetSlotIndex(key, mask);
+
+	while (slots[index].loadCount != 0)
+	{
+		Entry& entry = slots[index];
+
+		if (IsMatchingEntry(entry, key))
+		{
+			if (entry.loadCount < UINT32_MAX)
+			{
+				entry.loadCount++;
+			}
+			return false;
+		}
+
+		index = (index + 1) & mask;
+	}
+
+	Entry& entry = slots[index];
+	entry.type = key.type;
+	entry.group = key.group;
+	entry.instance = key.instance;
+	entry.loadCount = 1;
+
+	uniqueKeyCount++;
+
+	if (uniqueKeyCount > (slots.size() / 2))
+	{
+		Grow();
+	}
+
+	return true;
+}
+
+size_t ExemplarLoadCountTable::GetUniqueKeyCount() const
+{
+	return uniqueKeyCount;
+}
+
+uint64_t ExemplarLoadCountTable::GetTotalLoadCount() const
+{
+	return totalLoadCount;
+}
+
+std::vector<ExemplarLoadCountTable::Entry> ExemplarLoadCountTable::GetEntriesSortedByLoadCount() const
+{
+	std::vector<Entry> entries;
+	entries.reserve(uniqueKeyCount);
+
+	for (const Entry& entry : slots)
+	{
+		if (entry.loadCount != 0)
+		{
+			entries.push_back(entry);
+		}
+	}
+
+	std::stable_sort(
+		entries.begin(),
+		entries.end(),
+		[](const Entry& lhs, const Entry& rhs) { return lhs.loadCount > rhs.loadCount; });
+
+	return entries;
+}
+
+size_t ExemplarLoadCountTable::GetSlotIndex(const cGZPersistResourceKey& key, size_t mask)
+{
+	return boost::hash<const cGZPersistResourceKey>()(key) & mask;
+}
+
+void ExemplarLoadCountTable::Grow()
+{
+	std::vector<Entry> oldSlots(slots.size() * 2);
+	oldSlots.swap(slots);
+	mask = slots.size() - 1;
+
+	for (const Entry& entry : oldSlots)
+	{
+		if (entry.loadCount != 0)
+		{
+			size_t index = GetSlotIndex(cGZPersistResourceKey(entry.type, entry.group, entry.instance), mask);
+
+			while (slots[index].loadCount != 0)
+			{
+				index = (index + 1) & mask;
+			}
+
+			slots[index] = entry;
+		}
+	}
+}
@@ -0,0 +1,69 @@
+/*
+ * This file is part of sc4-resource-loading-hooks, a DLL Plugin for SimCity 4
+ * that allows other DLLs to modify resources as the game loads them.
+ *
+ * Copyright (C) 2024, 2025 Nicholas Hayes
+ *
+ * sc4-resource-loading-hooks is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * sc4-resource-loading-hooks is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with sc4-resource-loading-hooks.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#include "cGZPersistResourceKey.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// An open-addressing hash table that counts how many times each exemplar
+// TGI has been loaded.
+//
+// Every slot is a fixed 16 bytes, the table starts with a small number of
+// slots and doubles when it is half full.
+
+class ExemplarLoadCountTable
+{
+public:
+
+	struct Entry
+	{
+		uint32_t type;
+		uint32_t group;
+		uint32_t instance;
+		uint32_t loadCount;
+	};
+
+	ExemplarLoadCountTable();
+
+	// Increments the load count for the specified key.
+	// Returns true if this is the first time the key has been loaded.
+	bool AddLoad(const cGZPersistResourceKey& key);
+
+	size_t GetUniqueKeyCount() const;
+
+	uint64_t GetTotalLoadCount() const;
+
+	// Returns the used entries in descending order of their load count.
+	std::vector<Entry> GetEntriesSortedByLoadCount() const;
+
+private:
+
+	static size_t GetSlotIndex(const cGZPersistResourceKey& key, size_t mask);
+
+	void Grow();
+
+	std::vector<Entry> slots;
+	size_t mask;
+	size_t uniqueKeyCount;
+	uint64_t totalLoadCount;
+};
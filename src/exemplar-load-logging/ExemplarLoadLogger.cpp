@@ -23,9 +23,11 @@
 #include "FileSystem.h"
 #include "Logger.h"
 #include "ExemplarErrorLogger.h"
+#include "ExemplarFilterExpression.h"
 #include "ExemplarTGILogger.h"
 #include "ExemplarTypeLogger.h"
 #include "ExemplarTypes.h"
+#include "ExemplarUniqueTGILogger.h"
 #include "FilteredExemplarLogger.h"
 #include "StringViewUtil.h"
 #include "cIExemplarLoadHookServer.h"
@@ -43,9 +45,6 @@
 #include <functional>
 #include <memory>
 #include <string>
-#include <Windows.h>
-#include "wil/resource.h"
-#include "wil/win32_helpers.h"
 
 static constexpr uint32_t kExemplarLoadLoggingDirectorID = 0xC6703C6C;
 
@@ -54,7 +53,8 @@ using namespace std::string_view_literals;
 static constexpr std::string_view PluginLogFileName = "SC4ExemplarLoad.log"sv;
 
 ExemplarLoadLogger::ExemplarLoadLogger()
-	: refCount(0)
+	: sampler(),
+	  refCount(0)
 {
 	std::filesystem::path dllFolderPath = FileSystem::GetDllFolderPath();
 
@@ -100,7 +100,7 @@ uint32_t ExemplarLoadLogger::Release()
 	return refCount;
 }
 
-void ExemplarLoadLogger::Init(cIGZFrameWork* const pFrameWork)
+void ExemplarLoadLogger::Init(cIGZFrameWork* const pFrameWork, const LogRotationOptions& rotationOptions)
 {
 	if (pFrameWork)
 	{
@@ -112,6 +112,13 @@ void ExemplarLoadLogger::Init(cIGZFrameWork* const pFrameWork)
 		{
 			SetLoggerFromCommandLine(value.ToChar());
 
+			if (exemplarLogger)
+			{
+				exemplarLogger->SetRotationOptions(rotationOptions);
+				SetOutputFormatFromCommandLine(pCmdLine);
+				SetSamplerFromCommandLine(pCmdLine);
+			}
+
 			cIGZCOM* const pCOM = pFrameWork->GetCOMObject();
 
 			if (exemplarLogger && pCOM)
@@ -148,11 +155,26 @@ void ExemplarLoadLogger::Init(cIGZFrameWork* const pFrameWork)
 	}
 }
 
+void ExemplarLoadLogger::Shutdown()
+{
+	if (exemplarLogger)
+	{
+		exemplarLogger->Shutdown();
+	}
+}
+
 void ExemplarLoadLogger::ExemplarLoaded(
 	const char* const originalFunctionName,
 	const cGZPersistResourceKey& key,
 	cISCResExemplar* resExemplar)
 {
+	// The sampling check is done before the logger reads any
+	// exemplar properties or formats the log output.
+	if (!sampler.IsSampled(key))
+	{
+		return;
+	}
+
 	exemplarLogger->ExemplarLoaded(
 		originalFunctionName,
 		key,
@@ -203,22 +225,133 @@ void ExemplarLoadLogger::SetLoggerFromCommandLine(const std::string_view& argNam
 			logFilePath,
 			false);
 	}
+	else if (StringViewUtil::EqualsIgnoreCase(argName, "unique-TGI"sv))
+	{
+		exemplarLogger = std::make_unique<ExemplarUniqueTGILogger>(logFilePath, false);
+	}
 	else
 	{
-		// Any other value is an integer that is used to filter for a specific
-		// exemplar type.
+		// Any other value is either an integer that is used to filter for a specific
+		// exemplar type, or a filter expression.
 		uint32_t type = 0;
 
 		if (ExemplarTypes::TryParseExemplarNumber(argName, type))
 		{
-			exemplarLogger = std::make_unique<FilteredExemplarLogger>(type, logFilePath, false);
+			exemplarLogger = std::make_unique<FilteredExemplarLogger>(
+				ExemplarFilterExpression::CreateExemplarTypeFilter(type),
+				logFilePath,
+				false);
 		}
 		else
+		{
+			ExemplarFilterExpression filter;
+			std::string errorMessage;
+
+			if (ExemplarFilterExpression::TryParse(argName, filter, errorMessage))
+			{
+				exemplarLogger = std::make_unique<FilteredExemplarLogger>(
+					std::move(filter),
+					logFilePath,
+					false);
+			}
+			else
+			{
+				Logger::GetInstance().WriteLineFormatted(
+					LogLevel::Error,
+					"Invalid exemplar log argument '%s', expected an exemplar type number or a filter expression: %s.",
+					std::string(argName).c_str(),
+					errorMessage.c_str());
+			}
+		}
+	}
+}
+
+void ExemplarLoadLogger::SetOutputFormatFromCommandLine(cIGZCmdLine* const pCmdLine)
+{
+	ExemplarLogFormat format = ExemplarLogFormat::Text;
+	ExemplarLogColumns columns = ExemplarLogColumns::None;
+
+	cRZBaseString value;
+
+	if (pCmdLine->IsSwitchPresent(cRZBaseString("exemplar-log-format"), value, true))
+	{
+		const std::string_view formatName(value.ToChar(), value.Strlen());
+
+		if (StringViewUtil::EqualsIgnoreCase(formatName, "jsonl"sv))
+		{
+			format = ExemplarLogFormat::JsonLines;
+		}
+		else if (StringViewUtil::EqualsIgnoreCase(formatName, "csv"sv))
+		{
+			format = ExemplarLogFormat::Csv;
+		}
+		else if (!StringViewUtil::EqualsIgnoreCase(formatName, "text"sv))
+		{
+			Logger::GetInstance().WriteLineFormatted(
+				LogLevel::Error,
+				"Unknown exemplar log format '%s', expected text, jsonl or csv.",
+				value.ToChar());
+		}
+	}
+
+	if (format != ExemplarLogFormat::Text
+		&& pCmdLine->IsSwitchPresent(cRZBaseString("exemplar-log-columns"), value, true))
+	{
+		std::string_view remaining(value.ToChar(), value.Strlen());
+
+		while (!remaining.empty())
+		{
+			const size_t separator = remaining.find(',');
+			const std::string_view columnName = remaining.substr(0, separator);
+
+			if (StringViewUtil::EqualsIgnoreCase(columnName, "name"sv))
+			{
+				columns = columns | ExemplarLogColumns::ExemplarName;
+			}
+			else if (StringViewUtil::EqualsIgnoreCase(columnName, "type"sv))
+			{
+				columns = columns | ExemplarLogColumns::ExemplarType;
+			}
+			else if (StringViewUtil::EqualsIgnoreCase(columnName, "path"sv))
+			{
+				columns = columns | ExemplarLogColumns::SourcePath;
+			}
+			else if (StringViewUtil::EqualsIgnoreCase(columnName, "timestamp"sv))
+			{
+				columns = columns | ExemplarLogColumns::Timestamp;
+			}
+			else if (!columnName.empty())
+			{
+				Logger::GetInstance().WriteLineFormatted(
+					LogLevel::Error,
+					"Unknown exemplar log column '%s', expected name, type, path or timestamp.",
+					std::string(columnName).c_str());
+			}
+
+			if (separator == std::string_view::npos)
+			{
+				break;
+			}
+
+			remaining.remove_prefix(separator + 1);
+		}
+	}
+
+	exemplarLogger->SetOutputFormat(format, columns);
+}
+
+void ExemplarLoadLogger::SetSamplerFromCommandLine(cIGZCmdLine* const pCmdLine)
+{
+	cRZBaseString value;
+
+	if (pCmdLine->IsSwitchPresent(cRZBaseString("exemplar-log-sample"), value, true))
+	{
+		if (!ExemplarLoadSampler::TryParse(std::string_view(value.ToChar(), value.Strlen()), sampler))
 		{
 			Logger::GetInstance().WriteLineFormatted(
 				LogLevel::Error,
-				"Invalid exemplar type argument '%s', expected an exemplar type number.",
-				std::string(argName).c_str());
+				"Invalid exemplar log sample value '%s', expected a 1 in N sample rate or a probability between 0 and 1.",
+				value.ToChar());
 		}
 	}
 }
@@ -22,10 +22,12 @@
 #pragma once
 #include "cIExemplarLoadHookTarget.h"
 #include "cIExemplarLoadErrorHookTarget.h"
+#include "ExemplarLoadSampler.h"
 #include "ExemplarLoggerBase.h"
 #include <filesystem>
 #include <memory>
 
+class cIGZCmdLine;
 class cIGZFrameWork;
 
 class ExemplarLoadLogger
@@ -42,7 +44,9 @@ public:
 
 	uint32_t Release() override;
 
-	void Init(cIGZFrameWork* const pFrameWork);
+	void Init(cIGZFrameWork* const pFrameWork, const LogRotationOptions& rotationOptions);
+
+	void Shutdown();
 
 private:
 
@@ -62,7 +66,12 @@ private:
 
 	void SetLoggerFromCommandLine(const std::string_view& argName);
 
+	void SetOutputFormatFromCommandLine(cIGZCmdLine* const pCmdLine);
+
+	void SetSamplerFromCommandLine(cIGZCmdLine* const pCmdLine);
+
 	std::filesystem::path logFilePath;
 	std::unique_ptr<ExemplarLoggerBase> exemplarLogger;
+	ExemplarLoadSampler sampler;
 	uint32_t refCount;
 };
\ No newline at end of file
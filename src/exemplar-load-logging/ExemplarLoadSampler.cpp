@@ -0,0 +1,108 @@
+/*
+ * This file is part of sc4-resource-loading-hooks, a DLL Plugin for SimCity 4
+ * that allows other DLLs to modify resources as the game loads them.
+ *
+ * Copyright (C) 2024, 2025 Nicholas Hayes
+ *
+ * sc4-resource-loading-hooks is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * sc4-resource-loading-hooks is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with sc4-resource-loading-hooks.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ExemplarLoadSampler.h"
+#include "cGZPersistResourceKey.h"
+#include <charconv>
+#include <limits>
+
+namespace
+{
+	// A fixed hash function is used instead of boost::hash so that the
+	// sampled exemplars do not change between library versions.
+	uint64_t HashTGI(const cGZPersistResourceKey& key)
+	{
+		uint64_t value = (static_cast<uint64_t>(key.group) << 32) | key.instance;
+		value ^= static_cast<uint64_t>(key.type) * 0x9E3779B97F4A7C15ULL;
+
+		// The MurmurHash3 64-bit finalizer.
+		value ^= value >> 33;
+		value *= 0xFF51AFD7ED558CCDULL;
+		value ^= value >> 33;
+		value *= 0xC4CEB9FE1A85EC53ULL;
+		value ^= value >> 33;
+
+		return value;
+	}
+}
+
+ExemplarLoadSampler::ExemplarLoadSampler()
+	: threshold(std::numeric_limits<uint64_t>::max())
+{
+}
+
+ExemplarLoadSampler::ExemplarLoadSampler(uint64_t threshold)
+	: threshold(threshold)
+{
+}
+
+bool ExemplarLoadSampler::TryParse(const std::string_view& text, ExemplarLoadSampler& sampler)
+{
+	const char* const first = text.data();
+	const char* const last = text.data() + text.size();
+
+	if (text.find('.') != std::string_view::npos)
+	{
+		double probability = 0.0;
+
+		const auto result = std::from_chars(first, last, probability);
+
+		if (result.ec != std::errc() || result.ptr != last || !(probability > 0.0 && probability <= 1.0))
+		{
+			return false;
+		}
+
+		if (probability == 1.0)
+		{
+			sampler = ExemplarLoadSampler();
+		}
+		else
+		{
+			// 2^64 as a double, the product is always less than 2^64.
+			sampler = ExemplarLoadSampler(static_cast<uint64_t>(probability * 18446744073709551616.0));
+		}
+	}
+	else
+	{
+		uint64_t rate = 0;
+
+		const auto result = std::from_chars(first, last, rate);
+
+		if (result.ec != std::errc() || result.ptr != last || rate == 0)
+		{
+			return false;
+		}
+
+		sampler = ExemplarLoadSampler(std::numeric_limits<uint64_t>::max() / rate);
+	}
+
+	return true;
+}
+
+bool ExemplarLoadSampler::IsEnabled() const
+{
+	return threshold != std::numeric_limits<uint64_t>::max();
+}
+
+bool ExemplarLoadSampler::IsSampled(const cGZPersistResourceKey& key) const
+{
+	return HashTGI(key) <= threshold;
+}
@@ -0,0 +1,50 @@
+/*
+ * This file is part of sc4-resource-loading-hooks, a DLL Plugin for SimCity 4
+ * that allows other DLLs to modify resources as the game loads them.
+ *
+ * Copyright (C) 2024, 2025 Nicholas Hayes
+ *
+ * sc4-resource-loading-hooks is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * sc4-resource-loading-hooks is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with sc4-resource-loading-hooks.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#include <cstdint>
+#include <string_view>
+
+class cGZPersistResourceKey;
+
+// Selects a deterministic subset of the exemplar loads for logging.
+// The decision only depends on the exemplar TGI, so the same exemplars
+// are sampled in every run and the resulting logs can be compared.
+class ExemplarLoadSampler
+{
+public:
+
+	ExemplarLoadSampler();
+
+	// Parses either a 1 in N sample rate, e.g. 100, or a probability
+	// between 0 and 1, e.g. 0.01.
+	static bool TryParse(const std::string_view& text, ExemplarLoadSampler& sampler);
+
+	bool IsEnabled() const;
+
+	bool IsSampled(const cGZPersistResourceKey& key) const;
+
+private:
+
+	explicit ExemplarLoadSampler(uint64_t threshold);
+
+	uint64_t threshold;
+};
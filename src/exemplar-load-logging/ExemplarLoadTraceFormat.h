@@ -0,0 +1,54 @@
+/*
+ * This file is part of sc4-resource-loading-hooks, a DLL Plugin for SimCity 4
+ * that allows other DLLs to modify resources as the game loads them.
+ *
+ * Copyright (C) 2024, 2025 Nicholas Hayes
+ *
+ * sc4-resource-loading-hooks is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * sc4-resource-loading-hooks is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with sc4-resource-loading-hooks.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+// The binary exemplar load trace format.
+//
+// The file starts with a header, followed by a sequence of records that each
+// start with a record type byte. All values are stored in little-endian byte order.
+// The function names are written to a string table record the first time they are
+// used, the load records reference them by their string table index.
+namespace ExemplarLoadTraceFormat
+{
+	static constexpr uint64_t Signature = 0x3143525444414F4CULL; // LOADTRC1
+	static constexpr uint32_t Version = 1;
+
+	// The header contains the signature, version, a reserved field
+	// and the trace start time in milliseconds since the Unix epoch.
+	static constexpr size_t HeaderSize = 24;
+
+	enum class RecordType : uint8_t
+	{
+		// uint16 string index, uint16 length, the string characters.
+		String = 1,
+		// uint16 function name index, uint32 thread ID, uint64 nanoseconds since
+		// the trace started, uint32 type, uint32 group, uint32 instance.
+		Load = 2,
+		// uint16 function name index, uint32 thread ID, uint64 nanoseconds since
+		// the trace started, uint32 riid.
+		LoadError = 3,
+		// The same fields as LoadError followed by the type, group and instance.
+		LoadErrorWithKey = 4,
+	};
+}
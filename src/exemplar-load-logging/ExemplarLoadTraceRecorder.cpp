@@ -0,0 +1,272 @@
+/*
+ * This file is part of sc4-resource-loading-hooks, a DLL Plugin for SimCity 4
+ * that allows other DLLs to modify resources as the game loads them.
+ *
+ * Copyright (C) 2024, 2025 Nicholas Hayes
+ *
+ * sc4-resource-loading-hooks is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * sc4-resource-loading-hooks is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with sc4-resource-loading-hooks.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ExemplarLoadTraceRecorder.h"
+#include "FileSystem.h"
+#include "Logger.h"
+#include "cGZPersistResourceKey.h"
+#include "cIExemplarLoadHookServer.h"
+#include "cIGZCmdLine.h"
+#include "cIGZCOM.h"
+#include "cIGZFrameWork.h"
+#include "cRZAutoRefCount.h"
+#include "cRZBaseString.h"
+#include <algorithm>
+#include <cstring>
+#include <thread>
+#ifdef _WIN32
+#include <Windows.h>
+#endif // _WIN32
+
+using namespace std::string_view_literals;
+
+static constexpr std::string_view TraceFileName = "SC4ExemplarLoad.trace"sv;
+static constexpr size_t TraceStreamBufferSize = 256 * 1024;
+
+namespace
+{
+	uint32_t GetCurrentThreadIdentifier()
+	{
+#ifdef _WIN32
+		return GetCurrentThreadId();
+#else
+		return static_cast<uint32_t>(std::hash<std::thread::id>()(std::this_thread::get_id()));
+#endif // _WIN32
+	}
+}
+
+template<typename T> void ExemplarLoadTraceRecorder::WriteValue(T value)
+{
+	recordBuffer.append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+ExemplarLoadTraceRecorder::ExemplarLoadTraceRecorder()
+	: traceFilePath(),
+	  streamBuffer(),
+	  traceFile(),
+	  recordBuffer(),
+	  functionNameIndices(),
+	  startTime(),
+	  mutex(),
+	  refCount(0)
+{
+	traceFilePath = FileSystem::GetDllFolderPath();
+	traceFilePath /= TraceFileName;
+}
+
+bool ExemplarLoadTraceRecorder::QueryInterface(uint32_t riid, void** ppvObj)
+{
+	if (riid == GZIID_cIExemplarLoadHookTarget)
+	{
+		*ppvObj = static_cast<cIExemplarLoadHookTarget*>(this);
+		AddRef();
+
+		return true;
+	}
+	else if (riid == GZIID_cIExemplarLoadErrorHookTarget)
+	{
+		*ppvObj = static_cast<cIExemplarLoadErrorHookTarget*>(this);
+		AddRef();
+
+		return true;
+	}
+	else if (riid == GZIID_cIGZUnknown)
+	{
+		*ppvObj = static_cast<cIGZUnknown*>(static_cast<cIExemplarLoadErrorHookTarget*>(this));
+		AddRef();
+
+		return true;
+	}
+
+	*ppvObj = nullptr;
+	return false;
+}
+
+uint32_t ExemplarLoadTraceRecorder::AddRef()
+{
+	return ++refCount;
+}
+
+uint32_t ExemplarLoadTraceRecorder::Release()
+{
+	return refCount;
+}
+
+void ExemplarLoadTraceRecorder::Init(cIGZFrameWork* const pFrameWork)
+{
+	if (pFrameWork)
+	{
+		cIGZCmdLine* pCmdLine = pFrameWork->CommandLine();
+
+		if (pCmdLine && pCmdLine->IsSwitchPresent(cRZBaseString("exemplar-load-trace")))
+		{
+			cIGZCOM* const pCOM = pFrameWork->GetCOMObject();
+
+			if (pCOM && Open())
+			{
+				cRZAutoRefCount<cIExemplarLoadHookServer> exemplarHookServer;
+
+				if (pCOM->GetClassObject(
+					GZCLSID_cIExemplarLoadHookServer,
+					GZIID_cIExemplarLoadHookServer,
+					exemplarHookServer.AsPPVoid()))
+				{
+					exemplarHookServer->AddLoadNotification(this);
+					exemplarHookServer->AddLoadErrorNotification(this);
+				}
+			}
+		}
+	}
+}
+
+void ExemplarLoadTraceRecorder::Shutdown()
+{
+	std::lock_guard<std::mutex> lock(mutex);
+
+	if (traceFile.is_open())
+	{
+		traceFile.close();
+	}
+}
+
+void ExemplarLoadTraceRecorder::ExemplarLoaded(
+	const char* const originalFunctionName,
+	const cGZPersistResourceKey& key,
+	cISCResExemplar* resExemplar)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+
+	if (traceFile)
+	{
+		WriteRecordHeader(ExemplarLoadTraceFormat::RecordType::Load, originalFunctionName);
+		WriteValue<uint32_t>(key.type);
+		WriteValue<uint32_t>(key.group);
+		WriteValue<uint32_t>(key.instance);
+
+		traceFile.write(recordBuffer.data(), static_cast<std::streamsize>(recordBuffer.size()));
+	}
+}
+
+void ExemplarLoadTraceRecorder::LoadError(
+	const char* const originalFunctionName,
+	uint32_t riid)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+
+	if (traceFile)
+	{
+		WriteRecordHeader(ExemplarLoadTraceFormat::RecordType::LoadError, originalFunctionName);
+		WriteValue<uint32_t>(riid);
+
+		traceFile.write(recordBuffer.data(), static_cast<std::streamsize>(recordBuffer.size()));
+	}
+}
+
+void ExemplarLoadTraceRecorder::LoadError(
+	const char* const originalFunctionName,
+	uint32_t riid,
+	const cGZPersistResourceKey& key)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+
+	if (traceFile)
+	{
+		WriteRecordHeader(ExemplarLoadTraceFormat::RecordType::LoadErrorWithKey, originalFunctionName);
+		WriteValue<uint32_t>(riid);
+		WriteValue<uint32_t>(key.type);
+		WriteValue<uint32_t>(key.group);
+		WriteValue<uint32_t>(key.instance);
+
+		traceFile.write(recordBuffer.data(), static_cast<std::streamsize>(recordBuffer.size()));
+	}
+}
+
+bool ExemplarLoadTraceRecorder::Open()
+{
+	streamBuffer = std::make_unique_for_overwrite<char[]>(TraceStreamBufferSize);
+
+	// The stream buffer must be set before the file is opened.
+	traceFile.rdbuf()->pubsetbuf(streamBuffer.get(), TraceStreamBufferSize);
+	traceFile.open(traceFilePath, std::ofstream::out | std::ofstream::binary | std::ofstream::trunc);
+
+	if (!traceFile)
+	{
+		Logger::GetInstance().WriteLine(
+			LogLevel::Error,
+			"Failed to create the exemplar load trace file.");
+		return false;
+	}
+
+	startTime = std::chrono::steady_clock::now();
+
+	const uint64_t startTimeInMilliseconds = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+		std::chrono::system_clock::now().time_since_epoch()).count());
+
+	recordBuffer.clear();
+	WriteValue<uint64_t>(ExemplarLoadTraceFormat::Signature);
+	WriteValue<uint32_t>(ExemplarLoadTraceFormat::Version);
+	WriteValue<uint32_t>(0);
+	WriteValue<uint64_t>(startTimeInMilliseconds);
+
+	traceFile.write(recordBuffer.data(), static_cast<std::streamsize>(recordBuffer.size()));
+
+	return traceFile.good();
+}
+
+void ExemplarLoadTraceRecorder::WriteRecordHeader(
+	ExemplarLoadTraceFormat::RecordType type,
+	const char* const originalFunctionName)
+{
+	const uint16_t functionNameIndex = GetFunctionNameIndex(originalFunctionName);
+	const auto elapsed = std::chrono::steady_clock::now() - startTime;
+
+	recordBuffer.clear();
+	WriteValue<uint8_t>(static_cast<uint8_t>(type));
+	WriteValue<uint16_t>(functionNameIndex);
+	WriteValue<uint32_t>(GetCurrentThreadIdentifier());
+	WriteValue<uint64_t>(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()));
+}
+
+uint16_t ExemplarLoadTraceRecorder::GetFunctionNameIndex(const char* const originalFunctionName)
+{
+	const auto item = functionNameIndices.find(originalFunctionName);
+
+	if (item != functionNameIndices.end())
+	{
+		return item->second;
+	}
+
+	const uint16_t index = static_cast<uint16_t>(functionNameIndices.size());
+	const size_t length = std::min<size_t>(std::strlen(originalFunctionName), UINT16_MAX);
+
+	functionNameIndices.emplace(originalFunctionName, index);
+
+	// The string record is written before the record that references it.
+	recordBuffer.clear();
+	WriteValue<uint8_t>(static_cast<uint8_t>(ExemplarLoadTraceFormat::RecordType::String));
+	WriteValue<uint16_t>(index);
+	WriteValue<uint16_t>(static_cast<uint16_t>(length));
+	recordBuffer.append(originalFunctionName, length);
+
+	traceFile.write(recordBuffer.data(), static_cast<std::streamsize>(recordBuffer.size()));
+
+	return index;
+}
@@ -0,0 +1,91 @@
+/*
+ * This file is part of sc4-resource-loading-hooks, a DLL Plugin for SimCity 4
+ * that allows other DLLs to modify resources as the game loads them.
+ *
+ * Copyright (C) 2024, 2025 Nicholas Hayes
+ *
+ * sc4-resource-loading-hooks is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * sc4-resource-loading-hooks is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with sc4-resource-loading-hooks.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#include "cIExemplarLoadHookTarget.h"
+#include "cIExemplarLoadErrorHookTarget.h"
+#include "ExemplarLoadTraceFormat.h"
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+class cIGZFrameWork;
+
+// Records the sequence of exemplar loads to a binary trace file, allowing
+// a game session to be analyzed or replayed.
+class ExemplarLoadTraceRecorder
+	: private cIExemplarLoadHookTarget,
+	  private cIExemplarLoadErrorHookTarget
+{
+public:
+
+	ExemplarLoadTraceRecorder();
+
+	bool QueryInterface(uint32_t riid, void** ppvObj) override;
+
+	uint32_t AddRef() override;
+
+	uint32_t Release() override;
+
+	void Init(cIGZFrameWork* const pFrameWork);
+
+	void Shutdown();
+
+private:
+
+	void ExemplarLoaded(
+		const char* const originalFunctionName,
+		const cGZPersistResourceKey& key,
+		cISCResExemplar* resExemplar) override;
+
+	void LoadError(
+		const char* const originalFunctionName,
+		uint32_t riid) override;
+
+	void LoadError(
+		const char* const originalFunctionName,
+		uint32_t riid,
+		const cGZPersistResourceKey& key) override;
+
+	bool Open();
+
+	void WriteRecordHeader(
+		ExemplarLoadTraceFormat::RecordType type,
+		const char* const originalFunctionName);
+
+	uint16_t GetFunctionNameIndex(const char* const originalFunctionName);
+
+	template<typename T> void WriteValue(T value);
+
+	std::filesystem::path traceFilePath;
+	std::unique_ptr<char[]> streamBuffer;
+	std::ofstream traceFile;
+	std::string recordBuffer;
+	// The function names are string literals, so the pointer value identifies them.
+	std::unordered_map<const char*, uint16_t> functionNameIndices;
+	std::chrono::steady_clock::time_point startTime;
+	std::mutex mutex;
+	uint32_t refCount;
+};
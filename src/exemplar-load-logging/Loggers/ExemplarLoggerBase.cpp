@@ -20,16 +20,230 @@
  */
 
 #include "ExemplarLoggerBase.h"
+#include "ExemplarTypes.h"
+#include "PersistResourceUtil.h"
 #include "cGZPersistResourceKey.h"
+#include "cISCPropertyHolder.h"
+#include "cISCResExemplar.h"
+#include "cRZBaseString.h"
+#include "SCPropertyUtil.h"
+#include <charconv>
+#include <chrono>
 #include <cstdarg>
+#include <string_view>
+
+namespace
+{
+	// The structured log formats are written through a large stream buffer
+	// and are not flushed after every line.
+	static constexpr size_t StreamBufferSize = 256 * 1024;
+
+	static constexpr uint32_t ExemplarTypePropertyID = 0x00000010;
+	static constexpr uint32_t ExemplarNamePropertyID = 0x00000020;
+
+	enum class RecordFieldType
+	{
+		HexNumber,
+		Number,
+		String
+	};
+
+	// The structured log fields, in the order they are written.
+	enum RecordFieldIndex : size_t
+	{
+		FunctionField = 0,
+		EventField,
+		TypeField,
+		GroupField,
+		InstanceField,
+		ExemplarTypeField,
+		ExemplarTypeNameField,
+		ExemplarNameField,
+		SourcePathField,
+		TimestampField,
+		LoadCountField,
+		RIIDField,
+		RecordFieldCount
+	};
+
+	bool HasColumn(ExemplarLogColumns columns, ExemplarLogColumns value)
+	{
+		return (columns & value) != ExemplarLogColumns::None;
+	}
+
+	void AppendJsonString(std::string& buffer, const std::string_view& value)
+	{
+		static constexpr char HexDigits[] = "0123456789ABCDEF";
+
+		buffer.push_back('"');
+
+		for (const char c : value)
+		{
+			switch (c)
+			{
+			case '"':
+				buffer.append("\\\"");
+				break;
+			case '\\':
+				buffer.append("\\\\");
+				break;
+			case '\n':
+				buffer.append("\\n");
+				break;
+			case '\r':
+				buffer.append("\\r");
+				break;
+			case '\t':
+				buffer.append("\\t");
+				break;
+			default:
+				if (static_cast<unsigned char>(c) < 0x20)
+				{
+					buffer.append("\\u00");
+					buffer.push_back(HexDigits[(c >> 4) & 0xF]);
+					buffer.push_back(HexDigits[c & 0xF]);
+				}
+				else
+				{
+					buffer.push_back(c);
+				}
+				break;
+			}
+		}
+
+		buffer.push_back('"');
+	}
+
+	void AppendCsvField(std::string& buffer, const std::string_view& value)
+	{
+		if (value.find_first_of(",\"\r\n") == std::string_view::npos)
+		{
+			buffer.append(value);
+		}
+		else
+		{
+			buffer.push_back('"');
+
+			for (const char c : value)
+			{
+				if (c == '"')
+				{
+					buffer.push_back('"');
+				}
+
+				buffer.push_back(c);
+			}
+
+			buffer.push_back('"');
+		}
+	}
+
+	void AppendHexNumber(std::string& buffer, uint32_t value)
+	{
+		char temp[16]{};
+
+		std::snprintf(temp, sizeof(temp), "0x%08X", value);
+		buffer.append(temp);
+	}
+
+	void AppendNumber(std::string& buffer, uint64_t value)
+	{
+		char temp[32]{};
+
+		const auto result = std::to_chars(temp, temp + sizeof(temp), value);
+		buffer.append(temp, result.ptr);
+	}
+
+	uint64_t GetTimestampInMilliseconds()
+	{
+		return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+			std::chrono::system_clock::now().time_since_epoch()).count());
+	}
+}
+
+struct ExemplarLoggerBase::RecordField
+{
+	const char* name;
+	RecordFieldType type;
+	bool enabled = false;
+	bool present = false;
+	uint64_t number = 0;
+	std::string_view text{};
+
+	void SetNumber(uint64_t value)
+	{
+		number = value;
+		present = true;
+	}
+
+	void SetText(const std::string_view& value)
+	{
+		text = value;
+		present = true;
+	}
+};
 
 ExemplarLoggerBase::ExemplarLoggerBase(
 	const std::filesystem::path& logFilePath,
 	bool debugLevel)
-	: outStream(),
+	: writeMutex(),
+	  outStream(StreamBufferSize),
+	  recordBuffer(),
+	  outputFormat(ExemplarLogFormat::Text),
+	  outputColumns(ExemplarLogColumns::None),
 	  isDebugLevel(debugLevel)
 {
+	outStream.Open(logFilePath);
+}
 
+ExemplarLoggerBase::~ExemplarLoggerBase()
+{
+}
+
+void ExemplarLoggerBase::SetOutputFormat(ExemplarLogFormat format, ExemplarLogColumns columns)
+{
+	std::lock_guard<std::mutex> lock(writeMutex);
+
+	outputFormat = format;
+	outputColumns = columns | GetRequiredColumns();
+
+	if (outputFormat == ExemplarLogFormat::Csv && outStream.IsOpen())
+	{
+		RecordField fields[RecordFieldCount]{};
+		InitializeRecordFields(fields);
+
+		recordBuffer.clear();
+
+		for (const RecordField& field : fields)
+		{
+			if (field.enabled)
+			{
+				if (!recordBuffer.empty())
+				{
+					recordBuffer.push_back(',');
+				}
+
+				recordBuffer.append(field.name);
+			}
+		}
+
+		// The CSV header is repeated at the start of each rotated log file.
+		outStream.SetFileHeader(recordBuffer);
+	}
+}
+
+void ExemplarLoggerBase::SetRotationOptions(const LogRotationOptions& options)
+{
+	std::lock_guard<std::mutex> lock(writeMutex);
+
+	outStream.SetRotationOptions(options);
+}
+
+void ExemplarLoggerBase::Shutdown()
+{
+	std::lock_guard<std::mutex> lock(writeMutex);
+
+	outStream.Shutdown();
 }
 
 bool ExemplarLoggerBase::IsDebugLevel() const
@@ -37,14 +251,29 @@ bool ExemplarLoggerBase::IsDebugLevel() const
 	return isDebugLevel;
 }
 
+bool ExemplarLoggerBase::IsStructuredOutput() const
+{
+	return outputFormat != ExemplarLogFormat::Text;
+}
+
+ExemplarLogColumns ExemplarLoggerBase::GetRequiredColumns() const
+{
+	return ExemplarLogColumns::None;
+}
+
 void ExemplarLoggerBase::LoadError(
 	const char* const originalFunctionName,
 	uint32_t riid)
 {
-	if (isDebugLevel)
+	if (IsStructuredOutput())
+	{
+		WriteErrorRecord(originalFunctionName, riid, nullptr);
+	}
+	else if (isDebugLevel)
 	{
 		WriteLineFormatted(
-			__FUNCSIG__ ": Error loading exemplar, riid=0x%08X",
+			"%s: Error loading exemplar, riid=0x%08X",
+			__FUNCSIG__,
 			riid);
 	}
 	else
@@ -60,10 +289,15 @@ void ExemplarLoggerBase::LoadError(
 	uint32_t riid,
 	const cGZPersistResourceKey& key)
 {
-	if (isDebugLevel)
+	if (IsStructuredOutput())
+	{
+		WriteErrorRecord(originalFunctionName, riid, &key);
+	}
+	else if (isDebugLevel)
 	{
 		WriteLineFormatted(
-			__FUNCSIG__ ": Error loading exemplar, T=0x%08X G=0x%08X, I=0x%08X, riid=0x%08X",
+			"%s: Error loading exemplar, T=0x%08X G=0x%08X, I=0x%08X, riid=0x%08X",
+			__FUNCSIG__,
 			key.type,
 			key.group,
 			key.instance,
@@ -82,9 +316,12 @@ void ExemplarLoggerBase::LoadError(
 
 void ExemplarLoggerBase::WriteLine(const char* const line)
 {
-	if (outStream)
+	std::lock_guard<std::mutex> lock(writeMutex);
+
+	if (outStream.IsOpen())
 	{
-		outStream << line << std::endl;
+		outStream.WriteLine(line);
+		outStream.Flush();
 	}
 }
 
@@ -127,4 +364,207 @@ void ExemplarLoggerBase::WriteLineFormatted(const char* const format, ...)
 	va_end(args);
 }
 
+void ExemplarLoggerBase::InitializeRecordFields(RecordField* fields) const
+{
+	const ExemplarLogColumns columns = outputColumns;
+
+	fields[FunctionField] = { "function", RecordFieldType::String, isDebugLevel };
+	fields[EventField] = { "event", RecordFieldType::String, true };
+	fields[TypeField] = { "type", RecordFieldType::HexNumber, true };
+	fields[GroupField] = { "group", RecordFieldType::HexNumber, true };
+	fields[InstanceField] = { "instance", RecordFieldType::HexNumber, true };
+	fields[ExemplarTypeField] = { "exemplarType", RecordFieldType::HexNumber, HasColumn(columns, ExemplarLogColumns::ExemplarType) };
+	fields[ExemplarTypeNameField] = { "exemplarTypeName", RecordFieldType::String, HasColumn(columns, ExemplarLogColumns::ExemplarType) };
+	fields[ExemplarNameField] = { "exemplarName", RecordFieldType::String, HasColumn(columns, ExemplarLogColumns::ExemplarName) };
+	fields[SourcePathField] = { "path", RecordFieldType::String, HasColumn(columns, ExemplarLogColumns::SourcePath) };
+	fields[TimestampField] = { "timestamp", RecordFieldType::Number, HasColumn(columns, ExemplarLogColumns::Timestamp) };
+	fields[LoadCountField] = { "loadCount", RecordFieldType::Number, HasColumn(columns, ExemplarLogColumns::LoadCount) };
+	fields[RIIDField] = { "riid", RecordFieldType::HexNumber, true };
+}
+
+void ExemplarLoggerBase::SetResourceKeyFields(RecordField* fields, const cGZPersistResourceKey& key)
+{
+	fields[TypeField].SetNumber(key.type);
+	fields[GroupField].SetNumber(key.group);
+	fields[InstanceField].SetNumber(key.instance);
+}
+
+void ExemplarLoggerBase::WriteExemplarRecord(
+	const char* const originalFunctionName,
+	const cGZPersistResourceKey& key,
+	cISCResExemplar* resExemplar)
+{
+	RecordField fields[RecordFieldCount]{};
+	InitializeRecordFields(fields);
+
+	fields[FunctionField].SetText(originalFunctionName);
+	fields[EventField].SetText("load");
+	SetResourceKeyFields(fields, key);
+
+	const cISCPropertyHolder* propertyHolder = resExemplar ? resExemplar->AsISCPropertyHolder() : nullptr;
+
+	if (propertyHolder)
+	{
+		if (fields[ExemplarTypeField].enabled)
+		{
+			uint32_t exemplarType = 0;
+
+			if (SCPropertyUtil::GetPropertyValue(propertyHolder, ExemplarTypePropertyID, exemplarType))
+			{
+				fields[ExemplarTypeField].SetNumber(exemplarType);
+				fields[ExemplarTypeNameField].SetText(ExemplarTypes::GetExemplarTypeName(exemplarType));
+			}
+		}
+	}
+
+	// The strings must stay in scope until the record has been written.
+	cRZBaseString exemplarName;
+	cRZBaseString sourcePath;
+
+	if (propertyHolder && fields[ExemplarNameField].enabled)
+	{
+		if (SCPropertyUtil::GetPropertyValue(propertyHolder, ExemplarNamePropertyID, exemplarName))
+		{
+			fields[ExemplarNameField].SetText(std::string_view(exemplarName.ToChar(), exemplarName.Strlen()));
+		}
+	}
+
+	if (fields[SourcePathField].enabled)
+	{
+		if (PersistResourceUtil::GetResourceFilePath(key, sourcePath))
+		{
+			fields[SourcePathField].SetText(std::string_view(sourcePath.ToChar(), sourcePath.Strlen()));
+		}
+	}
+
+	if (fields[TimestampField].enabled)
+	{
+		fields[TimestampField].SetNumber(GetTimestampInMilliseconds());
+	}
+
+	WriteRecord(fields, RecordFieldCount);
+}
+
+void ExemplarLoggerBase::WriteLoadCountRecord(const cGZPersistResourceKey& key, uint32_t loadCount)
+{
+	RecordField fields[RecordFieldCount]{};
+	InitializeRecordFields(fields);
+
+	fields[EventField].SetText("loadCount");
+	SetResourceKeyFields(fields, key);
+	fields[LoadCountField].SetNumber(loadCount);
+
+	WriteRecord(fields, RecordFieldCount);
+}
+
+void ExemplarLoggerBase::WriteErrorRecord(
+	const char* const originalFunctionName,
+	uint32_t riid,
+	const cGZPersistResourceKey* key)
+{
+	RecordField fields[RecordFieldCount]{};
+	InitializeRecordFields(fields);
+
+	fields[FunctionField].SetText(originalFunctionName);
+	fields[EventField].SetText("error");
+	fields[RIIDField].SetNumber(riid);
+
+	if (key)
+	{
+		SetResourceKeyFields(fields, *key);
+	}
+
+	if (fields[TimestampField].enabled)
+	{
+		fields[TimestampField].SetNumber(GetTimestampInMilliseconds());
+	}
+
+	WriteRecord(fields, RecordFieldCount);
+}
+
+void ExemplarLoggerBase::WriteRecord(const RecordField* fields, size_t fieldCount)
+{
+	std::lock_guard<std::mutex> lock(writeMutex);
+
+	if (!outStream.IsOpen())
+	{
+		return;
+	}
+
+	const bool json = outputFormat == ExemplarLogFormat::JsonLines;
+	bool firstField = true;
+
+	recordBuffer.clear();
+
+	if (json)
+	{
+		recordBuffer.push_back('{');
+	}
 
+	for (size_t i = 0; i < fieldCount; i++)
+	{
+		const RecordField& field = fields[i];
+
+		// JSON omits the missing fields, CSV writes an empty column.
+		if (!field.enabled || (json && !field.present))
+		{
+			continue;
+		}
+
+		if (!firstField)
+		{
+			recordBuffer.push_back(',');
+		}
+		firstField = false;
+
+		if (json)
+		{
+			recordBuffer.push_back('"');
+			recordBuffer.append(field.name);
+			recordBuffer.append("\":");
+		}
+
+		if (field.present)
+		{
+			switch (field.type)
+			{
+			case RecordFieldType::HexNumber:
+				// The hexadecimal numbers are written as strings because JSON
+				// does not support hexadecimal literals.
+				if (json)
+				{
+					recordBuffer.push_back('"');
+					AppendHexNumber(recordBuffer, static_cast<uint32_t>(field.number));
+					recordBuffer.push_back('"');
+				}
+				else
+				{
+					AppendHexNumber(recordBuffer, static_cast<uint32_t>(field.number));
+				}
+				break;
+			case RecordFieldType::Number:
+				AppendNumber(recordBuffer, field.number);
+				break;
+			case RecordFieldType::String:
+				if (json)
+				{
+					AppendJsonString(recordBuffer, field.text);
+				}
+				else
+				{
+					AppendCsvField(recordBuffer, field.text);
+				}
+				break;
+			}
+		}
+	}
+
+	if (json)
+	{
+		recordBuffer.push_back('}');
+	}
+
+	recordBuffer.push_back('\n');
+
+	outStream.Write(recordBuffer);
+}
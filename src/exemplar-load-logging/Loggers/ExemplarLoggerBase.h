@@ -20,8 +20,11 @@
  */
 
 #pragma once
+#include "RotatingLogFile.h"
 #include <filesystem>
-#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
 #include <type_traits>
 
 class cGZPersistResourceKey;
@@ -50,14 +53,56 @@ inline ExemplarLoggerOptions operator&(ExemplarLoggerOptions lhs, ExemplarLogger
 		);
 }
 
+enum class ExemplarLogFormat : uint32_t
+{
+	Text = 0,
+	JsonLines = 1,
+	Csv = 2
+};
+
+// The optional columns that are written in the structured log formats.
+enum class ExemplarLogColumns : uint32_t
+{
+	None = 0,
+	ExemplarName = 1 << 0,
+	ExemplarType = 1 << 1,
+	SourcePath = 1 << 2,
+	Timestamp = 1 << 3,
+	// Only used by loggers that write the per-key load counts.
+	LoadCount = 1 << 4,
+};
+
+inline ExemplarLogColumns operator|(ExemplarLogColumns lhs, ExemplarLogColumns rhs)
+{
+	return static_cast<ExemplarLogColumns>(
+		static_cast<std::underlying_type<ExemplarLogColumns>::type>(lhs) |
+		static_cast<std::underlying_type<ExemplarLogColumns>::type>(rhs)
+		);
+}
+
+inline ExemplarLogColumns operator&(ExemplarLogColumns lhs, ExemplarLogColumns rhs)
+{
+	return static_cast<ExemplarLogColumns>(
+		static_cast<std::underlying_type<ExemplarLogColumns>::type>(lhs) &
+		static_cast<std::underlying_type<ExemplarLogColumns>::type>(rhs)
+		);
+}
+
 class ExemplarLoggerBase
 {
 public:
 
 	ExemplarLoggerBase(const std::filesystem::path& logFilePath, bool debugLevel);
 
+	virtual ~ExemplarLoggerBase();
+
 	virtual ExemplarLoggerOptions GetLoggerOptions() const = 0;
 
+	// Sets the log output format, this must be called before any records are written.
+	void SetOutputFormat(ExemplarLogFormat format, ExemplarLogColumns columns);
+
+	void SetRotationOptions(const LogRotationOptions& options);
+
 	virtual void ExemplarLoaded(
 		const char* const originalFunctionName,
 		const cGZPersistResourceKey& key,
@@ -72,16 +117,52 @@ public:
 		uint32_t riid,
 		const cGZPersistResourceKey& key);
 
+	// Called when the game is shutting down, allows loggers that
+	// collect statistics to write them to the log.
+	// The base class flushes the log file.
+	virtual void Shutdown();
+
 protected:
 
 	bool IsDebugLevel() const;
 
+	bool IsStructuredOutput() const;
+
+	// The columns that the logger always writes in the structured log formats.
+	virtual ExemplarLogColumns GetRequiredColumns() const;
+
 	void WriteLine(const char* const line);
 
 	void WriteLineFormatted(const char* const format, ...);
 
+	void WriteExemplarRecord(
+		const char* const originalFunctionName,
+		const cGZPersistResourceKey& key,
+		cISCResExemplar* resExemplar);
+
+	void WriteLoadCountRecord(const cGZPersistResourceKey& key, uint32_t loadCount);
+
 private:
 
-	std::ofstream outStream;
+	struct RecordField;
+
+	void InitializeRecordFields(RecordField* fields) const;
+
+	static void SetResourceKeyFields(RecordField* fields, const cGZPersistResourceKey& key);
+
+	void WriteErrorRecord(
+		const char* const originalFunctionName,
+		uint32_t riid,
+		const cGZPersistResourceKey* key);
+
+	void WriteRecord(const RecordField* fields, size_t fieldCount);
+
+	// The exemplars can be loaded on more than one thread, the mutex protects
+	// the shared record buffer and the log file.
+	std::mutex writeMutex;
+	RotatingLogFile outStream;
+	std::string recordBuffer;
+	ExemplarLogFormat outputFormat;
+	ExemplarLogColumns outputColumns;
 	bool isDebugLevel;
-};
\ No newline at end of file
+};
@@ -49,9 +49,14 @@ ExemplarLoggerOptions ExemplarResourceLoggerBase::GetLoggerOptions() const
 
 void ExemplarResourceLoggerBase::LogExemplarTGI(
 	const char* const originalFunctionName,
-	const cGZPersistResourceKey& key)
+	const cGZPersistResourceKey& key,
+	cISCResExemplar* resExemplar)
 {
-	if (IsDebugLevel())
+	if (IsStructuredOutput())
+	{
+		WriteExemplarRecord(originalFunctionName, key, resExemplar);
+	}
+	else if (IsDebugLevel())
 	{
 		WriteLineFormatted(
 			"%s: T=0x%08X G=0x%08X, I=0x%08X",
@@ -39,7 +39,8 @@ protected:
 
 	void LogExemplarTGI(
 		const char* const originalFunctionName,
-		const cGZPersistResourceKey& key);
+		const cGZPersistResourceKey& key,
+		cISCResExemplar* resExemplar);
 
 private:
 
@@ -34,5 +34,5 @@ void ExemplarTGILogger::ExemplarLoaded(
 	const cGZPersistResourceKey& key,
 	cISCResExemplar* resExemplar)
 {
-	LogExemplarTGI(originalFunctionName, key);
+	LogExemplarTGI(originalFunctionName, key, resExemplar);
 }
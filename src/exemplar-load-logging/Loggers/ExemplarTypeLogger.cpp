@@ -39,11 +39,23 @@ ExemplarTypeLogger::ExemplarTypeLogger(
 {
 }
 
+ExemplarLogColumns ExemplarTypeLogger::GetRequiredColumns() const
+{
+	return ExemplarLogColumns::ExemplarType;
+}
+
 void ExemplarTypeLogger::ExemplarLoaded(
 	const char* const originalFunctionName,
 	const cGZPersistResourceKey& key,
 	cISCResExemplar* resExemplar)
 {
+	if (IsStructuredOutput())
+	{
+		// The exemplar type is one of the required columns.
+		WriteExemplarRecord(originalFunctionName, key, resExemplar);
+		return;
+	}
+
 	uint32_t exemplarType = 0;
 
 	const cISCPropertyHolder* propertyHolder = resExemplar->AsISCPropertyHolder();
@@ -81,6 +93,6 @@ void ExemplarTypeLogger::ExemplarLoaded(
 
 	if (!wroteExemplarType)
 	{
-		LogExemplarTGI(originalFunctionName, key);
+		LogExemplarTGI(originalFunctionName, key, resExemplar);
 	}
 }
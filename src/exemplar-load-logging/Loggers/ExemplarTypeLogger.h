@@ -32,6 +32,8 @@ public:
 
 private:
 
+	ExemplarLogColumns GetRequiredColumns() const override;
+
 	void ExemplarLoaded(
 		const char* const originalFunctionName,
 		const cGZPersistResourceKey& key,
@@ -0,0 +1,104 @@
+/*
+ * This file is part of sc4-resource-loading-hooks, a DLL Plugin for SimCity 4
+ * that allows other DLLs to modify resources as the game loads them.
+ *
+ * Copyright (C) 2024, 2025 Nicholas Hayes
+ *
+ * sc4-resource-loading-hooks is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * sc4-resource-loading-hooks is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with sc4-resource-loading-hooks.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ExemplarUniqueTGILogger.h"
+#include "cGZPersistResourceKey.h"
+
+ExemplarUniqueTGILogger::ExemplarUniqueTGILogger(
+	const std::filesystem::path& logFilePath,
+	bool debugLevel)
+	: ExemplarResourceLoggerBase(/*logResourceLoadErrors*/false, logFilePath, debugLevel),
+	  loadCounts(),
+	  mutex()
+{
+}
+
+void ExemplarUniqueTGILogger::Shutdown()
+{
+	std::lock_guard<std::mutex> lock(mutex);
+
+	if (loadCounts)
+	{
+		if (IsStructuredOutput())
+		{
+			for (const ExemplarLoadCountTable::Entry& entry : loadCounts->GetEntriesSortedByLoadCount())
+			{
+				WriteLoadCountRecord(
+					cGZPersistResourceKey(entry.type, entry.group, entry.instance),
+					entry.loadCount);
+			}
+		}
+		else
+		{
+			WriteLineFormatted(
+				"Loaded %zu unique exemplars, %llu exemplar loads in total.",
+				loadCounts->GetUniqueKeyCount(),
+				loadCounts->GetTotalLoadCount());
+
+			for (const ExemplarLoadCountTable::Entry& entry : loadCounts->GetEntriesSortedByLoadCount())
+			{
+				WriteLineFormatted(
+					"T=0x%08X G=0x%08X, I=0x%08X, LoadCount=%u",
+					entry.type,
+					entry.group,
+					entry.instance,
+					entry.loadCount);
+			}
+		}
+
+		loadCounts.reset();
+	}
+
+	ExemplarResourceLoggerBase::Shutdown();
+}
+
+ExemplarLogColumns ExemplarUniqueTGILogger::GetRequiredColumns() const
+{
+	return ExemplarLogColumns::LoadCount;
+}
+
+void ExemplarUniqueTGILogger::ExemplarLoaded(
+	const char* const originalFunctionName,
+	const cGZPersistResourceKey& key,
+	cISCResExemplar* resExemplar)
+{
+	bool firstLoad = false;
+
+	{
+		// The lock only covers the table, LogExemplarTGI reads the exemplar properties
+		// and takes the writer lock.
+		std::lock_guard<std::mutex> lock(mutex);
+
+		if (!loadCounts)
+		{
+			// The table starts small and grows with the unique exemplar count, asking the
+			// resource manager for the exemplar count would enumerate every resource.
+			loadCounts = std::make_unique<ExemplarLoadCountTable>();
+		}
+
+		firstLoad = loadCounts->AddLoad(key);
+	}
+
+	if (firstLoad)
+	{
+		LogExemplarTGI(originalFunctionName, key, resExemplar);
+	}
+}
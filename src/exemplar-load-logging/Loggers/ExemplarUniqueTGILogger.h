@@ -0,0 +1,52 @@
+/*
+ * This file is part of sc4-resource-loading-hooks, a DLL Plugin for SimCity 4
+ * that allows other DLLs to modify resources as the game loads them.
+ *
+ * Copyright (C) 2024, 2025 Nicholas Hayes
+ *
+ * sc4-resource-loading-hooks is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * sc4-resource-loading-hooks is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with sc4-resource-loading-hooks.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#include "ExemplarResourceLoggerBase.h"
+#include "ExemplarLoadCountTable.h"
+#include <memory>
+#include <mutex>
+
+// Logs the TGI of an exemplar the first time it is loaded, and writes
+// the number of times each exemplar was loaded when the game exits.
+
+class ExemplarUniqueTGILogger final : public ExemplarResourceLoggerBase
+{
+public:
+
+	ExemplarUniqueTGILogger(
+		const std::filesystem::path& logFilePath,
+		bool debugLevel);
+
+	void Shutdown() override;
+
+private:
+
+	ExemplarLogColumns GetRequiredColumns() const override;
+
+	void ExemplarLoaded(
+		const char* const originalFunctionName,
+		const cGZPersistResourceKey& key,
+		cISCResExemplar* resExemplar) override;
+
+	std::unique_ptr<ExemplarLoadCountTable> loadCounts;
+	std::mutex mutex;
+};
@@ -21,23 +21,16 @@
 
 #include "FilteredExemplarLogger.h"
 #include "cGZPersistResourceKey.h"
-#include "cIGZPersistResource.h"
-#include "cIGZVariant.h"
-#include "cISCProperty.h"
 #include "cISCPropertyHolder.h"
 #include "cISCResExemplar.h"
-#include "cRZAutoRefCount.h"
-#include "SCPropertyUtil.h"
-
-static constexpr uint32_t ExemplarTypePropertyID = 0x00000010;
 
 FilteredExemplarLogger::FilteredExemplarLogger(
-	uint32_t type,
+	ExemplarFilterExpression&& filter,
 	const std::filesystem::path& logFilePath,
 	bool debugLevel)
-	: ExemplarResourceLoggerBase(/*logResourceLoadErrors*/false, logFilePath, debugLevel)
+	: ExemplarResourceLoggerBase(/*logResourceLoadErrors*/false, logFilePath, debugLevel),
+	  filter(std::move(filter))
 {
-	exemplarTypeToLog = type;
 }
 
 void FilteredExemplarLogger::ExemplarLoaded(
@@ -45,18 +38,8 @@ void FilteredExemplarLogger::ExemplarLoaded(
 	const cGZPersistResourceKey& key,
 	cISCResExemplar* resExemplar)
 {
-	const cISCPropertyHolder* propertyHolder = resExemplar->AsISCPropertyHolder();
-
-	if (propertyHolder)
+	if (filter.IsMatch(key, resExemplar->AsISCPropertyHolder()))
 	{
-		uint32_t type = 0;
-
-		if (SCPropertyUtil::GetPropertyValue(propertyHolder, ExemplarTypePropertyID, type))
-		{
-			if (type == exemplarTypeToLog)
-			{
-				LogExemplarTGI(originalFunctionName, key);
-			}
-		}
+		LogExemplarTGI(originalFunctionName, key, resExemplar);
 	}
 }
@@ -12,16 +12,17 @@
 
 #pragma once
 #include "ExemplarResourceLoggerBase.h"
+#include "ExemplarFilterExpression.h"
 
-// Filters the exemplars by their ExemplarType and logs the TGI
-// of any matching exemplars.
+// Filters the exemplars using a compiled filter expression and logs
+// the TGI of any matching exemplars.
 
 class FilteredExemplarLogger final : public ExemplarResourceLoggerBase
 {
 public:
 
 	FilteredExemplarLogger(
-		uint32_t type,
+		ExemplarFilterExpression&& filter,
 		const std::filesystem::path& logFilePath,
 		bool debugLevel);
 
@@ -32,6 +33,6 @@ private:
 		const cGZPersistResourceKey& key,
 		cISCResExemplar* resExemplar) override;
 
-	uint32_t exemplarTypeToLog;
+	ExemplarFilterExpression filter;
 };
 
@@ -0,0 +1,76 @@
+/*
+ * This file is part of sc4-resource-loading-hooks, a DLL Plugin for SimCity 4
+ * that allows other DLLs to modify resources as the game loads them.
+ *
+ * Copyright (C) 2024, 2025 Nicholas Hayes
+ *
+ * sc4-resource-loading-hooks is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * sc4-resource-loading-hooks is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with sc4-resource-loading-hooks.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ExemplarPatch.h"
+#include "cISCPropertyHolder.h"
+
+namespace
+{
+	static constexpr uint32_t kExemplarNamePropertyId = 0x20;
+	static constexpr uint32_t kExemplarPatchTargetPropertyId = 0x0062e78a;
+	static constexpr uint32_t kExemplarPatchTargetRangesPropertyId = 0x0062e78b;
+	static constexpr uint32_t kExemplarPatchTypeTargetsPropertyId = 0x0062e78c;
+}
+
+ExemplarPatch::ExemplarPatch(const cGZPersistResourceKey& key)
+	: key(key),
+	  properties()
+{
+}
+
+const cGZPersistResourceKey& ExemplarPatch::GetKey() const
+{
+	return key;
+}
+
+const ExemplarPatch::PropertyList& ExemplarPatch::GetProperties() const
+{
+	return properties;
+}
+
+bool ExemplarPatch::IsPatchProperty(uint32_t id)
+{
+	return id != kExemplarPatchTargetPropertyId
+		&& id != kExemplarPatchTargetRangesPropertyId
+		&& id != kExemplarPatchTypeTargetsPropertyId
+		&& id != kExemplarNamePropertyId;
+}
+
+void ExemplarPatch::AddProperty(cISCProperty* pProperty)
+{
+	if (pProperty && IsPatchProperty(pProperty->GetPropertyID()))
+	{
+		properties.push_back(cRZAutoRefCount<cISCProperty>(pProperty, cRZAutoRefCount<cISCProperty>::kAddRef));
+	}
+}
+
+void ExemplarPatch::AddProperties(const cISCPropertyHolder* pPropertyHolder)
+{
+	if (pPropertyHolder)
+	{
+		pPropertyHolder->EnumProperties(AddPropertyCallback, this);
+	}
+}
+
+void ExemplarPatch::AddPropertyCallback(cISCProperty* pProperty, void* pContext)
+{
+	static_cast<ExemplarPatch*>(pContext)->AddProperty(pProperty);
+}
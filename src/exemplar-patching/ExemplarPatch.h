@@ -0,0 +1,59 @@
+/*
+ * This file is part of sc4-resource-loading-hooks, a DLL Plugin for SimCity 4
+ * that allows other DLLs to modify resources as the game loads them.
+ *
+ * Copyright (C) 2024, 2025 Nicholas Hayes
+ *
+ * sc4-resource-loading-hooks is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * sc4-resource-loading-hooks is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with sc4-resource-loading-hooks.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#include "cGZPersistResourceKey.h"
+#include "cISCProperty.h"
+#include "cRZAutoRefCount.h"
+#include <vector>
+
+class cISCPropertyHolder;
+
+// The properties that an exemplar patch cohort adds to its target exemplars.
+// The Exemplar Patch Targets, Exemplar Patch Target Ranges, Exemplar Patch Type Targets
+// and Exemplar Name properties are not included.
+class ExemplarPatch
+{
+public:
+
+	using PropertyList = std::vector<cRZAutoRefCount<cISCProperty>>;
+
+	explicit ExemplarPatch(const cGZPersistResourceKey& key);
+
+	// The TGI of the exemplar patch cohort.
+	const cGZPersistResourceKey& GetKey() const;
+
+	const PropertyList& GetProperties() const;
+
+	static bool IsPatchProperty(uint32_t id);
+
+	void AddProperty(cISCProperty* pProperty);
+
+	// Adds the patch properties from the cohort that the game loaded.
+	void AddProperties(const cISCPropertyHolder* pPropertyHolder);
+
+private:
+
+	static void AddPropertyCallback(cISCProperty* pProperty, void* pContext);
+
+	cGZPersistResourceKey key;
+	PropertyList properties;
+};
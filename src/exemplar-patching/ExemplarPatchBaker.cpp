@@ -0,0 +1,468 @@
+/*
+ * This file is part of sc4-resource-loading-hooks, a DLL Plugin for SimCity 4
+ * that allows other DLLs to modify resources as the game loads them.
+ *
+ * Copyright (C) 2024, 2025 Nicholas Hayes
+ *
+ * sc4-resource-loading-hooks is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * sc4-resource-loading-hooks is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with sc4-resource-loading-hooks.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ExemplarPatchBaker.h"
+#include "cIGZPersistResourceKeyList.h"
+#include "cIGZPersistResourceManager.h"
+#include "cRZBaseString.h"
+#include "DBPFFormat.h"
+#include "DBPFWriter.h"
+#include "ExemplarBinaryParser.h"
+#include "ExemplarBinaryWriter.h"
+#include "PersistResourceKeyFilterBase.h"
+#include "PersistResourceUtil.h"
+#include <cstring>
+
+namespace
+{
+	static constexpr uint32_t kExemplarTypeId = 0x6534284a;
+
+	static constexpr uint32_t kFingerprintRecordVersion = 1;
+	static constexpr size_t kFingerprintRecordSize = 12;
+
+	// The record that lists the files the target exemplars were read from.
+	static const cGZPersistResourceKey kSourceFilesRecordKey(0x7B0C3E55, 0xD87C03CB, 0x00000002);
+	static constexpr uint32_t kSourceFilesRecordVersion = 1;
+	static constexpr size_t kSourceFileHeaderSize = 20;
+
+	bool TryGetFileStamp(const std::filesystem::path& path, uint64_t& size, int64_t& lastWriteTime)
+	{
+		std::error_code ec;
+
+		const uintmax_t fileSize = std::filesystem::file_size(path, ec);
+
+		if (ec)
+		{
+			return false;
+		}
+
+		const auto fileTime = std::filesystem::last_write_time(path, ec);
+
+		if (ec)
+		{
+			return false;
+		}
+
+		size = static_cast<uint64_t>(fileSize);
+		lastWriteTime = static_cast<int64_t>(fileTime.time_since_epoch().count());
+		return true;
+	}
+
+	void AppendBytes(std::vector<uint8_t>& output, const void* data, size_t size)
+	{
+		const uint8_t* bytes = static_cast<const uint8_t*>(data);
+
+		output.insert(output.end(), bytes, bytes + size);
+	}
+
+	// Returns false if a source file is missing or was changed after the file was baked.
+	bool AreSourceFilesUnchanged(std::span<const uint8_t> data)
+	{
+		if (data.size() < 8 || DBPF::ReadUint32(data.data()) != kSourceFilesRecordVersion)
+		{
+			return false;
+		}
+
+		const uint32_t fileCount = DBPF::ReadUint32(data.data() + 4);
+		size_t offset = 8;
+
+		for (uint32_t i = 0; i < fileCount; i++)
+		{
+			if ((data.size() - offset) < kSourceFileHeaderSize)
+			{
+				return false;
+			}
+
+			uint64_t bakedSize = 0;
+			int64_t bakedLastWriteTime = 0;
+			std::memcpy(&bakedSize, data.data() + offset, sizeof(bakedSize));
+			std::memcpy(&bakedLastWriteTime, data.data() + offset + 8, sizeof(bakedLastWriteTime));
+			const uint32_t pathLength = DBPF::ReadUint32(data.data() + offset + 16);
+			offset += kSourceFileHeaderSize;
+
+			if ((data.size() - offset) < pathLength)
+			{
+				return false;
+			}
+
+			const std::filesystem::path path(std::u8string(
+				reinterpret_cast<const char8_t*>(data.data() + offset),
+				pathLength));
+			offset += pathLength;
+
+			uint64_t size = 0;
+			int64_t lastWriteTime = 0;
+
+			if (!TryGetFileStamp(path, size, lastWriteTime) || size != bakedSize || lastWriteTime != bakedLastWriteTime)
+			{
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	// Includes the exemplars that are only targeted by an exemplar patch range.
+	class RangeTargetFilter : public PersistResourceKeyFilterBase
+	{
+	public:
+
+		explicit RangeTargetFilter(const ExemplarPatchIndex& index)
+			: index(index)
+		{
+		}
+
+		bool IsKeyIncluded(cGZPersistResourceKey const& key) override
+		{
+			return key.type == kExemplarTypeId
+				&& index.GetRanges().HasGroup(key.group)
+				&& index.Find(key).empty();
+		}
+
+	private:
+
+		const ExemplarPatchIndex& index;
+	};
+
+	void AddRangeTargetCallback(const cGZPersistResourceKey& key, void* pContext)
+	{
+		static_cast<std::vector<cGZPersistResourceKey>*>(pContext)->push_back(key);
+	}
+}
+
+ExemplarPatchBaker::ExemplarPatchBaker(cIGZPersistResourceManager* pResMan)
+	: pResMan(pResMan),
+	  sourceFiles(),
+	  properties(),
+	  propertyIndices(),
+	  recordBuffer(),
+	  outputBuffer(),
+	  textParser(),
+	  propertyFactory(),
+	  patchBuffer(),
+	  bakedExemplarCount(0),
+	  skippedExemplarCount(0)
+{
+}
+
+bool ExemplarPatchBaker::Bake(const ExemplarPatchIndex& index, uint64_t fingerprint, const std::filesystem::path& outputPath)
+{
+	bakedExemplarCount = 0;
+	skippedExemplarCount = 0;
+
+	if (!pResMan)
+	{
+		return false;
+	}
+
+	DBPFWriter writer;
+
+	if (!writer.Open(outputPath))
+	{
+		return false;
+	}
+
+	uint8_t fingerprintRecord[kFingerprintRecordSize]{};
+	DBPF::WriteUint32(fingerprintRecord, kFingerprintRecordVersion);
+	std::memcpy(fingerprintRecord + 4, &fingerprint, sizeof(fingerprint));
+
+	bool result = writer.AddRecord(FingerprintRecordKey, fingerprintRecord, sizeof(fingerprintRecord), false);
+
+	index.EnumTargets([&](const cGZPersistResourceKey& key, const ExemplarPatchIndex::PatchList& patches)
+	{
+		if (result)
+		{
+			patchBuffer.clear();
+
+			for (const auto& patch : patches)
+			{
+				patchBuffer.push_back(patch.get());
+			}
+
+			if (index.GetRanges().Find(key, patchBuffer))
+			{
+				// The patches are applied in load order, like the server does.
+				index.SortByLoadOrder(patchBuffer);
+			}
+
+			if (BakeExemplar(key, patchBuffer, writer))
+			{
+				bakedExemplarCount++;
+			}
+			else
+			{
+				skippedExemplarCount++;
+			}
+		}
+	});
+
+	if (result && !index.GetRanges().Empty())
+	{
+		// The exemplars that are only targeted by a range are listed by the resource manager.
+		std::vector<cGZPersistResourceKey> rangeTargets;
+
+		cRZAutoRefCount<cIGZPersistResourceKeyList> pResourceList;
+
+		RangeTargetFilter* filter = new RangeTargetFilter(index);
+		filter->AddRef();
+		pResMan->GetAvailableResourceList(pResourceList.AsPPObj(), filter);
+		filter->Release();
+
+		if (pResourceList)
+		{
+			rangeTargets.reserve(pResourceList->Size());
+			pResourceList->EnumKeys(AddRangeTargetCallback, &rangeTargets);
+		}
+
+		for (const cGZPersistResourceKey& key : rangeTargets)
+		{
+			patchBuffer.clear();
+
+			if (index.GetRanges().Find(key, patchBuffer))
+			{
+				if (BakeExemplar(key, patchBuffer, writer))
+				{
+					bakedExemplarCount++;
+				}
+				else
+				{
+					skippedExemplarCount++;
+				}
+			}
+		}
+	}
+
+	if (result)
+	{
+		// The baked exemplars replace the target exemplars, a change to a file that
+		// provided a target makes the baked file stale.
+		std::vector<uint8_t> sourceFilesRecord(8);
+		DBPF::WriteUint32(sourceFilesRecord.data(), kSourceFilesRecordVersion);
+		uint32_t sourceFileCount = 0;
+
+		for (const auto& item : sourceFiles)
+		{
+			const std::filesystem::path path(item.first);
+			const std::u8string pathString = path.u8string();
+			uint64_t size = 0;
+			int64_t lastWriteTime = 0;
+
+			if (!item.second || !TryGetFileStamp(path, size, lastWriteTime))
+			{
+				continue;
+			}
+
+			uint8_t pathLength[4];
+			DBPF::WriteUint32(pathLength, static_cast<uint32_t>(pathString.size()));
+
+			AppendBytes(sourceFilesRecord, &size, sizeof(size));
+			AppendBytes(sourceFilesRecord, &lastWriteTime, sizeof(lastWriteTime));
+			AppendBytes(sourceFilesRecord, pathLength, sizeof(pathLength));
+			AppendBytes(sourceFilesRecord, pathString.data(), pathString.size());
+			sourceFileCount++;
+		}
+
+		DBPF::WriteUint32(sourceFilesRecord.data() + 4, sourceFileCount);
+
+		result = writer.AddRecord(kSourceFilesRecordKey, sourceFilesRecord.data(), sourceFilesRecord.size(), true);
+	}
+
+	sourceFiles.clear();
+
+	return writer.Close() && result;
+}
+
+uint32_t ExemplarPatchBaker::GetBakedExemplarCount() const
+{
+	return bakedExemplarCount;
+}
+
+uint32_t ExemplarPatchBaker::GetSkippedExemplarCount() const
+{
+	return skippedExemplarCount;
+}
+
+bool ExemplarPatchBaker::IsUpToDate(const std::filesystem::path& path, uint64_t fingerprint)
+{
+	DBPFFile file;
+
+	if (!file.Open(path))
+	{
+		return false;
+	}
+
+	bool fingerprintMatches = false;
+	bool sourceFilesUnchanged = false;
+	std::vector<uint8_t> buffer;
+
+	file.FindIndexEntries(
+		FingerprintRecordKey.type,
+		FingerprintRecordKey.group,
+		[&](const DBPFFile::IndexEntry& entry)
+		{
+			if (entry.key.instance == FingerprintRecordKey.instance)
+			{
+				const std::span<const uint8_t> data = file.GetRecordData(entry);
+				uint64_t bakedFingerprint = 0;
+
+				if (data.size() == kFingerprintRecordSize
+					&& DBPF::ReadUint32(data.data()) == kFingerprintRecordVersion)
+				{
+					std::memcpy(&bakedFingerprint, data.data() + 4, sizeof(bakedFingerprint));
+					fingerprintMatches = bakedFingerprint == fingerprint;
+				}
+			}
+			else if (entry.key.instance == kSourceFilesRecordKey.instance)
+			{
+				std::span<const uint8_t> data;
+
+				sourceFilesUnchanged = file.ReadRecord(entry, buffer, data) && AreSourceFilesUnchanged(data);
+			}
+		});
+
+	return fingerprintMatches && sourceFilesUnchanged;
+}
+
+bool ExemplarPatchBaker::BakeExemplar(
+	const cGZPersistResourceKey& key,
+	const std::vector<const ExemplarPatch*>& patches,
+	DBPFWriter& writer)
+{
+	const SourceFile* sourceFile = GetSourceFile(key);
+
+	if (!sourceFile)
+	{
+		return false;
+	}
+
+	const auto entry = sourceFile->exemplars.find(key);
+
+	if (entry == sourceFile->exemplars.end())
+	{
+		return false;
+	}
+
+	std::span<const uint8_t> data;
+
+	if (!sourceFile->file->ReadRecord(entry->second, recordBuffer, data))
+	{
+		return false;
+	}
+
+	properties.clear();
+	propertyIndices.clear();
+
+	cGZPersistResourceKey parentCohortKey;
+
+	if (ExemplarFormat::IsTextFormat(data.data(), data.size()))
+	{
+		if (!textParser.Open(data.data(), data.size()))
+		{
+			return false;
+		}
+
+		parentCohortKey = textParser.GetParentCohortKey();
+		AddTargetProperties(textParser);
+	}
+	else
+	{
+		ExemplarBinaryParser binaryParser;
+
+		if (!binaryParser.Open(data.data(), data.size()))
+		{
+			return false;
+		}
+
+		parentCohortKey = binaryParser.GetParentCohortKey();
+		AddTargetProperties(binaryParser);
+	}
+
+	for (const auto& patch : patches)
+	{
+		for (const auto& property : patch->GetProperties())
+		{
+			AddProperty(property);
+		}
+	}
+
+	return ExemplarBinaryWriter::Write(properties, parentCohortKey, ExemplarBinaryWriter::FileKind::Exemplar, outputBuffer)
+		&& writer.AddRecord(key, outputBuffer.data(), outputBuffer.size(), true);
+}
+
+const ExemplarPatchBaker::SourceFile* ExemplarPatchBaker::GetSourceFile(const cGZPersistResourceKey& key)
+{
+	cRZBaseString path;
+
+	if (!PersistResourceUtil::GetResourceFilePath(pResMan, key, path))
+	{
+		return nullptr;
+	}
+
+	auto result = sourceFiles.try_emplace(std::string(path.ToChar(), path.Strlen()));
+
+	if (result.second)
+	{
+		std::unique_ptr<SourceFile> sourceFile = std::make_unique<SourceFile>();
+		sourceFile->file = std::make_unique<DBPFFile>();
+
+		if (sourceFile->file->Open(std::filesystem::path(result.first->first)))
+		{
+			const DBPFFile& file = *sourceFile->file;
+
+			for (size_t i = 0; i < file.GetIndexEntryCount(); i++)
+			{
+				const DBPFFile::IndexEntry indexEntry = file.GetIndexEntry(i);
+
+				if (indexEntry.key.type == kExemplarTypeId)
+				{
+					sourceFile->exemplars.insert_or_assign(indexEntry.key, indexEntry);
+				}
+			}
+
+			result.first->second = std::move(sourceFile);
+		}
+	}
+
+	return result.first->second.get();
+}
+
+template<typename TParser>
+void ExemplarPatchBaker::AddTargetProperties(const TParser& parser)
+{
+	parser.EnumProperties([&](const ExemplarPropertyView& property)
+	{
+		AddProperty(propertyFactory.Create(property));
+	});
+}
+
+void ExemplarPatchBaker::AddProperty(const cRZAutoRefCount<cISCProperty>& property)
+{
+	const auto result = propertyIndices.try_emplace(property->GetPropertyID(), properties.size());
+
+	if (result.second)
+	{
+		properties.push_back(property);
+	}
+	else
+	{
+		properties[result.first->second] = property;
+	}
+}
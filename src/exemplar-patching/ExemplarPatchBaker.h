@@ -0,0 +1,100 @@
+/*
+ * This file is part of sc4-resource-loading-hooks, a DLL Plugin for SimCity 4
+ * that allows other DLLs to modify resources as the game loads them.
+ *
+ * Copyright (C) 2024, 2025 Nicholas Hayes
+ *
+ * sc4-resource-loading-hooks is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * sc4-resource-loading-hooks is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with sc4-resource-loading-hooks.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#include "cGZPersistResourceKey.h"
+#include "DBPFFile.h"
+#include "ExemplarPatchIndex.h"
+#include "ExemplarPropertyFactory.h"
+#include "ExemplarTextParser.h"
+#include "PersistResourceKeyBoostHash.h"
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "boost/unordered/unordered_flat_map.hpp"
+
+class cIGZPersistResourceManager;
+class DBPFWriter;
+
+// Writes the patched target exemplars to a DBPF file.
+//
+// The target exemplars are read from the DBPF files that the game loads them from,
+// and the patches are applied with the same rules as ExemplarPatchingServer::ApplyPatches:
+// the patches are applied in load order and a later patch replaces the properties
+// of an earlier one, including the patches that target a range of instance IDs.
+// The file also stores the fingerprint of the exemplar patches it was baked from, and
+// the size and modification time of the files that the target exemplars were read from.
+class ExemplarPatchBaker
+{
+public:
+
+	// An arbitrary TGI for the record that stores the exemplar patch fingerprint.
+	// The resource manager is queried for this record to find the baked file that the game loaded.
+	static inline const cGZPersistResourceKey FingerprintRecordKey{ 0x7B0C3E55, 0xD87C03CB, 0x00000001 };
+
+	explicit ExemplarPatchBaker(cIGZPersistResourceManager* pResMan);
+
+	bool Bake(const ExemplarPatchIndex& index, uint64_t fingerprint, const std::filesystem::path& outputPath);
+
+	uint32_t GetBakedExemplarCount() const;
+
+	// The number of target exemplars that could not be read from a DBPF file.
+	uint32_t GetSkippedExemplarCount() const;
+
+	// Returns true if the baked file was built from the exemplar patches with the specified
+	// fingerprint, and the files that provided the target exemplars have not changed since.
+	static bool IsUpToDate(const std::filesystem::path& path, uint64_t fingerprint);
+
+private:
+
+	struct SourceFile
+	{
+		std::unique_ptr<DBPFFile> file;
+		boost::unordered_flat_map<const cGZPersistResourceKey, DBPFFile::IndexEntry> exemplars;
+	};
+
+	bool BakeExemplar(
+		const cGZPersistResourceKey& key,
+		const std::vector<const ExemplarPatch*>& patches,
+		DBPFWriter& writer);
+
+	const SourceFile* GetSourceFile(const cGZPersistResourceKey& key);
+
+	template<typename TParser>
+	void AddTargetProperties(const TParser& parser);
+
+	void AddProperty(const cRZAutoRefCount<cISCProperty>& property);
+
+	cIGZPersistResourceManager* pResMan;
+	boost::unordered_flat_map<std::string, std::unique_ptr<SourceFile>> sourceFiles;
+	ExemplarPatch::PropertyList properties;
+	boost::unordered_flat_map<uint32_t, size_t> propertyIndices;
+	std::vector<uint8_t> recordBuffer;
+	std::vector<uint8_t> outputBuffer;
+	ExemplarTextParser textParser;
+	ExemplarPropertyFactory propertyFactory;
+	std::vector<const ExemplarPatch*> patchBuffer;
+	uint32_t bakedExemplarCount;
+	uint32_t skippedExemplarCount;
+};
@@ -0,0 +1,426 @@
+/*
+ * This file is part of sc4-resource-loading-hooks, a DLL Plugin for SimCity 4
+ * that allows other DLLs to modify resources as the game loads them.
+ *
+ * Copyright (C) 2024, 2025 Nicholas Hayes
+ *
+ * sc4-resource-loading-hooks is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * sc4-resource-loading-hooks is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with sc4-resource-loading-hooks.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ExemplarPatchBundle.h"
+#include "DBPFFormat.h"
+#include "ExemplarBinaryParser.h"
+#include "ExemplarBinaryWriter.h"
+#include "ExemplarPatchBundleFormat.h"
+#include "ExemplarPropertyFactory.h"
+#include "MemoryMappedFile.h"
+#include <algorithm>
+#include <fstream>
+#include <system_error>
+#include <vector>
+
+#include "boost/unordered/unordered_flat_map.hpp"
+
+namespace
+{
+	static constexpr uint32_t kExemplarTypeId = 0x6534284a;
+
+	struct TargetItem
+	{
+		cGZPersistResourceKey key;
+		ExemplarPatchIndex::PatchList patches;
+	};
+
+	void AppendUint32(std::vector<uint8_t>& output, uint32_t value)
+	{
+		const size_t offset = output.size();
+
+		output.resize(offset + sizeof(uint32_t));
+		DBPF::WriteUint32(output.data() + offset, value);
+	}
+
+	uint64_t ReadUint64(const uint8_t* data)
+	{
+		uint64_t value;
+		std::memcpy(&value, data, sizeof(value));
+
+		return value;
+	}
+
+	bool IsValidRange(uint64_t offset, uint64_t size, uint64_t fileSize)
+	{
+		return offset <= fileSize && size <= (fileSize - offset);
+	}
+}
+
+bool ExemplarPatchBundle::Write(
+	const std::filesystem::path& path,
+	uint64_t fingerprint,
+	const ExemplarPatchIndex& index)
+{
+	std::vector<TargetItem> targets;
+	targets.reserve(index.GetTargetCount());
+
+	index.EnumTargets([&](const cGZPersistResourceKey& key, const ExemplarPatchIndex::PatchList& patches)
+	{
+		targets.push_back(TargetItem{ key, patches });
+	});
+
+	std::sort(
+		targets.begin(),
+		targets.end(),
+		[](const TargetItem& lhs, const TargetItem& rhs)
+		{
+			return lhs.key.group < rhs.key.group
+				|| (lhs.key.group == rhs.key.group && lhs.key.instance < rhs.key.instance);
+		});
+
+	// Every patch is stored once, the targets reference the patches by index.
+	std::vector<const ExemplarPatch*> patches;
+	boost::unordered_flat_map<const ExemplarPatch*, uint32_t> patchIndices;
+	std::vector<uint8_t> targetTable;
+	std::vector<uint8_t> references;
+
+	targetTable.reserve(targets.size() * ExemplarPatchBundleFormat::TargetEntrySize);
+
+	for (const TargetItem& target : targets)
+	{
+		AppendUint32(targetTable, target.key.group);
+		AppendUint32(targetTable, target.key.instance);
+		AppendUint32(targetTable, static_cast<uint32_t>(references.size() / ExemplarPatchBundleFormat::ReferenceSize));
+		AppendUint32(targetTable, static_cast<uint32_t>(target.patches.size()));
+
+		for (const auto& patch : target.patches)
+		{
+			auto result = patchIndices.try_emplace(patch.get(), static_cast<uint32_t>(patches.size()));
+
+			if (result.second)
+			{
+				patches.push_back(patch.get());
+			}
+
+			AppendUint32(references, result.first->second);
+		}
+	}
+
+	std::vector<uint8_t> rangeTable;
+
+	index.GetRanges().EnumPatches(
+		[&](const std::shared_ptr<const ExemplarPatch>& patch, std::span<const ExemplarPatchTargetRange> ranges)
+		{
+			auto result = patchIndices.try_emplace(patch.get(), static_cast<uint32_t>(patches.size()));
+
+			if (result.second)
+			{
+				patches.push_back(patch.get());
+			}
+
+			for (const ExemplarPatchTargetRange& range : ranges)
+			{
+				AppendUint32(rangeTable, range.group);
+				AppendUint32(rangeTable, range.firstInstance);
+				AppendUint32(rangeTable, range.lastInstance);
+				AppendUint32(rangeTable, result.first->second);
+			}
+		});
+
+	std::vector<uint8_t> typeTargetTable;
+
+	index.GetTypeTargets().EnumPatches(
+		[&](const std::shared_ptr<const ExemplarPatch>& patch, std::span<const ExemplarPatchTypeTarget> typeTargets)
+		{
+			auto result = patchIndices.try_emplace(patch.get(), static_cast<uint32_t>(patches.size()));
+
+			if (result.second)
+			{
+				patches.push_back(patch.get());
+			}
+
+			for (const ExemplarPatchTypeTarget& typeTarget : typeTargets)
+			{
+				AppendUint32(typeTargetTable, typeTarget.exemplarType);
+				AppendUint32(typeTargetTable, typeTarget.conditionPropertyID);
+				AppendUint32(typeTargetTable, typeTarget.conditionValue);
+				AppendUint32(typeTargetTable, result.first->second);
+			}
+		});
+
+	const size_t patchTableSize = patches.size() * ExemplarPatchBundleFormat::PatchEntrySize;
+	const size_t payloadStart = ExemplarPatchBundleFormat::HeaderSize
+		+ patchTableSize
+		+ targetTable.size()
+		+ references.size()
+		+ rangeTable.size()
+		+ typeTargetTable.size();
+
+	std::vector<uint8_t> patchTable;
+	std::vector<uint8_t> payloads;
+	std::vector<uint8_t> payload;
+
+	patchTable.reserve(patchTableSize);
+
+	for (const ExemplarPatch* patch : patches)
+	{
+		if (!ExemplarBinaryWriter::Write(
+			patch->GetProperties(),
+			cGZPersistResourceKey(),
+			ExemplarBinaryWriter::FileKind::Cohort,
+			payload))
+		{
+			return false;
+		}
+
+		const cGZPersistResourceKey& key = patch->GetKey();
+
+		AppendUint32(patchTable, key.type);
+		AppendUint32(patchTable, key.group);
+		AppendUint32(patchTable, key.instance);
+		AppendUint32(patchTable, static_cast<uint32_t>(payloadStart + payloads.size()));
+		AppendUint32(patchTable, static_cast<uint32_t>(payload.size()));
+
+		payloads.insert(payloads.end(), payload.begin(), payload.end());
+	}
+
+	if ((payloadStart + payloads.size()) > UINT32_MAX)
+	{
+		return false;
+	}
+
+	std::vector<uint8_t> header(ExemplarPatchBundleFormat::HeaderSize);
+
+	std::memcpy(header.data(), ExemplarPatchBundleFormat::Signature.data(), ExemplarPatchBundleFormat::Signature.size());
+	DBPF::WriteUint32(header.data() + ExemplarPatchBundleFormat::VersionOffset, ExemplarPatchBundleFormat::Version);
+	DBPF::WriteUint32(header.data() + ExemplarPatchBundleFormat::PatchCountOffset, static_cast<uint32_t>(patches.size()));
+	DBPF::WriteUint32(header.data() + ExemplarPatchBundleFormat::TargetCountOffset, static_cast<uint32_t>(targets.size()));
+	DBPF::WriteUint32(
+		header.data() + ExemplarPatchBundleFormat::ReferenceCountOffset,
+		static_cast<uint32_t>(references.size() / ExemplarPatchBundleFormat::ReferenceSize));
+	std::memcpy(header.data() + ExemplarPatchBundleFormat::FingerprintOffset, &fingerprint, sizeof(fingerprint));
+	DBPF::WriteUint32(
+		header.data() + ExemplarPatchBundleFormat::RangeCountOffset,
+		static_cast<uint32_t>(rangeTable.size() / ExemplarPatchBundleFormat::RangeEntrySize));
+	DBPF::WriteUint32(
+		header.data() + ExemplarPatchBundleFormat::TypeTargetCountOffset,
+		static_cast<uint32_t>(typeTargetTable.size() / ExemplarPatchBundleFormat::TypeTargetEntrySize));
+
+	// The bundle is written to a temporary file that replaces the existing
+	// bundle, so that a partially written bundle is never read.
+	std::filesystem::path tempPath = path;
+	tempPath += ".tmp";
+
+	{
+		std::ofstream stream(tempPath, std::ofstream::out | std::ofstream::binary | std::ofstream::trunc);
+
+		if (!stream)
+		{
+			return false;
+		}
+
+		stream.write(reinterpret_cast<const char*>(header.data()), header.size());
+		stream.write(reinterpret_cast<const char*>(patchTable.data()), patchTable.size());
+		stream.write(reinterpret_cast<const char*>(targetTable.data()), targetTable.size());
+		stream.write(reinterpret_cast<const char*>(references.data()), references.size());
+		stream.write(reinterpret_cast<const char*>(rangeTable.data()), rangeTable.size());
+		stream.write(reinterpret_cast<const char*>(typeTargetTable.data()), typeTargetTable.size());
+		stream.write(reinterpret_cast<const char*>(payloads.data()), payloads.size());
+
+		if (!stream)
+		{
+			return false;
+		}
+	}
+
+	std::error_code ec;
+	std::filesystem::rename(tempPath, path, ec);
+
+	return !ec;
+}
+
+bool ExemplarPatchBundle::Read(
+	const std::filesystem::path& path,
+	uint64_t fingerprint,
+	ExemplarPatchIndex& index,
+	uint32_t& patchCount)
+{
+	MemoryMappedFile file;
+
+	if (!file.Open(path))
+	{
+		return false;
+	}
+
+	const uint8_t* const data = file.GetData();
+	const uint64_t fileSize = file.GetSize();
+
+	if (fileSize < ExemplarPatchBundleFormat::HeaderSize
+		|| std::memcmp(data, ExemplarPatchBundleFormat::Signature.data(), ExemplarPatchBundleFormat::Signature.size()) != 0
+		|| DBPF::ReadUint32(data + ExemplarPatchBundleFormat::VersionOffset) != ExemplarPatchBundleFormat::Version
+		|| ReadUint64(data + ExemplarPatchBundleFormat::FingerprintOffset) != fingerprint)
+	{
+		return false;
+	}
+
+	const uint32_t bundlePatchCount = DBPF::ReadUint32(data + ExemplarPatchBundleFormat::PatchCountOffset);
+	const uint32_t targetCount = DBPF::ReadUint32(data + ExemplarPatchBundleFormat::TargetCountOffset);
+	const uint32_t referenceCount = DBPF::ReadUint32(data + ExemplarPatchBundleFormat::ReferenceCountOffset);
+	const uint32_t rangeCount = DBPF::ReadUint32(data + ExemplarPatchBundleFormat::RangeCountOffset);
+	const uint32_t typeTargetCount = DBPF::ReadUint32(data + ExemplarPatchBundleFormat::TypeTargetCountOffset);
+
+	const uint64_t patchTableOffset = ExemplarPatchBundleFormat::HeaderSize;
+	const uint64_t targetTableOffset = patchTableOffset + (static_cast<uint64_t>(bundlePatchCount) * ExemplarPatchBundleFormat::PatchEntrySize);
+	const uint64_t referencesOffset = targetTableOffset + (static_cast<uint64_t>(targetCount) * ExemplarPatchBundleFormat::TargetEntrySize);
+	const uint64_t referencesSize = static_cast<uint64_t>(referenceCount) * ExemplarPatchBundleFormat::ReferenceSize;
+	const uint64_t rangeTableOffset = referencesOffset + referencesSize;
+	const uint64_t rangeTableSize = static_cast<uint64_t>(rangeCount) * ExemplarPatchBundleFormat::RangeEntrySize;
+	const uint64_t typeTargetTableOffset = rangeTableOffset + rangeTableSize;
+	const uint64_t typeTargetTableSize = static_cast<uint64_t>(typeTargetCount) * ExemplarPatchBundleFormat::TypeTargetEntrySize;
+
+	if (!IsValidRange(typeTargetTableOffset, typeTargetTableSize, fileSize))
+	{
+		return false;
+	}
+
+	std::vector<std::shared_ptr<const ExemplarPatch>> patches;
+	patches.reserve(bundlePatchCount);
+
+	ExemplarBinaryParser parser;
+	ExemplarPropertyFactory propertyFactory;
+
+	for (uint32_t i = 0; i < bundlePatchCount; i++)
+	{
+		const uint8_t* entry = data + patchTableOffset + (static_cast<size_t>(i) * ExemplarPatchBundleFormat::PatchEntrySize);
+
+		const cGZPersistResourceKey key(DBPF::ReadUint32(entry), DBPF::ReadUint32(entry + 4), DBPF::ReadUint32(entry + 8));
+		const uint32_t payloadOffset = DBPF::ReadUint32(entry + 12);
+		const uint32_t payloadSize = DBPF::ReadUint32(entry + 16);
+
+		if (!IsValidRange(payloadOffset, payloadSize, fileSize)
+			|| !parser.Open(data + payloadOffset, payloadSize))
+		{
+			return false;
+		}
+
+		std::shared_ptr<ExemplarPatch> patch = std::make_shared<ExemplarPatch>(key);
+
+		parser.EnumProperties([&](const ExemplarPropertyView& property)
+		{
+			patch->AddProperty(propertyFactory.Create(property));
+		});
+
+		patches.push_back(std::move(patch));
+	}
+
+	ExemplarPatchIndex bundleIndex;
+
+	for (uint32_t i = 0; i < targetCount; i++)
+	{
+		const uint8_t* entry = data + targetTableOffset + (static_cast<size_t>(i) * ExemplarPatchBundleFormat::TargetEntrySize);
+
+		const cGZPersistResourceKey target(kExemplarTypeId, DBPF::ReadUint32(entry), DBPF::ReadUint32(entry + 4));
+		const uint32_t firstReference = DBPF::ReadUint32(entry + 8);
+		const uint32_t targetReferenceCount = DBPF::ReadUint32(entry + 12);
+
+		if (firstReference > referenceCount || targetReferenceCount > (referenceCount - firstReference))
+		{
+			return false;
+		}
+
+		const uint8_t* reference = data + referencesOffset + (static_cast<size_t>(firstReference) * ExemplarPatchBundleFormat::ReferenceSize);
+
+		for (uint32_t j = 0; j < targetReferenceCount; j++, reference += ExemplarPatchBundleFormat::ReferenceSize)
+		{
+			const uint32_t patchIndex = DBPF::ReadUint32(reference);
+
+			if (patchIndex >= patches.size())
+			{
+				return false;
+			}
+
+			bundleIndex.AddPatch(patches[patchIndex], target);
+		}
+	}
+
+	ExemplarPatchRangeIndex ranges;
+	std::vector<ExemplarPatchTargetRange> patchRanges;
+	uint32_t rangePatchIndex = 0;
+
+	for (uint32_t i = 0; i < rangeCount; i++)
+	{
+		const uint8_t* entry = data + rangeTableOffset + (static_cast<size_t>(i) * ExemplarPatchBundleFormat::RangeEntrySize);
+
+		const ExemplarPatchTargetRange range{ DBPF::ReadUint32(entry), DBPF::ReadUint32(entry + 4), DBPF::ReadUint32(entry + 8) };
+		const uint32_t patchIndex = DBPF::ReadUint32(entry + 12);
+
+		if (patchIndex >= patches.size() || range.firstInstance > range.lastInstance)
+		{
+			return false;
+		}
+
+		if (!patchRanges.empty() && patchIndex != rangePatchIndex)
+		{
+			ranges.AddPatch(patches[rangePatchIndex], patchRanges);
+			patchRanges.clear();
+		}
+
+		rangePatchIndex = patchIndex;
+		patchRanges.push_back(range);
+	}
+
+	if (!patchRanges.empty())
+	{
+		ranges.AddPatch(patches[rangePatchIndex], patchRanges);
+	}
+
+	ranges.Build();
+	bundleIndex.SetRanges(std::move(ranges));
+
+	ExemplarPatchTypeIndex typeTargets;
+	std::vector<ExemplarPatchTypeTarget> patchTypeTargets;
+	uint32_t typeTargetPatchIndex = 0;
+
+	for (uint32_t i = 0; i < typeTargetCount; i++)
+	{
+		const uint8_t* entry = data + typeTargetTableOffset + (static_cast<size_t>(i) * ExemplarPatchBundleFormat::TypeTargetEntrySize);
+
+		const ExemplarPatchTypeTarget typeTarget{ DBPF::ReadUint32(entry), DBPF::ReadUint32(entry + 4), DBPF::ReadUint32(entry + 8) };
+		const uint32_t patchIndex = DBPF::ReadUint32(entry + 12);
+
+		if (patchIndex >= patches.size())
+		{
+			return false;
+		}
+
+		if (!patchTypeTargets.empty() && patchIndex != typeTargetPatchIndex)
+		{
+			typeTargets.AddPatch(patches[typeTargetPatchIndex], patchTypeTargets);
+			patchTypeTargets.clear();
+		}
+
+		typeTargetPatchIndex = patchIndex;
+		patchTypeTargets.push_back(typeTarget);
+	}
+
+	if (!patchTypeTargets.empty())
+	{
+		typeTargets.AddPatch(patches[typeTargetPatchIndex], patchTypeTargets);
+	}
+
+	bundleIndex.SetTypeTargets(std::move(typeTargets));
+
+	index = std::move(bundleIndex);
+	patchCount = bundlePatchCount;
+
+	return true;
+}
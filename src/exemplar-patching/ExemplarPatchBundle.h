@@ -0,0 +1,43 @@
+/*
+ * This file is part of sc4-resource-loading-hooks, a DLL Plugin for SimCity 4
+ * that allows other DLLs to modify resources as the game loads them.
+ *
+ * Copyright (C) 2024, 2025 Nicholas Hayes
+ *
+ * sc4-resource-loading-hooks is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * sc4-resource-loading-hooks is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with sc4-resource-loading-hooks.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#include "ExemplarPatchIndex.h"
+#include <cstdint>
+#include <filesystem>
+
+// Stores the exemplar patch index in a file, so that the next start with
+// the same plugins can load it instead of scanning the plugins.
+namespace ExemplarPatchBundle
+{
+	bool Write(
+		const std::filesystem::path& path,
+		uint64_t fingerprint,
+		const ExemplarPatchIndex& index);
+
+	// Returns false if the bundle does not exist, is not valid, or was written
+	// for a plugin set with a different fingerprint.
+	bool Read(
+		const std::filesystem::path& path,
+		uint64_t fingerprint,
+		ExemplarPatchIndex& index,
+		uint32_t& patchCount);
+}
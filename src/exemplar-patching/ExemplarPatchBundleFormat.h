@@ -0,0 +1,67 @@
+/*
+ * This file is part of sc4-resource-loading-hooks, a DLL Plugin for SimCity 4
+ * that allows other DLLs to modify resources as the game loads them.
+ *
+ * Copyright (C) 2024, 2025 Nicholas Hayes
+ *
+ * sc4-resource-loading-hooks is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * sc4-resource-loading-hooks is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with sc4-resource-loading-hooks.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+// The exemplar patch bundle file format.
+// All values are stored in little-endian byte order.
+//
+// The file starts with a header, followed by the patch table, the target table,
+// the patch reference list, the target range table, the type target table and the patch payloads.
+// Each patch payload is a binary cohort record that contains the patch properties.
+// The target table is sorted by group and instance ID, the patch references of
+// each target are stored in the order that the patches are applied.
+// The target ranges and type targets are stored in patch load order, the entries of a
+// patch are consecutive.
+namespace ExemplarPatchBundleFormat
+{
+	using namespace std::string_view_literals;
+
+	static constexpr std::string_view Signature = "SC4EXPB1"sv;
+	static constexpr uint32_t Version = 3;
+
+	// The header field offsets.
+	static constexpr size_t VersionOffset = 8;
+	static constexpr size_t PatchCountOffset = 12;
+	static constexpr size_t TargetCountOffset = 16;
+	static constexpr size_t ReferenceCountOffset = 20;
+	static constexpr size_t FingerprintOffset = 24;
+	static constexpr size_t RangeCountOffset = 32;
+	static constexpr size_t TypeTargetCountOffset = 36;
+	static constexpr size_t HeaderSize = 40;
+
+	// The patch cohort type, group and instance IDs, followed by the payload offset and size.
+	static constexpr size_t PatchEntrySize = 20;
+	// The target exemplar group and instance IDs, followed by the index of the
+	// first patch reference and the patch reference count.
+	static constexpr size_t TargetEntrySize = 16;
+	// A patch reference is the index of the patch in the patch table.
+	static constexpr size_t ReferenceSize = 4;
+	// The target exemplar group ID, the first and last instance IDs, followed by
+	// the index of the patch in the patch table.
+	static constexpr size_t RangeEntrySize = 16;
+	// The exemplar type, the condition property ID and value, followed by
+	// the index of the patch in the patch table.
+	static constexpr size_t TypeTargetEntrySize = 16;
+}
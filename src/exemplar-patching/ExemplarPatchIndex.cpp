@@ -0,0 +1,314 @@
+/*
+ * This file is part of sc4-resource-loading-hooks, a DLL Plugin for SimCity 4
+ * that allows other DLLs to modify resources as the game loads them.
+ *
+ * Copyright (C) 2024, 2025 Nicholas Hayes
+ *
+ * sc4-resource-loading-hooks is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * sc4-resource-loading-hooks is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with sc4-resource-loading-hooks.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ExemplarPatchIndex.h"
+#include <algorithm>
+#include <cstdint>
+
+static constexpr uint32_t kExemplarTypeId = 0x6534284a;
+
+ExemplarPatchIndex::ExemplarPatchIndex()
+	: patches(),
+	  coldTargets(),
+	  nodes(),
+	  firstFreeNode(NoNode),
+	  patchNodes(),
+	  sources(),
+	  ranges(),
+	  typeTargets()
+{
+}
+
+void ExemplarPatchIndex::AddPatch(
+	const std::shared_ptr<const ExemplarPatch>& patch,
+	const uint32_t* groupAndInstanceIDs,
+	uint32_t valueCount)
+{
+	for (uint32_t i = 1; i < valueCount; i += 2)
+	{
+		const cGZPersistResourceKey targetTgi(kExemplarTypeId, groupAndInstanceIDs[i - 1], groupAndInstanceIDs[i]);
+
+		AddPatch(patch, targetTgi);
+	}
+}
+
+void ExemplarPatchIndex::AddPatch(const std::shared_ptr<const ExemplarPatch>& patch, const cGZPersistResourceKey& target)
+{
+	PatchListHead& head = GetOrAddPatchList(target);
+
+	LinkNode(head, AllocateNode(patch, target), head.last);
+}
+
+void ExemplarPatchIndex::RemovePatch(const ExemplarPatch* patch)
+{
+	const auto patchItem = patchNodes.find(patch);
+
+	if (patchItem == patchNodes.end())
+	{
+		return;
+	}
+
+	uint32_t node = patchItem->second;
+	patchNodes.erase(patchItem);
+
+	while (node != NoNode)
+	{
+		PatchNode& patchNode = nodes[node];
+		const uint32_t nextPatchNode = patchNode.nextPatchNode;
+
+		const auto item = patches.find(patchNode.target);
+
+		if (item != patches.end())
+		{
+			PatchListHead& head = item->second;
+
+			if (patchNode.previous != NoNode)
+			{
+				nodes[patchNode.previous].next = patchNode.next;
+			}
+			else
+			{
+				head.first = patchNode.next;
+			}
+
+			if (patchNode.next != NoNode)
+			{
+				nodes[patchNode.next].previous = patchNode.previous;
+			}
+			else
+			{
+				head.last = patchNode.previous;
+			}
+
+			head.count--;
+
+			if (head.count == 0)
+			{
+				patches.erase(item);
+			}
+		}
+
+		patchNode.patch.reset();
+		patchNode.nextPatchNode = firstFreeNode;
+		firstFreeNode = node;
+
+		node = nextPatchNode;
+	}
+}
+
+const ExemplarPatchSourceIndex& ExemplarPatchIndex::GetSources() const
+{
+	return sources;
+}
+
+void ExemplarPatchIndex::SetSources(ExemplarPatchSourceIndex&& sources)
+{
+	this->sources = std::move(sources);
+}
+
+const ExemplarPatchRangeIndex& ExemplarPatchIndex::GetRanges() const
+{
+	return ranges;
+}
+
+void ExemplarPatchIndex::SetRanges(ExemplarPatchRangeIndex&& ranges)
+{
+	this->ranges = std::move(ranges);
+}
+
+const ExemplarPatchTypeIndex& ExemplarPatchIndex::GetTypeTargets() const
+{
+	return typeTargets;
+}
+
+void ExemplarPatchIndex::SetTypeTargets(ExemplarPatchTypeIndex&& typeTargets)
+{
+	this->typeTargets = std::move(typeTargets);
+}
+
+void ExemplarPatchIndex::SetLoadOrder(boost::unordered_flat_map<const ExemplarPatch*, uint32_t>&& loadOrder)
+{
+	this->loadOrder = std::move(loadOrder);
+}
+
+void ExemplarPatchIndex::SortByLoadOrder(std::vector<const ExemplarPatch*>& patches) const
+{
+	const auto getLoadOrder = [this](const ExemplarPatch* patch)
+	{
+		const auto item = loadOrder.find(patch);
+
+		return item != loadOrder.end() ? item->second : UINT32_MAX;
+	};
+
+	std::stable_sort(
+		patches.begin(),
+		patches.end(),
+		[&](const ExemplarPatch* lhs, const ExemplarPatch* rhs)
+		{
+			return getLoadOrder(lhs) < getLoadOrder(rhs);
+		});
+
+	patches.erase(std::unique(patches.begin(), patches.end()), patches.end());
+}
+
+ExemplarPatchIndex::PatchList ExemplarPatchIndex::Find(const cGZPersistResourceKey& key) const
+{
+	const auto item = patches.find(key);
+
+	return item != patches.end() ? PatchList(nodes.data(), item->second) : PatchList();
+}
+
+size_t ExemplarPatchIndex::GetTargetCount() const
+{
+	return patches.size() + coldTargets.size();
+}
+
+size_t ExemplarPatchIndex::PruneTargets(std::span<const cGZPersistResourceKey> availableTargets)
+{
+	// The available targets are moved to a new table, that also shrinks
+	// the lookup table to fit the remaining targets.
+	boost::unordered_flat_map<const cGZPersistResourceKey, PatchListHead> availablePatches;
+	availablePatches.reserve(availableTargets.size());
+
+	for (const cGZPersistResourceKey& target : availableTargets)
+	{
+		const auto item = patches.find(target);
+
+		if (item != patches.end())
+		{
+			availablePatches.emplace(target, item->second);
+			patches.erase(item);
+		}
+	}
+
+	const size_t prunedTargetCount = patches.size();
+
+	coldTargets.reserve(coldTargets.size() + prunedTargetCount);
+
+	for (auto& item : patches)
+	{
+		coldTargets.emplace_back(item.first, item.second);
+	}
+
+	patches = std::move(availablePatches);
+
+	return prunedTargetCount;
+}
+
+void ExemplarPatchIndex::RestoreColdTargets()
+{
+	for (auto& item : coldTargets)
+	{
+		patches.emplace(item.first, item.second);
+	}
+
+	coldTargets.clear();
+}
+
+size_t ExemplarPatchIndex::GetColdTargetCount() const
+{
+	return coldTargets.size();
+}
+
+size_t ExemplarPatchIndex::GetLookupTableSize() const
+{
+	return patches.bucket_count() * sizeof(decltype(patches)::value_type);
+}
+
+void ExemplarPatchIndex::Clear()
+{
+	patches.clear();
+	coldTargets.clear();
+	nodes.clear();
+	firstFreeNode = NoNode;
+	patchNodes.clear();
+	sources.Clear();
+	ranges.Clear();
+	typeTargets.Clear();
+	loadOrder.clear();
+}
+
+ExemplarPatchIndex::PatchListHead& ExemplarPatchIndex::GetOrAddPatchList(const cGZPersistResourceKey& target)
+{
+	return patches.try_emplace(target, PatchListHead{ NoNode, NoNode, 0 }).first->second;
+}
+
+uint32_t ExemplarPatchIndex::AllocateNode(const std::shared_ptr<const ExemplarPatch>& patch, const cGZPersistResourceKey& target)
+{
+	uint32_t node = firstFreeNode;
+
+	if (node != NoNode)
+	{
+		firstFreeNode = nodes[node].nextPatchNode;
+	}
+	else
+	{
+		node = static_cast<uint32_t>(nodes.size());
+		nodes.emplace_back();
+	}
+
+	// The new node becomes the first node of the patch.
+	const auto result = patchNodes.try_emplace(patch.get(), node);
+
+	PatchNode& patchNode = nodes[node];
+	patchNode.patch = patch;
+	patchNode.target = target;
+	patchNode.previous = NoNode;
+	patchNode.next = NoNode;
+	patchNode.nextPatchNode = NoNode;
+
+	if (!result.second)
+	{
+		patchNode.nextPatchNode = result.first->second;
+		result.first->second = node;
+	}
+
+	return node;
+}
+
+void ExemplarPatchIndex::LinkNode(PatchListHead& head, uint32_t node, uint32_t previous)
+{
+	PatchNode& patchNode = nodes[node];
+	const uint32_t next = previous != NoNode ? nodes[previous].next : head.first;
+
+	patchNode.previous = previous;
+	patchNode.next = next;
+
+	if (previous != NoNode)
+	{
+		nodes[previous].next = node;
+	}
+	else
+	{
+		head.first = node;
+	}
+
+	if (next != NoNode)
+	{
+		nodes[next].previous = node;
+	}
+	else
+	{
+		head.last = node;
+	}
+
+	head.count++;
+}
@@ -0,0 +1,284 @@
+/*
+ * This file is part of sc4-resource-loading-hooks, a DLL Plugin for SimCity 4
+ * that allows other DLLs to modify resources as the game loads them.
+ *
+ * Copyright (C) 2024, 2025 Nicholas Hayes
+ *
+ * sc4-resource-loading-hooks is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * sc4-resource-loading-hooks is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with sc4-resource-loading-hooks.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#include "cGZPersistResourceKey.h"
+#include "ExemplarPatch.h"
+#include "ExemplarPatchRangeIndex.h"
+#include "ExemplarPatchSourceIndex.h"
+#include "ExemplarPatchTypeIndex.h"
+#include "PersistResourceKeyBoostHash.h"
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <span>
+#include <utility>
+#include <vector>
+
+#include "boost/unordered/unordered_flat_map.hpp"
+
+// Maps the exemplar TGIs to the exemplar patches that target them.
+// The patches for each target are stored in load order.
+// The patches that target a range of instance IDs or an exemplar type are stored
+// in separate indices.
+//
+// The patch lists are linked lists in a shared node array. The nodes of each patch
+// are also linked together, that allows a patch to be removed from all of its targets
+// without searching the target lists.
+class ExemplarPatchIndex
+{
+	static constexpr uint32_t NoNode = UINT32_MAX;
+
+	struct PatchNode
+	{
+		std::shared_ptr<const ExemplarPatch> patch;
+		cGZPersistResourceKey target;
+		uint32_t previous;
+		uint32_t next;
+		// The next node of the same patch, or the next free node.
+		uint32_t nextPatchNode;
+	};
+
+	struct PatchListHead
+	{
+		uint32_t first;
+		uint32_t last;
+		uint32_t count;
+	};
+
+public:
+
+	// The patches for a target exemplar in load order.
+	// The list is invalidated when the index is modified.
+	class PatchList
+	{
+	public:
+
+		class Iterator
+		{
+		public:
+
+			using iterator_category = std::forward_iterator_tag;
+			using value_type = std::shared_ptr<const ExemplarPatch>;
+			using difference_type = std::ptrdiff_t;
+			using pointer = const value_type*;
+			using reference = const value_type&;
+
+			Iterator(const PatchNode* nodes, uint32_t node)
+				: nodes(nodes), node(node)
+			{
+			}
+
+			reference operator*() const
+			{
+				return nodes[node].patch;
+			}
+
+			pointer operator->() const
+			{
+				return &nodes[node].patch;
+			}
+
+			Iterator& operator++()
+			{
+				node = nodes[node].next;
+				return *this;
+			}
+
+			Iterator operator++(int)
+			{
+				Iterator previous = *this;
+				node = nodes[node].next;
+				return previous;
+			}
+
+			bool operator==(const Iterator& other) const
+			{
+				return node == other.node;
+			}
+
+		private:
+
+			const PatchNode* nodes;
+			uint32_t node;
+		};
+
+		PatchList()
+			: nodes(nullptr), first(NoNode), count(0)
+		{
+		}
+
+		PatchList(const PatchNode* nodes, const PatchListHead& head)
+			: nodes(nodes), first(head.first), count(head.count)
+		{
+		}
+
+		Iterator begin() const
+		{
+			return Iterator(nodes, first);
+		}
+
+		Iterator end() const
+		{
+			return Iterator(nodes, NoNode);
+		}
+
+		size_t size() const
+		{
+			return count;
+		}
+
+		bool empty() const
+		{
+			return count == 0;
+		}
+
+	private:
+
+		const PatchNode* nodes;
+		uint32_t first;
+		uint32_t count;
+	};
+
+	ExemplarPatchIndex();
+
+	// Adds the patch to each exemplar in a list of group and instance ID pairs.
+	void AddPatch(
+		const std::shared_ptr<const ExemplarPatch>& patch,
+		const uint32_t* groupAndInstanceIDs,
+		uint32_t valueCount);
+
+	// Adds the patch to the end of the patch list for the target exemplar.
+	void AddPatch(const std::shared_ptr<const ExemplarPatch>& patch, const cGZPersistResourceKey& target);
+
+	// Inserts the patch into the patch list for the target exemplar, before the patches
+	// that the predicate reports as loaded after it.
+	// The list is searched from the end, so adding a patch that loads last is cheap.
+	template<typename IsLoadedAfter>
+	void InsertPatch(
+		const std::shared_ptr<const ExemplarPatch>& patch,
+		const cGZPersistResourceKey& target,
+		IsLoadedAfter&& isLoadedAfter)
+	{
+		PatchListHead& head = GetOrAddPatchList(target);
+
+		uint32_t previous = head.last;
+
+		while (previous != NoNode && isLoadedAfter(nodes[previous].patch.get()))
+		{
+			previous = nodes[previous].previous;
+		}
+
+		LinkNode(head, AllocateNode(patch, target), previous);
+	}
+
+	// Removes the patch from all of its target exemplars.
+	// The targets are removed when they have no patches left.
+	void RemovePatch(const ExemplarPatch* patch);
+
+	// The reverse index from the exemplar patches to their targets.
+	const ExemplarPatchSourceIndex& GetSources() const;
+
+	void SetSources(ExemplarPatchSourceIndex&& sources);
+
+	// The patches that target a range of exemplar instance IDs.
+	const ExemplarPatchRangeIndex& GetRanges() const;
+
+	// The range index must have been built.
+	void SetRanges(ExemplarPatchRangeIndex&& ranges);
+
+	// The patches that target the exemplars of a type which match a condition.
+	const ExemplarPatchTypeIndex& GetTypeTargets() const;
+
+	void SetTypeTargets(ExemplarPatchTypeIndex&& typeTargets);
+
+	// Sets the load order position of every active patch.
+	// The positions are used to apply the patches from the target lists and the
+	// range and type indices in a single load order.
+	void SetLoadOrder(boost::unordered_flat_map<const ExemplarPatch*, uint32_t>&& loadOrder);
+
+	// Sorts the patches by their load order position and removes the duplicates,
+	// a patch can target an exemplar both directly and through a range or type.
+	void SortByLoadOrder(std::vector<const ExemplarPatch*>& patches) const;
+
+	// Returns the patches that target the exemplar, the list is empty if the
+	// exemplar is not patched.
+	// The range and type indices are not searched.
+	PatchList Find(const cGZPersistResourceKey& key) const;
+
+	// The number of target exemplars, including the cold targets.
+	size_t GetTargetCount() const;
+
+	// Calls the callback with every target exemplar TGI and its patch list,
+	// including the cold targets.
+	template<typename Callback>
+	void EnumTargets(Callback&& callback) const
+	{
+		for (const auto& item : patches)
+		{
+			callback(item.first, PatchList(nodes.data(), item.second));
+		}
+
+		for (const auto& item : coldTargets)
+		{
+			callback(item.first, PatchList(nodes.data(), item.second));
+		}
+	}
+
+	// Moves the targets that are not in the available target list to the cold list.
+	// Find does not search the cold list.
+	// Returns the number of targets that were moved.
+	size_t PruneTargets(std::span<const cGZPersistResourceKey> availableTargets);
+
+	// Moves the cold targets back to the index, this must be done before
+	// the index is modified.
+	void RestoreColdTargets();
+
+	size_t GetColdTargetCount() const;
+
+	// Gets the size of the target lookup table in bytes.
+	// The patch lists are not included, the cold targets keep their patch list nodes.
+	size_t GetLookupTableSize() const;
+
+	void Clear();
+
+private:
+
+	PatchListHead& GetOrAddPatchList(const cGZPersistResourceKey& target);
+
+	uint32_t AllocateNode(const std::shared_ptr<const ExemplarPatch>& patch, const cGZPersistResourceKey& target);
+
+	// Links the node into the list after the previous node, or at the start
+	// of the list if the previous node is NoNode.
+	void LinkNode(PatchListHead& head, uint32_t node, uint32_t previous);
+
+	boost::unordered_flat_map<const cGZPersistResourceKey, PatchListHead> patches;
+	std::vector<std::pair<cGZPersistResourceKey, PatchListHead>> coldTargets;
+	std::vector<PatchNode> nodes;
+	uint32_t firstFreeNode;
+	// The first node of each patch.
+	boost::unordered_flat_map<const ExemplarPatch*, uint32_t> patchNodes;
+	ExemplarPatchSourceIndex sources;
+	ExemplarPatchRangeIndex ranges;
+	ExemplarPatchTypeIndex typeTargets;
+	boost::unordered_flat_map<const ExemplarPatch*, uint32_t> loadOrder;
+};
@@ -0,0 +1,226 @@
+/*
+ * This file is part of sc4-resource-loading-hooks, a DLL Plugin for SimCity 4
+ * that allows other DLLs to modify resources as the game loads them.
+ *
+ * Copyright (C) 2024, 2025 Nicholas Hayes
+ *
+ * sc4-resource-loading-hooks is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * sc4-resource-loading-hooks is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with sc4-resource-loading-hooks.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ExemplarPatchRangeIndex.h"
+#include <algorithm>
+
+static constexpr uint32_t kExemplarTypeId = 0x6534284a;
+
+ExemplarPatchRangeIndex::ExemplarPatchRangeIndex()
+	: patches(),
+	  pendingRanges(),
+	  groups(),
+	  segmentPatches(),
+	  rangeCount(0)
+{
+}
+
+void ExemplarPatchRangeIndex::AddPatch(
+	const std::shared_ptr<const ExemplarPatch>& patch,
+	std::span<const ExemplarPatchTargetRange> ranges)
+{
+	if (ranges.empty())
+	{
+		return;
+	}
+
+	const uint32_t patchIndex = static_cast<uint32_t>(patches.size());
+
+	patches.push_back(PatchRanges{ patch, std::vector<ExemplarPatchTargetRange>(ranges.begin(), ranges.end()) });
+
+	for (const ExemplarPatchTargetRange& range : ranges)
+	{
+		pendingRanges[range.group].push_back(GroupRange{ range.firstInstance, range.lastInstance, patchIndex });
+	}
+
+	rangeCount += ranges.size();
+}
+
+void ExemplarPatchRangeIndex::Build()
+{
+	// A range starts covering the instance IDs at its first instance ID, and stops
+	// after its last instance ID. The end positions can be 2^32.
+	struct Boundary
+	{
+		uint64_t position;
+		uint32_t patchIndex;
+		bool isStart;
+	};
+
+	std::vector<Boundary> boundaries;
+	// The number of ranges of each active patch that cover the current position,
+	// sorted by the patch index.
+	std::vector<std::pair<uint32_t, uint32_t>> activePatches;
+
+	for (auto& item : pendingRanges)
+	{
+		boundaries.clear();
+		boundaries.reserve(item.second.size() * 2);
+
+		for (const GroupRange& range : item.second)
+		{
+			boundaries.push_back(Boundary{ range.firstInstance, range.patchIndex, true });
+			boundaries.push_back(Boundary{ static_cast<uint64_t>(range.lastInstance) + 1, range.patchIndex, false });
+		}
+
+		std::sort(
+			boundaries.begin(),
+			boundaries.end(),
+			[](const Boundary& lhs, const Boundary& rhs)
+			{
+				return lhs.position < rhs.position;
+			});
+
+		std::vector<GroupSegment>& segments = groups[item.first];
+		segments.clear();
+
+		for (size_t i = 0; i < boundaries.size();)
+		{
+			const uint64_t position = boundaries[i].position;
+
+			for (; i < boundaries.size() && boundaries[i].position == position; i++)
+			{
+				const Boundary& boundary = boundaries[i];
+
+				auto active = std::lower_bound(
+					activePatches.begin(),
+					activePatches.end(),
+					boundary.patchIndex,
+					[](const std::pair<uint32_t, uint32_t>& lhs, uint32_t patchIndex)
+					{
+						return lhs.first < patchIndex;
+					});
+
+				if (boundary.isStart)
+				{
+					if (active != activePatches.end() && active->first == boundary.patchIndex)
+					{
+						active->second++;
+					}
+					else
+					{
+						activePatches.emplace(active, boundary.patchIndex, 1);
+					}
+				}
+				else if (--active->second == 0)
+				{
+					activePatches.erase(active);
+				}
+			}
+
+			if (!activePatches.empty())
+			{
+				// The segment ends before the next boundary, the active ranges always
+				// end at a later boundary.
+				const uint64_t nextPosition = boundaries[i].position;
+
+				segments.push_back(GroupSegment
+				{
+					static_cast<uint32_t>(position),
+					static_cast<uint32_t>(nextPosition - 1),
+					static_cast<uint32_t>(segmentPatches.size()),
+					static_cast<uint32_t>(activePatches.size())
+				});
+
+				for (const auto& active : activePatches)
+				{
+					segmentPatches.push_back(active.first);
+				}
+			}
+		}
+
+		segments.shrink_to_fit();
+	}
+
+	pendingRanges.clear();
+	segmentPatches.shrink_to_fit();
+}
+
+bool ExemplarPatchRangeIndex::Find(const cGZPersistResourceKey& key, std::vector<const ExemplarPatch*>& result) const
+{
+	if (key.type != kExemplarTypeId)
+	{
+		return false;
+	}
+
+	const auto item = groups.find(key.group);
+
+	if (item == groups.end())
+	{
+		return false;
+	}
+
+	const std::vector<GroupSegment>& segments = item->second;
+	const uint32_t instance = key.instance;
+
+	// The segments after this position start after the instance ID.
+	auto position = std::upper_bound(
+		segments.begin(),
+		segments.end(),
+		instance,
+		[](uint32_t value, const GroupSegment& segment)
+		{
+			return value < segment.firstInstance;
+		});
+
+	if (position == segments.begin())
+	{
+		return false;
+	}
+
+	--position;
+
+	if (position->lastInstance < instance)
+	{
+		return false;
+	}
+
+	for (uint32_t i = 0; i < position->patchCount; i++)
+	{
+		result.push_back(patches[segmentPatches[position->firstPatch + i]].patch.get());
+	}
+
+	return true;
+}
+
+bool ExemplarPatchRangeIndex::HasGroup(uint32_t group) const
+{
+	return groups.find(group) != groups.end();
+}
+
+bool ExemplarPatchRangeIndex::Empty() const
+{
+	return patches.empty();
+}
+
+size_t ExemplarPatchRangeIndex::GetRangeCount() const
+{
+	return rangeCount;
+}
+
+void ExemplarPatchRangeIndex::Clear()
+{
+	patches.clear();
+	pendingRanges.clear();
+	groups.clear();
+	segmentPatches.clear();
+	rangeCount = 0;
+}
@@ -0,0 +1,115 @@
+/*
+ * This file is part of sc4-resource-loading-hooks, a DLL Plugin for SimCity 4
+ * that allows other DLLs to modify resources as the game loads them.
+ *
+ * Copyright (C) 2024, 2025 Nicholas Hayes
+ *
+ * sc4-resource-loading-hooks is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * sc4-resource-loading-hooks is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with sc4-resource-loading-hooks.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#include "cGZPersistResourceKey.h"
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <vector>
+
+#include "boost/unordered/unordered_flat_map.hpp"
+
+class ExemplarPatch;
+
+// A range of exemplar instance IDs in a group, the first and last instance IDs are inclusive.
+struct ExemplarPatchTargetRange
+{
+	uint32_t group;
+	uint32_t firstInstance;
+	uint32_t lastInstance;
+};
+
+// Maps the exemplar groups to the exemplar patches that target a range of
+// instance IDs in that group.
+// Build splits the overlapping ranges of each group into disjoint segments, and
+// every segment stores the patches that cover it in load order. A lookup is a
+// hash table probe followed by a binary search, regardless of how the ranges overlap.
+class ExemplarPatchRangeIndex
+{
+public:
+
+	ExemplarPatchRangeIndex();
+
+	// Adds the patch and its target ranges, the patches must be added in load order.
+	// Build must be called after the patches have been added.
+	void AddPatch(const std::shared_ptr<const ExemplarPatch>& patch, std::span<const ExemplarPatchTargetRange> ranges);
+
+	// Splits the ranges of each group into disjoint segments.
+	void Build();
+
+	// Appends the patches that have a range containing the exemplar to the list, in load order.
+	// Returns false if no range contains the exemplar.
+	bool Find(const cGZPersistResourceKey& key, std::vector<const ExemplarPatch*>& result) const;
+
+	// Returns true if a patch has a range in the exemplar's group.
+	bool HasGroup(uint32_t group) const;
+
+	bool Empty() const;
+
+	size_t GetRangeCount() const;
+
+	// Calls the callback with every patch and its target ranges, in load order.
+	template<typename Callback>
+	void EnumPatches(Callback&& callback) const
+	{
+		for (const PatchRanges& item : patches)
+		{
+			callback(item.patch, std::span<const ExemplarPatchTargetRange>(item.ranges));
+		}
+	}
+
+	void Clear();
+
+private:
+
+	struct PatchRanges
+	{
+		std::shared_ptr<const ExemplarPatch> patch;
+		std::vector<ExemplarPatchTargetRange> ranges;
+	};
+
+	struct GroupRange
+	{
+		uint32_t firstInstance;
+		uint32_t lastInstance;
+		// The index of the patch in the load order list.
+		uint32_t patchIndex;
+	};
+
+	// A range of instance IDs that is covered by the same patches.
+	struct GroupSegment
+	{
+		uint32_t firstInstance;
+		uint32_t lastInstance;
+		// The patch indices of the segment in the segment patch list, in load order.
+		uint32_t firstPatch;
+		uint32_t patchCount;
+	};
+
+	std::vector<PatchRanges> patches;
+	// The ranges that were added since the last build.
+	boost::unordered_flat_map<uint32_t, std::vector<GroupRange>> pendingRanges;
+	// The segments of each group, sorted by their first instance ID.
+	boost::unordered_flat_map<uint32_t, std::vector<GroupSegment>> groups;
+	std::vector<uint32_t> segmentPatches;
+	size_t rangeCount;
+};
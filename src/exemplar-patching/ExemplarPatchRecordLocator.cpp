@@ -0,0 +1,294 @@
+/*
+ * This file is part of sc4-resource-loading-hooks, a DLL Plugin for SimCity 4
+ * that allows other DLLs to modify resources as the game loads them.
+ *
+ * Copyright (C) 2024, 2025 Nicholas Hayes
+ *
+ * sc4-resource-loading-hooks is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * sc4-resource-loading-hooks is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with sc4-resource-loading-hooks.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ExemplarPatchRecordLocator.h"
+#include "cIGZPersistResourceManager.h"
+#include "cIGZPersistResourceKeyList.h"
+#include "cRZAutoRefCount.h"
+#include "cRZBaseString.h"
+#include "PersistResourceUtil.h"
+#include "PersistResourceKeyFilterByTypeAndGroup.h"
+#include <filesystem>
+
+#include "boost/unordered/unordered_flat_map.hpp"
+
+namespace
+{
+	static constexpr uint32_t kCohortTypeId = 0x05342861;
+	static constexpr uint32_t kExemplarPatchGroupId = 0xb03697d1;  // GID of Cohort files
+
+	// A 64-bit FNV-1a hash, the fingerprint must be stable between runs.
+	class FingerprintHash
+	{
+	public:
+
+		void Add(const void* data, size_t size)
+		{
+			const uint8_t* bytes = static_cast<const uint8_t*>(data);
+
+			for (size_t i = 0; i < size; i++)
+			{
+				value = (value ^ bytes[i]) * 0x100000001b3ULL;
+			}
+		}
+
+		template<typename T>
+		void Add(T item)
+		{
+			Add(&item, sizeof(item));
+		}
+
+		uint64_t GetValue() const
+		{
+			return value;
+		}
+
+	private:
+
+		uint64_t value = 0xcbf29ce484222325ULL;
+	};
+}
+
+ExemplarPatchRecordLocator::ExemplarPatchRecordLocator(cIGZPersistResourceManager* pResMan)
+	: pResMan(pResMan),
+	  records(),
+	  recordFileIndices(),
+	  filePaths(),
+	  fileStamps(),
+	  validFileStamps(),
+	  files()
+{
+}
+
+bool ExemplarPatchRecordLocator::Locate()
+{
+	records.clear();
+	recordFileIndices.clear();
+	filePaths.clear();
+	fileStamps.clear();
+	validFileStamps.clear();
+	files.clear();
+
+	if (!pResMan)
+	{
+		return false;
+	}
+
+	cRZAutoRefCount<cIGZPersistResourceKeyList> pResourceList;
+
+	PersistResourceKeyFilterByTypeAndGroup* filter = new PersistResourceKeyFilterByTypeAndGroup(kCohortTypeId, kExemplarPatchGroupId);
+	filter->AddRef();
+	pResMan->GetAvailableResourceList(pResourceList.AsPPObj(), filter);
+	filter->Release();
+
+	if (!pResourceList || pResourceList->Size() == 0)
+	{
+		return false;
+	}
+
+	records.reserve(pResourceList->Size());
+	pResourceList->EnumKeys(EnumKeysCallback, this);
+
+	// Group the records by the file that the game will load them from, so that
+	// every index table is only read once.
+	boost::unordered_flat_map<std::string, size_t> fileIndexByPath;
+
+	recordFileIndices.reserve(records.size());
+
+	for (const Record& record : records)
+	{
+		cRZBaseString path;
+		size_t fileIndex = NoFile;
+
+		if (PersistResourceUtil::GetResourceFilePath(pResMan, record.key, path))
+		{
+			auto result = fileIndexByPath.try_emplace(std::string(path.ToChar(), path.Strlen()), filePaths.size());
+
+			if (result.second)
+			{
+				filePaths.push_back(result.first->first);
+			}
+
+			fileIndex = result.first->second;
+		}
+
+		recordFileIndices.push_back(fileIndex);
+	}
+
+	fileStamps.resize(filePaths.size());
+	validFileStamps.resize(filePaths.size());
+
+	for (size_t i = 0; i < filePaths.size(); i++)
+	{
+		std::error_code ec;
+		const std::filesystem::path filePath(filePaths[i]);
+
+		const uintmax_t size = std::filesystem::file_size(filePath, ec);
+
+		if (!ec)
+		{
+			const auto lastWriteTime = std::filesystem::last_write_time(filePath, ec);
+
+			if (!ec)
+			{
+				fileStamps[i] = FileStamp{ static_cast<uint64_t>(size), static_cast<int64_t>(lastWriteTime.time_since_epoch().count()) };
+				validFileStamps[i] = true;
+			}
+		}
+	}
+
+	return true;
+}
+
+void ExemplarPatchRecordLocator::ReadRecordLocations()
+{
+	ReadRecordLocations(std::vector<bool>(filePaths.size(), true));
+}
+
+void ExemplarPatchRecordLocator::ReadRecordLocations(const std::vector<bool>& fileFilter)
+{
+	files.clear();
+	files.resize(filePaths.size());
+
+	std::vector<std::vector<size_t>> recordIndicesByFile(filePaths.size());
+
+	for (size_t i = 0; i < records.size(); i++)
+	{
+		if (recordFileIndices[i] != NoFile && fileFilter[recordFileIndices[i]])
+		{
+			recordIndicesByFile[recordFileIndices[i]].push_back(i);
+		}
+	}
+
+	for (size_t i = 0; i < filePaths.size(); i++)
+	{
+		if (fileFilter[i])
+		{
+			ReadFileIndex(i, recordIndicesByFile[i]);
+		}
+	}
+}
+
+bool ExemplarPatchRecordLocator::TryGetFingerprint(uint64_t& fingerprint) const
+{
+	FingerprintHash hash;
+
+	for (size_t i = 0; i < records.size(); i++)
+	{
+		const cGZPersistResourceKey& key = records[i].key;
+		const size_t fileIndex = recordFileIndices[i];
+
+		if (fileIndex == NoFile)
+		{
+			return false;
+		}
+
+		hash.Add(key.type);
+		hash.Add(key.group);
+		hash.Add(key.instance);
+		hash.Add(static_cast<uint64_t>(fileIndex));
+	}
+
+	for (size_t i = 0; i < filePaths.size(); i++)
+	{
+		if (!validFileStamps[i])
+		{
+			return false;
+		}
+
+		const std::string& path = filePaths[i];
+
+		hash.Add(path.data(), path.size());
+		hash.Add(fileStamps[i].size);
+		hash.Add(fileStamps[i].lastWriteTime);
+	}
+
+	fingerprint = hash.GetValue();
+	return true;
+}
+
+const std::vector<ExemplarPatchRecordLocator::Record>& ExemplarPatchRecordLocator::GetRecords() const
+{
+	return records;
+}
+
+size_t ExemplarPatchRecordLocator::GetRecordFileIndex(size_t recordIndex) const
+{
+	return recordFileIndices[recordIndex];
+}
+
+size_t ExemplarPatchRecordLocator::GetFileCount() const
+{
+	return filePaths.size();
+}
+
+const std::string& ExemplarPatchRecordLocator::GetFilePath(size_t fileIndex) const
+{
+	return filePaths[fileIndex];
+}
+
+bool ExemplarPatchRecordLocator::TryGetFileStamp(size_t fileIndex, FileStamp& stamp) const
+{
+	stamp = fileStamps[fileIndex];
+	return validFileStamps[fileIndex];
+}
+
+void ExemplarPatchRecordLocator::EnumKeysCallback(const cGZPersistResourceKey& key, void* pContext)
+{
+	static_cast<ExemplarPatchRecordLocator*>(pContext)->records.push_back(Record{ key, nullptr, {} });
+}
+
+void ExemplarPatchRecordLocator::ReadFileIndex(size_t fileIndex, const std::vector<size_t>& recordIndices)
+{
+	std::unique_ptr<DBPFFile> file = std::make_unique<DBPFFile>();
+
+	if (!file->Open(std::filesystem::path(filePaths[fileIndex])))
+	{
+		return;
+	}
+
+	boost::unordered_flat_map<const cGZPersistResourceKey, size_t> recordIndexByKey;
+	recordIndexByKey.reserve(recordIndices.size());
+
+	for (size_t index : recordIndices)
+	{
+		recordIndexByKey.emplace(records[index].key, index);
+	}
+
+	const DBPFFile* pFile = file.get();
+
+	pFile->FindIndexEntries(
+		kCohortTypeId,
+		kExemplarPatchGroupId,
+		[&](const DBPFFile::IndexEntry& entry)
+		{
+			auto it = recordIndexByKey.find(entry.key);
+
+			if (it != recordIndexByKey.end())
+			{
+				Record& record = records[it->second];
+				record.file = pFile;
+				record.entry = entry;
+			}
+		});
+
+	files[fileIndex] = std::move(file);
+}
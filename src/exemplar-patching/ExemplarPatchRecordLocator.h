@@ -0,0 +1,112 @@
+/*
+ * This file is part of sc4-resource-loading-hooks, a DLL Plugin for SimCity 4
+ * that allows other DLLs to modify resources as the game loads them.
+ *
+ * Copyright (C) 2024, 2025 Nicholas Hayes
+ *
+ * sc4-resource-loading-hooks is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * sc4-resource-loading-hooks is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with sc4-resource-loading-hooks.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#include "cGZPersistResourceKey.h"
+#include "DBPFFile.h"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+class cIGZPersistResourceManager;
+
+// Locates the exemplar patch cohort records in the DBPF files that provide them.
+//
+// The game's filtered resource key list is still used to decide which records
+// are active, that keeps the game's plugin load order and override rules intact.
+// Each file that provides an active record is memory mapped once and its index
+// table is read sequentially to find the record locations.
+//
+// Locating the records is split in two steps, resolving the files that provide
+// the records is cheap enough to be used for the exemplar patch bundle fingerprint.
+class ExemplarPatchRecordLocator
+{
+public:
+
+	struct Record
+	{
+		cGZPersistResourceKey key;
+		// The file and index entry are null if the record could not be located,
+		// e.g. when the segment is not a DBPF file on disk.
+		const DBPFFile* file;
+		DBPFFile::IndexEntry entry;
+	};
+
+	// The size and modification time of a file, used to detect changed files.
+	struct FileStamp
+	{
+		uint64_t size;
+		int64_t lastWriteTime;
+
+		bool operator==(const FileStamp& other) const = default;
+	};
+
+	static constexpr size_t NoFile = SIZE_MAX;
+
+	explicit ExemplarPatchRecordLocator(cIGZPersistResourceManager* pResMan);
+
+	// Gets the exemplar patch keys and the files that provide them.
+	// Returns false if the resource manager does not contain any exemplar patches.
+	bool Locate();
+
+	// Reads the index tables of the files to find the record locations.
+	void ReadRecordLocations();
+
+	// Reads the index tables of the files that are selected in the filter, which is indexed
+	// by file index. The records in the other files are not located.
+	void ReadRecordLocations(const std::vector<bool>& fileFilter);
+
+	// Computes a fingerprint of the exemplar patch keys, their load order and the
+	// size and modification time of the files that provide them.
+	// Returns false if a record is not provided by a file on disk.
+	bool TryGetFingerprint(uint64_t& fingerprint) const;
+
+	// The records are returned in the same order as the game's resource key list.
+	const std::vector<Record>& GetRecords() const;
+
+	// Returns the index of the file that provides the record, or NoFile.
+	size_t GetRecordFileIndex(size_t recordIndex) const;
+
+	size_t GetFileCount() const;
+
+	const std::string& GetFilePath(size_t fileIndex) const;
+
+	// Returns false if the file could not be queried.
+	bool TryGetFileStamp(size_t fileIndex, FileStamp& stamp) const;
+
+private:
+
+	static void EnumKeysCallback(const cGZPersistResourceKey& key, void* pContext);
+
+	void ReadFileIndex(size_t fileIndex, const std::vector<size_t>& recordIndices);
+
+	cIGZPersistResourceManager* pResMan;
+	std::vector<Record> records;
+	// The index of the file that provides each record, or NoFile.
+	std::vector<size_t> recordFileIndices;
+	// The files are stored in the order that they are first referenced.
+	std::vector<std::string> filePaths;
+	// The stamp of each file, queried once when the files are located.
+	std::vector<FileStamp> fileStamps;
+	std::vector<bool> validFileStamps;
+	std::vector<std::unique_ptr<DBPFFile>> files;
+};
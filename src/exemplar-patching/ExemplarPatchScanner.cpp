@@ -0,0 +1,1098 @@
+/*
+ * This file is part of sc4-resource-loading-hooks, a DLL Plugin for SimCity 4
+ * that allows other DLLs to modify resources as the game loads them.
+ *
+ * Copyright (C) 2024, 2025 Nicholas Hayes
+ *
+ * sc4-resource-loading-hooks is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * sc4-resource-loading-hooks is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with sc4-resource-loading-hooks.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ExemplarPatchScanner.h"
+#include "cIGZPersistResourceKeyList.h"
+#include "cIGZPersistResourceManager.h"
+#include "cIGZVariant.h"
+#include "cISCProperty.h"
+#include "cISCResExemplarCohort.h"
+#include "cRZBaseString.h"
+#include "ExemplarBinaryParser.h"
+#include "ExemplarPatchBaker.h"
+#include "ExemplarPatchBundle.h"
+#include "Logger.h"
+#include "PersistResourceKeyFilterBase.h"
+#include "PersistResourceUtil.h"
+#include <cstring>
+#include <string>
+
+#include "boost/unordered/unordered_flat_set.hpp"
+
+namespace
+{
+	static constexpr uint32_t kExemplarTypeId = 0x6534284a;
+	static constexpr uint32_t kExemplarPatchTargetPropertyId = 0x0062e78a;
+	static constexpr uint32_t kExemplarPatchTargetRangesPropertyId = 0x0062e78b;
+	static constexpr uint32_t kExemplarPatchTypeTargetsPropertyId = 0x0062e78c;
+
+	// Includes the exemplars that are targeted by an exemplar patch.
+	class PatchTargetFilter : public PersistResourceKeyFilterBase
+	{
+	public:
+
+		explicit PatchTargetFilter(const ExemplarPatchIndex& index)
+			: index(index)
+		{
+		}
+
+		bool IsKeyIncluded(cGZPersistResourceKey const& key) override
+		{
+			return key.type == kExemplarTypeId && !index.Find(key).empty();
+		}
+
+	private:
+
+		const ExemplarPatchIndex& index;
+	};
+
+	void AddAvailableTargetCallback(const cGZPersistResourceKey& key, void* pContext)
+	{
+		static_cast<std::vector<cGZPersistResourceKey>*>(pContext)->push_back(key);
+	}
+
+	uint32_t ToSourceFileIndex(size_t locatorFileIndex)
+	{
+		return locatorFileIndex != ExemplarPatchRecordLocator::NoFile
+			? static_cast<uint32_t>(locatorFileIndex)
+			: ExemplarPatchSourceIndex::NoFile;
+	}
+
+	void LogExemplarPatchScanError(const char* message, const ExemplarPatchRecordLocator::Record& record)
+	{
+		Logger& logger = Logger::GetInstance();
+
+		const cGZPersistResourceKey& key = record.key;
+		std::string path;
+
+		if (record.file)
+		{
+			// The native parser runs on the scan thread, which must not use the resource manager.
+			path = record.file->GetPath().string();
+		}
+		else
+		{
+			cRZBaseString segmentPath;
+
+			if (PersistResourceUtil::GetResourceFilePath(key, segmentPath))
+			{
+				path.assign(segmentPath.ToChar(), segmentPath.Strlen());
+			}
+		}
+
+		if (!path.empty())
+		{
+			logger.WriteLineFormatted(LogLevel::Error,
+				"%s: T:0x%08X G:0x%08X I:0x%08X in %s",
+				message,
+				key.type,
+				key.group,
+				key.instance,
+				path.c_str());
+		}
+		else
+		{
+			logger.WriteLineFormatted(LogLevel::Error,
+				"%s: T:0x%08X G:0x%08X I:0x%08X.",
+				message,
+				key.type,
+				key.group,
+				key.instance);
+		}
+	}
+
+	// The target list is a list of group and instance ID pairs.
+	bool IsValidTargetList(
+		bool isUint32Array,
+		const uint32_t* values,
+		uint32_t valueCount,
+		const ExemplarPatchRecordLocator::Record& record)
+	{
+		if (!isUint32Array)
+		{
+			LogExemplarPatchScanError(
+				"Exemplar Patch Target property requires type Uint32Array",
+				record);
+			return false;
+		}
+		else if ((valueCount % 2) != 0)
+		{
+			LogExemplarPatchScanError(
+				"Exemplar Patch Target property requires even number of values",
+				record);
+			return false;
+		}
+
+		return true;
+	}
+
+	// The target range list is a list of group, first instance and last instance ID triples.
+	bool IsValidTargetRangeList(
+		bool isUint32Array,
+		const uint32_t* values,
+		uint32_t valueCount,
+		const ExemplarPatchRecordLocator::Record& record)
+	{
+		if (!isUint32Array)
+		{
+			LogExemplarPatchScanError(
+				"Exemplar Patch Target Ranges property requires type Uint32Array",
+				record);
+			return false;
+		}
+		else if ((valueCount % 3) != 0)
+		{
+			LogExemplarPatchScanError(
+				"Exemplar Patch Target Ranges property requires a multiple of 3 values",
+				record);
+			return false;
+		}
+
+		for (uint32_t i = 2; i < valueCount; i += 3)
+		{
+			if (values[i - 1] > values[i])
+			{
+				LogExemplarPatchScanError(
+					"Exemplar Patch Target Ranges property has a first instance ID that is greater than the last instance ID",
+					record);
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	// The type target list is a list of exemplar type, condition property ID and condition value triples.
+	bool IsValidTypeTargetList(
+		bool isUint32Array,
+		const uint32_t* values,
+		uint32_t valueCount,
+		const ExemplarPatchRecordLocator::Record& record)
+	{
+		if (!isUint32Array)
+		{
+			LogExemplarPatchScanError(
+				"Exemplar Patch Type Targets property requires type Uint32Array",
+				record);
+			return false;
+		}
+		else if ((valueCount % 3) != 0)
+		{
+			LogExemplarPatchScanError(
+				"Exemplar Patch Type Targets property requires a multiple of 3 values",
+				record);
+			return false;
+		}
+
+		return true;
+	}
+}
+
+ExemplarPatchScanner::ExemplarPatchScanner(cIGZPersistResourceManager* pResMan, bool debugLoggingEnabled)
+	: pResMan(pResMan),
+	  bundlePath(),
+	  installedBakedFilePath(),
+	  scannedFiles(),
+	  activePatches(),
+	  currentPatch(),
+	  loadedExemplarPatchCount(0),
+	  fingerprint(0),
+	  hasFingerprint(false),
+	  useBakedFile(false),
+	  usedBakedFile(false),
+	  scanned(false),
+	  pruneUnavailableTargets(false),
+	  debugLoggingEnabled(debugLoggingEnabled),
+	  recordBuffer(),
+	  textParser(),
+	  propertyFactory(),
+	  targetBuffer(),
+	  targetRangeBuffer(),
+	  typeTargetBuffer()
+{
+}
+
+void ExemplarPatchScanner::SetBundlePath(const std::filesystem::path& path)
+{
+	bundlePath = path;
+}
+
+void ExemplarPatchScanner::SetUseBakedFile(bool value)
+{
+	useBakedFile = value;
+}
+
+void ExemplarPatchScanner::SetPruneUnavailableTargets(bool value)
+{
+	pruneUnavailableTargets = value;
+}
+
+bool ExemplarPatchScanner::Scan(ExemplarPatchIndex& index)
+{
+	BeginScan();
+	ReadFiles();
+	LoadGamePatches();
+
+	return EndScan(index);
+}
+
+void ExemplarPatchScanner::BeginScan()
+{
+	pending = PendingScan();
+	pending.locator = std::make_unique<ExemplarPatchRecordLocator>(pResMan);
+
+	if (!scanned && pResMan)
+	{
+		// The baked file can be installed anywhere in the plugins, the game's
+		// copy of its fingerprint record tells where it was loaded from.
+		cRZBaseString path;
+
+		if (PersistResourceUtil::GetResourceFilePath(pResMan, ExemplarPatchBaker::FingerprintRecordKey, path))
+		{
+			installedBakedFilePath = std::filesystem::path(std::string(path.ToChar(), path.Strlen()));
+		}
+	}
+
+	if (!pResMan || !pending.locator->Locate())
+	{
+		// A baked file is stale when all of the exemplar patches were removed.
+		pending.staleBakedFile = !scanned && !installedBakedFilePath.empty();
+		pending.kind = ScanKind::NoPatches;
+		return;
+	}
+
+	pending.hasFingerprint = pending.locator->TryGetFingerprint(pending.fingerprint);
+
+	if (scanned && hasFingerprint && pending.hasFingerprint && pending.fingerprint == fingerprint)
+	{
+		pending.kind = ScanKind::Unchanged;
+		return;
+	}
+
+	pending.kind = ScanKind::Files;
+	pending.firstScan = !scanned;
+	SelectFilesToRead();
+}
+
+void ExemplarPatchScanner::ReadFiles()
+{
+	if (pending.kind != ScanKind::Files)
+	{
+		return;
+	}
+
+	if (pending.firstScan && !installedBakedFilePath.empty())
+	{
+		if (pending.hasFingerprint && ExemplarPatchBaker::IsUpToDate(installedBakedFilePath, pending.fingerprint))
+		{
+			if (useBakedFile)
+			{
+				pending.kind = ScanKind::BakedFile;
+				return;
+			}
+		}
+		else
+		{
+			// The game already loaded the stale exemplars, the scan applies the current
+			// patches over them when they are loaded.
+			pending.staleBakedFile = true;
+		}
+	}
+
+	if (pending.firstScan && pending.hasFingerprint)
+	{
+		if (!bundlePath.empty()
+			&& ExemplarPatchBundle::Read(bundlePath, pending.fingerprint, pending.bundleIndex, pending.bundlePatchCount))
+		{
+			pending.kind = ScanKind::Bundle;
+			return;
+		}
+
+		// The bundle index is only valid if it was read completely.
+		pending.bundleIndex.Clear();
+	}
+
+	ReadRecords();
+}
+
+void ExemplarPatchScanner::LoadGamePatches()
+{
+	if (pending.kind != ScanKind::Files)
+	{
+		return;
+	}
+
+	const ExemplarPatchRecordLocator& locator = *pending.locator;
+	const std::vector<ExemplarPatchRecordLocator::Record>& records = locator.GetRecords();
+
+	for (size_t i = 0; i < records.size(); i++)
+	{
+		if (!pending.recordPatches[i])
+		{
+			pending.recordPatches[i] = LoadGameExemplarPatch(records[i]);
+
+			const size_t fileIndex = locator.GetRecordFileIndex(i);
+
+			if (fileIndex != ExemplarPatchRecordLocator::NoFile)
+			{
+				auto item = pending.currentFiles.find(locator.GetFilePath(fileIndex));
+
+				if (item != pending.currentFiles.end())
+				{
+					item->second.patches.emplace(records[i].key, pending.recordPatches[i]);
+				}
+			}
+		}
+	}
+}
+
+bool ExemplarPatchScanner::EndScan(ExemplarPatchIndex& index)
+{
+	// The locator keeps the DBPF files mapped until the scan ends.
+	PendingScan scan = std::move(pending);
+	pending = PendingScan();
+
+	if (scan.staleBakedFile)
+	{
+		DisableStaleBakedFile();
+	}
+
+	if (scan.kind == ScanKind::NoPatches)
+	{
+		// Remove the patches that were found by the previous scan.
+		index.RestoreColdTargets();
+		UpdatePatchIndex(index, {}, {});
+		scannedFiles.clear();
+		loadedExemplarPatchCount = 0;
+		hasFingerprint = false;
+		scanned = true;
+		return false;
+	}
+	else if (scan.kind == ScanKind::Unchanged)
+	{
+		// The exemplar patch files have not changed since the last scan, but the
+		// plugins that were loaded since then could provide some of the cold targets.
+		if (pruneUnavailableTargets && index.GetColdTargetCount() > 0)
+		{
+			index.RestoreColdTargets();
+			PruneUnavailableTargets(index);
+		}
+
+		return true;
+	}
+
+	fingerprint = scan.fingerprint;
+	hasFingerprint = scan.hasFingerprint;
+	usedBakedFile = false;
+	scanned = true;
+
+	if (scan.kind == ScanKind::BakedFile)
+	{
+		usedBakedFile = true;
+		Logger::GetInstance().WriteLineFormatted(
+			LogLevel::Info,
+			"Skipped the Exemplar patch scan, the patched exemplars are loaded from %s.",
+			installedBakedFilePath.string().c_str());
+		return true;
+	}
+	else if (scan.kind == ScanKind::Bundle)
+	{
+		index = std::move(scan.bundleIndex);
+		loadedExemplarPatchCount = scan.bundlePatchCount;
+		LoadScanState(*scan.locator, index);
+		Logger::GetInstance().WriteLineFormatted(
+			LogLevel::Info,
+			"Loaded the Exemplar patches from %s.",
+			bundlePath.string().c_str());
+
+		if (pruneUnavailableTargets)
+		{
+			PruneUnavailableTargets(index);
+		}
+
+		return true;
+	}
+
+	index.RestoreColdTargets();
+	UpdateScannedFiles(scan, index);
+
+	if (pruneUnavailableTargets)
+	{
+		PruneUnavailableTargets(index);
+	}
+
+	if (hasFingerprint && !bundlePath.empty() && !ExemplarPatchBundle::Write(bundlePath, fingerprint, index))
+	{
+		Logger::GetInstance().WriteLineFormatted(
+			LogLevel::Error,
+			"Failed to write the Exemplar patch bundle: %s",
+			bundlePath.string().c_str());
+	}
+
+	return true;
+}
+
+uint32_t ExemplarPatchScanner::GetLoadedExemplarPatchCount() const
+{
+	return loadedExemplarPatchCount;
+}
+
+bool ExemplarPatchScanner::TryGetFingerprint(uint64_t& fingerprint) const
+{
+	fingerprint = this->fingerprint;
+	return hasFingerprint;
+}
+
+bool ExemplarPatchScanner::UsedBakedFile() const
+{
+	return usedBakedFile;
+}
+
+const std::filesystem::path& ExemplarPatchScanner::GetInstalledBakedFilePath() const
+{
+	return installedBakedFilePath;
+}
+
+void ExemplarPatchScanner::DisableStaleBakedFile()
+{
+	Logger& logger = Logger::GetInstance();
+
+	logger.WriteLineFormatted(
+		LogLevel::Error,
+		"The baked Exemplar patch file %s does not match the installed exemplar patches or plugins."
+		" The game has loaded its outdated exemplars, restart the game after baking a new file.",
+		installedBakedFilePath.string().c_str());
+
+	std::filesystem::path disabledPath = installedBakedFilePath;
+	disabledPath += ".stale";
+
+	std::error_code ec;
+	std::filesystem::rename(installedBakedFilePath, disabledPath, ec);
+
+	if (ec)
+	{
+		logger.WriteLineFormatted(
+			LogLevel::Error,
+			"Failed to rename the stale baked Exemplar patch file, delete it before the next start: %s",
+			installedBakedFilePath.string().c_str());
+	}
+	else
+	{
+		logger.WriteLineFormatted(
+			LogLevel::Info,
+			"Renamed the stale baked Exemplar patch file to %s, the game will not load it on the next start.",
+			disabledPath.string().c_str());
+	}
+}
+
+void ExemplarPatchScanner::SelectFilesToRead()
+{
+	const ExemplarPatchRecordLocator& locator = *pending.locator;
+	const size_t fileCount = locator.GetFileCount();
+
+	// Only the files that are new or were changed since the last scan are read,
+	// the other files keep the patches that they provided.
+	pending.filesToRead.resize(fileCount);
+	pending.currentFiles.reserve(fileCount);
+
+	for (size_t i = 0; i < fileCount; i++)
+	{
+		const std::string& path = locator.GetFilePath(i);
+
+		ExemplarPatchRecordLocator::FileStamp stamp{};
+		const bool hasStamp = locator.TryGetFileStamp(i, stamp);
+
+		auto previous = scannedFiles.find(path);
+
+		if (hasStamp && previous != scannedFiles.end() && previous->second.stamp == stamp)
+		{
+			pending.currentFiles.emplace(path, std::move(previous->second));
+		}
+		else
+		{
+			pending.filesToRead[i] = true;
+			pending.readFileCount++;
+
+			if (hasStamp)
+			{
+				pending.currentFiles.emplace(path, ScannedFile{ stamp, {} });
+			}
+		}
+	}
+}
+
+void ExemplarPatchScanner::ReadRecords()
+{
+	ExemplarPatchRecordLocator& locator = *pending.locator;
+
+	locator.ReadRecordLocations(pending.filesToRead);
+
+	const std::vector<ExemplarPatchRecordLocator::Record>& records = locator.GetRecords();
+
+	pending.recordPatches.resize(records.size());
+
+	for (size_t i = 0; i < records.size(); i++)
+	{
+		const ExemplarPatchRecordLocator::Record& record = records[i];
+		const size_t fileIndex = locator.GetRecordFileIndex(i);
+
+		ScannedFile* scannedFile = nullptr;
+
+		if (fileIndex != ExemplarPatchRecordLocator::NoFile)
+		{
+			auto item = pending.currentFiles.find(locator.GetFilePath(fileIndex));
+
+			if (item != pending.currentFiles.end())
+			{
+				scannedFile = &item->second;
+			}
+		}
+
+		std::shared_ptr<const LoadedPatch> loadedPatch;
+
+		if (scannedFile)
+		{
+			auto item = scannedFile->patches.find(record.key);
+
+			if (item != scannedFile->patches.end())
+			{
+				loadedPatch = item->second;
+			}
+		}
+
+		if (!loadedPatch && record.file)
+		{
+			// The record is new, or it was overridden by another file in the last scan.
+			// The records that the native parser does not handle are left for LoadGamePatches.
+			loadedPatch = LoadNativeExemplarPatch(record);
+
+			if (loadedPatch && scannedFile)
+			{
+				scannedFile->patches.emplace(record.key, loadedPatch);
+			}
+		}
+
+		pending.recordPatches[i] = std::move(loadedPatch);
+	}
+}
+
+void ExemplarPatchScanner::UpdateScannedFiles(PendingScan& scan, ExemplarPatchIndex& index)
+{
+	const ExemplarPatchRecordLocator& locator = *scan.locator;
+	const size_t fileCount = locator.GetFileCount();
+
+	// The source index uses the same file indices as the locator.
+	ExemplarPatchSourceIndex currentSources;
+
+	for (size_t i = 0; i < fileCount; i++)
+	{
+		currentSources.AddFile(locator.GetFilePath(i));
+	}
+
+	const std::vector<ExemplarPatchRecordLocator::Record>& records = locator.GetRecords();
+
+	std::vector<std::shared_ptr<const LoadedPatch>> currentPatches;
+	currentPatches.reserve(records.size());
+
+	for (size_t i = 0; i < records.size(); i++)
+	{
+		std::shared_ptr<const LoadedPatch>& loadedPatch = scan.recordPatches[i];
+
+		if (loadedPatch->patch)
+		{
+			currentSources.AddSource(
+				records[i].key,
+				loadedPatch->patch.get(),
+				ToSourceFileIndex(locator.GetRecordFileIndex(i)),
+				loadedPatch->targets);
+			currentPatches.push_back(std::move(loadedPatch));
+		}
+	}
+
+	scannedFiles = std::move(scan.currentFiles);
+	UpdatePatchIndex(index, std::move(currentPatches), std::move(currentSources));
+	loadedExemplarPatchCount = static_cast<uint32_t>(activePatches.size());
+
+	if (debugLoggingEnabled)
+	{
+		Logger::GetInstance().WriteLineFormatted(
+			LogLevel::Info,
+			"Read the Exemplar patches from %zu of %zu files.",
+			scan.readFileCount,
+			fileCount);
+	}
+}
+
+void ExemplarPatchScanner::PruneUnavailableTargets(ExemplarPatchIndex& index)
+{
+	const size_t previousTableSize = index.GetLookupTableSize();
+
+	// The resource manager filters its whole key list in one call, the
+	// filter only includes the exemplars that have patches.
+	std::vector<cGZPersistResourceKey> availableTargets;
+
+	cRZAutoRefCount<cIGZPersistResourceKeyList> pResourceList;
+
+	PatchTargetFilter* filter = new PatchTargetFilter(index);
+	filter->AddRef();
+	pResMan->GetAvailableResourceList(pResourceList.AsPPObj(), filter);
+	filter->Release();
+
+	if (pResourceList)
+	{
+		availableTargets.reserve(pResourceList->Size());
+		pResourceList->EnumKeys(AddAvailableTargetCallback, &availableTargets);
+	}
+
+	const size_t prunedTargetCount = index.PruneTargets(availableTargets);
+
+	if (prunedTargetCount > 0)
+	{
+		const size_t tableSize = index.GetLookupTableSize();
+
+		// Only the lookup table shrinks, the cold targets keep their patch lists.
+		Logger::GetInstance().WriteLineFormatted(
+			LogLevel::Info,
+			"Moved %zu Exemplar patch targets that are not in the installed plugins to the cold list, the patch lookup table shrank by %zu KiB.",
+			prunedTargetCount,
+			previousTableSize > tableSize ? (previousTableSize - tableSize) / 1024 : 0);
+	}
+}
+
+void ExemplarPatchScanner::LoadScanState(const ExemplarPatchRecordLocator& locator, ExemplarPatchIndex& index)
+{
+	boost::unordered_flat_map<const cGZPersistResourceKey, std::shared_ptr<LoadedPatch>> patchesByKey;
+
+	index.EnumTargets([&](const cGZPersistResourceKey& target, const ExemplarPatchIndex::PatchList& patches)
+	{
+		for (const auto& patch : patches)
+		{
+			std::shared_ptr<LoadedPatch>& loadedPatch = patchesByKey[patch->GetKey()];
+
+			if (!loadedPatch)
+			{
+				loadedPatch = std::make_shared<LoadedPatch>();
+				loadedPatch->patch = patch;
+			}
+
+			loadedPatch->targets.push_back(target);
+		}
+	});
+
+	index.GetRanges().EnumPatches(
+		[&](const std::shared_ptr<const ExemplarPatch>& patch, std::span<const ExemplarPatchTargetRange> ranges)
+		{
+			std::shared_ptr<LoadedPatch>& loadedPatch = patchesByKey[patch->GetKey()];
+
+			if (!loadedPatch)
+			{
+				loadedPatch = std::make_shared<LoadedPatch>();
+				loadedPatch->patch = patch;
+			}
+
+			loadedPatch->targetRanges.assign(ranges.begin(), ranges.end());
+		});
+
+	index.GetTypeTargets().EnumPatches(
+		[&](const std::shared_ptr<const ExemplarPatch>& patch, std::span<const ExemplarPatchTypeTarget> typeTargets)
+		{
+			std::shared_ptr<LoadedPatch>& loadedPatch = patchesByKey[patch->GetKey()];
+
+			if (!loadedPatch)
+			{
+				loadedPatch = std::make_shared<LoadedPatch>();
+				loadedPatch->patch = patch;
+			}
+
+			loadedPatch->typeTargets.assign(typeTargets.begin(), typeTargets.end());
+		});
+
+	const std::vector<ExemplarPatchRecordLocator::Record>& records = locator.GetRecords();
+
+	ExemplarPatchSourceIndex sources;
+
+	for (size_t i = 0; i < locator.GetFileCount(); i++)
+	{
+		sources.AddFile(locator.GetFilePath(i));
+	}
+
+	scannedFiles.clear();
+	activePatches.clear();
+	activePatches.reserve(patchesByKey.size());
+
+	for (size_t i = 0; i < records.size(); i++)
+	{
+		const cGZPersistResourceKey& key = records[i].key;
+
+		std::shared_ptr<const LoadedPatch> loadedPatch;
+
+		auto item = patchesByKey.find(key);
+
+		if (item != patchesByKey.end())
+		{
+			loadedPatch = item->second;
+			sources.AddSource(
+				key,
+				loadedPatch->patch.get(),
+				ToSourceFileIndex(locator.GetRecordFileIndex(i)),
+				loadedPatch->targets);
+			activePatches.push_back(loadedPatch);
+		}
+		else
+		{
+			// The record is not a valid exemplar patch.
+			loadedPatch = std::make_shared<LoadedPatch>();
+		}
+
+		const size_t fileIndex = locator.GetRecordFileIndex(i);
+		ExemplarPatchRecordLocator::FileStamp stamp{};
+
+		if (fileIndex != ExemplarPatchRecordLocator::NoFile && locator.TryGetFileStamp(fileIndex, stamp))
+		{
+			ScannedFile& scannedFile = scannedFiles[locator.GetFilePath(fileIndex)];
+			scannedFile.stamp = stamp;
+			scannedFile.patches.emplace(key, std::move(loadedPatch));
+		}
+	}
+
+	boost::unordered_flat_map<const ExemplarPatch*, uint32_t> loadOrder;
+	loadOrder.reserve(activePatches.size());
+
+	for (size_t i = 0; i < activePatches.size(); i++)
+	{
+		loadOrder.emplace(activePatches[i]->patch.get(), static_cast<uint32_t>(i));
+	}
+
+	index.SetSources(std::move(sources));
+	index.SetLoadOrder(std::move(loadOrder));
+}
+
+void ExemplarPatchScanner::UpdatePatchIndex(
+	ExemplarPatchIndex& index,
+	std::vector<std::shared_ptr<const LoadedPatch>>&& currentPatches,
+	ExemplarPatchSourceIndex&& currentSources)
+{
+	boost::unordered_flat_map<const ExemplarPatch*, uint32_t> loadOrder;
+	loadOrder.reserve(currentPatches.size());
+
+	for (size_t i = 0; i < currentPatches.size(); i++)
+	{
+		loadOrder.emplace(currentPatches[i]->patch.get(), static_cast<uint32_t>(i));
+	}
+
+	// Remove the patches that are no longer active, and check that the
+	// remaining patches kept their relative load order.
+	boost::unordered_flat_set<const ExemplarPatch*> previousPatches;
+	previousPatches.reserve(activePatches.size());
+	bool loadOrderPreserved = true;
+	size_t lastLoadOrder = 0;
+
+	for (const auto& loadedPatch : activePatches)
+	{
+		const ExemplarPatch* patch = loadedPatch->patch.get();
+		const auto item = loadOrder.find(patch);
+
+		if (item == loadOrder.end())
+		{
+			index.RemovePatch(patch);
+		}
+		else
+		{
+			if (!previousPatches.empty() && item->second < lastLoadOrder)
+			{
+				loadOrderPreserved = false;
+			}
+
+			lastLoadOrder = item->second;
+			previousPatches.insert(patch);
+		}
+	}
+
+	if (loadOrderPreserved)
+	{
+		for (size_t i = 0; i < currentPatches.size(); i++)
+		{
+			const std::shared_ptr<const ExemplarPatch>& patch = currentPatches[i]->patch;
+
+			if (previousPatches.find(patch.get()) == previousPatches.end())
+			{
+				const auto isLoadedAfter = [&](const ExemplarPatch* other)
+				{
+					return loadOrder.find(other)->second > i;
+				};
+
+				for (const cGZPersistResourceKey& target : currentPatches[i]->targets)
+				{
+					index.InsertPatch(patch, target, isLoadedAfter);
+				}
+			}
+		}
+	}
+	else
+	{
+		// A change in the plugin load order is rare, the index is rebuilt from the loaded patches.
+		index.Clear();
+
+		for (const auto& loadedPatch : currentPatches)
+		{
+			for (const cGZPersistResourceKey& target : loadedPatch->targets)
+			{
+				index.AddPatch(loadedPatch->patch, target);
+			}
+		}
+	}
+
+	// The range and type indices are small, they are rebuilt from the loaded patches.
+	ExemplarPatchRangeIndex ranges;
+	ExemplarPatchTypeIndex typeTargets;
+
+	for (const auto& loadedPatch : currentPatches)
+	{
+		ranges.AddPatch(loadedPatch->patch, loadedPatch->targetRanges);
+		typeTargets.AddPatch(loadedPatch->patch, loadedPatch->typeTargets);
+	}
+
+	ranges.Build();
+
+	index.SetRanges(std::move(ranges));
+	index.SetTypeTargets(std::move(typeTargets));
+	index.SetSources(std::move(currentSources));
+	index.SetLoadOrder(std::move(loadOrder));
+	activePatches = std::move(currentPatches);
+}
+
+std::shared_ptr<const ExemplarPatchScanner::LoadedPatch> ExemplarPatchScanner::LoadNativeExemplarPatch(const ExemplarPatchRecordLocator::Record& record)
+{
+	std::span<const uint8_t> data;
+
+	if (!record.file->ReadRecord(record.entry, recordBuffer, data))
+	{
+		return nullptr;
+	}
+
+	currentPatch = std::make_shared<LoadedPatch>();
+
+	bool loaded = false;
+
+	if (ExemplarFormat::IsTextFormat(data.data(), data.size()))
+	{
+		loaded = textParser.Open(data.data(), data.size()) && LoadParsedExemplarPatch(record, textParser);
+	}
+	else
+	{
+		ExemplarBinaryParser binaryParser;
+
+		loaded = binaryParser.Open(data.data(), data.size()) && LoadParsedExemplarPatch(record, binaryParser);
+	}
+
+	// The game is used to load the patches that the native parser does not handle,
+	// for example cohorts that have a parent cohort.
+	std::shared_ptr<const LoadedPatch> loadedPatch = std::move(currentPatch);
+
+	return loaded ? loadedPatch : nullptr;
+}
+
+template<typename TParser>
+bool ExemplarPatchScanner::LoadParsedExemplarPatch(const ExemplarPatchRecordLocator::Record& record, const TParser& parser)
+{
+	const cGZPersistResourceKey& key = record.key;
+	const cGZPersistResourceKey& parentCohortKey = parser.GetParentCohortKey();
+
+	if (parentCohortKey.type != 0 || parentCohortKey.group != 0 || parentCohortKey.instance != 0)
+	{
+		// The game resolves the properties that are inherited from the parent cohort.
+		return false;
+	}
+
+	// Returns false if the property is present but not valid.
+	const auto readTargetProperty = [&](
+		uint32_t id,
+		auto isValid,
+		std::vector<uint32_t>& buffer,
+		std::span<const uint32_t>& values)
+	{
+		ExemplarPropertyView property{};
+
+		if (!parser.FindProperty(id, property))
+		{
+			return true;
+		}
+
+		const bool isUint32Array = property.type == ExemplarFormat::ValueType::Uint32 && property.isArray;
+
+		if (isUint32Array)
+		{
+			buffer.resize(property.count);
+			std::memcpy(buffer.data(), property.values, static_cast<size_t>(property.count) * sizeof(uint32_t));
+		}
+
+		if (!isValid(isUint32Array, buffer.data(), property.count, record))
+		{
+			return false;
+		}
+
+		values = std::span<const uint32_t>(buffer.data(), property.count);
+		return true;
+	};
+
+	std::span<const uint32_t> targets;
+	std::span<const uint32_t> targetRanges;
+	std::span<const uint32_t> typeTargets;
+
+	if (readTargetProperty(kExemplarPatchTargetPropertyId, IsValidTargetList, targetBuffer, targets)
+		&& readTargetProperty(kExemplarPatchTargetRangesPropertyId, IsValidTargetRangeList, targetRangeBuffer, targetRanges)
+		&& readTargetProperty(kExemplarPatchTypeTargetsPropertyId, IsValidTypeTargetList, typeTargetBuffer, typeTargets)
+		&& (!targets.empty() || !targetRanges.empty() || !typeTargets.empty()))
+	{
+		std::shared_ptr<ExemplarPatch> patch = std::make_shared<ExemplarPatch>(key);
+
+		parser.EnumProperties([&](const ExemplarPropertyView& property)
+		{
+			if (ExemplarPatch::IsPatchProperty(property.id))
+			{
+				patch->AddProperty(propertyFactory.Create(property));
+			}
+		});
+
+		AddExemplarPatch(record, std::move(patch), targets, targetRanges, typeTargets);
+	}
+
+	return true;
+}
+
+std::shared_ptr<const ExemplarPatchScanner::LoadedPatch> ExemplarPatchScanner::LoadGameExemplarPatch(const ExemplarPatchRecordLocator::Record& record)
+{
+	const cGZPersistResourceKey& key = record.key;
+	currentPatch = std::make_shared<LoadedPatch>();
+
+	cRZAutoRefCount<cISCResExemplarCohort> cohort;
+
+	if (pResMan->GetResource(key, GZIID_cISCResExemplarCohort, cohort.AsPPVoid(), 0, nullptr))
+	{
+		cISCPropertyHolder* propHolder = cohort->AsISCPropertyHolder();
+
+		// Returns false if the property is present but not valid.
+		const auto readTargetProperty = [&](uint32_t id, auto isValid, std::span<const uint32_t>& values)
+		{
+			auto property = propHolder->GetProperty(id);
+
+			if (!property)
+			{
+				return true;
+			}
+
+			const cIGZVariant* variant = property->GetPropertyValue();
+			const bool isUint32Array = variant->GetType() == cIGZVariant::Type::Uint32Array;
+			const uint32_t* data = isUint32Array ? variant->RefUint32() : nullptr;
+
+			if (!isValid(isUint32Array, data, variant->GetCount(), record))
+			{
+				return false;
+			}
+
+			values = std::span<const uint32_t>(data, variant->GetCount());
+			return true;
+		};
+
+		std::span<const uint32_t> targets;
+		std::span<const uint32_t> targetRanges;
+		std::span<const uint32_t> typeTargets;
+
+		if (readTargetProperty(kExemplarPatchTargetPropertyId, IsValidTargetList, targets)
+			&& readTargetProperty(kExemplarPatchTargetRangesPropertyId, IsValidTargetRangeList, targetRanges)
+			&& readTargetProperty(kExemplarPatchTypeTargetsPropertyId, IsValidTypeTargetList, typeTargets)
+			&& (!targets.empty() || !targetRanges.empty() || !typeTargets.empty()))
+		{
+			std::shared_ptr<ExemplarPatch> patch = std::make_shared<ExemplarPatch>(key);
+			patch->AddProperties(propHolder);
+
+			AddExemplarPatch(record, std::move(patch), targets, targetRanges, typeTargets);
+		}
+	}
+	else
+	{
+		LogExemplarPatchScanError("Exemplar Patch is not a valid cohort", record);
+	}
+
+	return std::move(currentPatch);
+}
+
+void ExemplarPatchScanner::AddExemplarPatch(
+	const ExemplarPatchRecordLocator::Record& record,
+	std::shared_ptr<const ExemplarPatch> patch,
+	std::span<const uint32_t> groupAndInstanceIDs,
+	std::span<const uint32_t> targetRanges,
+	std::span<const uint32_t> typeTargets)
+{
+	if (debugLoggingEnabled)
+	{
+		const cGZPersistResourceKey& key = record.key;
+		std::string path;
+
+		if (record.file)
+		{
+			path = record.file->GetPath().string();
+		}
+		else
+		{
+			cRZBaseString segmentPath;
+
+			if (PersistResourceUtil::GetResourceFilePath(pResMan, key, segmentPath))
+			{
+				path.assign(segmentPath.ToChar(), segmentPath.Strlen());
+			}
+		}
+
+		if (!path.empty())
+		{
+			Logger& logger = Logger::GetInstance();
+			logger.WriteLineFormatted(
+				LogLevel::Info,
+				"Exemplar patch T=0x%08X, G=0x%08X, I=0x%08X loaded from %s",
+				key.type,
+				key.group,
+				key.instance,
+				path.c_str());
+		}
+	}
+
+	currentPatch->patch = std::move(patch);
+	currentPatch->targets.reserve(groupAndInstanceIDs.size() / 2);
+
+	for (size_t i = 1; i < groupAndInstanceIDs.size(); i += 2)
+	{
+		currentPatch->targets.emplace_back(kExemplarTypeId, groupAndInstanceIDs[i - 1], groupAndInstanceIDs[i]);
+	}
+
+	currentPatch->targetRanges.reserve(targetRanges.size() / 3);
+
+	for (size_t i = 2; i < targetRanges.size(); i += 3)
+	{
+		currentPatch->targetRanges.push_back(ExemplarPatchTargetRange{ targetRanges[i - 2], targetRanges[i - 1], targetRanges[i] });
+	}
+
+	currentPatch->typeTargets.reserve(typeTargets.size() / 3);
+
+	for (size_t i = 2; i < typeTargets.size(); i += 3)
+	{
+		currentPatch->typeTargets.push_back(ExemplarPatchTypeTarget{ typeTargets[i - 2], typeTargets[i - 1], typeTargets[i] });
+	}
+}
@@ -0,0 +1,220 @@
+/*
+ * This file is part of sc4-resource-loading-hooks, a DLL Plugin for SimCity 4
+ * that allows other DLLs to modify resources as the game loads them.
+ *
+ * Copyright (C) 2024, 2025 Nicholas Hayes
+ *
+ * sc4-resource-loading-hooks is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * sc4-resource-loading-hooks is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with sc4-resource-loading-hooks.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#include "cGZPersistResourceKey.h"
+#include "ExemplarPatchIndex.h"
+#include "ExemplarPatchRecordLocator.h"
+#include "ExemplarPropertyFactory.h"
+#include "ExemplarTextParser.h"
+#include "PersistResourceKeyBoostHash.h"
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "boost/unordered/unordered_flat_map.hpp"
+
+class cIGZPersistResourceManager;
+
+// Builds the exemplar patch index from the exemplar patch cohorts that
+// are available in the resource manager.
+// The resource manager is passed in so that the scan does not depend on
+// the game's global resource manager instance.
+//
+// The scanner remembers the patches that each DBPF file provided, a later
+// scan only reads the files that were added or changed and updates the
+// index in place.
+//
+// A scan is split in steps so that the DBPF files can be read on a background thread.
+// The resource manager is not thread-safe, BeginScan, LoadGamePatches and EndScan must
+// be called on the thread that the game uses it on. ReadFiles does not use the resource
+// manager or the index. The steps of a scan must not overlap.
+class ExemplarPatchScanner
+{
+public:
+
+	ExemplarPatchScanner(cIGZPersistResourceManager* pResMan, bool debugLoggingEnabled);
+
+	// Enables the exemplar patch bundle.
+	// The patches are loaded from the bundle when it matches the current plugins,
+	// otherwise the bundle is written after the scan.
+	void SetBundlePath(const std::filesystem::path& path);
+
+	// Enables the baked exemplar patch file.
+	// The scan is skipped when the baked file that the game loaded was built from the
+	// current exemplar patches, the patched exemplars are then loaded from the baked file.
+	void SetUseBakedFile(bool value);
+
+	// Moves the patch targets that are not in the resource manager to the index's cold list
+	// after each scan.
+	void SetPruneUnavailableTargets(bool value);
+
+	// Updates the index with the exemplar patches that were added or removed since the last scan.
+	// The index must not be modified by the caller between scans.
+	// Returns false if the resource manager does not contain any exemplar patches.
+	bool Scan(ExemplarPatchIndex& index);
+
+	// Locates the exemplar patch records and selects the files that must be read.
+	void BeginScan();
+
+	// Reads the selected files and parses the exemplar patches that they contain.
+	void ReadFiles();
+
+	// Loads the exemplar patches that the native parser could not read through the game.
+	void LoadGamePatches();
+
+	// Updates the index with the result of the scan.
+	// Returns false if the resource manager does not contain any exemplar patches.
+	bool EndScan(ExemplarPatchIndex& index);
+
+	uint32_t GetLoadedExemplarPatchCount() const;
+
+	// Gets the fingerprint of the exemplar patch files that were found by the last scan.
+	bool TryGetFingerprint(uint64_t& fingerprint) const;
+
+	// Returns true if the last scan was skipped because the baked file is up to date.
+	bool UsedBakedFile() const;
+
+	// Gets the path of the baked file that the game loaded, or an empty path.
+	// The first scan checks that the file is up to date, a stale file is renamed
+	// so that the game does not load it again.
+	const std::filesystem::path& GetInstalledBakedFilePath() const;
+
+private:
+
+	// An exemplar patch record and the exemplars it targets.
+	struct LoadedPatch
+	{
+		// Null if the record is not a valid exemplar patch.
+		std::shared_ptr<const ExemplarPatch> patch;
+		std::vector<cGZPersistResourceKey> targets;
+		std::vector<ExemplarPatchTargetRange> targetRanges;
+		std::vector<ExemplarPatchTypeTarget> typeTargets;
+	};
+
+	// The exemplar patch records that were loaded from a DBPF file.
+	struct ScannedFile
+	{
+		ExemplarPatchRecordLocator::FileStamp stamp;
+		boost::unordered_flat_map<const cGZPersistResourceKey, std::shared_ptr<const LoadedPatch>> patches;
+	};
+
+	enum class ScanKind
+	{
+		// The resource manager does not contain any exemplar patches.
+		NoPatches,
+		// The exemplar patch files have not changed since the last scan.
+		Unchanged,
+		// The baked file was built from the current exemplar patches.
+		BakedFile,
+		// The patches are loaded from the exemplar patch bundle.
+		Bundle,
+		// The added or changed files are read.
+		Files,
+	};
+
+	// The state of the scan that is in progress.
+	struct PendingScan
+	{
+		ScanKind kind = ScanKind::NoPatches;
+		std::unique_ptr<ExemplarPatchRecordLocator> locator;
+		uint64_t fingerprint = 0;
+		bool hasFingerprint = false;
+		bool firstScan = false;
+		// Indexed by the locator file index.
+		std::vector<bool> filesToRead;
+		size_t readFileCount = 0;
+		boost::unordered_flat_map<std::string, ScannedFile> currentFiles;
+		// The patch of each locator record, null if the record must be loaded by the game.
+		std::vector<std::shared_ptr<const LoadedPatch>> recordPatches;
+		ExemplarPatchIndex bundleIndex;
+		uint32_t bundlePatchCount = 0;
+		// Set if the game loaded a baked file that does not match the current plugins.
+		bool staleBakedFile = false;
+	};
+
+	// Selects the files that were added or changed since the last scan.
+	void SelectFilesToRead();
+
+	// Reads the patches from the selected files, the unchanged files keep their patches.
+	void ReadRecords();
+
+	// Replaces the scanned files and updates the index with the patches of the scan.
+	void UpdateScannedFiles(PendingScan& scan, ExemplarPatchIndex& index);
+
+	// Renames the stale baked file so that the game does not load it on the next start.
+	void DisableStaleBakedFile();
+
+	// Rebuilds the scan state from an index that was loaded from the exemplar patch bundle.
+	void LoadScanState(const ExemplarPatchRecordLocator& locator, ExemplarPatchIndex& index);
+
+	// Removes the inactive patches from the index, inserts the new patches in
+	// load order and replaces the index sources.
+	void PruneUnavailableTargets(ExemplarPatchIndex& index);
+
+	void UpdatePatchIndex(
+		ExemplarPatchIndex& index,
+		std::vector<std::shared_ptr<const LoadedPatch>>&& currentPatches,
+		ExemplarPatchSourceIndex&& currentSources);
+
+	// Reads the patch from the mapped DBPF record.
+	// Returns null if the record must be loaded by the game.
+	std::shared_ptr<const LoadedPatch> LoadNativeExemplarPatch(const ExemplarPatchRecordLocator::Record& record);
+
+	std::shared_ptr<const LoadedPatch> LoadGameExemplarPatch(const ExemplarPatchRecordLocator::Record& record);
+
+	template<typename TParser>
+	bool LoadParsedExemplarPatch(const ExemplarPatchRecordLocator::Record& record, const TParser& parser);
+
+	void AddExemplarPatch(
+		const ExemplarPatchRecordLocator::Record& record,
+		std::shared_ptr<const ExemplarPatch> patch,
+		std::span<const uint32_t> groupAndInstanceIDs,
+		std::span<const uint32_t> targetRanges,
+		std::span<const uint32_t> typeTargets);
+
+	cIGZPersistResourceManager* pResMan;
+	std::filesystem::path bundlePath;
+	std::filesystem::path installedBakedFilePath;
+	boost::unordered_flat_map<std::string, ScannedFile> scannedFiles;
+	PendingScan pending;
+	// The valid exemplar patches in load order.
+	std::vector<std::shared_ptr<const LoadedPatch>> activePatches;
+	// The patch that is being loaded.
+	std::shared_ptr<LoadedPatch> currentPatch;
+	uint32_t loadedExemplarPatchCount;
+	uint64_t fingerprint;
+	bool hasFingerprint;
+	bool useBakedFile;
+	bool usedBakedFile;
+	bool scanned;
+	bool pruneUnavailableTargets;
+	bool debugLoggingEnabled;
+	std::vector<uint8_t> recordBuffer;
+	ExemplarTextParser textParser;
+	ExemplarPropertyFactory propertyFactory;
+	std::vector<uint32_t> targetBuffer;
+	std::vector<uint32_t> targetRangeBuffer;
+	std::vector<uint32_t> typeTargetBuffer;
+};
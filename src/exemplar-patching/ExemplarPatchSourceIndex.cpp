@@ -0,0 +1,83 @@
+/*
+ * This file is part of sc4-resource-loading-hooks, a DLL Plugin for SimCity 4
+ * that allows other DLLs to modify resources as the game loads them.
+ *
+ * Copyright (C) 2024, 2025 Nicholas Hayes
+ *
+ * sc4-resource-loading-hooks is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * sc4-resource-loading-hooks is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with sc4-resource-loading-hooks.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ExemplarPatchSourceIndex.h"
+
+ExemplarPatchSourceIndex::ExemplarPatchSourceIndex()
+	: sources(),
+	  targets(),
+	  filePaths()
+{
+}
+
+uint32_t ExemplarPatchSourceIndex::AddFile(const std::string& path)
+{
+	filePaths.push_back(path);
+
+	return static_cast<uint32_t>(filePaths.size() - 1);
+}
+
+void ExemplarPatchSourceIndex::AddSource(
+	const cGZPersistResourceKey& key,
+	const ExemplarPatch* patch,
+	uint32_t fileIndex,
+	std::span<const cGZPersistResourceKey> patchTargets)
+{
+	const Source source
+	{
+		patch,
+		static_cast<uint32_t>(targets.size()),
+		static_cast<uint32_t>(patchTargets.size()),
+		fileIndex
+	};
+
+	targets.insert(targets.end(), patchTargets.begin(), patchTargets.end());
+	sources.insert_or_assign(key, source);
+}
+
+const ExemplarPatchSourceIndex::Source* ExemplarPatchSourceIndex::Find(const cGZPersistResourceKey& patchKey) const
+{
+	const auto item = sources.find(patchKey);
+
+	return item != sources.end() ? &item->second : nullptr;
+}
+
+std::span<const cGZPersistResourceKey> ExemplarPatchSourceIndex::GetTargets(const Source& source) const
+{
+	return std::span<const cGZPersistResourceKey>(targets.data() + source.firstTarget, source.targetCount);
+}
+
+const std::string* ExemplarPatchSourceIndex::GetFilePath(const Source& source) const
+{
+	return source.fileIndex != NoFile ? &filePaths[source.fileIndex] : nullptr;
+}
+
+size_t ExemplarPatchSourceIndex::GetSourceCount() const
+{
+	return sources.size();
+}
+
+void ExemplarPatchSourceIndex::Clear()
+{
+	sources.clear();
+	targets.clear();
+	filePaths.clear();
+}
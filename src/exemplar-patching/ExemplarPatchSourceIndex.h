@@ -0,0 +1,79 @@
+/*
+ * This file is part of sc4-resource-loading-hooks, a DLL Plugin for SimCity 4
+ * that allows other DLLs to modify resources as the game loads them.
+ *
+ * Copyright (C) 2024, 2025 Nicholas Hayes
+ *
+ * sc4-resource-loading-hooks is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * sc4-resource-loading-hooks is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with sc4-resource-loading-hooks.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#include "cGZPersistResourceKey.h"
+#include "PersistResourceKeyBoostHash.h"
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "boost/unordered/unordered_flat_map.hpp"
+
+class ExemplarPatch;
+
+// Maps the exemplar patch cohort TGIs to the exemplars that they target and
+// the file that they were loaded from.
+// The targets of all patches are stored in a single array.
+class ExemplarPatchSourceIndex
+{
+public:
+
+	static constexpr uint32_t NoFile = UINT32_MAX;
+
+	struct Source
+	{
+		const ExemplarPatch* patch;
+		uint32_t firstTarget;
+		uint32_t targetCount;
+		// The index of the file that the patch was loaded from, or NoFile.
+		uint32_t fileIndex;
+	};
+
+	ExemplarPatchSourceIndex();
+
+	uint32_t AddFile(const std::string& path);
+
+	void AddSource(
+		const cGZPersistResourceKey& key,
+		const ExemplarPatch* patch,
+		uint32_t fileIndex,
+		std::span<const cGZPersistResourceKey> targets);
+
+	// Returns the source of the patch, or nullptr if the patch is not in the index.
+	const Source* Find(const cGZPersistResourceKey& patchKey) const;
+
+	std::span<const cGZPersistResourceKey> GetTargets(const Source& source) const;
+
+	// Returns nullptr if the patch was not loaded from a file on disk.
+	const std::string* GetFilePath(const Source& source) const;
+
+	size_t GetSourceCount() const;
+
+	void Clear();
+
+private:
+
+	boost::unordered_flat_map<const cGZPersistResourceKey, Source> sources;
+	std::vector<cGZPersistResourceKey> targets;
+	std::vector<std::string> filePaths;
+};
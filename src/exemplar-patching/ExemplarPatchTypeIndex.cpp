@@ -0,0 +1,112 @@
+/*
+ * This file is part of sc4-resource-loading-hooks, a DLL Plugin for SimCity 4
+ * that allows other DLLs to modify resources as the game loads them.
+ *
+ * Copyright (C) 2024, 2025 Nicholas Hayes
+ *
+ * sc4-resource-loading-hooks is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * sc4-resource-loading-hooks is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with sc4-resource-loading-hooks.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ExemplarPatchTypeIndex.h"
+#include "ExemplarTypeReader.h"
+
+ExemplarPatchTypeIndex::ExemplarPatchTypeIndex()
+	: patches(),
+	  types(),
+	  targetCount(0)
+{
+}
+
+void ExemplarPatchTypeIndex::AddPatch(
+	const std::shared_ptr<const ExemplarPatch>& patch,
+	std::span<const ExemplarPatchTypeTarget> targets)
+{
+	if (targets.empty())
+	{
+		return;
+	}
+
+	const uint32_t patchIndex = static_cast<uint32_t>(patches.size());
+
+	patches.push_back(PatchTypeTargets{ patch, std::vector<ExemplarPatchTypeTarget>(targets.begin(), targets.end()) });
+
+	for (const ExemplarPatchTypeTarget& target : targets)
+	{
+		types[target.exemplarType].push_back(TypeEntry{ target.conditionPropertyID, target.conditionValue, patchIndex });
+	}
+
+	targetCount += targets.size();
+}
+
+bool ExemplarPatchTypeIndex::Find(
+	uint32_t exemplarType,
+	const cISCPropertyHolder* pExemplar,
+	std::vector<const ExemplarPatch*>& result) const
+{
+	const auto item = types.find(exemplarType);
+
+	if (item == types.end())
+	{
+		return false;
+	}
+
+	const size_t firstResult = result.size();
+	uint32_t lastPatchIndex = UINT32_MAX;
+
+	// The entries are in load order, a patch with more than one matching
+	// condition is only added once.
+	for (const TypeEntry& entry : item->second)
+	{
+		if (entry.patchIndex == lastPatchIndex)
+		{
+			continue;
+		}
+
+		bool matches = true;
+
+		if (entry.conditionPropertyID != 0)
+		{
+			uint32_t value = 0;
+
+			matches = ExemplarTypeReader::TryGetFirstValue(pExemplar, entry.conditionPropertyID, value)
+				&& value == entry.conditionValue;
+		}
+
+		if (matches)
+		{
+			result.push_back(patches[entry.patchIndex].patch.get());
+			lastPatchIndex = entry.patchIndex;
+		}
+	}
+
+	return result.size() > firstResult;
+}
+
+bool ExemplarPatchTypeIndex::Empty() const
+{
+	return patches.empty();
+}
+
+size_t ExemplarPatchTypeIndex::GetTargetCount() const
+{
+	return targetCount;
+}
+
+void ExemplarPatchTypeIndex::Clear()
+{
+	patches.clear();
+	types.clear();
+	targetCount = 0;
+}
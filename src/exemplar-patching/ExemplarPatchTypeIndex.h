@@ -0,0 +1,98 @@
+/*
+ * This file is part of sc4-resource-loading-hooks, a DLL Plugin for SimCity 4
+ * that allows other DLLs to modify resources as the game loads them.
+ *
+ * Copyright (C) 2024, 2025 Nicholas Hayes
+ *
+ * sc4-resource-loading-hooks is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * sc4-resource-loading-hooks is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with sc4-resource-loading-hooks.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <vector>
+
+#include "boost/unordered/unordered_flat_map.hpp"
+
+class cISCPropertyHolder;
+class ExemplarPatch;
+
+// An exemplar type that a patch targets, and the condition that the exemplar must match.
+struct ExemplarPatchTypeTarget
+{
+	uint32_t exemplarType;
+	// The property that the condition checks, or 0 if every exemplar of the type is targeted.
+	uint32_t conditionPropertyID;
+	// The value that the first item of the condition property must have.
+	uint32_t conditionValue;
+};
+
+// Maps the exemplar types to the exemplar patches that target every exemplar of that type
+// which matches a condition.
+// The patches of each type are stored in load order.
+class ExemplarPatchTypeIndex
+{
+public:
+
+	ExemplarPatchTypeIndex();
+
+	// Adds the patch and its target types, the patches must be added in load order.
+	void AddPatch(const std::shared_ptr<const ExemplarPatch>& patch, std::span<const ExemplarPatchTypeTarget> targets);
+
+	// Appends the patches for the exemplar type whose condition the exemplar matches
+	// to the list, in load order.
+	// Returns false if no patch matches the exemplar.
+	bool Find(
+		uint32_t exemplarType,
+		const cISCPropertyHolder* pExemplar,
+		std::vector<const ExemplarPatch*>& result) const;
+
+	bool Empty() const;
+
+	size_t GetTargetCount() const;
+
+	// Calls the callback with every patch and its target types, in load order.
+	template<typename Callback>
+	void EnumPatches(Callback&& callback) const
+	{
+		for (const PatchTypeTargets& item : patches)
+		{
+			callback(item.patch, std::span<const ExemplarPatchTypeTarget>(item.targets));
+		}
+	}
+
+	void Clear();
+
+private:
+
+	struct PatchTypeTargets
+	{
+		std::shared_ptr<const ExemplarPatch> patch;
+		std::vector<ExemplarPatchTypeTarget> targets;
+	};
+
+	struct TypeEntry
+	{
+		uint32_t conditionPropertyID;
+		uint32_t conditionValue;
+		// The index of the patch in the load order list.
+		uint32_t patchIndex;
+	};
+
+	std::vector<PatchTypeTargets> patches;
+	boost::unordered_flat_map<uint32_t, std::vector<TypeEntry>> types;
+	size_t targetCount;
+};
@@ -20,290 +20,213 @@
  */
 
 #include "ExemplarPatchingServer.h"
+#include "ExemplarPatchBaker.h"
+#include "ExemplarTypeReader.h"
 #include "cIGZCmdLine.h"
 #include "cIGZFrameWork.h"
 #include "cIGZMessage2.h"
 #include "cIGZMessageServer2.h"
-#include "cIGZPersistDBSegment.h"
-#include "cIGZPersistDBSegmentMultiPackedFiles.h"
-#include "cIGZPersistResource.h"
 #include "cIGZPersistResourceManager.h"
-#include "cIGZPersistResourceKeyList.h"
 #include "cIGZVariant.h"
 #include "cISCProperty.h"
-#include "cISCResExemplarCohort.h"
+#include "cRZBaseString.h"
 #include "cRZCOMDllDirector.h"
+#include "FileSystem.h"
 #include "GZServPtrs.h"
 #include "Logger.h"
-#include "PersistResourceKeyFilterByTypeAndGroup.h"
+#include "PerformanceCounters.h"
+#include "PersistResourceUtil.h"
+#include <algorithm>
+#include <cstring>
+#include <string_view>
+
+using namespace std::string_view_literals;
 
 namespace
 {
-	static constexpr uint32_t kCohortTypeId = 0x05342861;
-	static constexpr uint32_t kExemplarPatchGroupId = 0xb03697d1;  // GID of Cohort files
-	static constexpr uint32_t kExemplarTypeId = 0x6534284a;
-	static constexpr uint32_t kExemplarNamePropertyId = 0x20;
-	static constexpr uint32_t kExemplarPatchTargetPropertyId = 0x0062e78a;
-
 	// Services with a priority at or below -3000000 will be initialized
 	// by the framework in PostAppInit.
 	static constexpr int32_t kExemplarPatchingServerPriority = -3000000;
 
-	struct ApplyPatchContext
-	{
-		cISCPropertyHolder* pTarget;
-		bool logPatchedProperties;
-		bool writtenExemplarPatchHeader;
+	static constexpr std::string_view BundleFileName = "SC4ExemplarPatches.bundle"sv;
+	// The file does not use a plugin extension, the game only loads it after the user installs it.
+	static constexpr std::string_view BakedFileName = "SC4ExemplarPatches.baked"sv;
 
-		ApplyPatchContext(cISCPropertyHolder* pTarget, bool logPatchedProperties)
-			: pTarget(pTarget),
-			logPatchedProperties(logPatchedProperties),
-			writtenExemplarPatchHeader(false)
-		{
-		}
-	};
+	// The number of ApplyPatches calls on this thread that hold the shared index lock.
+	// std::shared_mutex is not recursive, a nested exemplar load on the same thread must
+	// not lock it again while a scan is waiting for the exclusive lock.
+	thread_local uint32_t patchesReadDepth = 0;
 
-	void ApplyPatchCallback(cISCProperty* pProperty, void* pContext)
-	{
-		uint32_t id = pProperty->GetPropertyID();
+	// The longest time that a thread other than the main thread waits for a scan without a
+	// timeout of its own. The main thread runs the scan steps in OnTick, which may not happen
+	// while the thread that is waiting holds up the game.
+	static constexpr uint32_t ScanWaitTimeoutMilliseconds = 120000;
 
-		if (id != kExemplarPatchTargetPropertyId && id != kExemplarNamePropertyId)
+	size_t GetVariantValueSize(uint16_t type)
+	{
+		switch (type & ~0x80)
 		{
-			auto context = static_cast<ApplyPatchContext*>(pContext);
-
-			context->pTarget->AddProperty(pProperty, /*bSendMsg*/ false);  // `true` results in a crash
-
-			if (context->logPatchedProperties)
-			{
-				Logger& logger = Logger::GetInstance();
-
-				// The log lines are indented because ExemplarPatcher::ApplyPatches
-				// writes the patched exemplar TGI before this function gets called.
-
-				if (context->writtenExemplarPatchHeader)
-				{
-					// The source exemplar patch info was written, so add an extra indent level.
-					logger.WriteLineFormatted(
-						LogLevel::Info,
-						"    Patched property 0x%08X",
-						id);
-				}
-				else
-				{
-					logger.WriteLineFormatted(
-						LogLevel::Info,
-						"  Patched property 0x%08X",
-						id);
-				}
-			}
+		case cIGZVariant::Type::Bool:
+			return sizeof(bool);
+		case cIGZVariant::Type::Uint8:
+		case cIGZVariant::Type::Sint8:
+		case cIGZVariant::Type::RZChar:
+			return 1;
+		case cIGZVariant::Type::Uint16:
+		case cIGZVariant::Type::Sint16:
+			return 2;
+		case cIGZVariant::Type::Uint32:
+		case cIGZVariant::Type::Sint32:
+		case cIGZVariant::Type::Float32:
+			return 4;
+		case cIGZVariant::Type::Uint64:
+		case cIGZVariant::Type::Sint64:
+		case cIGZVariant::Type::Float64:
+			return 8;
+		default:
+			return 0;
 		}
 	}
 
-	bool GetResourceFilePath(const cGZPersistResourceKey& key, cIGZString& path)
+	const void* GetVariantData(const cIGZVariant* variant)
 	{
-		bool result = false;
-
-		cIGZPersistResourceManagerPtr pResMan;
-
-		if (pResMan)
+		switch (variant->GetType() & ~0x80)
 		{
-			cRZAutoRefCount<cIGZPersistDBSegment> pSegment;
-
-			if (pResMan->FindDBSegment(key, pSegment.AsPPObj()))
-			{
-				cRZAutoRefCount<cIGZPersistDBSegmentMultiPackedFiles> pMultiPackedFile;
-
-				if (pSegment->QueryInterface(GZIID_cIGZPersistDBSegmentMultiPackedFiles, pMultiPackedFile.AsPPVoid()))
-				{
-					// cIGZPersistDBSegmentMultiPackedFiles is a collection of DAT files in a specific folder
-					// and its sub-folders.
-					// Call its FindDBSegment method to get the actual file.
-
-					cRZAutoRefCount<cIGZPersistDBSegment> pMultiPackedSegment;
-
-					if (pMultiPackedFile->FindDBSegment(key, pMultiPackedSegment.AsPPObj()))
-					{
-						pMultiPackedSegment->GetPath(path);
-						result = true;
-					}
-				}
-				else
-				{
-					pSegment->GetPath(path);
-					result = true;
-				}
-			}
+		case cIGZVariant::Type::Bool:
+			return variant->RefBool();
+		case cIGZVariant::Type::Uint8:
+			return variant->RefUint8();
+		case cIGZVariant::Type::Sint8:
+			return variant->RefSint8();
+		case cIGZVariant::Type::Uint16:
+			return variant->RefUint16();
+		case cIGZVariant::Type::Sint16:
+			return variant->RefSint16();
+		case cIGZVariant::Type::Uint32:
+			return variant->RefUint32();
+		case cIGZVariant::Type::Sint32:
+			return variant->RefSint32();
+		case cIGZVariant::Type::Uint64:
+			return variant->RefUint64();
+		case cIGZVariant::Type::Sint64:
+			return variant->RefSint64();
+		case cIGZVariant::Type::Float32:
+			return variant->RefFloat32();
+		case cIGZVariant::Type::Float64:
+			return variant->RefFloat64();
+		case cIGZVariant::Type::RZChar:
+			return variant->RefRZChar();
+		default:
+			return nullptr;
 		}
-
-		return result;
 	}
 
-	struct ExemplarPatchScanContext
+	// Compares the type, count and raw bytes of two property values.
+	// Returns false for the value types that can't be compared as bytes.
+	bool HasSameValue(const cIGZVariant* lhs, const cIGZVariant* rhs)
 	{
-		cIGZPersistResourceManager* pResMan;
-		ExemplarPatchingServer::PatchContainer patches;
-		uint32_t loadedExemplarPatchCount;
-		bool debugLoggingEnabled;
-
-		ExemplarPatchScanContext(cIGZPersistResourceManager* pResMan, bool debugLoggingEnabled)
-			: pResMan(pResMan),
-			  patches(),
-			  loadedExemplarPatchCount(0),
-			  debugLoggingEnabled(debugLoggingEnabled)
+		if (!lhs || !rhs || lhs->GetType() != rhs->GetType() || lhs->GetCount() != rhs->GetCount())
 		{
+			return false;
 		}
-	};
 
-	void LogExemplarPatchScanError(const char* message, cGZPersistResourceKey const& key)
-	{
-		Logger& logger = Logger::GetInstance();
-
-		cRZBaseString path;
+		const size_t valueSize = GetVariantValueSize(lhs->GetType());
 
-		if (GetResourceFilePath(key, path))
+		if (valueSize == 0)
 		{
-			logger.WriteLineFormatted(LogLevel::Error,
-				"%s: T:0x%08X G:0x%08X I:0x%08X in %s",
-				message,
-				key.type,
-				key.group,
-				key.instance,
-				path.ToChar());
+			return false;
 		}
-		else
+
+		const size_t count = lhs->GetCount();
+
+		if (count == 0)
 		{
-			logger.WriteLineFormatted(LogLevel::Error,
-				"%s: T:0x%08X G:0x%08X I:0x%08X.",
-				message,
-				key.type,
-				key.group,
-				key.instance);
+			return true;
 		}
+
+		const void* lhsData = GetVariantData(lhs);
+		const void* rhsData = GetVariantData(rhs);
+
+		return lhsData && rhsData && std::memcmp(lhsData, rhsData, count * valueSize) == 0;
 	}
 
-	void ExemplarPatchScanCallback(cGZPersistResourceKey const& key, void* pContext)
+	void LogPatchedProperty(uint32_t id, bool writtenExemplarPatchHeader)
 	{
-		auto context = static_cast<ExemplarPatchScanContext*>(pContext);
+		Logger& logger = Logger::GetInstance();
 
-		cRZAutoRefCount<cISCResExemplarCohort> cohort;
+		// The log lines are indented because ExemplarPatchingServer::ApplyPatches
+		// writes the patched exemplar TGI before this function gets called.
 
-		if (context->pResMan->GetResource(key, GZIID_cISCResExemplarCohort, cohort.AsPPVoid(), 0, nullptr))
+		if (writtenExemplarPatchHeader)
 		{
-			cISCPropertyHolder* propHolder = cohort->AsISCPropertyHolder();
-
-			auto property = propHolder->GetProperty(kExemplarPatchTargetPropertyId);
-
-			if (property)
-			{
-				const cIGZVariant* variant = property->GetPropertyValue();
-				const uint32_t reps = variant->GetCount();
-
-				if (variant->GetType() != cIGZVariant::Type::Uint32Array)
-				{
-					LogExemplarPatchScanError(
-						"Exemplar Patch Target property requires type Uint32Array",
-						key);
-				}
-				else if (reps > 0)
-				{
-					if ((reps % 2) != 0)
-					{
-						LogExemplarPatchScanError(
-							"Exemplar Patch Target property requires even number of values",
-							key);
-					}
-					else
-					{
-						context->loadedExemplarPatchCount++;
-
-						if (context->debugLoggingEnabled)
-						{
-							cRZBaseString path;
-
-							if (GetResourceFilePath(key, path))
-							{
-								Logger& logger = Logger::GetInstance();
-								logger.WriteLineFormatted(
-									LogLevel::Info,
-									"Exemplar patch T=0x%08X, G=0x%08X, I=0x%08X loaded from %s",
-									key.type,
-									key.group,
-									key.instance,
-									path.ToChar());
-							}
-						}
-
-						auto& patches = context->patches;
-						const uint32_t* values = variant->RefUint32();
-
-						for (uint32_t i = 1; i < reps; i += 2)
-						{
-							const cGZPersistResourceKey targetTgi(kExemplarTypeId, values[i - 1], values[i]);
-
-							auto item = patches.find(targetTgi);
-
-							if (item != patches.end())
-							{
-								cRZAutoRefCount<cISCPropertyHolder> containerPropertyHolder(
-									propHolder,
-									cRZAutoRefCount<cISCPropertyHolder>::kAddRef);
-
-								item->second.push_back(std::move(containerPropertyHolder));
-							}
-							else
-							{
-								cRZAutoRefCount<cISCPropertyHolder> containerPropertyHolder(
-									propHolder,
-									cRZAutoRefCount<cISCPropertyHolder>::kAddRef);
-
-								boost::container::deque<cRZAutoRefCount<cISCPropertyHolder>> queue;
-								queue.push_back(std::move(containerPropertyHolder));
-
-								patches.emplace(targetTgi, std::move(queue));
-							}
-						}
-					}
-				}
-			}
+			// The source exemplar patch info was written, so add an extra indent level.
+			logger.WriteLineFormatted(
+				LogLevel::Info,
+				"    Patched property 0x%08X",
+				id);
 		}
 		else
 		{
-			LogExemplarPatchScanError("Exemplar Patch is not a valid cohort", key);
+			logger.WriteLineFormatted(
+				LogLevel::Info,
+				"  Patched property 0x%08X",
+				id);
 		}
 	}
-
-	bool GetResourceKeyAndNameFromExemplarPatch(
-		cISCPropertyHolder* pExemplarPatch,
-		cGZPersistResourceKey& key,
-		cIGZString& filePath)
-	{
-		bool result = false;
-
-		if (pExemplarPatch)
-		{
-			cRZAutoRefCount<cIGZPersistResource> pPersistResource;
-
-			if (pExemplarPatch->QueryInterface(GZIID_cIGZPersistResource, pPersistResource.AsPPVoid()))
-			{
-				pPersistResource->GetKey(key);
-
-				result = GetResourceFilePath(key, filePath);
-			}
-		}
-
-		return result;
-	}
 }
 
 ExemplarPatchingServer::ExemplarPatchingServer()
 	: cRZBaseSystemService(GZSERVID_ExemplarPatchingServer, kExemplarPatchingServerPriority),
-	  debugLoggingEnabled(false)
+	  patches(),
+	  patchesMutex(),
+	  scanner(),
+	  scanMutex(),
+	  scanStateChanged(),
+	  scanThread(),
+	  mainThreadId(),
+	  scanState(ScanState::Idle),
+	  requestedScanGeneration(0),
+	  startedScanGeneration(0),
+	  completedScanGeneration(0),
+	  stopScanThread(false),
+	  scanStartTime(),
+	  initialScanPending(false),
+	  initialScanGeneration(0),
+	  initialScanWaitActive(false),
+	  initialScanMainThreadTime(),
+	  initialScanDuration(),
+	  bundlePath(),
+	  bakedFilePath(),
+	  bakeEnabled(false),
+	  useBakedFile(false),
+	  pruneUnavailableTargets(false),
+	  skipIdenticalProperties(false),
+	  debugLoggingEnabled(false),
+	  totalAppliedPropertyCount(0),
+	  totalSkippedPropertyCount(0)
 {
 }
 
+ExemplarPatchingServer::~ExemplarPatchingServer()
+{
+	if (scanThread.joinable())
+	{
+		// Joining a thread when the DLL is being unloaded can deadlock on the
+		// loader lock, Shutdown stops the thread before that happens.
+		scanThread.detach();
+	}
+}
+
 bool ExemplarPatchingServer::QueryInterface(uint32_t riid, void** ppvObj)
 {
-	if (riid == GZIID_cIExemplarPatchingServer)
+	if (riid == GZIID_cIExemplarPatchingServer2)
+	{
+		*ppvObj = static_cast<cIExemplarPatchingServer2*>(this);
+		AddRef();
+
+		return true;
+	}
+	else if (riid == GZIID_cIExemplarPatchingServer)
 	{
 		*ppvObj = static_cast<cIExemplarPatchingServer*>(this);
 		AddRef();
@@ -353,6 +276,26 @@ bool ExemplarPatchingServer::Init()
 		if (pCmdLine)
 		{
 			debugLoggingEnabled = pCmdLine->IsSwitchPresent(cRZBaseString("exemplar-patch-debug-logging"));
+
+			if (pCmdLine->IsSwitchPresent(cRZBaseString("exemplar-patch-bundle")))
+			{
+				bundlePath = FileSystem::GetDllFolderPath();
+				bundlePath /= BundleFileName;
+			}
+
+			pruneUnavailableTargets = pCmdLine->IsSwitchPresent(cRZBaseString("exemplar-patch-prune-targets"));
+			skipIdenticalProperties = pCmdLine->IsSwitchPresent(cRZBaseString("exemplar-patch-skip-identical"));
+
+			// The bake switch takes precedence, it always scans the exemplar patches
+			// and writes a new baked file.
+			bakeEnabled = pCmdLine->IsSwitchPresent(cRZBaseString("exemplar-patch-bake"));
+			useBakedFile = !bakeEnabled && pCmdLine->IsSwitchPresent(cRZBaseString("exemplar-patch-baked"));
+
+			if (bakeEnabled)
+			{
+				bakedFilePath = FileSystem::GetDllFolderPath();
+				bakedFilePath /= BakedFileName;
+			}
 		}
 	}
 
@@ -360,67 +303,545 @@ bool ExemplarPatchingServer::Init()
 	auto state = pFrameWork->GetState();
 #endif // !NDEBUG
 
-	ScanForExemplarPatches();
+	// The resource manager is only used on the thread that initializes the services,
+	// the rescans that are queued on other threads are processed in OnTick.
+	{
+		std::lock_guard<std::mutex> lock(scanMutex);
+		mainThreadId = std::this_thread::get_id();
+	}
+
+	if (pFrameWork)
+	{
+		SetServiceRunning(true);
+		pFrameWork->AddToTick(this);
+	}
+
+	// Only the step that locates the patch records runs here, the patch files are read on
+	// the scan thread and OnTick finishes the scan. The game does not load the patched
+	// exemplars until a city or region loads, the first exemplar load waits for the scan.
+	const auto requestStartTime = std::chrono::steady_clock::now();
+	initialScanGeneration = RequestScanForExemplarPatches();
+	initialScanMainThreadTime = std::chrono::steady_clock::now() - requestStartTime;
+	initialScanPending.store(true, std::memory_order_release);
 
 	return true;
 }
 
 bool ExemplarPatchingServer::Shutdown()
 {
+	cIGZFrameWork* const pFrameWork = RZGetFrameWork();
+
+	if (pFrameWork)
+	{
+		pFrameWork->RemoveFromTick(this);
+	}
+
+	// The exemplar loads after this point use the patches that the last scan found.
+	initialScanPending.store(false, std::memory_order_release);
+
+	if (scanThread.joinable())
+	{
+		// A file read that is in progress is finished, the queued requests are discarded.
+		{
+			std::lock_guard<std::mutex> lock(scanMutex);
+			stopScanThread = true;
+		}
+		scanStateChanged.notify_all();
+		scanThread.join();
+	}
+
+	if (skipIdenticalProperties)
+	{
+		Logger::GetInstance().WriteLineFormatted(
+			LogLevel::Info,
+			"Applied %llu Exemplar patch properties, skipped %llu properties that had the same value.",
+			static_cast<unsigned long long>(totalAppliedPropertyCount.load()),
+			static_cast<unsigned long long>(totalSkippedPropertyCount.load()));
+	}
+
+	return true;
+}
+
+bool ExemplarPatchingServer::OnTick(uint32_t unknown1)
+{
+	ProcessScanRequests();
+
 	return true;
 }
 
 void ExemplarPatchingServer::ScanForExemplarPatches()
 {
-	auto guard = sync.lock();
+	bool runScanSteps = false;
 
-	cIGZPersistResourceManagerPtr pResMan;
+	{
+		// Before Init there is no main thread to run the scan steps, the caller
+		// runs them itself like the main thread does.
+		std::lock_guard<std::mutex> lock(scanMutex);
+		runScanSteps = mainThreadId == std::thread::id() || std::this_thread::get_id() == mainThreadId;
+	}
+
+	const uint32_t generation = RequestScanForExemplarPatches();
+
+	if (runScanSteps)
+	{
+		// The scan steps that run on this thread never wait for the game,
+		// only the file reads are waited for.
+		WaitForScan(generation, UINT32_MAX, /*runScanSteps*/ true);
+	}
+	else if (!WaitForScan(generation, ScanWaitTimeoutMilliseconds, /*runScanSteps*/ false))
+	{
+		LogScanWaitTimeout();
+	}
+}
+
+uint32_t ExemplarPatchingServer::RequestScanForExemplarPatches()
+{
+	uint32_t generation = 0;
+
+	{
+		std::lock_guard<std::mutex> lock(scanMutex);
 
-	if (pResMan)
+		if (stopScanThread)
+		{
+			return completedScanGeneration;
+		}
+
+		// A request that arrives before the previous request starts is combined with it.
+		if (requestedScanGeneration == startedScanGeneration)
+		{
+			requestedScanGeneration++;
+		}
+
+		generation = requestedScanGeneration;
+	}
+
+	if (IsMainThread())
 	{
-		cRZAutoRefCount<cIGZPersistResourceKeyList> pResourceList;
+		ProcessScanRequests();
+	}
+
+	return generation;
+}
 
-		PersistResourceKeyFilterByTypeAndGroup* filter = new PersistResourceKeyFilterByTypeAndGroup(kCohortTypeId, kExemplarPatchGroupId);
-		filter->AddRef();
-		uint32_t res = pResMan->GetAvailableResourceList(pResourceList.AsPPObj(), filter);
-		filter->Release();
+uint32_t ExemplarPatchingServer::GetCompletedScanGeneration()
+{
+	std::lock_guard<std::mutex> lock(scanMutex);
+
+	return completedScanGeneration;
+}
+
+bool ExemplarPatchingServer::WaitForScan(uint32_t generation, uint32_t timeoutMilliseconds)
+{
+	return WaitForScan(generation, timeoutMilliseconds, IsMainThread());
+}
 
-		uint32_t loadedExemplarPatchCount = 0;
+bool ExemplarPatchingServer::WaitForScan(uint32_t generation, uint32_t timeoutMilliseconds, bool runScanSteps)
+{
+	const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMilliseconds);
+
+	std::unique_lock<std::mutex> lock(scanMutex);
+
+	if (generation > requestedScanGeneration)
+	{
+		return false;
+	}
 
-		if (pResourceList->Size() > 0)
+	while (completedScanGeneration < generation && !stopScanThread)
+	{
+		if (runScanSteps)
 		{
-			ExemplarPatchScanContext context(pResMan, debugLoggingEnabled);
+			if (scanState == ScanState::Beginning || scanState == ScanState::Ending)
+			{
+				// Called by a resource load in one of the scan steps that run on this
+				// thread, waiting would deadlock.
+				break;
+			}
+			else if (scanState == ScanState::Idle || scanState == ScanState::FilesRead)
+			{
+				// The other threads rely on OnTick, this thread runs the next step itself.
+				lock.unlock();
+				ProcessScanRequests();
+				lock.lock();
+				continue;
+			}
+		}
 
-			pResourceList->EnumKeys(ExemplarPatchScanCallback, &context);
+		if (timeoutMilliseconds == UINT32_MAX)
+		{
+			scanStateChanged.wait(lock);
+		}
+		else if (scanStateChanged.wait_until(lock, deadline) == std::cv_status::timeout)
+		{
+			break;
+		}
+	}
 
-			loadedExemplarPatchCount = context.loadedExemplarPatchCount;
-			patches.clear();
-			patches = std::move(context.patches);
+	return completedScanGeneration >= generation;
+}
+
+void ExemplarPatchingServer::LogScanWaitTimeout()
+{
+	{
+		std::lock_guard<std::mutex> lock(scanMutex);
+
+		if (stopScanThread)
+		{
+			// The wait was ended by Shutdown.
+			return;
 		}
+	}
 
-		Logger& logger = Logger::GetInstance();
+	Logger::GetInstance().WriteLineFormatted(
+		LogLevel::Error,
+		"The Exemplar patch scan did not finish within %u ms, the main thread has not processed it.",
+		ScanWaitTimeoutMilliseconds);
+}
+
+void ExemplarPatchingServer::WaitForInitialScan()
+{
+	if (IsMainThread())
+	{
+		if (initialScanWaitActive)
+		{
+			// A load in one of the scan steps that the outer wait runs.
+			return;
+		}
+
+		// The wait includes the scan steps that it runs on this thread.
+		initialScanWaitActive = true;
+		const auto waitStartTime = std::chrono::steady_clock::now();
+
+		WaitForScan(initialScanGeneration, UINT32_MAX, /*runScanSteps*/ true);
+
+		initialScanMainThreadTime += std::chrono::steady_clock::now() - waitStartTime;
+		initialScanWaitActive = false;
+
+		if (!initialScanPending.load(std::memory_order_acquire))
+		{
+			LogInitialScanTime();
+		}
+	}
+	else if (!WaitForScan(initialScanGeneration, ScanWaitTimeoutMilliseconds, /*runScanSteps*/ false))
+	{
+		LogScanWaitTimeout();
+	}
+}
+
+void ExemplarPatchingServer::CompleteInitialScan(
+	std::chrono::steady_clock::duration endScanDuration,
+	std::chrono::steady_clock::duration scanDuration)
+{
+	initialScanDuration = scanDuration;
+	initialScanPending.store(false, std::memory_order_release);
+
+	if (!initialScanWaitActive)
+	{
+		// Finished by OnTick, WaitForInitialScan logs the scans that it finishes.
+		initialScanMainThreadTime += endScanDuration;
+		LogInitialScanTime();
+	}
+}
+
+void ExemplarPatchingServer::LogInitialScanTime() const
+{
+	const long long scanMilliseconds = std::chrono::duration_cast<std::chrono::milliseconds>(
+		initialScanDuration).count();
+	const long long mainThreadMilliseconds = std::chrono::duration_cast<std::chrono::milliseconds>(
+		initialScanMainThreadTime).count();
+
+	Logger::GetInstance().WriteLineFormatted(
+		LogLevel::Info,
+		"The initial Exemplar patch scan took %lld ms, the main thread spent %lld ms in it."
+		" Scanning in the background saved %lld ms of main thread time.",
+		scanMilliseconds,
+		mainThreadMilliseconds,
+		std::max(scanMilliseconds - mainThreadMilliseconds, 0LL));
+}
+
+bool ExemplarPatchingServer::IsMainThread() const
+{
+	return std::this_thread::get_id() == mainThreadId;
+}
+
+void ExemplarPatchingServer::ProcessScanRequests()
+{
+	std::unique_lock<std::mutex> lock(scanMutex);
+
+	if (scanState == ScanState::FilesRead)
+	{
+		scanState = ScanState::Ending;
+		lock.unlock();
+
+		const auto endScanStartTime = std::chrono::steady_clock::now();
+		EndScan();
+		const auto endScanFinishTime = std::chrono::steady_clock::now();
+
+		lock.lock();
+		completedScanGeneration = startedScanGeneration;
+		scanState = ScanState::Idle;
+		scanStateChanged.notify_all();
+
+		if (initialScanPending.load(std::memory_order_relaxed) && completedScanGeneration >= initialScanGeneration)
+		{
+			lock.unlock();
+
+			CompleteInitialScan(endScanFinishTime - endScanStartTime, endScanFinishTime - scanStartTime);
+
+			lock.lock();
+		}
+	}
+
+	if (scanState == ScanState::Idle && requestedScanGeneration != startedScanGeneration && !stopScanThread)
+	{
+		startedScanGeneration = requestedScanGeneration;
+		scanState = ScanState::Beginning;
+		lock.unlock();
+
+		BeginScan();
+
+		lock.lock();
+
+		if (!scanThread.joinable())
+		{
+			scanThread = std::thread(&ExemplarPatchingServer::ScanThreadProc, this);
+		}
+
+		scanState = ScanState::ReadingFiles;
+		scanStateChanged.notify_all();
+	}
+}
+
+void ExemplarPatchingServer::ScanThreadProc()
+{
+	std::unique_lock<std::mutex> lock(scanMutex);
+
+	while (true)
+	{
+		scanStateChanged.wait(lock, [&] { return stopScanThread || scanState == ScanState::ReadingFiles; });
+
+		if (stopScanThread)
+		{
+			break;
+		}
+
+		lock.unlock();
+
+		// Only the DBPF files are read on this thread, the scanner does not use
+		// the resource manager or the index in this step.
+		scanner->ReadFiles();
+
+		lock.lock();
+
+		scanState = ScanState::FilesRead;
+		scanStateChanged.notify_all();
+	}
+}
+
+void ExemplarPatchingServer::BeginScan()
+{
+	scanStartTime = std::chrono::steady_clock::now();
+
+	if (!scanner)
+	{
+		cIGZPersistResourceManagerPtr pResMan;
+
+		scanner = std::make_unique<ExemplarPatchScanner>(pResMan, debugLoggingEnabled);
+		scanner->SetBundlePath(bundlePath);
+		scanner->SetPruneUnavailableTargets(pruneUnavailableTargets);
+		scanner->SetUseBakedFile(useBakedFile);
+	}
+
+	scanner->BeginScan();
+}
+
+void ExemplarPatchingServer::EndScan()
+{
+	// The cohorts that the native parser could not read are loaded by the game
+	// before the index is locked.
+	scanner->LoadGamePatches();
+
+	bool bake = false;
+	size_t targetCount = 0;
+	size_t targetRangeCount = 0;
+	size_t typeTargetCount = 0;
+
+	{
+		// The changes are applied to the index in place, the exemplar loads wait
+		// until the scan has finished updating it.
+		std::unique_lock<std::shared_mutex> lock(patchesMutex);
+
+		bake = scanner->EndScan(patches) && bakeEnabled;
+		targetCount = patches.GetTargetCount();
+		targetRangeCount = patches.GetRanges().GetRangeCount();
+		typeTargetCount = patches.GetTypeTargets().GetTargetCount();
+	}
+
+	if (bake)
+	{
+		// The index is only modified on this thread, it can be read without the lock.
+		BakeExemplarPatches(patches);
+	}
+
+	if (PerformanceCounters::IsEnabled())
+	{
+		PerformanceCounters::Add(
+			PerformanceCounter::ExemplarPatchScan,
+			static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+				std::chrono::steady_clock::now() - scanStartTime).count()));
+	}
+
+	Logger& logger = Logger::GetInstance();
+	logger.WriteLineFormatted(LogLevel::Info,
+		"Loaded %u Exemplar patches targeting, in total, %zu Exemplar files.",
+		scanner->GetLoadedExemplarPatchCount(),
+		targetCount);
+
+	if (targetRangeCount > 0)
+	{
+		logger.WriteLineFormatted(LogLevel::Info,
+			"The Exemplar patches also target %zu Exemplar instance ID ranges.",
+			targetRangeCount);
+	}
+
+	if (typeTargetCount > 0)
+	{
 		logger.WriteLineFormatted(LogLevel::Info,
-			"Loaded %u Exemplar patches targeting, in total, %u Exemplar files.",
-			loadedExemplarPatchCount,
-			patches.size());
+			"The Exemplar patches also target %zu Exemplar types.",
+			typeTargetCount);
+	}
+}
+
+void ExemplarPatchingServer::BakeExemplarPatches(const ExemplarPatchIndex& index)
+{
+	Logger& logger = Logger::GetInstance();
+
+	uint64_t fingerprint = 0;
+
+	if (!scanner->TryGetFingerprint(fingerprint))
+	{
+		logger.WriteLine(LogLevel::Error, "Failed to bake the Exemplar patches, the patch files could not be fingerprinted.");
+		return;
+	}
+
+	if (!scanner->GetInstalledBakedFilePath().empty())
+	{
+		// The game would read the target exemplars from the installed baked file.
+		logger.WriteLineFormatted(
+			LogLevel::Error,
+			"Failed to bake the Exemplar patches, remove the installed baked file before baking: %s",
+			scanner->GetInstalledBakedFilePath().string().c_str());
+		return;
+	}
+
+	if (!index.GetTypeTargets().Empty())
+	{
+		// The exemplar type and conditions are only known when the game loads the exemplar.
+		logger.WriteLine(LogLevel::Error, "Failed to bake the Exemplar patches, the patches that target an Exemplar type cannot be baked.");
+		return;
+	}
+
+	cIGZPersistResourceManagerPtr pResMan;
+
+	ExemplarPatchBaker baker(pResMan);
+
+	if (baker.Bake(index, fingerprint, bakedFilePath))
+	{
+		logger.WriteLineFormatted(
+			LogLevel::Info,
+			"Baked %u patched Exemplar files to %s, skipped %u Exemplar files that are not in a DBPF file."
+			" Install the file as a .dat plugin that loads after the patched plugins to use it.",
+			baker.GetBakedExemplarCount(),
+			bakedFilePath.string().c_str(),
+			baker.GetSkippedExemplarCount());
+	}
+	else
+	{
+		logger.WriteLineFormatted(
+			LogLevel::Error,
+			"Failed to write the baked Exemplar patch file: %s",
+			bakedFilePath.string().c_str());
 	}
 }
 
 void ExemplarPatchingServer::ApplyPatches(const cGZPersistResourceKey& key, cISCResExemplar* pExemplar)
 {
-	auto guard = sync.lock();
+	if (initialScanPending.load(std::memory_order_acquire) && patchesReadDepth == 0)
+	{
+		// The scan takes the exclusive lock when it finishes, wait before taking the shared lock.
+		WaitForInitialScan();
+	}
+
+	// A scan only holds the exclusive lock while it updates the index.
+	// The calls into the game below (GetProperty, AddProperty and FindDBSegment) do not
+	// load resources, but a nested load on this thread reuses the outer lock.
+	std::shared_lock<std::shared_mutex> lock(patchesMutex, std::defer_lock);
+
+	if (patchesReadDepth == 0)
+	{
+		lock.lock();
+	}
+
+	patchesReadDepth++;
+
+	struct ReadDepthGuard
+	{
+		~ReadDepthGuard()
+		{
+			patchesReadDepth--;
+		}
+	} readDepthGuard;
+
+	const ExemplarPatchIndex& index = patches;
+
+	ExemplarPatchIndex::PatchList patchList;
+	// The patches that target the exemplar through its type or an instance range.
+	// The list is only allocated when a patch matches.
+	std::vector<const ExemplarPatch*> indirectPatches;
+
+	{
+		ScopedPerformanceTimer lookupTimer(PerformanceCounter::ExemplarPatchLookupMiss);
+
+		patchList = index.Find(key);
+
+		const ExemplarPatchTypeIndex& typeTargets = index.GetTypeTargets();
+
+		if (!typeTargets.Empty())
+		{
+			// The type patches are selected by the Exemplar Type that the exemplar was loaded with,
+			// the load notifications are sent after patching and see the patched type.
+			ExemplarTypeReader exemplarTypeReader(pExemplar->AsISCPropertyHolder());
+			uint32_t exemplarType = 0;
 
-	const auto item = patches.find(key);
+			if (exemplarTypeReader.TryGetExemplarType(exemplarType))
+			{
+				typeTargets.Find(exemplarType, pExemplar->AsISCPropertyHolder(), indirectPatches);
+			}
+		}
+
+		const ExemplarPatchRangeIndex& ranges = index.GetRanges();
+
+		if (!ranges.Empty())
+		{
+			ranges.Find(key, indirectPatches);
+		}
+
+		if (!patchList.empty() || !indirectPatches.empty())
+		{
+			lookupTimer.SetCounter(PerformanceCounter::ExemplarPatchLookupHit);
+		}
+	}
 
-	if (item != patches.end())
+	if (!patchList.empty() || !indirectPatches.empty())
 	{
+		ScopedPerformanceTimer applyTimer(PerformanceCounter::ExemplarPatchApply);
+
 		if (debugLoggingEnabled)
 		{
 			Logger& logger = Logger::GetInstance();
 
 			cRZBaseString path;
 
-			if (GetResourceFilePath(key, path))
+			if (PersistResourceUtil::GetResourceFilePath(key, path))
 			{
 				logger.WriteLineFormatted(
 					LogLevel::Info,
@@ -441,38 +862,99 @@ void ExemplarPatchingServer::ApplyPatches(const cGZPersistResourceKey& key, cISC
 			}
 		}
 
-		ApplyPatchContext context(pExemplar->AsISCPropertyHolder(), debugLoggingEnabled);
+		cISCPropertyHolder* const pTarget = pExemplar->AsISCPropertyHolder();
+		uint32_t appliedPropertyCount = 0;
+		uint32_t skippedPropertyCount = 0;
 
-		for (auto& patch : item->second)
+		const auto applyPatch = [&](const ExemplarPatch* patch)
 		{
+			bool writtenExemplarPatchHeader = false;
+
 			if (debugLoggingEnabled)
 			{
-				cGZPersistResourceKey key;
-				cRZBaseString path;
+				// The scan recorded the file that each patch was loaded from.
+				const cGZPersistResourceKey& patchKey = patch->GetKey();
+				const ExemplarPatchSourceIndex& sources = index.GetSources();
+				const ExemplarPatchSourceIndex::Source* source = sources.Find(patchKey);
+				const std::string* path = source ? sources.GetFilePath(*source) : nullptr;
 
-				if (GetResourceKeyAndNameFromExemplarPatch(
-					patch,
-					key,
-					path))
+				if (path)
 				{
 					Logger& logger = Logger::GetInstance();
 					logger.WriteLineFormatted(
 						LogLevel::Info,
 						"  Applying exemplar patch T=0x%08X, G=0x%08X, I=0x%08X from %s",
-						key.type,
-						key.group,
-						key.instance,
-						path.ToChar());
+						patchKey.type,
+						patchKey.group,
+						patchKey.instance,
+						path->c_str());
 
-					context.writtenExemplarPatchHeader = true;
+					writtenExemplarPatchHeader = true;
 				}
-				else
+			}
+
+			for (const auto& property : patch->GetProperties())
+			{
+				if (skipIdenticalProperties)
 				{
-					context.writtenExemplarPatchHeader = false;
+					// Replacing a property makes the game allocate a new property object,
+					// that is avoided when the exemplar already has the same value.
+					const cISCProperty* existing = pTarget->GetProperty(property->GetPropertyID());
+
+					if (existing && HasSameValue(existing->GetPropertyValue(), property->GetPropertyValue()))
+					{
+						skippedPropertyCount++;
+						continue;
+					}
 				}
+
+				pTarget->AddProperty(property, /*bSendMsg*/ false);  // `true` results in a crash
+				appliedPropertyCount++;
+
+				if (debugLoggingEnabled)
+				{
+					LogPatchedProperty(property->GetPropertyID(), writtenExemplarPatchHeader);
+				}
+			}
+		};
+
+		if (indirectPatches.empty())
+		{
+			for (const auto& patch : patchList)
+			{
+				applyPatch(patch.get());
 			}
+		}
+		else
+		{
+			// All of the patches are applied in load order, so the last loaded patch
+			// wins regardless of how it targets the exemplar.
+			for (const auto& patch : patchList)
+			{
+				indirectPatches.push_back(patch.get());
+			}
+
+			index.SortByLoadOrder(indirectPatches);
 
-			patch->EnumProperties(ApplyPatchCallback, &context);
+			for (const ExemplarPatch* patch : indirectPatches)
+			{
+				applyPatch(patch);
+			}
+		}
+
+		if (skipIdenticalProperties)
+		{
+			totalAppliedPropertyCount.fetch_add(appliedPropertyCount, std::memory_order_relaxed);
+			totalSkippedPropertyCount.fetch_add(skippedPropertyCount, std::memory_order_relaxed);
+
+			if (debugLoggingEnabled)
+			{
+				Logger::GetInstance().WriteLineFormatted(
+					LogLevel::Info,
+					"  Applied %u properties, skipped %u properties that had the same value",
+					appliedPropertyCount,
+					skippedPropertyCount);
+			}
 		}
 	}
 }
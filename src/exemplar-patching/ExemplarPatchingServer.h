@@ -23,29 +23,32 @@
 #include "cRZBaseUnknown.h"
 #include "cRZBaseSystemService.h"
 #include "cGZPersistResourceKey.h"
-#include "cIExemplarPatchingServer.h"
+#include "cIExemplarPatchingServer2.h"
 #include "cISCPropertyHolder.h"
 #include "cISCResExemplar.h"
 #include "cRZAutoRefCount.h"
+#include "ExemplarPatchIndex.h"
+#include "ExemplarPatchScanner.h"
 #include "IApplyExemplarPatch.h"
-#include "PersistResourceKeyBoostHash.h"
-
-#include "boost/container/deque.hpp"
-#include "boost/unordered/unordered_flat_map.hpp"
-
-#include "wil/resource.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
 
 class ExemplarPatchingServer
 	: public cRZBaseUnknown,
 	  public cRZBaseSystemService,
-	  private cIExemplarPatchingServer,
+	  private cIExemplarPatchingServer2,
 	  private IApplyExemplarPatch
 {
 public:
 
-	using PatchContainer = boost::unordered_flat_map<const cGZPersistResourceKey, boost::container::deque<cRZAutoRefCount<cISCPropertyHolder>>>;
-
 	ExemplarPatchingServer();
+	~ExemplarPatchingServer();
 
 	// cRZBaseUnknown
 	bool QueryInterface(uint32_t riid, void** ppvObj) override;
@@ -58,18 +61,88 @@ private:
 
 	bool Init() override;
 	bool Shutdown() override;
+	bool OnTick(uint32_t unknown1) override;
 
 	// cIExemplarPatchingServer
 
 	void ScanForExemplarPatches() override;
 
+	// cIExemplarPatchingServer2
+
+	uint32_t RequestScanForExemplarPatches() override;
+	uint32_t GetCompletedScanGeneration() override;
+	bool WaitForScan(uint32_t generation, uint32_t timeoutMilliseconds) override;
+
 	// IExemplarPatchService
 
 	void ApplyPatches(const cGZPersistResourceKey& key, cISCResExemplar* pExemplar) override;
 
+	// Private functions
+
+	// The main thread, or a caller that runs before Init, runs the scan steps itself
+	// instead of waiting for OnTick.
+	bool WaitForScan(uint32_t generation, uint32_t timeoutMilliseconds, bool runScanSteps);
+	void LogScanWaitTimeout();
+	void WaitForInitialScan();
+	void CompleteInitialScan(
+		std::chrono::steady_clock::duration endScanDuration,
+		std::chrono::steady_clock::duration scanDuration);
+	void LogInitialScanTime() const;
+	bool IsMainThread() const;
+	// Runs the scan steps that use the resource manager, must be called on the main thread.
+	void ProcessScanRequests();
+	void ScanThreadProc();
+	void BeginScan();
+	void EndScan();
+	void BakeExemplarPatches(const ExemplarPatchIndex& index);
+
 	// Private members
 
-	PatchContainer patches;
-	wil::critical_section sync;
+	enum class ScanState
+	{
+		Idle,
+		// The main thread is locating the exemplar patch records.
+		Beginning,
+		// The scan thread is reading the DBPF files.
+		ReadingFiles,
+		// The main thread has not yet applied the files that were read.
+		FilesRead,
+		// The main thread is loading the remaining patches and updating the index.
+		Ending,
+	};
+
+	// The exemplar loads read the index under a shared lock, the scans update
+	// it in place under the exclusive lock. Neither lock is held across a resource
+	// load: the scanner loads the game cohorts before EndScan takes the exclusive lock.
+	// scanMutex only guards the scan state and is never held while calling the game.
+	ExemplarPatchIndex patches;
+	std::shared_mutex patchesMutex;
+	// The scan steps never overlap, only ReadFiles runs on the scan thread.
+	std::unique_ptr<ExemplarPatchScanner> scanner;
+	std::mutex scanMutex;
+	std::condition_variable scanStateChanged;
+	std::thread scanThread;
+	std::thread::id mainThreadId;
+	ScanState scanState;
+	uint32_t requestedScanGeneration;
+	uint32_t startedScanGeneration;
+	uint32_t completedScanGeneration;
+	bool stopScanThread;
+	std::chrono::steady_clock::time_point scanStartTime;
+	// Init starts the initial scan, the exemplar loads wait for it while the flag is set.
+	// The wait and the main thread time are only updated on the main thread.
+	std::atomic<bool> initialScanPending;
+	uint32_t initialScanGeneration;
+	bool initialScanWaitActive;
+	std::chrono::steady_clock::duration initialScanMainThreadTime;
+	std::chrono::steady_clock::duration initialScanDuration;
+	std::filesystem::path bundlePath;
+	std::filesystem::path bakedFilePath;
+	bool bakeEnabled;
+	bool useBakedFile;
+	bool pruneUnavailableTargets;
+	bool skipIdenticalProperties;
 	bool debugLoggingEnabled;
+	std::atomic<uint64_t> totalAppliedPropertyCount;
+	std::atomic<uint64_t> totalSkippedPropertyCount;
 };
\ No newline at end of file
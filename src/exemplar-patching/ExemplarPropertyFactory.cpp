@@ -0,0 +1,136 @@
+/*
+ * This file is part of sc4-resource-loading-hooks, a DLL Plugin for SimCity 4
+ * that allows other DLLs to modify resources as the game loads them.
+ *
+ * Copyright (C) 2024, 2025 Nicholas Hayes
+ *
+ * sc4-resource-loading-hooks is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * sc4-resource-loading-hooks is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with sc4-resource-loading-hooks.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ExemplarPropertyFactory.h"
+#include "cRZBaseVariant.h"
+#include "cSCBaseProperty.h"
+#include <cstring>
+
+namespace
+{
+	// Copies the values to an aligned buffer, the values in the file may be unaligned.
+	template<typename T>
+	const T* GetAlignedValues(const ExemplarPropertyView& view, std::vector<uint64_t>& buffer)
+	{
+		const size_t size = static_cast<size_t>(view.count) * sizeof(T);
+
+		buffer.resize((size + sizeof(uint64_t) - 1) / sizeof(uint64_t));
+		std::memcpy(buffer.data(), view.values, size);
+
+		return reinterpret_cast<const T*>(buffer.data());
+	}
+
+	void SetArrayValue(cIGZVariant& variant, const ExemplarPropertyView& view, std::vector<uint64_t>& buffer)
+	{
+		switch (view.type)
+		{
+		case ExemplarFormat::ValueType::Uint8:
+			variant.SetValUint8(view.values, view.count);
+			break;
+		case ExemplarFormat::ValueType::Uint16:
+			variant.SetValUint16(GetAlignedValues<uint16_t>(view, buffer), view.count);
+			break;
+		case ExemplarFormat::ValueType::Uint32:
+			variant.SetValUint32(GetAlignedValues<uint32_t>(view, buffer), view.count);
+			break;
+		case ExemplarFormat::ValueType::Sint32:
+			variant.SetValSint32(GetAlignedValues<int32_t>(view, buffer), view.count);
+			break;
+		case ExemplarFormat::ValueType::Sint64:
+			variant.SetValSint64(GetAlignedValues<int64_t>(view, buffer), view.count);
+			break;
+		case ExemplarFormat::ValueType::Float32:
+			variant.SetValFloat32(GetAlignedValues<float>(view, buffer), view.count);
+			break;
+		case ExemplarFormat::ValueType::Bool:
+		{
+			// The size of bool is implementation-defined, the file format uses 1 byte.
+			buffer.resize((view.count + sizeof(uint64_t) - 1) / sizeof(uint64_t));
+			bool* values = reinterpret_cast<bool*>(buffer.data());
+
+			for (uint32_t i = 0; i < view.count; i++)
+			{
+				values[i] = view.values[i] != 0;
+			}
+
+			variant.SetValBool(values, view.count);
+			break;
+		}
+		case ExemplarFormat::ValueType::String:
+			variant.SetValRZChar(reinterpret_cast<const char*>(view.values), view.count);
+			break;
+		}
+	}
+
+	void SetSingleValue(cIGZVariant& variant, const ExemplarPropertyView& view)
+	{
+		switch (view.type)
+		{
+		case ExemplarFormat::ValueType::Uint8:
+			variant.SetValUint8(view.GetValue<uint8_t>(0));
+			break;
+		case ExemplarFormat::ValueType::Uint16:
+			variant.SetValUint16(view.GetValue<uint16_t>(0));
+			break;
+		case ExemplarFormat::ValueType::Uint32:
+			variant.SetValUint32(view.GetValue<uint32_t>(0));
+			break;
+		case ExemplarFormat::ValueType::Sint32:
+			variant.SetValSint32(view.GetValue<int32_t>(0));
+			break;
+		case ExemplarFormat::ValueType::Sint64:
+			variant.SetValSint64(view.GetValue<int64_t>(0));
+			break;
+		case ExemplarFormat::ValueType::Float32:
+			variant.SetValFloat32(view.GetValue<float>(0));
+			break;
+		case ExemplarFormat::ValueType::Bool:
+			variant.SetValBool(view.values[0] != 0);
+			break;
+		case ExemplarFormat::ValueType::String:
+			variant.SetValRZChar(reinterpret_cast<const char*>(view.values), view.count);
+			break;
+		}
+	}
+}
+
+ExemplarPropertyFactory::ExemplarPropertyFactory()
+	: valueBuffer()
+{
+}
+
+cRZAutoRefCount<cISCProperty> ExemplarPropertyFactory::Create(const ExemplarPropertyView& view)
+{
+	cRZBaseVariant variant;
+
+	if (view.isArray)
+	{
+		SetArrayValue(variant, view, valueBuffer);
+	}
+	else
+	{
+		SetSingleValue(variant, view);
+	}
+
+	return cRZAutoRefCount<cISCProperty>(
+		new cSCBaseProperty(view.id, &variant),
+		cRZAutoRefCount<cISCProperty>::kAddRef);
+}
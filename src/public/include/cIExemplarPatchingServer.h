@@ -37,6 +37,9 @@ public:
 	/**
 	 * @brief Allows DLLs that dynamically load and unload DBPF
 	 * plugins to request a new scan for exemplar patches.
+	 *
+	 * Only the DBPF files that were added or changed since the
+	 * previous scan are read.
 	 */
 	virtual void ScanForExemplarPatches() = 0;
 };
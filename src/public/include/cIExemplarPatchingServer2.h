@@ -0,0 +1,70 @@
+/*
+* The public header for the sc4-resource-loading-hooks
+* cIExemplarPatchingServer2 interface.
+* This file is licensed under terms of the MIT License.
+*
+* Copyright (c) 2024, 2025 Nicholas Hayes
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+#pragma once
+#include "cIExemplarPatchingServer.h"
+
+static const uint32_t GZIID_cIExemplarPatchingServer2 = 0x4A7E21D3;
+
+/**
+ * @brief Extends cIExemplarPatchingServer with scans that run on a background thread.
+ */
+class cIExemplarPatchingServer2 : public cIExemplarPatchingServer
+{
+public:
+
+	/**
+	 * @brief Queues a scan for exemplar patches and returns without waiting for it.
+	 *
+	 * The DBPF files are read on a background thread, the scan steps that use
+	 * the game's resource manager run on the main thread when the service is
+	 * ticked. The requests that arrive before the scan starts are combined into
+	 * a single scan. The exemplars that are loaded during the scan use the
+	 * previous exemplar patches.
+	 * @return The scan generation that will include this request.
+	 */
+	virtual uint32_t RequestScanForExemplarPatches() = 0;
+
+	/**
+	 * @brief Gets the generation of the last completed scan.
+	 * @return The generation of the last completed scan, or 0 if no scan
+	 * has completed.
+	 */
+	virtual uint32_t GetCompletedScanGeneration() = 0;
+
+	/**
+	 * @brief Waits for a scan generation to complete.
+	 *
+	 * When called on the main thread, the scan steps that use the resource
+	 * manager are run by this method. Returns false without waiting when it
+	 * is called by a resource load that one of those steps started.
+	 * @param generation The value returned by RequestScanForExemplarPatches.
+	 * @param timeoutMilliseconds The maximum time to wait, or 0xFFFFFFFF to
+	 * wait until the scan completes.
+	 * @return true if the scan completed; otherwise, false.
+	 */
+	virtual bool WaitForScan(uint32_t generation, uint32_t timeoutMilliseconds) = 0;
+};
@@ -0,0 +1,138 @@
+/*
+ * This file is part of sc4-resource-loading-hooks, a DLL Plugin for SimCity 4
+ * that allows other DLLs to modify resources as the game loads them.
+ *
+ * Copyright (C) 2024, 2025 Nicholas Hayes
+ *
+ * sc4-resource-loading-hooks is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * sc4-resource-loading-hooks is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with sc4-resource-loading-hooks.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ExemplarLoadTargetRegistry.h"
+#include "cIExemplarLoadHookTarget.h"
+#include "cIExemplarLoadErrorHookTarget.h"
+
+ExemplarLoadTargetRegistry::ExemplarLoadTargetRegistry()
+	: exemplarLoadTargets(),
+	  exemplarLoadErrorTargets()
+{
+}
+
+bool ExemplarLoadTargetRegistry::AddLoadTarget(
+	cIExemplarLoadHookTarget* target,
+	uint32_t requestedGroupID,
+	uint32_t requestedInstanceID)
+{
+	bool result = false;
+
+	if (target)
+	{
+		result = exemplarLoadTargets.emplace(target, ExemplarTGIFilter(requestedGroupID, requestedInstanceID)).second;
+	}
+
+	return result;
+}
+
+bool ExemplarLoadTargetRegistry::RemoveLoadTarget(cIExemplarLoadHookTarget* target)
+{
+	bool result = false;
+
+	if (target)
+	{
+		result = exemplarLoadTargets.erase(target) == 1;
+	}
+
+	return result;
+}
+
+bool ExemplarLoadTargetRegistry::AddLoadErrorTarget(cIExemplarLoadErrorHookTarget* target)
+{
+	bool result = false;
+
+	if (target)
+	{
+		result = exemplarLoadErrorTargets.emplace(target).second;
+	}
+
+	return result;
+}
+
+bool ExemplarLoadTargetRegistry::RemoveLoadErrorTarget(cIExemplarLoadErrorHookTarget* target)
+{
+	bool result = false;
+
+	if (target)
+	{
+		result = exemplarLoadErrorTargets.erase(target) == 1;
+	}
+
+	return result;
+}
+
+void ExemplarLoadTargetRegistry::ExemplarLoaded(
+	const char* const originalFunctionName,
+	const cGZPersistResourceKey& key,
+	cISCResExemplar* resExemplar) const
+{
+	if (exemplarLoadTargets.size() > 0)
+	{
+		for (const auto& item : exemplarLoadTargets)
+		{
+			cIExemplarLoadHookTarget* const temp = item.first;
+			const ExemplarTGIFilter& filter = item.second;
+
+			if (temp && filter.IsIncluded(key))
+			{
+				temp->ExemplarLoaded(originalFunctionName, key, resExemplar);
+			}
+		}
+	}
+}
+
+void ExemplarLoadTargetRegistry::LoadError(
+	const char* const originalFunctionName,
+	uint32_t riid) const
+{
+	if (exemplarLoadErrorTargets.size() > 0)
+	{
+		for (cIExemplarLoadErrorHookTarget* pTarget : exemplarLoadErrorTargets)
+		{
+			cIExemplarLoadErrorHookTarget* const temp = pTarget;
+
+			if (temp)
+			{
+				temp->LoadError(originalFunctionName, riid);
+			}
+		}
+	}
+}
+
+void ExemplarLoadTargetRegistry::LoadError(
+	const char* const originalFunctionName,
+	uint32_t riid,
+	const cGZPersistResourceKey& key) const
+{
+	if (exemplarLoadErrorTargets.size() > 0)
+	{
+		for (cIExemplarLoadErrorHookTarget* pTarget : exemplarLoadErrorTargets)
+		{
+			cIExemplarLoadErrorHookTarget* const temp = pTarget;
+
+			if (temp)
+			{
+				temp->LoadError(originalFunctionName, riid, key);
+			}
+		}
+	}
+}
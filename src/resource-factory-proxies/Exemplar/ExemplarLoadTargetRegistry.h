@@ -0,0 +1,70 @@
+/*
+ * This file is part of sc4-resource-loading-hooks, a DLL Plugin for SimCity 4
+ * that allows other DLLs to modify resources as the game loads them.
+ *
+ * Copyright (C) 2024, 2025 Nicholas Hayes
+ *
+ * sc4-resource-loading-hooks is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * sc4-resource-loading-hooks is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with sc4-resource-loading-hooks.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#include "ExemplarTGIFilter.h"
+#include <cstdint>
+#include <unordered_map>
+#include <unordered_set>
+
+class cGZPersistResourceKey;
+class cIExemplarLoadHookTarget;
+class cIExemplarLoadErrorHookTarget;
+class cISCResExemplar;
+
+// Tracks the subscribers for the exemplar load and load error notifications,
+// and dispatches the notifications to them.
+class ExemplarLoadTargetRegistry
+{
+public:
+
+	ExemplarLoadTargetRegistry();
+
+	bool AddLoadTarget(
+		cIExemplarLoadHookTarget* target,
+		uint32_t requestedGroupID,
+		uint32_t requestedInstanceID);
+
+	bool RemoveLoadTarget(cIExemplarLoadHookTarget* target);
+
+	bool AddLoadErrorTarget(cIExemplarLoadErrorHookTarget* target);
+
+	bool RemoveLoadErrorTarget(cIExemplarLoadErrorHookTarget* target);
+
+	void ExemplarLoaded(
+		const char* const originalFunctionName,
+		const cGZPersistResourceKey& key,
+		cISCResExemplar* resExemplar) const;
+
+	void LoadError(
+		const char* const originalFunctionName,
+		uint32_t riid) const;
+
+	void LoadError(
+		const char* const originalFunctionName,
+		uint32_t riid,
+		const cGZPersistResourceKey& key) const;
+
+private:
+
+	std::unordered_map<cIExemplarLoadHookTarget*, ExemplarTGIFilter> exemplarLoadTargets;
+	std::unordered_set<cIExemplarLoadErrorHookTarget*> exemplarLoadErrorTargets;
+};
@@ -20,11 +20,10 @@
  */
 
 #include "ExemplarResourceFactoryProxy.h"
-#include "cIExemplarLoadHookTarget.h"
-#include "cIExemplarLoadErrorHookTarget.h"
 #include "cIGZPersistResource.h"
 #include "cISCResExemplar.h"
 #include "cRZAutoRefCount.h"
+#include "PerformanceCounters.h"
 
 static constexpr uint32_t GZCLSID_SCResExemplarFactory = 0x453429B3;
 
@@ -75,50 +74,22 @@ bool ExemplarResourceFactoryProxy::AddLoadNotification(
 	uint32_t requestedGroupID,
 	uint32_t requestedInstanceID)
 {
-	bool result = false;
-
-	if (target)
-	{
-		result = exemplarLoadTargets.emplace(target, ExemplarTGIFilter(requestedGroupID, requestedInstanceID)).second;
-	}
-
-	return result;
+	return loadTargets.AddLoadTarget(target, requestedGroupID, requestedInstanceID);
 }
 
 bool ExemplarResourceFactoryProxy::RemoveLoadNotification(cIExemplarLoadHookTarget* target)
 {
-	bool result = false;
-
-	if (target)
-	{
-		result = exemplarLoadTargets.erase(target) == 1;
-	}
-
-	return result;
+	return loadTargets.RemoveLoadTarget(target);
 }
 
 bool ExemplarResourceFactoryProxy::AddLoadErrorNotification(cIExemplarLoadErrorHookTarget* target)
 {
-	bool result = false;
-
-	if (target)
-	{
-		result = exemplarLoadErrorTargets.emplace(target).second;
-	}
-
-	return result;
+	return loadTargets.AddLoadErrorTarget(target);
 }
 
 bool ExemplarResourceFactoryProxy::RemoveLoadErrorNotification(cIExemplarLoadErrorHookTarget* target)
 {
-	bool result = false;
-
-	if (target)
-	{
-		result = exemplarLoadErrorTargets.erase(target) == 1;
-	}
-
-	return result;
+	return loadTargets.RemoveLoadErrorTarget(target);
 }
 
 void ExemplarResourceFactoryProxy::ResourceLoaded(
@@ -138,19 +109,9 @@ void ExemplarResourceFactoryProxy::ResourceLoaded(
 		{
 			exemplarPatcher->ApplyPatches(key, resExemplar);
 
-			if (exemplarLoadTargets.size() > 0)
-			{
-				for (const auto& item : exemplarLoadTargets)
-				{
-					cIExemplarLoadHookTarget* const temp = item.first;
-					const ExemplarTGIFilter& filter = item.second;
-
-					if (temp && filter.IsIncluded(key))
-					{
-						temp->ExemplarLoaded(originalFunctionName, key, resExemplar);
-					}
-				}
-			}
+			ScopedPerformanceTimer dispatchTimer(PerformanceCounter::ExemplarLoadDispatch);
+
+			loadTargets.ExemplarLoaded(originalFunctionName, key, resExemplar);
 		}
 	}
 }
@@ -159,18 +120,7 @@ void ExemplarResourceFactoryProxy::ResourceLoadError(
 	const char* const originalFunctionName,
 	uint32_t riid)
 {
-	if (exemplarLoadErrorTargets.size() > 0)
-	{
-		for (cIExemplarLoadErrorHookTarget* pTarget : exemplarLoadErrorTargets)
-		{
-			cIExemplarLoadErrorHookTarget* const temp = pTarget;
-
-			if (temp)
-			{
-				temp->LoadError(originalFunctionName, riid);
-			}
-		}
-	}
+	loadTargets.LoadError(originalFunctionName, riid);
 }
 
 void ExemplarResourceFactoryProxy::ResourceLoadError(
@@ -178,44 +128,5 @@ void ExemplarResourceFactoryProxy::ResourceLoadError(
 	uint32_t riid,
 	const cGZPersistResourceKey& key)
 {
-	if (exemplarLoadErrorTargets.size() > 0)
-	{
-		for (cIExemplarLoadErrorHookTarget* pTarget : exemplarLoadErrorTargets)
-		{
-			cIExemplarLoadErrorHookTarget* const temp = pTarget;
-
-			if (temp)
-			{
-				temp->LoadError(originalFunctionName, riid, key);
-			}
-		}
-	}
-}
-
-ExemplarResourceFactoryProxy::ExemplarTGIFilter::ExemplarTGIFilter(
-	uint32_t requestedGroupID,
-	uint32_t requestedInstanceID)
-	: groupID(requestedGroupID),
-	  instanceID(requestedInstanceID)
-{
-}
-
-bool ExemplarResourceFactoryProxy::ExemplarTGIFilter::IsIncluded(const cGZPersistResourceKey& key) const
-{
-	bool result = true;
-
-	// A group/instance ID of 0 is treated as including every value for that item.
-	if (groupID != 0)
-	{
-		if (instanceID != 0)
-		{
-			result = key.group == groupID && key.instance == instanceID;
-		}
-		else
-		{
-			result = key.group == groupID;
-		}
-	}
-
-	return result;
+	loadTargets.LoadError(originalFunctionName, riid, key);
 }
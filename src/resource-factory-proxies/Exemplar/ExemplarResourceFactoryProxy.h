@@ -24,9 +24,8 @@
 #include "cIExemplarLoadHookServer.h"
 #include "cIExemplarPatchingServer.h"
 #include "cRZSysServPtr.h"
+#include "ExemplarLoadTargetRegistry.h"
 #include "IApplyExemplarPatch.h"
-#include <unordered_map>
-#include <unordered_set>
 
 static constexpr uint32_t GZCLSID_ExemplarFactoryProxy = 0xEDA309D9;
 static constexpr uint32_t ExemplarTypeID = 0x6534284A;
@@ -75,22 +74,7 @@ private:
 		uint32_t riid,
 		const cGZPersistResourceKey& key) override;
 
-	class ExemplarTGIFilter
-	{
-	public:
-
-		ExemplarTGIFilter(uint32_t requestedGroupID, uint32_t requestedInstanceID);
-
-		bool IsIncluded(const cGZPersistResourceKey& key) const;
-
-	private:
-
-		uint32_t groupID;
-		uint32_t instanceID;
-	};
-
-	std::unordered_map<cIExemplarLoadHookTarget*, ExemplarTGIFilter> exemplarLoadTargets;
-	std::unordered_set<cIExemplarLoadErrorHookTarget*> exemplarLoadErrorTargets;
+	ExemplarLoadTargetRegistry loadTargets;
 	cRZSysServPtr<IApplyExemplarPatch, GZIID_IApplyExemplarPatch, GZSERVID_ExemplarPatchingServer> exemplarPatcher;
 };
 
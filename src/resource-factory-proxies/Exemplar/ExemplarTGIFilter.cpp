@@ -0,0 +1,51 @@
+/*
+ * This file is part of sc4-resource-loading-hooks, a DLL Plugin for SimCity 4
+ * that allows other DLLs to modify resources as the game loads them.
+ *
+ * Copyright (C) 2024, 2025 Nicholas Hayes
+ *
+ * sc4-resource-loading-hooks is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * sc4-resource-loading-hooks is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with sc4-resource-loading-hooks.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ExemplarTGIFilter.h"
+#include "cGZPersistResourceKey.h"
+
+ExemplarTGIFilter::ExemplarTGIFilter(
+	uint32_t requestedGroupID,
+	uint32_t requestedInstanceID)
+	: groupID(requestedGroupID),
+	  instanceID(requestedInstanceID)
+{
+}
+
+bool ExemplarTGIFilter::IsIncluded(const cGZPersistResourceKey& key) const
+{
+	bool result = true;
+
+	// A group/instance ID of 0 is treated as including every value for that item.
+	if (groupID != 0)
+	{
+		if (instanceID != 0)
+		{
+			result = key.group == groupID && key.instance == instanceID;
+		}
+		else
+		{
+			result = key.group == groupID;
+		}
+	}
+
+	return result;
+}
@@ -151,7 +151,8 @@ bool ResourceFactoryProxy::Read(cIGZPersistResource& resource, cIGZPersistDBReco
 
 	Logger::GetInstance().WriteLineFormatted(
 		LogLevel::Debug,
-		__FUNCSIG__ ": result=%s",
+		"%s: result=%s",
+		__FUNCSIG__,
 		result ? "true" : "false");
 
 	return result;
@@ -163,7 +164,8 @@ bool ResourceFactoryProxy::Write(cIGZPersistResource const& resource, cIGZPersis
 
 	Logger::GetInstance().WriteLineFormatted(
 		LogLevel::Debug,
-		__FUNCSIG__ ": result=%s",
+		"%s: result=%s",
+		__FUNCSIG__,
 		result ? "true" : "false");
 
 	return result;
@@ -0,0 +1,802 @@
+/*
+ * This file is part of sc4-resource-loading-hooks, a DLL Plugin for SimCity 4
+ * that allows other DLLs to modify resources as the game loads them.
+ *
+ * Copyright (C) 2024, 2025 Nicholas Hayes
+ *
+ * sc4-resource-loading-hooks is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * sc4-resource-loading-hooks is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with sc4-resource-loading-hooks.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Runs the exemplar patching server and the exemplar factory proxy end to end
+// on the in-memory GZCOM services.
+
+#include "TestCheck.h"
+#include "cIExemplarLoadHookTarget.h"
+#include "cRZBaseVariant.h"
+#include "cSCBaseProperty.h"
+#include "cIGZPersistResource.h"
+#include "ExemplarLoadTraceReader.h"
+#include "ExemplarLoadTraceRecorder.h"
+#include "ExemplarLoadTraceReplayer.h"
+#include "ExemplarPatchBaker.h"
+#include "ExemplarPatchingHarness.h"
+#include "ExemplarResourceFactoryProxy.h"
+#include "FileSystem.h"
+#include "MockDBRecord.h"
+#include "OfflineExemplarPatchScan.h"
+#include "PluginResourceLoader.h"
+#include "SyntheticCorpusWriter.h"
+#include "SyntheticExemplarPopulation.h"
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace
+{
+	// The registry does not take a reference, the target lives on the stack.
+	class PatchedPropertyLoadTarget : public cIExemplarLoadHookTarget
+	{
+	public:
+		explicit PatchedPropertyLoadTarget(uint32_t propertyID) : propertyID(propertyID)
+		{
+		}
+
+		bool QueryInterface(uint32_t riid, void** ppvObj) override
+		{
+			return false;
+		}
+
+		uint32_t AddRef() override
+		{
+			return 1;
+		}
+
+		uint32_t Release() override
+		{
+			return 1;
+		}
+
+		void ExemplarLoaded(
+			const char* const originalFunctionName,
+			const cGZPersistResourceKey& key,
+			cISCResExemplar* resExemplar) override
+		{
+			loadCount++;
+
+			// The subscribers are notified after the patches were applied.
+			if (resExemplar && resExemplar->AsISCPropertyHolder()->HasProperty(propertyID))
+			{
+				patchedLoadCount++;
+			}
+		}
+
+		uint32_t propertyID;
+		uint32_t loadCount = 0;
+		uint32_t patchedLoadCount = 0;
+	};
+
+	bool HasSameValue(const cIGZVariant* left, const cIGZVariant* right)
+	{
+		if (!left || !right || left->GetType() != right->GetType() || left->GetCount() != right->GetCount())
+		{
+			return false;
+		}
+
+		switch (left->GetType())
+		{
+		case cIGZVariant::Type::Uint32:
+			return *left->RefUint32() == *right->RefUint32();
+		case cIGZVariant::Type::Float32Array:
+			for (uint32_t i = 0; i < left->GetCount(); i++)
+			{
+				if (left->RefFloat32()[i] != right->RefFloat32()[i])
+				{
+					return false;
+				}
+			}
+			return true;
+		case cIGZVariant::Type::RZCharArray:
+			for (uint32_t i = 0; i < left->GetCount(); i++)
+			{
+				if (left->RefRZChar()[i] != right->RefRZChar()[i])
+				{
+					return false;
+				}
+			}
+			return true;
+		default:
+			return false;
+		}
+	}
+
+	// The property values that the exemplar has after all of its patches were applied in load order.
+	std::unordered_map<uint32_t, cRZAutoRefCount<cISCProperty>> GetExpectedProperties(
+		const SyntheticExemplarPopulation& population,
+		uint32_t exemplarIndex)
+	{
+		std::unordered_map<uint32_t, cRZAutoRefCount<cISCProperty>> expected;
+
+		const SyntheticResource exemplar = population.CreateExemplar(exemplarIndex);
+
+		for (const auto& property : exemplar.properties)
+		{
+			expected[property->GetPropertyID()] = property;
+		}
+
+		for (uint32_t patchIndex : population.GetPatchesByExemplar()[exemplarIndex])
+		{
+			const SyntheticResource patch = population.CreatePatch(patchIndex);
+
+			for (const auto& property : patch.properties)
+			{
+				const uint32_t id = property->GetPropertyID();
+
+				if (id != SyntheticExemplarPopulation::ExemplarPatchTargetsPropertyID
+					&& id != SyntheticExemplarPopulation::ExemplarNamePropertyID)
+				{
+					expected[id] = property;
+				}
+			}
+		}
+
+		return expected;
+	}
+
+	bool CheckExemplar(
+		ExemplarPatchingHarness& harness,
+		const SyntheticExemplarPopulation& population,
+		uint32_t exemplarIndex)
+	{
+		cRZAutoRefCount<cISCResExemplar> exemplar = harness.LoadExemplar(population.GetExemplarKey(exemplarIndex));
+
+		if (!exemplar)
+		{
+			return false;
+		}
+
+		const cISCPropertyHolder* propertyHolder = exemplar->AsISCPropertyHolder();
+
+		for (const auto& [id, property] : GetExpectedProperties(population, exemplarIndex))
+		{
+			const cISCProperty* actual = propertyHolder->GetProperty(id);
+
+			if (!actual || !HasSameValue(actual->GetPropertyValue(), property->GetPropertyValue()))
+			{
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	void CheckAllExemplars(ExemplarPatchingHarness& harness, const SyntheticExemplarPopulation& population)
+	{
+		uint32_t mismatchCount = 0;
+
+		for (uint32_t i = 0; i < population.GetExemplarCount(); i++)
+		{
+			if (!CheckExemplar(harness, population, i))
+			{
+				mismatchCount++;
+			}
+		}
+
+		CHECK(mismatchCount == 0);
+	}
+
+	void TestPopulation(const SyntheticPopulationOptions& options, const std::vector<std::string>& arguments)
+	{
+		const SyntheticExemplarPopulation population(options);
+
+		ExemplarPatchingHarness harness(arguments);
+		population.AddTo(harness.GetResourceManager());
+
+		CHECK(harness.Start());
+		CHECK(harness.GetPatchingServer() != nullptr);
+		CHECK(harness.GetLoadHookServer() != nullptr);
+
+		if (!harness.GetPatchingServer() || !harness.GetLoadHookServer())
+		{
+			return;
+		}
+
+		CheckAllExemplars(harness, population);
+
+		// Every exemplar is created once by the original factory, the patches are read by the scan.
+		const uint64_t createdCount = harness.GetCreatedResourceCount();
+		CHECK(createdCount >= population.GetExemplarCount() + population.GetPatchCount());
+	}
+
+	void TestCorpusFiles()
+	{
+		SyntheticPopulationOptions options;
+		options.exemplarCount = 2000;
+		options.parentCohortCount = 8;
+		options.patchCount = 200;
+		options.patchTargetCount = 16;
+		options.targetOverlap = 0.5;
+
+		SyntheticCorpusOptions corpusOptions;
+		corpusOptions.exemplarFileCount = 3;
+		corpusOptions.patchFileCount = 2;
+		corpusOptions.compressedFraction = 0.5;
+
+		const SyntheticExemplarPopulation population(options);
+		SyntheticCorpusWriter writer(population, corpusOptions);
+
+		const std::filesystem::path directory = std::filesystem::temp_directory_path() / "sc4rlh-harness-corpus";
+		std::filesystem::remove_all(directory);
+
+		std::string error;
+		CHECK(writer.Write(directory, error));
+		CHECK(writer.GetFiles().size() == 6);
+
+		{
+			ExemplarPatchingHarness harness;
+			writer.AddTo(harness.GetResourceManager(), directory);
+
+			CHECK(harness.Start());
+
+			// The scan read the patches from the DBPF files instead of loading them through the game.
+			CHECK(harness.GetCreatedResourceCount() == 0);
+
+			if (harness.GetPatchingServer())
+			{
+				CheckAllExemplars(harness, population);
+			}
+		}
+
+		std::filesystem::remove_all(directory);
+	}
+
+	void TestOfflineBundle()
+	{
+		SyntheticPopulationOptions options;
+		options.exemplarCount = 500;
+		options.patchCount = 50;
+		options.patchTargetCount = 8;
+		options.targetOverlap = 0.5;
+
+		SyntheticCorpusOptions corpusOptions;
+		corpusOptions.exemplarFileCount = 2;
+		corpusOptions.patchFileCount = 2;
+
+		const SyntheticExemplarPopulation population(options);
+		SyntheticCorpusWriter writer(population, corpusOptions);
+
+		const std::filesystem::path directory = std::filesystem::temp_directory_path() / "sc4rlh-harness-bundle";
+		std::filesystem::remove_all(directory);
+
+		std::string error;
+		CHECK(writer.Write(directory, error));
+
+		// The server loads the bundle from the folder of the DLL.
+		const std::filesystem::path bundlePath = FileSystem::GetDllFolderPath() / "SC4ExemplarPatches.bundle";
+
+		{
+			OfflineExemplarPatchScan scan;
+			CHECK(scan.Scan({ directory }, error));
+			CHECK(scan.GetPatchCount() == population.GetPatchCount());
+			CHECK(scan.WriteBundle(bundlePath, error));
+		}
+
+		// The server rewrites the bundle after it scans the plugin files.
+		const std::filesystem::file_time_type bundleTime = std::filesystem::last_write_time(bundlePath) - std::chrono::hours(1);
+		std::filesystem::last_write_time(bundlePath, bundleTime);
+
+		{
+			ExemplarPatchingHarness harness({ "-exemplar-patch-bundle" });
+
+			PluginResourceLoader pluginLoader(harness.GetResourceManager());
+			pluginLoader.Load({ directory }, [](const cGZPersistResourceKey&)
+			{
+				return PluginResourceLoader::RecordContent::Properties;
+			});
+
+			CHECK(harness.Start());
+
+			if (harness.GetPatchingServer())
+			{
+				CheckAllExemplars(harness, population);
+			}
+		}
+
+		CHECK(std::filesystem::last_write_time(bundlePath) == bundleTime);
+
+		std::filesystem::remove(bundlePath);
+		std::filesystem::remove_all(directory);
+	}
+
+	void TestOfflineBake()
+	{
+		SyntheticPopulationOptions options;
+		options.exemplarCount = 500;
+		options.patchCount = 50;
+		options.patchTargetCount = 8;
+		options.targetOverlap = 0.5;
+
+		SyntheticCorpusOptions corpusOptions;
+		corpusOptions.exemplarFileCount = 2;
+		corpusOptions.patchFileCount = 2;
+
+		const SyntheticExemplarPopulation population(options);
+		SyntheticCorpusWriter writer(population, corpusOptions);
+
+		const std::filesystem::path directory = std::filesystem::temp_directory_path() / "sc4rlh-harness-bake";
+		std::filesystem::remove_all(directory);
+
+		std::string error;
+		CHECK(writer.Write(directory, error));
+
+		uint32_t expectedBakedCount = 0;
+
+		for (const auto& patches : population.GetPatchesByExemplar())
+		{
+			if (!patches.empty())
+			{
+				expectedBakedCount++;
+			}
+		}
+
+		// Installed as a plugin that loads after the patched plugins.
+		const std::filesystem::path bakedPath = directory / "zzzz SC4ExemplarPatches.baked.dat";
+
+		{
+			OfflineExemplarPatchScan scan;
+			uint32_t bakedCount = 0;
+			uint32_t skippedCount = 0;
+
+			CHECK(scan.Scan({ directory }, error));
+			CHECK(scan.Bake(bakedPath, bakedCount, skippedCount, error));
+			CHECK(bakedCount == expectedBakedCount);
+			CHECK(skippedCount == 0);
+			CHECK(ExemplarPatchBaker::IsUpToDate(bakedPath, scan.GetFingerprint()));
+		}
+
+		{
+			// The installed baked file is refused, the target exemplars would be read from it.
+			OfflineExemplarPatchScan scan;
+			uint32_t bakedCount = 0;
+			uint32_t skippedCount = 0;
+
+			CHECK(scan.Scan({ directory }, error));
+			CHECK(!scan.Bake(directory / "SC4ExemplarPatches.baked", bakedCount, skippedCount, error));
+		}
+
+		{
+			// The server skips the scan, the patched exemplars are loaded from the baked file.
+			ExemplarPatchingHarness harness({ "-exemplar-patch-baked" });
+
+			PluginResourceLoader pluginLoader(harness.GetResourceManager());
+			pluginLoader.Load({ directory }, [](const cGZPersistResourceKey& key)
+			{
+				return key.type == ExemplarPatchBaker::FingerprintRecordKey.type
+					? PluginResourceLoader::RecordContent::FileOnly
+					: PluginResourceLoader::RecordContent::Properties;
+			});
+
+			CHECK(harness.Start());
+
+			if (harness.GetPatchingServer())
+			{
+				CheckAllExemplars(harness, population);
+			}
+		}
+
+		// The server renames a baked file that does not match the plugins.
+		CHECK(std::filesystem::exists(bakedPath));
+
+		{
+			// Without the exemplar patches the exemplars are only patched by the baked file.
+			ExemplarPatchingHarness harness;
+
+			PluginResourceLoader pluginLoader(harness.GetResourceManager());
+			pluginLoader.Load({ directory }, [](const cGZPersistResourceKey& key)
+			{
+				return key.type == ExemplarTypeID
+					? PluginResourceLoader::RecordContent::Properties
+					: PluginResourceLoader::RecordContent::None;
+			});
+
+			CHECK(harness.Start());
+
+			if (harness.GetPatchingServer())
+			{
+				CheckAllExemplars(harness, population);
+			}
+		}
+
+		std::filesystem::remove_all(directory);
+	}
+
+	void TestLoadNotification()
+	{
+		SyntheticPopulationOptions options;
+		options.exemplarCount = 64;
+		options.patchCount = 4;
+		options.patchTargetCount = 4;
+		options.exemplarPropertyCount = 0;
+		options.patchPropertyCount = 1;
+
+		const SyntheticExemplarPopulation population(options);
+
+		ExemplarPatchingHarness harness;
+		population.AddTo(harness.GetResourceManager());
+
+		CHECK(harness.Start());
+
+		cIExemplarLoadHookServer* loadHookServer = harness.GetLoadHookServer();
+
+		if (!loadHookServer)
+		{
+			return;
+		}
+
+		// With no exemplar properties every patch property is new, so a subscriber
+		// only sees it on the patched exemplars.
+		PatchedPropertyLoadTarget target(population.CreatePatch(0).properties.back()->GetPropertyID());
+		CHECK(loadHookServer->AddLoadNotification(&target));
+
+		uint32_t expectedPatchedCount = 0;
+
+		for (uint32_t i = 0; i < population.GetExemplarCount(); i++)
+		{
+			for (uint32_t patchIndex : population.GetPatchesByExemplar()[i])
+			{
+				const MockPropertyList properties = population.CreatePatch(patchIndex).properties;
+
+				if (properties.back()->GetPropertyID() == target.propertyID)
+				{
+					expectedPatchedCount++;
+					break;
+				}
+			}
+
+			harness.LoadExemplar(population.GetExemplarKey(i));
+		}
+
+		CHECK(target.loadCount == population.GetExemplarCount());
+		CHECK(target.patchedLoadCount == expectedPatchedCount);
+		CHECK(expectedPatchedCount > 0);
+
+		CHECK(loadHookServer->RemoveLoadNotification(&target));
+		harness.LoadExemplar(population.GetExemplarKey(0));
+		CHECK(target.loadCount == population.GetExemplarCount());
+	}
+
+	void TestInitialScan()
+	{
+		SyntheticPopulationOptions options;
+		options.exemplarCount = 64;
+		options.patchCount = 8;
+
+		const SyntheticExemplarPopulation population(options);
+
+		{
+			ExemplarPatchingHarness harness;
+			population.AddTo(harness.GetResourceManager());
+
+			CHECK(harness.Start());
+
+			cIExemplarPatchingServer2* server = harness.GetPatchingServer();
+
+			if (!server)
+			{
+				return;
+			}
+
+			// Init only starts the scan, the first exemplar load finishes it on this thread.
+			CHECK(server->GetCompletedScanGeneration() == 0);
+			CHECK(CheckExemplar(harness, population, population.GetPatchTargets(0).front()));
+			CHECK(server->GetCompletedScanGeneration() == 1);
+		}
+
+		{
+			ExemplarPatchingHarness harness;
+			population.AddTo(harness.GetResourceManager());
+
+			CHECK(harness.Start());
+
+			cIExemplarPatchingServer2* server = harness.GetPatchingServer();
+
+			if (!server)
+			{
+				return;
+			}
+
+			// Without an exemplar load the scan is finished by the service tick.
+			while (server->GetCompletedScanGeneration() == 0)
+			{
+				harness.GetFrameWork().Tick();
+				std::this_thread::yield();
+			}
+
+			CheckAllExemplars(harness, population);
+		}
+	}
+
+	void TestRescan()
+	{
+		SyntheticPopulationOptions options;
+		options.exemplarCount = 32;
+		options.patchCount = 0;
+
+		const SyntheticExemplarPopulation population(options);
+		const cGZPersistResourceKey targetKey = population.GetExemplarKey(5);
+		const cGZPersistResourceKey patchKey(
+			SyntheticExemplarPopulation::CohortTypeID,
+			SyntheticExemplarPopulation::ExemplarPatchGroupID,
+			0x7FFF0001);
+		constexpr uint32_t PatchedPropertyID = 0x4B000001;
+
+		ExemplarPatchingHarness harness;
+		population.AddTo(harness.GetResourceManager());
+
+		CHECK(harness.Start());
+
+		cIExemplarPatchingServer2* server = harness.GetPatchingServer();
+
+		if (!server)
+		{
+			return;
+		}
+
+		cRZAutoRefCount<cISCResExemplar> exemplar = harness.LoadExemplar(targetKey);
+		CHECK(exemplar && !exemplar->AsISCPropertyHolder()->HasProperty(PatchedPropertyID));
+
+		MockPropertyList patchProperties;
+		cRZBaseVariant value;
+
+		// The targets are group and instance ID pairs.
+		const uint32_t targets[2] = { targetKey.group, targetKey.instance };
+		value.SetValUint32(targets, 2);
+		patchProperties.emplace_back(
+			new cSCBaseProperty(SyntheticExemplarPopulation::ExemplarPatchTargetsPropertyID, &value),
+			cRZAutoRefCount<cISCProperty>::kAddRef);
+
+		value.SetValUint32(42);
+		patchProperties.emplace_back(new cSCBaseProperty(PatchedPropertyID, &value), cRZAutoRefCount<cISCProperty>::kAddRef);
+
+		harness.GetResourceManager().AddResource(patchKey, patchProperties);
+
+		// A synchronous scan picks up the new patch.
+		server->ScanForExemplarPatches();
+
+		exemplar = harness.LoadExemplar(targetKey);
+		CHECK(exemplar && exemplar->AsISCPropertyHolder()->HasProperty(PatchedPropertyID));
+
+		// The other exemplars are not patched.
+		exemplar = harness.LoadExemplar(population.GetExemplarKey(6));
+		CHECK(exemplar && !exemplar->AsISCPropertyHolder()->HasProperty(PatchedPropertyID));
+
+		// A background scan removes it again.
+		CHECK(harness.GetResourceManager().RemoveResource(patchKey));
+
+		const uint32_t generation = server->RequestScanForExemplarPatches();
+		CHECK(server->WaitForScan(generation, 10000));
+		CHECK(server->GetCompletedScanGeneration() >= generation);
+
+		exemplar = harness.LoadExemplar(targetKey);
+		CHECK(exemplar && !exemplar->AsISCPropertyHolder()->HasProperty(PatchedPropertyID));
+
+		// A synchronous scan on another thread waits for the main thread to tick.
+		harness.GetResourceManager().AddResource(patchKey, patchProperties);
+
+		std::atomic<bool> scanReturned = false;
+		std::thread scanThread([&]
+		{
+			server->ScanForExemplarPatches();
+			scanReturned = true;
+		});
+
+		while (!scanReturned)
+		{
+			harness.GetFrameWork().Tick();
+			std::this_thread::yield();
+		}
+
+		scanThread.join();
+
+		exemplar = harness.LoadExemplar(targetKey);
+		CHECK(exemplar && exemplar->AsISCPropertyHolder()->HasProperty(PatchedPropertyID));
+	}
+
+	void TestTraceReplay()
+	{
+		SyntheticPopulationOptions options;
+		options.exemplarCount = 64;
+		options.patchCount = 8;
+		options.patchTargetCount = 4;
+		options.exemplarPropertyCount = 0;
+		options.patchPropertyCount = 1;
+
+		const SyntheticExemplarPopulation population(options);
+		const uint32_t patchedPropertyID = population.CreatePatch(0).properties.back()->GetPropertyID();
+		constexpr uint32_t UnknownInterfaceID = 0x7A5E0001;
+
+		const std::filesystem::path tracePath = FileSystem::GetDllFolderPath() / "SC4ExemplarLoad.trace";
+		uint32_t recordedPatchedLoadCount = 0;
+
+		{
+			// The recorder must outlive the load hook server that it is registered with.
+			ExemplarLoadTraceRecorder recorder;
+			ExemplarPatchingHarness harness({ "-exemplar-load-trace" });
+			population.AddTo(harness.GetResourceManager());
+
+			CHECK(harness.Start());
+
+			cIExemplarLoadHookServer* loadHookServer = harness.GetLoadHookServer();
+			cIGZPersistResourceFactory* proxy = harness.GetExemplarFactoryProxy();
+
+			if (!loadHookServer || !proxy)
+			{
+				return;
+			}
+
+			recorder.Init(&harness.GetFrameWork());
+
+			PatchedPropertyLoadTarget target(patchedPropertyID);
+			CHECK(loadHookServer->AddLoadNotification(&target));
+
+			// Every exemplar is loaded twice, the second time in reverse order.
+			for (uint32_t i = 0; i < population.GetExemplarCount(); i++)
+			{
+				CHECK(harness.LoadExemplar(population.GetExemplarKey(i)) != nullptr);
+			}
+
+			for (uint32_t i = population.GetExemplarCount(); i-- > 0;)
+			{
+				CHECK(harness.LoadExemplar(population.GetExemplarKey(i)) != nullptr);
+			}
+
+			// The empty exemplar that the other CreateInstance overload creates.
+			cRZAutoRefCount<cIGZPersistResource> resource;
+			CHECK(proxy->CreateInstance(ExemplarTypeID, GZIID_cIGZPersistResource, resource.AsPPVoid(), 0, nullptr));
+
+			// A load error without a key and one with a key.
+			cRZAutoRefCount<cIGZUnknown> unknown;
+			CHECK(!proxy->CreateInstance(ExemplarTypeID, UnknownInterfaceID, unknown.AsPPVoid(), 0, nullptr));
+
+			const MockPropertyList properties;
+			cRZAutoRefCount<MockDBRecord> damagedRecord(
+				new MockDBRecord(population.GetExemplarKey(3), properties),
+				cRZAutoRefCount<MockDBRecord>::kAddRef);
+			damagedRecord->SetDamaged(true);
+			CHECK(!proxy->CreateInstance(*damagedRecord, GZIID_cIGZPersistResource, unknown.AsPPVoid(), 0, nullptr));
+
+			CHECK(loadHookServer->RemoveLoadNotification(&target));
+			recordedPatchedLoadCount = target.patchedLoadCount;
+			CHECK(recordedPatchedLoadCount > 0);
+
+			recorder.Shutdown();
+		}
+
+		ExemplarLoadTraceReader trace;
+		std::string error;
+
+		CHECK(trace.Open(tracePath, error));
+		CHECK(!trace.IsTruncated());
+		CHECK(trace.GetThreadCount() == 1);
+
+		const std::vector<ExemplarLoadTraceRecord>& records = trace.GetRecords();
+		const size_t loadCount = static_cast<size_t>(population.GetExemplarCount()) * 2;
+
+		CHECK(records.size() == loadCount + 3);
+
+		if (records.size() != loadCount + 3)
+		{
+			return;
+		}
+
+		for (size_t i = 0; i < records.size(); i++)
+		{
+			CHECK(i == 0 || records[i].timestampNanoseconds >= records[i - 1].timestampNanoseconds);
+		}
+
+		CHECK(records[0].type == ExemplarLoadTraceFormat::RecordType::Load);
+		CHECK(trace.IsRecordOverload(records[0]));
+		CHECK(records[0].key == population.GetExemplarKey(0));
+		CHECK(records[loadCount - 1].key == population.GetExemplarKey(0));
+
+		CHECK(records[loadCount].type == ExemplarLoadTraceFormat::RecordType::Load);
+		CHECK(!trace.IsRecordOverload(records[loadCount]));
+		CHECK(trace.GetFunctionName(records[loadCount]) != trace.GetFunctionName(records[0]));
+
+		CHECK(records[loadCount + 1].type == ExemplarLoadTraceFormat::RecordType::LoadError);
+		CHECK(records[loadCount + 1].riid == UnknownInterfaceID);
+
+		CHECK(records[loadCount + 2].type == ExemplarLoadTraceFormat::RecordType::LoadErrorWithKey);
+		CHECK(records[loadCount + 2].key == population.GetExemplarKey(3));
+
+		// The replay reproduces the loads, the patches and the notifications.
+		{
+			ExemplarPatchingHarness harness;
+			population.AddTo(harness.GetResourceManager());
+
+			ExemplarLoadTraceReplayer replayer(harness, trace);
+			CHECK(replayer.GetLoadedKeys().size() == population.GetExemplarCount());
+			CHECK(replayer.AddMissingExemplars() == 0);
+
+			CHECK(harness.Start());
+
+			cIExemplarLoadHookServer* loadHookServer = harness.GetLoadHookServer();
+
+			if (!loadHookServer)
+			{
+				return;
+			}
+
+			PatchedPropertyLoadTarget target(patchedPropertyID);
+			CHECK(loadHookServer->AddLoadNotification(&target));
+
+			const ExemplarLoadTraceReplayResult result = replayer.Replay();
+
+			CHECK(result.recordOverloadLoadCount == loadCount);
+			CHECK(result.typeOverloadLoadCount == 1);
+			CHECK(result.loadErrorCount == 2);
+			CHECK(result.mismatchCount == 0);
+			CHECK(target.loadCount == loadCount + 1);
+			CHECK(target.patchedLoadCount == recordedPatchedLoadCount);
+
+			CHECK(loadHookServer->RemoveLoadNotification(&target));
+		}
+
+		// Without the plugins the exemplars are replayed without properties.
+		{
+			ExemplarPatchingHarness harness;
+			ExemplarLoadTraceReplayer replayer(harness, trace);
+
+			CHECK(replayer.AddMissingExemplars() == population.GetExemplarCount());
+			CHECK(harness.Start());
+
+			const ExemplarLoadTraceReplayResult result = replayer.Replay();
+			CHECK(result.mismatchCount == 0);
+		}
+
+		std::filesystem::remove(tracePath);
+	}
+}
+
+int main()
+{
+	SyntheticPopulationOptions small;
+	small.exemplarCount = 200;
+	small.patchCount = 40;
+	TestPopulation(small, {});
+
+	SyntheticPopulationOptions overlapping;
+	overlapping.exemplarCount = 2000;
+	overlapping.parentCohortCount = 16;
+	overlapping.patchCount = 300;
+	overlapping.patchTargetCount = 12;
+	overlapping.targetOverlap = 0.75;
+	TestPopulation(overlapping, {});
+
+	// Skipping the identical properties must not change the patched values.
+	TestPopulation(overlapping, { "-exemplar-patch-skip-identical" });
+
+	TestCorpusFiles();
+	TestOfflineBundle();
+	TestOfflineBake();
+	TestLoadNotification();
+	TestInitialScan();
+	TestRescan();
+	TestTraceReplay();
+
+	return TestCheck::Result("ExemplarPatchingHarnessTests");
+}
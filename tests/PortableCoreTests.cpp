@@ -0,0 +1,171 @@
+/*
+ * This file is part of sc4-resource-loading-hooks, a DLL Plugin for SimCity 4
+ * that allows other DLLs to modify resources as the game loads them.
+ *
+ * Copyright (C) 2024, 2025 Nicholas Hayes
+ *
+ * sc4-resource-loading-hooks is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * sc4-resource-loading-hooks is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with sc4-resource-loading-hooks.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Checks the patch index, the load notification dispatch and the logger on the portable build.
+
+#include "TestCheck.h"
+#include "cIExemplarLoadHookTarget.h"
+#include "ExemplarLoadTargetRegistry.h"
+#include "ExemplarPatch.h"
+#include "ExemplarPatchIndex.h"
+#include "ExemplarTGIFilter.h"
+#include "Logger.h"
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace
+{
+	constexpr uint32_t ExemplarTypeID = 0x6534284A;
+
+	// The registry does not take a reference, the target lives on the stack.
+	class CountingLoadTarget : public cIExemplarLoadHookTarget
+	{
+	public:
+		bool QueryInterface(uint32_t riid, void** ppvObj) override
+		{
+			return false;
+		}
+
+		uint32_t AddRef() override
+		{
+			return 1;
+		}
+
+		uint32_t Release() override
+		{
+			return 1;
+		}
+
+		void ExemplarLoaded(
+			const char* const originalFunctionName,
+			const cGZPersistResourceKey& key,
+			cISCResExemplar* resExemplar) override
+		{
+			keys.push_back(key);
+		}
+
+		std::vector<cGZPersistResourceKey> keys;
+	};
+
+	void TestPatchIndex()
+	{
+		const cGZPersistResourceKey target(ExemplarTypeID, 0x1000, 0x2000);
+		const cGZPersistResourceKey otherTarget(ExemplarTypeID, 0x1000, 0x2001);
+
+		auto first = std::make_shared<const ExemplarPatch>(cGZPersistResourceKey(0x05342861, 0xB03697D1, 1));
+		auto second = std::make_shared<const ExemplarPatch>(cGZPersistResourceKey(0x05342861, 0xB03697D1, 2));
+
+		ExemplarPatchIndex index;
+		index.AddPatch(first, target);
+		index.AddPatch(second, target);
+		index.AddPatch(second, otherTarget);
+
+		std::vector<const ExemplarPatch*> found;
+
+		for (const auto& patch : index.Find(target))
+		{
+			found.push_back(patch.get());
+		}
+
+		// The patches are applied in the order they were added.
+		CHECK(found.size() == 2);
+		CHECK(found.size() == 2 && found[0] == first.get() && found[1] == second.get());
+		CHECK(index.Find(otherTarget).size() == 1);
+		CHECK(index.Find(cGZPersistResourceKey(ExemplarTypeID, 0x1000, 0x2002)).empty());
+		CHECK(index.GetTargetCount() == 2);
+
+		index.RemovePatch(second.get());
+
+		CHECK(index.Find(target).size() == 1);
+		CHECK(index.Find(otherTarget).empty());
+	}
+
+	void TestTGIFilter()
+	{
+		const cGZPersistResourceKey key(ExemplarTypeID, 0x1000, 0x2000);
+
+		CHECK(ExemplarTGIFilter(0, 0).IsIncluded(key));
+		CHECK(ExemplarTGIFilter(0x1000, 0).IsIncluded(key));
+		CHECK(ExemplarTGIFilter(0x1000, 0x2000).IsIncluded(key));
+		CHECK(ExemplarTGIFilter(0, 0x2000).IsIncluded(key));
+		CHECK(!ExemplarTGIFilter(0x1001, 0).IsIncluded(key));
+		CHECK(!ExemplarTGIFilter(0x1000, 0x2001).IsIncluded(key));
+	}
+
+	void TestLoadTargetRegistry()
+	{
+		CountingLoadTarget allTarget;
+		CountingLoadTarget groupTarget;
+		ExemplarLoadTargetRegistry registry;
+
+		CHECK(registry.AddLoadTarget(&allTarget, 0, 0));
+		CHECK(registry.AddLoadTarget(&groupTarget, 0x1000, 0));
+		// A target can only be added once.
+		CHECK(!registry.AddLoadTarget(&groupTarget, 0x1000, 0));
+
+		registry.ExemplarLoaded(__FUNCSIG__, cGZPersistResourceKey(ExemplarTypeID, 0x1000, 1), nullptr);
+		registry.ExemplarLoaded(__FUNCSIG__, cGZPersistResourceKey(ExemplarTypeID, 0x2000, 2), nullptr);
+
+		CHECK(allTarget.keys.size() == 2);
+		CHECK(groupTarget.keys.size() == 1);
+
+		CHECK(registry.RemoveLoadTarget(&groupTarget));
+		registry.ExemplarLoaded(__FUNCSIG__, cGZPersistResourceKey(ExemplarTypeID, 0x1000, 3), nullptr);
+
+		CHECK(allTarget.keys.size() == 3);
+		CHECK(groupTarget.keys.size() == 1);
+		CHECK(!registry.RemoveLoadTarget(&groupTarget));
+	}
+
+	void TestLogger()
+	{
+		const std::filesystem::path logPath = std::filesystem::temp_directory_path() / "SC4ResourceLoadingHooksPortableCoreTests.log";
+		std::filesystem::remove(logPath);
+
+		Logger& logger = Logger::GetInstance();
+		logger.Init(logPath, LogLevel::Info);
+		logger.WriteLineFormatted(LogLevel::Info, "Loaded %u Exemplar patches.", 2u);
+		logger.WriteLineFormatted(LogLevel::Debug, "Not written at the Info level.");
+		logger.Shutdown();
+
+		std::ifstream stream(logPath);
+		std::string contents((std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>());
+
+		CHECK(contents.find("Loaded 2 Exemplar patches.") != std::string::npos);
+		CHECK(contents.find("Not written") == std::string::npos);
+
+		stream.close();
+		std::filesystem::remove(logPath);
+	}
+}
+
+int main()
+{
+	TestPatchIndex();
+	TestTGIFilter();
+	TestLoadTargetRegistry();
+	TestLogger();
+
+	return TestCheck::Result("PortableCoreTests");
+}
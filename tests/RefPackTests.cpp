@@ -0,0 +1,600 @@
+/*
+ * This file is part of sc4-resource-loading-hooks, a DLL Plugin for SimCity 4
+ * that allows other DLLs to modify resources as the game loads them.
+ *
+ * Copyright (C) 2024, 2025 Nicholas Hayes
+ *
+ * sc4-resource-loading-hooks is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * sc4-resource-loading-hooks is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with sc4-resource-loading-hooks.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Fuzz-style checks of the QFS/RefPack decompressor.
+//
+// The decompressor is compared with a byte-at-a-time reference decoder on compressed data,
+// on generated command streams that use every command form, and on corrupted copies of both.
+// The inputs and outputs are allocated with their exact size, so an AddressSanitizer build
+// catches any read or write outside the buffers. The same seed always runs the same cases,
+// use --seed=<value> and --iterations=<count> for a longer run.
+
+#include "TestCheck.h"
+#include "DBPFFormat.h"
+#include "RefPackCompressor.h"
+#include "RefPackDecompressor.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iterator>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace
+{
+	// Decodes one byte at a time with the same validation rules as the decompressor.
+	bool ReferenceDecompress(const std::vector<uint8_t>& data, std::vector<uint8_t>& output)
+	{
+		uint32_t uncompressedSize = 0;
+
+		if (!RefPackDecompressor::GetUncompressedSize(data.data(), data.size(), uncompressedSize))
+		{
+			return false;
+		}
+
+		output.clear();
+
+		size_t in = DBPF::QfsHeaderSize;
+
+		while (in < data.size())
+		{
+			const uint32_t control = data[in];
+			size_t commandSize = 1;
+			size_t literalCount = 0;
+			size_t copyLength = 0;
+			size_t copyOffset = 0;
+			bool endOfData = false;
+
+			if (control < 0x80)
+			{
+				commandSize = 2;
+			}
+			else if (control < 0xC0)
+			{
+				commandSize = 3;
+			}
+			else if (control < 0xE0)
+			{
+				commandSize = 4;
+			}
+
+			if (data.size() - in < commandSize)
+			{
+				return false;
+			}
+
+			const uint8_t* command = &data[in];
+
+			if (control < 0x80)
+			{
+				literalCount = control & 0x03;
+				copyLength = ((control >> 2) & 0x07) + 3;
+				copyOffset = (((control >> 5) & 0x03) << 8) + command[1] + 1;
+			}
+			else if (control < 0xC0)
+			{
+				literalCount = command[1] >> 6;
+				copyLength = (control & 0x3F) + 4;
+				copyOffset = ((command[1] & 0x3F) << 8) + command[2] + 1;
+			}
+			else if (control < 0xE0)
+			{
+				literalCount = control & 0x03;
+				copyLength = (((control >> 2) & 0x03) << 8) + command[3] + 5;
+				copyOffset = (((control >> 4) & 0x01) << 16) + (command[1] << 8) + command[2] + 1;
+			}
+			else if (control < 0xFC)
+			{
+				literalCount = ((control & 0x1F) + 1) * 4;
+			}
+			else
+			{
+				literalCount = control & 0x03;
+				endOfData = true;
+			}
+
+			in += commandSize;
+
+			for (size_t i = 0; i < literalCount; i++)
+			{
+				if (in >= data.size() || output.size() >= uncompressedSize)
+				{
+					return false;
+				}
+
+				output.push_back(data[in++]);
+			}
+
+			if (copyLength > 0 && copyOffset > output.size())
+			{
+				return false;
+			}
+
+			for (size_t i = 0; i < copyLength; i++)
+			{
+				if (output.size() >= uncompressedSize)
+				{
+					return false;
+				}
+
+				output.push_back(output[output.size() - copyOffset]);
+			}
+
+			if (endOfData)
+			{
+				break;
+			}
+		}
+
+		return output.size() == uncompressedSize;
+	}
+
+	// Writes the 9-byte QFS header, the compressed size is not used by the decompressor.
+	std::vector<uint8_t> CreateHeader(size_t uncompressedSize)
+	{
+		std::vector<uint8_t> data(DBPF::QfsHeaderSize);
+
+		data[4] = DBPF::QfsSignature0;
+		data[5] = DBPF::QfsSignature1;
+		data[6] = static_cast<uint8_t>(uncompressedSize >> 16);
+		data[7] = static_cast<uint8_t>(uncompressedSize >> 8);
+		data[8] = static_cast<uint8_t>(uncompressedSize);
+
+		return data;
+	}
+
+	void SetUncompressedSize(std::vector<uint8_t>& data, size_t uncompressedSize)
+	{
+		data[6] = static_cast<uint8_t>(uncompressedSize >> 16);
+		data[7] = static_cast<uint8_t>(uncompressedSize >> 8);
+		data[8] = static_cast<uint8_t>(uncompressedSize);
+	}
+
+	class CommandStreamBuilder
+	{
+	public:
+
+		explicit CommandStreamBuilder(std::mt19937_64& random) : random(random), data(), expected()
+		{
+		}
+
+		// Adds a random command, the literal and copy counts stay within the command limits.
+		void AddRandomCommand()
+		{
+			const uint32_t kind = static_cast<uint32_t>(random() % 4);
+
+			if (kind == 0 || expected.empty())
+			{
+				const size_t count = 4 * (1 + random() % 28);
+				data.push_back(static_cast<uint8_t>(0xE0 + ((count - 4) >> 2)));
+				AddLiterals(count);
+				return;
+			}
+
+			const size_t literalCount = random() % 4;
+			const size_t available = expected.size() + literalCount;
+
+			// Short offsets repeat a pattern, the others copy from anywhere in the output.
+			size_t offset = random() % 2 == 0 ? 1 + random() % 20 : 1 + random() % available;
+			offset = std::min(offset, available);
+
+			if (kind == 1 && offset <= 1024)
+			{
+				const size_t length = 3 + random() % 8;
+				const size_t o = offset - 1;
+
+				data.push_back(static_cast<uint8_t>(((o >> 3) & 0x60) | ((length - 3) << 2) | literalCount));
+				data.push_back(static_cast<uint8_t>(o));
+				AddLiteralsAndCopy(literalCount, offset, length);
+			}
+			else if (kind == 2 && offset <= 16384)
+			{
+				const size_t length = 4 + random() % 64;
+				const size_t o = offset - 1;
+
+				data.push_back(static_cast<uint8_t>(0x80 | (length - 4)));
+				data.push_back(static_cast<uint8_t>((literalCount << 6) | (o >> 8)));
+				data.push_back(static_cast<uint8_t>(o));
+				AddLiteralsAndCopy(literalCount, offset, length);
+			}
+			else
+			{
+				offset = std::min<size_t>(offset, 131072);
+
+				const size_t length = 5 + random() % 1024;
+				const size_t o = offset - 1;
+				const size_t l = length - 5;
+
+				data.push_back(static_cast<uint8_t>(0xC0 | (((o >> 16) & 0x01) << 4) | (((l >> 8) & 0x03) << 2) | literalCount));
+				data.push_back(static_cast<uint8_t>(o >> 8));
+				data.push_back(static_cast<uint8_t>(o));
+				data.push_back(static_cast<uint8_t>(l));
+				AddLiteralsAndCopy(literalCount, offset, length);
+			}
+		}
+
+		// The end of data command is optional, the decompressor also stops at the end of the input.
+		std::vector<uint8_t> Finish(bool addEndOfData)
+		{
+			if (addEndOfData)
+			{
+				const size_t literalCount = random() % 4;
+
+				data.push_back(static_cast<uint8_t>(0xFC | literalCount));
+				AddLiterals(literalCount);
+			}
+
+			std::vector<uint8_t> stream = CreateHeader(expected.size());
+			stream.insert(stream.end(), data.begin(), data.end());
+
+			return stream;
+		}
+
+		size_t GetOutputSize() const
+		{
+			return expected.size();
+		}
+
+		const std::vector<uint8_t>& GetExpected() const
+		{
+			return expected;
+		}
+
+	private:
+
+		void AddLiterals(size_t count)
+		{
+			for (size_t i = 0; i < count; i++)
+			{
+				const uint8_t value = static_cast<uint8_t>(random());
+
+				data.push_back(value);
+				expected.push_back(value);
+			}
+		}
+
+		void AddLiteralsAndCopy(size_t literalCount, size_t offset, size_t length)
+		{
+			AddLiterals(literalCount);
+
+			for (size_t i = 0; i < length; i++)
+			{
+				expected.push_back(expected[expected.size() - offset]);
+			}
+		}
+
+		std::mt19937_64& random;
+		std::vector<uint8_t> data;
+		std::vector<uint8_t> expected;
+	};
+
+	// Creates data that compresses in different ways: random bytes, a small alphabet,
+	// long runs, a repeated phrase with changes, and short repeating patterns.
+	std::vector<uint8_t> CreateSample(std::mt19937_64& random, size_t size)
+	{
+		std::vector<uint8_t> sample(size);
+
+		switch (random() % 5)
+		{
+		case 0:
+			for (uint8_t& value : sample)
+			{
+				value = static_cast<uint8_t>(random());
+			}
+			break;
+		case 1:
+			for (uint8_t& value : sample)
+			{
+				value = static_cast<uint8_t>('a' + random() % 4);
+			}
+			break;
+		case 2:
+			for (size_t i = 0; i < size;)
+			{
+				const uint8_t value = static_cast<uint8_t>(random() % 3);
+				const size_t run = std::min<size_t>(size - i, 1 + random() % 2000);
+
+				std::memset(&sample[i], value, run);
+				i += run;
+			}
+			break;
+		case 3:
+		{
+			static constexpr char Phrase[] = "0x00000020:{\"Exemplar Name\"}=String:0:{\"Synthetic Exemplar\"}\r\n";
+
+			for (size_t i = 0; i < size; i++)
+			{
+				sample[i] = random() % 50 == 0 ? static_cast<uint8_t>(random()) : static_cast<uint8_t>(Phrase[i % (sizeof(Phrase) - 1)]);
+			}
+			break;
+		}
+		default:
+		{
+			const size_t period = 1 + random() % 24;
+
+			for (size_t i = 0; i < size; i++)
+			{
+				sample[i] = static_cast<uint8_t>((i % period) * 7);
+			}
+			break;
+		}
+		}
+
+		return sample;
+	}
+
+	size_t GetRandomSize(std::mt19937_64& random)
+	{
+		// The sizes around the 16-byte copy blocks are the most likely to have edge cases.
+		static constexpr size_t EdgeSizes[] = { 0, 1, 2, 3, 4, 5, 15, 16, 17, 31, 32, 33, 63, 64, 65, 127, 128, 129 };
+
+		switch (random() % 4)
+		{
+		case 0:
+			return EdgeSizes[random() % std::size(EdgeSizes)];
+		case 1:
+			return random() % 512;
+		case 2:
+			return random() % 16384;
+		default:
+			return random() % 262144;
+		}
+	}
+
+	// Decompresses with both decoders, they must return the same result and the same data.
+	bool CheckDecodersAgree(const std::vector<uint8_t>& input)
+	{
+		// An exact size copy, so a read past the end is caught by the sanitizers.
+		const std::vector<uint8_t> data(input);
+
+		std::vector<uint8_t> output;
+		const bool result = RefPackDecompressor::Decompress(data.data(), data.size(), output);
+
+		std::vector<uint8_t> referenceOutput;
+		const bool referenceResult = ReferenceDecompress(data, referenceOutput);
+
+		return result == referenceResult && (!result || output == referenceOutput);
+	}
+
+	void Mutate(std::mt19937_64& random, std::vector<uint8_t>& data)
+	{
+		switch (random() % 6)
+		{
+		case 0:
+			// Flip a bit in the commands or the literals.
+			if (data.size() > DBPF::QfsHeaderSize)
+			{
+				const size_t index = DBPF::QfsHeaderSize + random() % (data.size() - DBPF::QfsHeaderSize);
+				data[index] ^= static_cast<uint8_t>(1 << (random() % 8));
+			}
+			break;
+		case 1:
+			// Replace a byte.
+			if (!data.empty())
+			{
+				data[random() % data.size()] = static_cast<uint8_t>(random());
+			}
+			break;
+		case 2:
+			// Truncate the data.
+			data.resize(random() % (data.size() + 1));
+			break;
+		case 3:
+			// Append random bytes.
+			for (size_t count = 1 + random() % 32; count > 0; count--)
+			{
+				data.push_back(static_cast<uint8_t>(random()));
+			}
+			break;
+		case 4:
+			// Change the uncompressed size in the header.
+			if (data.size() >= DBPF::QfsHeaderSize)
+			{
+				uint32_t size = 0;
+				RefPackDecompressor::GetUncompressedSize(data.data(), data.size(), size);
+
+				const int64_t delta = static_cast<int64_t>(random() % 33) - 16;
+				SetUncompressedSize(data, static_cast<size_t>(std::max<int64_t>(0, static_cast<int64_t>(size) + delta)) & 0xFFFFFF);
+			}
+			break;
+		default:
+			// Overwrite a range with random bytes.
+			if (data.size() > DBPF::QfsHeaderSize)
+			{
+				const size_t start = DBPF::QfsHeaderSize + random() % (data.size() - DBPF::QfsHeaderSize);
+				const size_t end = std::min(data.size(), start + 1 + random() % 8);
+
+				for (size_t i = start; i < end; i++)
+				{
+					data[i] = static_cast<uint8_t>(random());
+				}
+			}
+			break;
+		}
+	}
+
+	void CheckMutations(std::mt19937_64& random, const std::vector<uint8_t>& compressed, uint32_t mutationCount)
+	{
+		for (uint32_t i = 0; i < mutationCount; i++)
+		{
+			std::vector<uint8_t> mutated(compressed);
+
+			for (uint32_t count = 1 + static_cast<uint32_t>(random() % 3); count > 0; count--)
+			{
+				Mutate(random, mutated);
+			}
+
+			CHECK(CheckDecodersAgree(mutated));
+		}
+	}
+
+	void TestRoundTrip(std::mt19937_64& random, uint32_t iterations)
+	{
+		uint32_t compressedCount = 0;
+
+		for (uint32_t i = 0; i < iterations; i++)
+		{
+			const std::vector<uint8_t> sample = CreateSample(random, GetRandomSize(random));
+			std::vector<uint8_t> compressed;
+
+			if (!RefPackCompressor::Compress(sample.data(), sample.size(), compressed))
+			{
+				// The data does not compress.
+				continue;
+			}
+
+			compressedCount++;
+
+			std::vector<uint8_t> output;
+			CHECK(RefPackDecompressor::Decompress(compressed.data(), compressed.size(), output));
+			CHECK(output == sample);
+			CHECK(CheckDecodersAgree(compressed));
+
+			// The output size must match the header.
+			if (!sample.empty())
+			{
+				std::vector<uint8_t> smaller(sample.size() - 1);
+				CHECK(!RefPackDecompressor::Decompress(compressed.data(), compressed.size(), smaller.data(), smaller.size()));
+			}
+
+			CheckMutations(random, compressed, 8);
+		}
+
+		CHECK(compressedCount > iterations / 2);
+	}
+
+	void TestCommandStreams(std::mt19937_64& random, uint32_t iterations)
+	{
+		for (uint32_t i = 0; i < iterations; i++)
+		{
+			CommandStreamBuilder builder(random);
+			const size_t targetSize = GetRandomSize(random) % 65536;
+
+			while (builder.GetOutputSize() < targetSize)
+			{
+				builder.AddRandomCommand();
+			}
+
+			const std::vector<uint8_t> stream = builder.Finish(random() % 2 == 0);
+
+			if (builder.GetOutputSize() > DBPF::QfsMaxUncompressedSize)
+			{
+				continue;
+			}
+
+			std::vector<uint8_t> output;
+			CHECK(RefPackDecompressor::Decompress(stream.data(), stream.size(), output));
+			CHECK(output == builder.GetExpected());
+			CHECK(CheckDecodersAgree(stream));
+
+			CheckMutations(random, stream, 8);
+		}
+	}
+
+	void TestInvalidData()
+	{
+		std::vector<uint8_t> output;
+
+		// No QFS header.
+		const std::vector<uint8_t> empty;
+		CHECK(!RefPackDecompressor::Decompress(empty.data(), empty.size(), output));
+
+		std::vector<uint8_t> data = CreateHeader(4);
+		data[5] = 0;
+		CHECK(!RefPackDecompressor::Decompress(data.data(), data.size(), output));
+
+		// A copy before the start of the output.
+		data = CreateHeader(8);
+		data.insert(data.end(), { 0xE0, 'a', 'b', 'c', 'd', 0x04, 0x04, 0xFC });
+		CHECK(!RefPackDecompressor::Decompress(data.data(), data.size(), output));
+
+		// The same copy with a valid offset repeats the 4 literals.
+		data[DBPF::QfsHeaderSize + 6] = 0x03;
+		CHECK(RefPackDecompressor::Decompress(data.data(), data.size(), output));
+		CHECK(output.size() == 8 && std::memcmp(output.data(), "abcdabcd", 8) == 0);
+
+		// A literal run that is longer than the remaining input.
+		data = CreateHeader(8);
+		data.insert(data.end(), { 0xE4, 'a', 'b', 'c', 'd' });
+		CHECK(!RefPackDecompressor::Decompress(data.data(), data.size(), output));
+
+		// The data ends before the output is complete.
+		data = CreateHeader(8);
+		data.insert(data.end(), { 0xE0, 'a', 'b', 'c', 'd' });
+		CHECK(!RefPackDecompressor::Decompress(data.data(), data.size(), output));
+
+		// A copy that is longer than the remaining output.
+		data = CreateHeader(6);
+		data.insert(data.end(), { 0xE0, 'a', 'b', 'c', 'd', 0x00, 0x00 });
+		CHECK(!RefPackDecompressor::Decompress(data.data(), data.size(), output));
+	}
+
+	bool ParseUint64(const char* text, uint64_t& value)
+	{
+		char* end = nullptr;
+		const unsigned long long result = std::strtoull(text, &end, 0);
+
+		if (end == text || *end != '\0' || text[0] == '-')
+		{
+			return false;
+		}
+
+		value = static_cast<uint64_t>(result);
+		return true;
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	uint64_t seed = 1;
+	uint64_t iterations = 400;
+
+	for (int i = 1; i < argc; i++)
+	{
+		const char* argument = argv[i];
+		bool valid = false;
+
+		if (std::strncmp(argument, "--seed=", 7) == 0)
+		{
+			valid = ParseUint64(argument + 7, seed);
+		}
+		else if (std::strncmp(argument, "--iterations=", 13) == 0)
+		{
+			valid = ParseUint64(argument + 13, iterations) && iterations > 0 && iterations <= UINT32_MAX;
+		}
+
+		if (!valid)
+		{
+			std::fprintf(stderr, "Usage: %s [--seed=<value>] [--iterations=<count>]\n", argv[0]);
+			return 2;
+		}
+	}
+
+	std::mt19937_64 random(seed);
+
+	TestInvalidData();
+	TestRoundTrip(random, static_cast<uint32_t>(iterations));
+	TestCommandStreams(random, static_cast<uint32_t>(iterations));
+
+	return TestCheck::Result("RefPackTests");
+}
@@ -0,0 +1,56 @@
+/*
+ * This file is part of sc4-resource-loading-hooks, a DLL Plugin for SimCity 4
+ * that allows other DLLs to modify resources as the game loads them.
+ *
+ * Copyright (C) 2024, 2025 Nicholas Hayes
+ *
+ * sc4-resource-loading-hooks is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * sc4-resource-loading-hooks is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with sc4-resource-loading-hooks.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#include <cstdio>
+
+// The tests are plain executables that return a non-zero exit code when a check fails.
+namespace TestCheck
+{
+	inline int failureCount = 0;
+
+	inline void Fail(const char* file, int line, const char* expression)
+	{
+		std::fprintf(stderr, "%s(%d): check failed: %s\n", file, line, expression);
+		failureCount++;
+	}
+
+	inline int Result(const char* testName)
+	{
+		if (failureCount == 0)
+		{
+			std::printf("%s: all checks passed\n", testName);
+			return 0;
+		}
+
+		std::fprintf(stderr, "%s: %d checks failed\n", testName, failureCount);
+		return 1;
+	}
+}
+
+#define CHECK(expression) \
+	do \
+	{ \
+		if (!(expression)) \
+		{ \
+			TestCheck::Fail(__FILE__, __LINE__, #expression); \
+		} \
+	} while (false)
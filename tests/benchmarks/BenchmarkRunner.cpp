@@ -0,0 +1,356 @@
+/*
+ * This file is part of sc4-resource-loading-hooks, a DLL Plugin for SimCity 4
+ * that allows other DLLs to modify resources as the game loads them.
+ *
+ * Copyright (C) 2024, 2025 Nicholas Hayes
+ *
+ * sc4-resource-loading-hooks is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * sc4-resource-loading-hooks is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with sc4-resource-loading-hooks.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "BenchmarkRunner.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <thread>
+
+namespace
+{
+	bool StartsWith(const char* argument, const char* prefix, const char*& value)
+	{
+		const size_t length = std::strlen(prefix);
+
+		if (std::strncmp(argument, prefix, length) == 0)
+		{
+			value = argument + length;
+			return true;
+		}
+
+		return false;
+	}
+
+	void PrintUsage(const char* program)
+	{
+		std::fprintf(
+			stderr,
+			"Usage: %s [--filter=<text>] [--output=<path>] [--min-time=<seconds>] [--repetitions=<count>] [--smoke-test]\n",
+			program);
+	}
+
+	std::string EscapeJson(const std::string& value)
+	{
+		std::string escaped;
+		escaped.reserve(value.size());
+
+		for (char c : value)
+		{
+			switch (c)
+			{
+			case '"':
+				escaped += "\\\"";
+				break;
+			case '\\':
+				escaped += "\\\\";
+				break;
+			case '\n':
+				escaped += "\\n";
+				break;
+			default:
+				if (static_cast<unsigned char>(c) < 0x20)
+				{
+					char buffer[8]{};
+					std::snprintf(buffer, sizeof(buffer), "\\u%04x", c);
+					escaped += buffer;
+				}
+				else
+				{
+					escaped += c;
+				}
+				break;
+			}
+		}
+
+		return escaped;
+	}
+
+	std::string GetCompilerName()
+	{
+#if defined(__clang__)
+		return "clang " __clang_version__;
+#elif defined(__GNUC__)
+		return "gcc " __VERSION__;
+#elif defined(_MSC_VER)
+		return "msvc " + std::to_string(_MSC_FULL_VER);
+#else
+		return "unknown";
+#endif
+	}
+
+	std::string GetCurrentDate()
+	{
+		const std::time_t now = std::time(nullptr);
+		std::tm utc{};
+#ifdef _WIN32
+		gmtime_s(&utc, &now);
+#else
+		gmtime_r(&now, &utc);
+#endif
+		char buffer[32]{};
+		std::strftime(buffer, sizeof(buffer), "%Y-%m-%dT%H:%M:%SZ", &utc);
+
+		return buffer;
+	}
+
+	struct Sample
+	{
+		double realTimeNanoseconds;
+		double cpuTimeNanoseconds;
+	};
+
+	Sample Measure(const Benchmark::Runner::Function& function, uint64_t iterations)
+	{
+		const std::clock_t cpuStart = std::clock();
+		const auto start = std::chrono::steady_clock::now();
+
+		function(iterations);
+
+		const auto end = std::chrono::steady_clock::now();
+		const std::clock_t cpuEnd = std::clock();
+
+		Sample sample{};
+		sample.realTimeNanoseconds = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count());
+		sample.cpuTimeNanoseconds = static_cast<double>(cpuEnd - cpuStart) * 1e9 / CLOCKS_PER_SEC;
+
+		return sample;
+	}
+}
+
+bool Benchmark::ParseArguments(int argc, char* argv[], Options& options)
+{
+	for (int i = 1; i < argc; i++)
+	{
+		const char* argument = argv[i];
+		const char* value = nullptr;
+
+		if (StartsWith(argument, "--filter=", value))
+		{
+			options.filter = value;
+		}
+		else if (StartsWith(argument, "--output=", value))
+		{
+			options.outputPath = value;
+		}
+		else if (StartsWith(argument, "--min-time=", value))
+		{
+			char* end = nullptr;
+			options.minTimeSeconds = std::strtod(value, &end);
+
+			if (end == value || *end != '\0' || options.minTimeSeconds < 0)
+			{
+				PrintUsage(argv[0]);
+				return false;
+			}
+		}
+		else if (StartsWith(argument, "--repetitions=", value))
+		{
+			char* end = nullptr;
+			const unsigned long repetitions = std::strtoul(value, &end, 10);
+
+			if (end == value || *end != '\0' || repetitions == 0 || repetitions > 1000)
+			{
+				PrintUsage(argv[0]);
+				return false;
+			}
+
+			options.repetitions = static_cast<uint32_t>(repetitions);
+		}
+		else if (std::strcmp(argument, "--smoke-test") == 0)
+		{
+			options.smokeTest = true;
+		}
+		else
+		{
+			PrintUsage(argv[0]);
+			return false;
+		}
+	}
+
+	return true;
+}
+
+Benchmark::Runner::Runner(const char* suiteName, const Options& options)
+	: suiteName(suiteName),
+	  options(options),
+	  context(),
+	  results()
+{
+}
+
+void Benchmark::Runner::AddContext(const std::string& name, const std::string& value)
+{
+	context.emplace_back(name, value);
+}
+
+bool Benchmark::Runner::IsEnabled(const std::string& name) const
+{
+	return options.filter.empty() || name.find(options.filter) != std::string::npos;
+}
+
+void Benchmark::Runner::Run(const std::string& name, const Function& function, uint64_t bytesPerIteration)
+{
+	if (!IsEnabled(name))
+	{
+		return;
+	}
+
+	Result result{};
+	result.name = name;
+	result.bytesPerIteration = bytesPerIteration;
+
+	if (options.smokeTest)
+	{
+		const Sample sample = Measure(function, 1);
+
+		result.iterations = 1;
+		result.realTimeNanoseconds = sample.realTimeNanoseconds;
+		result.minRealTimeNanoseconds = sample.realTimeNanoseconds;
+		result.maxRealTimeNanoseconds = sample.realTimeNanoseconds;
+		result.cpuTimeNanoseconds = sample.cpuTimeNanoseconds;
+	}
+	else
+	{
+		// Find an iteration count that runs for at least the minimum time,
+		// the first runs also warm up the caches.
+		const double minTimeNanoseconds = options.minTimeSeconds * 1e9;
+		uint64_t iterations = 1;
+
+		while (true)
+		{
+			const Sample sample = Measure(function, iterations);
+
+			if (sample.realTimeNanoseconds >= minTimeNanoseconds || iterations >= (1ULL << 40))
+			{
+				break;
+			}
+
+			// Grow by at most 10 times, aiming 20% above the minimum time.
+			const double perIteration = std::max(sample.realTimeNanoseconds, 1.0) / static_cast<double>(iterations);
+			const double target = minTimeNanoseconds * 1.2 / perIteration;
+			iterations = static_cast<uint64_t>(std::clamp(target, static_cast<double>(iterations + 1), static_cast<double>(iterations) * 10.0));
+		}
+
+		std::vector<Sample> samples;
+		samples.reserve(options.repetitions);
+
+		for (uint32_t i = 0; i < options.repetitions; i++)
+		{
+			samples.push_back(Measure(function, iterations));
+		}
+
+		std::sort(samples.begin(), samples.end(), [](const Sample& a, const Sample& b) { return a.realTimeNanoseconds < b.realTimeNanoseconds; });
+
+		const Sample& median = samples[samples.size() / 2];
+		const double count = static_cast<double>(iterations);
+
+		result.iterations = iterations;
+		result.realTimeNanoseconds = median.realTimeNanoseconds / count;
+		result.minRealTimeNanoseconds = samples.front().realTimeNanoseconds / count;
+		result.maxRealTimeNanoseconds = samples.back().realTimeNanoseconds / count;
+		result.cpuTimeNanoseconds = median.cpuTimeNanoseconds / count;
+	}
+
+	std::fprintf(stderr, "%-60s %14.1f ns %12llu iterations\n", name.c_str(), result.realTimeNanoseconds, static_cast<unsigned long long>(result.iterations));
+
+	results.push_back(std::move(result));
+}
+
+int Benchmark::Runner::Finish()
+{
+	std::ostringstream json;
+	json.precision(17);
+
+	json << "{\n";
+	json << "  \"context\": {\n";
+	json << "    \"suite\": \"" << EscapeJson(suiteName) << "\",\n";
+	json << "    \"date\": \"" << GetCurrentDate() << "\",\n";
+	json << "    \"compiler\": \"" << EscapeJson(GetCompilerName()) << "\",\n";
+#ifdef NDEBUG
+	json << "    \"library_build_type\": \"release\",\n";
+#else
+	json << "    \"library_build_type\": \"debug\",\n";
+#endif
+	json << "    \"num_cpus\": " << std::thread::hardware_concurrency() << ",\n";
+	json << "    \"repetitions\": " << (options.smokeTest ? 1 : options.repetitions) << ",\n";
+	json << "    \"min_time\": " << options.minTimeSeconds;
+
+	for (const auto& [name, value] : context)
+	{
+		json << ",\n    \"" << EscapeJson(name) << "\": \"" << EscapeJson(value) << '"';
+	}
+
+	json << "\n  },\n";
+	json << "  \"benchmarks\": [";
+
+	for (size_t i = 0; i < results.size(); i++)
+	{
+		const Result& result = results[i];
+		const double itemsPerSecond = result.realTimeNanoseconds > 0 ? 1e9 / result.realTimeNanoseconds : 0;
+
+		json << (i == 0 ? "\n" : ",\n");
+		json << "    {\n";
+		json << "      \"name\": \"" << EscapeJson(result.name) << "\",\n";
+		json << "      \"run_name\": \"" << EscapeJson(result.name) << "\",\n";
+		json << "      \"run_type\": \"iteration\",\n";
+		json << "      \"iterations\": " << result.iterations << ",\n";
+		json << "      \"real_time\": " << result.realTimeNanoseconds << ",\n";
+		json << "      \"cpu_time\": " << result.cpuTimeNanoseconds << ",\n";
+		json << "      \"min_time\": " << result.minRealTimeNanoseconds << ",\n";
+		json << "      \"max_time\": " << result.maxRealTimeNanoseconds << ",\n";
+		json << "      \"time_unit\": \"ns\",\n";
+
+		if (result.bytesPerIteration > 0)
+		{
+			json << "      \"bytes_per_second\": " << itemsPerSecond * static_cast<double>(result.bytesPerIteration) << ",\n";
+		}
+
+		json << "      \"items_per_second\": " << itemsPerSecond << "\n";
+		json << "    }";
+	}
+
+	json << "\n  ]\n}\n";
+
+	if (options.outputPath.empty())
+	{
+		std::cout << json.str();
+		std::cout.flush();
+
+		return std::cout.good() ? 0 : 1;
+	}
+
+	std::ofstream output(options.outputPath, std::ios::binary | std::ios::trunc);
+	output << json.str();
+
+	if (!output)
+	{
+		std::fprintf(stderr, "Failed to write the benchmark results to %s\n", options.outputPath.c_str());
+		return 1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,103 @@
+/*
+ * This file is part of sc4-resource-loading-hooks, a DLL Plugin for SimCity 4
+ * that allows other DLLs to modify resources as the game loads them.
+ *
+ * Copyright (C) 2024, 2025 Nicholas Hayes
+ *
+ * sc4-resource-loading-hooks is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * sc4-resource-loading-hooks is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with sc4-resource-loading-hooks.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+// A small benchmark runner for the portable build, it does not depend on a benchmark library.
+//
+// The results are written as JSON with the field names that Google Benchmark uses
+// (name, iterations, real_time, cpu_time, time_unit, items_per_second and bytes_per_second),
+// so the runs can be compared with its tools/compare.py script. The times are the median
+// of the repetitions, the minimum and maximum are written as min_time and max_time.
+namespace Benchmark
+{
+	struct Options
+	{
+		// Only the benchmarks whose name contains this text are run.
+		std::string filter;
+		// The JSON results are written to standard output when this is empty.
+		std::string outputPath;
+		// The minimum time of each repetition.
+		double minTimeSeconds = 0.1;
+		uint32_t repetitions = 5;
+		// Runs every benchmark once, for checking that the benchmarks work.
+		bool smokeTest = false;
+	};
+
+	// Parses --filter=<text>, --output=<path>, --min-time=<seconds>, --repetitions=<count> and --smoke-test.
+	// Returns false and prints the usage if an argument is not valid.
+	bool ParseArguments(int argc, char* argv[], Options& options);
+
+	// Keeps the compiler from removing a computation whose result is not used.
+	template<typename T> inline void DoNotOptimize(const T& value)
+	{
+#if defined(__GNUC__) || defined(__clang__)
+		asm volatile("" : : "r,m"(value) : "memory");
+#else
+		const volatile T* volatile pointer = &value;
+		(void)pointer;
+#endif
+	}
+
+	class Runner
+	{
+	public:
+
+		// The function performs the operation the given number of times.
+		using Function = std::function<void(uint64_t iterations)>;
+
+		Runner(const char* suiteName, const Options& options);
+
+		// Adds a context value to the JSON output, e.g. the size of the test data.
+		void AddContext(const std::string& name, const std::string& value);
+
+		// Runs the benchmark if it matches the filter.
+		// The bytes per iteration are used for the bytes_per_second field, 0 to omit it.
+		void Run(const std::string& name, const Function& function, uint64_t bytesPerIteration = 0);
+
+		bool IsEnabled(const std::string& name) const;
+
+		// Writes the JSON results, returns the exit code for main.
+		int Finish();
+
+	private:
+
+		struct Result
+		{
+			std::string name;
+			uint64_t iterations;
+			double realTimeNanoseconds;
+			double minRealTimeNanoseconds;
+			double maxRealTimeNanoseconds;
+			double cpuTimeNanoseconds;
+			uint64_t bytesPerIteration;
+		};
+
+		std::string suiteName;
+		Options options;
+		std::vector<std::pair<std::string, std::string>> context;
+		std::vector<Result> results;
+	};
+}
@@ -0,0 +1,500 @@
+/*
+ * This file is part of sc4-resource-loading-hooks, a DLL Plugin for SimCity 4
+ * that allows other DLLs to modify resources as the game loads them.
+ *
+ * Copyright (C) 2024, 2025 Nicholas Hayes
+ *
+ * sc4-resource-loading-hooks is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * sc4-resource-loading-hooks is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with sc4-resource-loading-hooks.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Benchmarks the native DBPF record reading that the exemplar patch scan uses:
+// the QFS/RefPack decompression of the patch cohort records and of larger records
+// whose matches take the different copy paths, and the text and binary exemplar parsers.
+
+#include "BenchmarkRunner.h"
+#include "cIGZVariant.h"
+#include "ExemplarBinaryParser.h"
+#include "ExemplarBinaryWriter.h"
+#include "ExemplarTextParser.h"
+#include "RefPackCompressor.h"
+#include "RefPackDecompressor.h"
+#include "SyntheticExemplarPopulation.h"
+#include <algorithm>
+#include <cinttypes>
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace
+{
+	struct CompressedRecord
+	{
+		std::vector<uint8_t> data;
+		uint32_t uncompressedSize;
+	};
+
+	void RunRefPackBenchmark(
+		Benchmark::Runner& runner,
+		const std::string& name,
+		const std::vector<CompressedRecord>& records)
+	{
+		uint64_t totalSize = 0;
+		uint32_t maxSize = 0;
+
+		for (const CompressedRecord& record : records)
+		{
+			totalSize += record.uncompressedSize;
+			maxSize = std::max(maxSize, record.uncompressedSize);
+		}
+
+		std::vector<uint8_t> output(maxSize);
+
+		// Each iteration decompresses every record, like a scan of the files.
+		runner.Run(name, [&](uint64_t iterations)
+		{
+			bool result = true;
+
+			for (uint64_t i = 0; i < iterations; i++)
+			{
+				for (const CompressedRecord& record : records)
+				{
+					result &= RefPackDecompressor::Decompress(
+						record.data.data(),
+						record.data.size(),
+						output.data(),
+						record.uncompressedSize);
+				}
+
+				Benchmark::DoNotOptimize(output.data());
+			}
+
+			if (!result)
+			{
+				std::fprintf(stderr, "%s: a record failed to decompress.\n", name.c_str());
+			}
+		}, totalSize);
+	}
+
+	bool AddCompressedRecord(const std::vector<uint8_t>& data, std::vector<CompressedRecord>& records)
+	{
+		CompressedRecord record;
+		record.uncompressedSize = static_cast<uint32_t>(data.size());
+
+		if (!RefPackCompressor::Compress(data.data(), data.size(), record.data))
+		{
+			return false;
+		}
+
+		records.push_back(std::move(record));
+		return true;
+	}
+
+	void RunPatchCohortBenchmarks(Benchmark::Runner& runner)
+	{
+		const std::string name = "RefPack/Decompress/patch_cohorts";
+
+		if (!runner.IsEnabled(name))
+		{
+			return;
+		}
+
+		// The patches of a large plugin set, each one targets a few dozen exemplars
+		// and sets a few dozen properties.
+		SyntheticPopulationOptions options;
+		options.exemplarCount = 65536;
+		options.patchCount = 1024;
+		options.patchTargetCount = 48;
+		options.patchPropertyCount = 24;
+
+		const SyntheticExemplarPopulation population(options);
+
+		std::vector<CompressedRecord> records;
+		std::vector<uint8_t> buffer;
+
+		for (uint32_t i = 0; i < population.GetPatchCount(); i++)
+		{
+			const SyntheticResource patch = population.CreatePatch(i);
+
+			if (ExemplarBinaryWriter::Write(patch.properties, patch.parentCohortKey, ExemplarBinaryWriter::FileKind::Cohort, buffer))
+			{
+				AddCompressedRecord(buffer, records);
+			}
+		}
+
+		runner.AddContext("patch_cohort_records", std::to_string(records.size()));
+		RunRefPackBenchmark(runner, name, records);
+	}
+
+	// A single large record with the data that selects one of the copy paths.
+	void RunRecordBenchmark(Benchmark::Runner& runner, const std::string& kind, size_t size)
+	{
+		const std::string name = "RefPack/Decompress/" + kind + ":" + std::to_string(size / 1024) + "KiB";
+
+		if (!runner.IsEnabled(name))
+		{
+			return;
+		}
+
+		std::mt19937_64 random(1);
+		std::vector<uint8_t> data(size);
+
+		if (kind == "text")
+		{
+			// Text exemplar lines with a few changed characters, mostly medium matches with literals.
+			static constexpr char Line[] = "0x27812810:{\"Occupant Size\"}=Float32:3:{16.0000,9.5000,16.0000}\r\n";
+
+			for (size_t i = 0; i < size; i++)
+			{
+				data[i] = random() % 40 == 0 ? static_cast<uint8_t>('0' + random() % 10) : static_cast<uint8_t>(Line[i % (sizeof(Line) - 1)]);
+			}
+		}
+		else if (kind == "runs")
+		{
+			// Long runs of a few values, the copies use the 16-byte blocks.
+			for (size_t i = 0; i < size;)
+			{
+				const size_t run = std::min<size_t>(size - i, 64 + random() % 4096);
+
+				std::fill_n(data.begin() + static_cast<ptrdiff_t>(i), run, static_cast<uint8_t>(random() % 4));
+				i += run;
+			}
+		}
+		else if (kind == "short_offsets")
+		{
+			// A pattern that repeats every 6 bytes, the overlapping copies are byte by byte.
+			for (size_t i = 0; i < size; i++)
+			{
+				data[i] = static_cast<uint8_t>((i % 6) * 17);
+			}
+		}
+		else
+		{
+			// A small alphabet without long matches, mostly short copies and literals.
+			for (uint8_t& value : data)
+			{
+				value = static_cast<uint8_t>('a' + random() % 8);
+			}
+		}
+
+		std::vector<CompressedRecord> records;
+
+		if (!AddCompressedRecord(data, records))
+		{
+			std::fprintf(stderr, "%s: the data does not compress.\n", name.c_str());
+			return;
+		}
+
+		runner.AddContext(name + "/compressed_bytes", std::to_string(records.front().data.size()));
+		RunRefPackBenchmark(runner, name, records);
+	}
+
+	void AppendFormat(std::string& text, const char* format, ...)
+#if defined(__GNUC__) || defined(__clang__)
+		__attribute__((format(printf, 2, 3)))
+#endif
+		;
+
+	void AppendFormat(std::string& text, const char* format, ...)
+	{
+		char buffer[64];
+
+		va_list args;
+		va_start(args, format);
+		const int length = std::vsnprintf(buffer, sizeof(buffer), format, args);
+		va_end(args);
+
+		if (length > 0)
+		{
+			text.append(buffer, std::min(static_cast<size_t>(length), sizeof(buffer) - 1));
+		}
+	}
+
+	// Writes the properties in the text format that the plugin creators use, with the
+	// hexadecimal integers and the decimal floats that the reader tools write.
+	// Returns false if a property uses a value type that the synthetic populations do not create.
+	bool WriteTextExemplar(
+		const MockPropertyList& properties,
+		const cGZPersistResourceKey& parentCohortKey,
+		bool isCohort,
+		std::string& text)
+	{
+		text = isCohort ? "CQZT1###\r\n" : "EQZT1###\r\n";
+		AppendFormat(
+			text,
+			"ParentCohort=Key:{0x%08" PRIX32 ",0x%08" PRIX32 ",0x%08" PRIX32 "}\r\n",
+			parentCohortKey.type,
+			parentCohortKey.group,
+			parentCohortKey.instance);
+		AppendFormat(text, "PropCount=0x%08zX\r\n", properties.size());
+
+		for (const cRZAutoRefCount<cISCProperty>& property : properties)
+		{
+			const cIGZVariant* value = property->GetPropertyValue();
+			const uint32_t count = value->GetCount();
+
+			AppendFormat(text, "0x%08" PRIX32 ":{\"Property\"}=", property->GetPropertyID());
+
+			switch (value->GetType())
+			{
+			case cIGZVariant::Uint32:
+				AppendFormat(text, "Uint32:0:{0x%08" PRIX32 "}", *value->RefUint32());
+				break;
+			case cIGZVariant::Uint32Array:
+				AppendFormat(text, "Uint32:%" PRIu32 ":{", count);
+
+				for (uint32_t i = 0; i < count; i++)
+				{
+					AppendFormat(text, i > 0 ? ",0x%08" PRIX32 : "0x%08" PRIX32, value->RefUint32()[i]);
+				}
+
+				text += '}';
+				break;
+			case cIGZVariant::Float32Array:
+				AppendFormat(text, "Float32:%" PRIu32 ":{", count);
+
+				for (uint32_t i = 0; i < count; i++)
+				{
+					// 9 significant digits read back as the same float.
+					AppendFormat(text, i > 0 ? ",%.9g" : "%.9g", static_cast<double>(value->RefFloat32()[i]));
+				}
+
+				text += '}';
+				break;
+			case cIGZVariant::RZCharArray:
+				AppendFormat(text, "String:1:{\"");
+				text.append(value->RefRZChar(), count);
+				text += "\"}";
+				break;
+			default:
+				return false;
+			}
+
+			text += "\r\n";
+		}
+
+		return true;
+	}
+
+	bool HasSameProperties(const ExemplarTextParser& textParser, const ExemplarBinaryParser& binaryParser)
+	{
+		bool same = textParser.GetPropertyCount() == binaryParser.GetPropertyCount();
+
+		textParser.EnumProperties([&](const ExemplarPropertyView& textProperty)
+		{
+			ExemplarPropertyView binaryProperty{};
+
+			same = same
+				&& binaryParser.FindProperty(textProperty.id, binaryProperty)
+				&& textProperty.type == binaryProperty.type
+				&& textProperty.isArray == binaryProperty.isArray
+				&& textProperty.count == binaryProperty.count
+				&& std::memcmp(
+					textProperty.values,
+					binaryProperty.values,
+					textProperty.count * ExemplarFormat::GetValueSize(textProperty.type)) == 0;
+		});
+
+		return same;
+	}
+
+	struct ExemplarRecords
+	{
+		std::vector<std::string> text;
+		std::vector<std::vector<uint8_t>> binary;
+		uint64_t textSize = 0;
+		uint64_t binarySize = 0;
+	};
+
+	// Writes the resources in both formats and checks that the parsers read the same properties.
+	bool CreateExemplarRecords(
+		const std::vector<SyntheticResource>& resources,
+		bool isCohort,
+		ExemplarRecords& records)
+	{
+		const ExemplarBinaryWriter::FileKind kind = isCohort ? ExemplarBinaryWriter::FileKind::Cohort : ExemplarBinaryWriter::FileKind::Exemplar;
+
+		ExemplarTextParser textParser;
+		ExemplarBinaryParser binaryParser;
+
+		for (const SyntheticResource& resource : resources)
+		{
+			std::string text;
+			std::vector<uint8_t> binary;
+
+			if (!WriteTextExemplar(resource.properties, resource.parentCohortKey, isCohort, text)
+				|| !ExemplarBinaryWriter::Write(resource.properties, resource.parentCohortKey, kind, binary)
+				|| !textParser.Open(reinterpret_cast<const uint8_t*>(text.data()), text.size())
+				|| !binaryParser.Open(binary.data(), binary.size())
+				|| !HasSameProperties(textParser, binaryParser))
+			{
+				return false;
+			}
+
+			records.textSize += text.size();
+			records.binarySize += binary.size();
+			records.text.push_back(std::move(text));
+			records.binary.push_back(std::move(binary));
+		}
+
+		return true;
+	}
+
+	void RunParserBenchmarks(Benchmark::Runner& runner, const std::string& suffix, const ExemplarRecords& records)
+	{
+		runner.Run("ExemplarTextParser/Open/" + suffix, [&](uint64_t iterations)
+		{
+			ExemplarTextParser parser;
+			uint32_t propertyCount = 0;
+
+			for (uint64_t i = 0; i < iterations; i++)
+			{
+				for (const std::string& text : records.text)
+				{
+					if (parser.Open(reinterpret_cast<const uint8_t*>(text.data()), text.size()))
+					{
+						propertyCount += parser.GetPropertyCount();
+					}
+				}
+			}
+
+			Benchmark::DoNotOptimize(propertyCount);
+		}, records.textSize);
+
+		// The binary parser on the same properties, for comparison.
+		runner.Run("ExemplarBinaryParser/Open/" + suffix, [&](uint64_t iterations)
+		{
+			ExemplarBinaryParser parser;
+			uint32_t propertyCount = 0;
+
+			for (uint64_t i = 0; i < iterations; i++)
+			{
+				for (const std::vector<uint8_t>& binary : records.binary)
+				{
+					if (parser.Open(binary.data(), binary.size()))
+					{
+						propertyCount += parser.GetPropertyCount();
+					}
+				}
+			}
+
+			Benchmark::DoNotOptimize(propertyCount);
+		}, records.binarySize);
+	}
+
+	bool RunExemplarParserBenchmarks(Benchmark::Runner& runner)
+	{
+		static constexpr const char* Suffixes[] = { "patch_cohorts", "exemplars", "large_arrays" };
+
+		bool valid = true;
+
+		for (const char* suffix : Suffixes)
+		{
+			const std::string name = suffix;
+
+			if (!runner.IsEnabled("ExemplarTextParser/Open/" + name) && !runner.IsEnabled("ExemplarBinaryParser/Open/" + name))
+			{
+				continue;
+			}
+
+			SyntheticPopulationOptions options;
+			std::vector<SyntheticResource> resources;
+			bool isCohort = false;
+
+			if (name == "patch_cohorts")
+			{
+				// The patch cohorts have a target list and a few properties.
+				options.exemplarCount = 65536;
+				options.patchCount = 1024;
+				options.patchTargetCount = 16;
+				options.patchPropertyCount = 8;
+				isCohort = true;
+			}
+			else if (name == "exemplars")
+			{
+				options.exemplarCount = 1024;
+				options.exemplarPropertyCount = 24;
+				options.patchCount = 0;
+			}
+			else
+			{
+				// A few patches with long target lists, mostly the hexadecimal number parsing.
+				options.exemplarCount = 65536;
+				options.patchCount = 16;
+				options.patchTargetCount = 2048;
+				options.patchPropertyCount = 4;
+				isCohort = true;
+			}
+
+			const SyntheticExemplarPopulation population(options);
+
+			if (isCohort)
+			{
+				for (uint32_t i = 0; i < population.GetPatchCount(); i++)
+				{
+					resources.push_back(population.CreatePatch(i));
+				}
+			}
+			else
+			{
+				for (uint32_t i = 0; i < population.GetExemplarCount(); i++)
+				{
+					resources.push_back(population.CreateExemplar(i));
+				}
+			}
+
+			ExemplarRecords records;
+
+			if (!CreateExemplarRecords(resources, isCohort, records))
+			{
+				std::fprintf(stderr, "%s: the text and binary parsers read different properties.\n", suffix);
+				valid = false;
+				continue;
+			}
+
+			runner.AddContext(name + "/records", std::to_string(records.text.size()));
+			RunParserBenchmarks(runner, name, records);
+		}
+
+		return valid;
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	Benchmark::Options options;
+
+	if (!Benchmark::ParseArguments(argc, argv, options))
+	{
+		return 2;
+	}
+
+	Benchmark::Runner runner("DBPFBenchmarks", options);
+
+	RunPatchCohortBenchmarks(runner);
+
+	for (const char* kind : { "text", "runs", "short_offsets", "alphabet" })
+	{
+		RunRecordBenchmark(runner, kind, 1024 * 1024);
+	}
+
+	const bool parsersMatch = RunExemplarParserBenchmarks(runner);
+	const int result = runner.Finish();
+
+	return parsersMatch ? result : 1;
+}
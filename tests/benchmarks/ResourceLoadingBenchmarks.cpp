@@ -0,0 +1,395 @@
+/*
+ * This file is part of sc4-resource-loading-hooks, a DLL Plugin for SimCity 4
+ * that allows other DLLs to modify resources as the game loads them.
+ *
+ * Copyright (C) 2024, 2025 Nicholas Hayes
+ *
+ * sc4-resource-loading-hooks is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * sc4-resource-loading-hooks is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with sc4-resource-loading-hooks.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Benchmarks the code that runs when the game loads an exemplar: the TGI hashing,
+// the patch index lookups, the load notification dispatch, the patch application
+// and the log writes.
+
+#include "BenchmarkRunner.h"
+#include "cIExemplarLoadHookTarget.h"
+#include "ExemplarLoadTargetRegistry.h"
+#include "ExemplarPatch.h"
+#include "ExemplarPatchIndex.h"
+#include "ExemplarPatchingHarness.h"
+#include "IApplyExemplarPatch.h"
+#include "Logger.h"
+#include "PersistResourceKeyBoostHash.h"
+#include "SyntheticExemplarPopulation.h"
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace
+{
+	constexpr uint32_t ExemplarTypeID = 0x6534284A;
+	constexpr uint32_t CohortTypeID = 0x05342861;
+	constexpr uint32_t ExemplarPatchGroupID = 0xB03697D1;
+
+	// The keys are looked up in a shuffled order, the lookups do not follow the insertion order.
+	std::vector<cGZPersistResourceKey> CreateKeys(uint32_t count, uint32_t instanceBase)
+	{
+		std::vector<cGZPersistResourceKey> keys;
+		keys.reserve(count);
+
+		uint64_t state = 0x2545F4914F6CDD1DULL ^ instanceBase;
+
+		for (uint32_t i = 0; i < count; i++)
+		{
+			state ^= state << 13;
+			state ^= state >> 7;
+			state ^= state << 17;
+
+			keys.emplace_back(ExemplarTypeID, 0x5A000000 + static_cast<uint32_t>(state % 64), instanceBase + static_cast<uint32_t>(state >> 32));
+		}
+
+		return keys;
+	}
+
+	void RunTGIHashBenchmarks(Benchmark::Runner& runner)
+	{
+		const std::vector<cGZPersistResourceKey> keys = CreateKeys(4096, 0x10000000);
+		const boost::hash<const cGZPersistResourceKey> hasher;
+
+		runner.Run("TGIHash/boost_hash", [&](uint64_t iterations)
+		{
+			size_t combined = 0;
+
+			for (uint64_t i = 0; i < iterations; i++)
+			{
+				combined += hasher(keys[i & 4095]);
+			}
+
+			Benchmark::DoNotOptimize(combined);
+		});
+	}
+
+	void RunPatchIndexBenchmarks(Benchmark::Runner& runner, uint32_t targetCount)
+	{
+		const std::string suffix = "/targets:" + std::to_string(targetCount);
+
+		if (!runner.IsEnabled("PatchIndex/Find_hit" + suffix) && !runner.IsEnabled("PatchIndex/Find_miss" + suffix))
+		{
+			return;
+		}
+
+		const std::vector<cGZPersistResourceKey> targets = CreateKeys(targetCount, 0x10000000);
+		const std::vector<cGZPersistResourceKey> missingKeys = CreateKeys(4096, 0x90000000);
+
+		// Every patch targets 8 exemplars, like a small building or prop pack.
+		ExemplarPatchIndex index;
+		std::shared_ptr<const ExemplarPatch> patch;
+
+		for (uint32_t i = 0; i < targetCount; i++)
+		{
+			if (i % 8 == 0)
+			{
+				patch = std::make_shared<const ExemplarPatch>(cGZPersistResourceKey(CohortTypeID, ExemplarPatchGroupID, i / 8));
+			}
+
+			index.AddPatch(patch, targets[i]);
+		}
+
+		const size_t mask = 4095;
+		std::vector<cGZPersistResourceKey> hitKeys(mask + 1);
+
+		for (size_t i = 0; i < hitKeys.size(); i++)
+		{
+			hitKeys[i] = targets[(i * 2654435761ULL) % targets.size()];
+		}
+
+		runner.Run("PatchIndex/Find_hit" + suffix, [&](uint64_t iterations)
+		{
+			size_t found = 0;
+
+			for (uint64_t i = 0; i < iterations; i++)
+			{
+				found += !index.Find(hitKeys[i & mask]).empty();
+			}
+
+			Benchmark::DoNotOptimize(found);
+		});
+
+		runner.Run("PatchIndex/Find_miss" + suffix, [&](uint64_t iterations)
+		{
+			size_t found = 0;
+
+			for (uint64_t i = 0; i < iterations; i++)
+			{
+				found += !index.Find(missingKeys[i & mask]).empty();
+			}
+
+			Benchmark::DoNotOptimize(found);
+		});
+	}
+
+	class NullLoadTarget : public cIExemplarLoadHookTarget
+	{
+	public:
+		bool QueryInterface(uint32_t riid, void** ppvObj) override
+		{
+			return false;
+		}
+
+		uint32_t AddRef() override
+		{
+			return 1;
+		}
+
+		uint32_t Release() override
+		{
+			return 1;
+		}
+
+		void ExemplarLoaded(
+			const char* const originalFunctionName,
+			const cGZPersistResourceKey& key,
+			cISCResExemplar* resExemplar) override
+		{
+			loadCount++;
+		}
+
+		uint64_t loadCount = 0;
+	};
+
+	void RunLoadDispatchBenchmarks(Benchmark::Runner& runner, uint32_t subscriberCount)
+	{
+		const std::string name = "ExemplarLoadDispatch/subscribers:" + std::to_string(subscriberCount);
+
+		if (!runner.IsEnabled(name))
+		{
+			return;
+		}
+
+		const std::vector<cGZPersistResourceKey> keys = CreateKeys(4096, 0x10000000);
+
+		// A mix of the filters that the DLLs use: every exemplar, one group,
+		// one exemplar and a group that is not loaded.
+		std::vector<NullLoadTarget> targets(subscriberCount);
+		ExemplarLoadTargetRegistry registry;
+
+		for (uint32_t i = 0; i < subscriberCount; i++)
+		{
+			const cGZPersistResourceKey& key = keys[i % keys.size()];
+
+			switch (i % 4)
+			{
+			case 0:
+				registry.AddLoadTarget(&targets[i], 0, 0);
+				break;
+			case 1:
+				registry.AddLoadTarget(&targets[i], key.group, 0);
+				break;
+			case 2:
+				registry.AddLoadTarget(&targets[i], key.group, key.instance);
+				break;
+			case 3:
+				registry.AddLoadTarget(&targets[i], 0x7A000000 + i, 0);
+				break;
+			}
+		}
+
+		runner.Run(name, [&](uint64_t iterations)
+		{
+			for (uint64_t i = 0; i < iterations; i++)
+			{
+				registry.ExemplarLoaded(__FUNCSIG__, keys[i & 4095], nullptr);
+			}
+		});
+	}
+
+	void RunApplyPatchBenchmarks(Benchmark::Runner& runner, uint32_t patchPropertyCount, bool skipIdentical)
+	{
+		std::string suffix = "/patch_properties:" + std::to_string(patchPropertyCount);
+
+		if (skipIdentical)
+		{
+			suffix += "/skip_identical";
+		}
+
+		const std::string applyName = "ApplyPatches" + suffix;
+		const std::string loadName = "ExemplarLoad/patched" + suffix;
+		const std::string unpatchedLoadName = "ExemplarLoad/unpatched" + suffix;
+
+		if (!runner.IsEnabled(applyName) && !runner.IsEnabled(loadName) && !runner.IsEnabled(unpatchedLoadName))
+		{
+			return;
+		}
+
+		SyntheticPopulationOptions options;
+		options.exemplarCount = 4096;
+		options.exemplarPropertyCount = 32;
+		options.patchCount = 1024;
+		options.patchTargetCount = 16;
+		// Without overlap every patched exemplar has a few patches, the shared exemplars
+		// would make the time depend on which exemplars a short run reaches.
+		options.targetOverlap = 0.0;
+		options.patchPropertyCount = patchPropertyCount;
+
+		const SyntheticExemplarPopulation population(options);
+
+		std::vector<std::string> arguments;
+
+		if (skipIdentical)
+		{
+			arguments.push_back("-exemplar-patch-skip-identical");
+		}
+
+		ExemplarPatchingHarness harness(arguments);
+		population.AddTo(harness.GetResourceManager());
+
+		cRZAutoRefCount<IApplyExemplarPatch> applyPatch;
+
+		if (!harness.Start()
+			|| !harness.GetPatchingServer()->QueryInterface(GZIID_IApplyExemplarPatch, applyPatch.AsPPVoid()))
+		{
+			std::fprintf(stderr, "Failed to start the exemplar patching harness.\n");
+			return;
+		}
+
+		std::vector<cGZPersistResourceKey> patchedKeys;
+		std::vector<cGZPersistResourceKey> unpatchedKeys;
+		std::vector<cRZAutoRefCount<cISCResExemplar>> patchedExemplars;
+
+		for (uint32_t i = 0; i < population.GetExemplarCount(); i++)
+		{
+			const cGZPersistResourceKey key = population.GetExemplarKey(i);
+
+			if (population.GetPatchesByExemplar()[i].empty())
+			{
+				unpatchedKeys.push_back(key);
+			}
+			else
+			{
+				patchedKeys.push_back(key);
+				patchedExemplars.push_back(harness.LoadExemplar(key));
+			}
+		}
+
+		// The exemplars were patched when they were loaded, so this applies the patches
+		// over their own values. The patches of an exemplar set some of the same properties,
+		// most properties are still replaced when the identical properties are skipped.
+		runner.Run(applyName, [&](uint64_t iterations)
+		{
+			for (uint64_t i = 0; i < iterations; i++)
+			{
+				const size_t index = i % patchedKeys.size();
+				applyPatch->ApplyPatches(patchedKeys[index], patchedExemplars[index]);
+			}
+		});
+
+		// The complete load through the resource manager, the original factory and the proxy.
+		// The difference between the two loads is the cost of the lookup hit and the patching.
+		const auto runLoads = [&](const std::vector<cGZPersistResourceKey>& keys)
+		{
+			return [&harness, &keys](uint64_t iterations)
+			{
+				for (uint64_t i = 0; i < iterations; i++)
+				{
+					cRZAutoRefCount<cISCResExemplar> exemplar = harness.LoadExemplar(keys[i % keys.size()]);
+					Benchmark::DoNotOptimize(exemplar.p);
+				}
+			};
+		};
+
+		runner.Run(loadName, runLoads(patchedKeys));
+
+		if (!unpatchedKeys.empty())
+		{
+			runner.Run(unpatchedLoadName, runLoads(unpatchedKeys));
+		}
+	}
+
+	void RunLoggerBenchmarks(Benchmark::Runner& runner)
+	{
+		if (!runner.IsEnabled("Logger/"))
+		{
+			return;
+		}
+
+		// The lines are written to the null device, this measures the formatting,
+		// the lock and the stream and not the disk.
+#ifdef _WIN32
+		const char* const nullDevice = "NUL";
+#else
+		const char* const nullDevice = "/dev/null";
+#endif
+		Logger& logger = Logger::GetInstance();
+		logger.Init(nullDevice, LogLevel::Info);
+
+		constexpr const char* format = "Exemplar patch T=0x%08X, G=0x%08X, I=0x%08X loaded from %s";
+		constexpr const char* path = "Plugins/zzz_Example Patches/Example Patches.dat";
+
+		char sample[256]{};
+		const int sampleLength = std::snprintf(sample, sizeof(sample), format, CohortTypeID, ExemplarPatchGroupID, 0x12345678, path);
+
+		runner.Run("Logger/WriteLineFormatted", [&](uint64_t iterations)
+		{
+			for (uint64_t i = 0; i < iterations; i++)
+			{
+				logger.WriteLineFormatted(LogLevel::Info, format, CohortTypeID, ExemplarPatchGroupID, static_cast<uint32_t>(i), path);
+			}
+		}, static_cast<uint64_t>(sampleLength + 1));
+
+		runner.Run("Logger/WriteLineFormatted_disabled_level", [&](uint64_t iterations)
+		{
+			for (uint64_t i = 0; i < iterations; i++)
+			{
+				logger.WriteLineFormatted(LogLevel::Debug, format, CohortTypeID, ExemplarPatchGroupID, static_cast<uint32_t>(i), path);
+			}
+		});
+
+		logger.Shutdown();
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	Benchmark::Options options;
+
+	if (!Benchmark::ParseArguments(argc, argv, options))
+	{
+		return 2;
+	}
+
+	Benchmark::Runner runner("ResourceLoadingBenchmarks", options);
+
+	RunTGIHashBenchmarks(runner);
+
+	for (uint32_t targetCount : { 1024u, 65536u, 1048576u })
+	{
+		RunPatchIndexBenchmarks(runner, targetCount);
+	}
+
+	for (uint32_t subscriberCount : { 1u, 8u, 64u })
+	{
+		RunLoadDispatchBenchmarks(runner, subscriberCount);
+	}
+
+	RunApplyPatchBenchmarks(runner, 4, false);
+	RunApplyPatchBenchmarks(runner, 32, false);
+	RunApplyPatchBenchmarks(runner, 32, true);
+
+	// The logger is a singleton that cannot be initialized twice, it runs last.
+	RunLoggerBenchmarks(runner);
+
+	return runner.Finish();
+}
@@ -0,0 +1,50 @@
+/*
+ * This file is part of sc4-resource-loading-hooks, a DLL Plugin for SimCity 4
+ * that allows other DLLs to modify resources as the game loads them.
+ *
+ * Copyright (C) 2024, 2025 Nicholas Hayes
+ *
+ * sc4-resource-loading-hooks is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * sc4-resource-loading-hooks is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with sc4-resource-loading-hooks.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#include "cRZBaseUnknown.h"
+#include "cIGZCmdLine.h"
+#include <string>
+#include <vector>
+
+// A command line with switches in the game's -name:value form.
+class MockCommandLine final : public cRZBaseUnknown, public cIGZCmdLine
+{
+public:
+
+	MockCommandLine();
+	explicit MockCommandLine(const std::vector<std::string>& arguments);
+
+	bool QueryInterface(uint32_t riid, void** ppvObj) override;
+	uint32_t AddRef() override;
+	uint32_t Release() override;
+
+	bool IsSwitchPresent(const cIGZString& name) override;
+	bool IsSwitchPresent(const cIGZString& name, cIGZString& value, bool requireValue) override;
+
+	void AddArgument(const std::string& argument);
+
+private:
+
+	const std::string* FindSwitch(const cIGZString& name) const;
+
+	std::vector<std::string> arguments;
+};
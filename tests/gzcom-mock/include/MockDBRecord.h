@@ -0,0 +1,54 @@
+/*
+ * This file is part of sc4-resource-loading-hooks, a DLL Plugin for SimCity 4
+ * that allows other DLLs to modify resources as the game loads them.
+ *
+ * Copyright (C) 2024, 2025 Nicholas Hayes
+ *
+ * sc4-resource-loading-hooks is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * sc4-resource-loading-hooks is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with sc4-resource-loading-hooks.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#include "cRZBaseUnknown.h"
+#include "cIGZPersistDBRecord.h"
+#include "MockExemplar.h"
+
+// The record that the resource manager passes to a factory when it loads a resource.
+// The properties stand in for the record data.
+class MockDBRecord final : public cRZBaseUnknown, public cIGZPersistDBRecord
+{
+public:
+
+	MockDBRecord(const cGZPersistResourceKey& key, const MockPropertyList& properties);
+
+	bool QueryInterface(uint32_t riid, void** ppvObj) override;
+	uint32_t AddRef() override;
+	uint32_t Release() override;
+
+	bool GetKey(cGZPersistResourceKey& key) override;
+	uint32_t GetSize() override;
+	bool GetFieldVoid(void* pBuffer, uint32_t size) override;
+
+	const MockPropertyList& GetProperties() const;
+
+	// A damaged record that the exemplar factory fails to load.
+	bool IsDamaged() const;
+	void SetDamaged(bool value);
+
+private:
+
+	cGZPersistResourceKey key;
+	const MockPropertyList& properties;
+	bool damaged;
+};
@@ -0,0 +1,78 @@
+/*
+ * This file is part of sc4-resource-loading-hooks, a DLL Plugin for SimCity 4
+ * that allows other DLLs to modify resources as the game loads them.
+ *
+ * Copyright (C) 2024, 2025 Nicholas Hayes
+ *
+ * sc4-resource-loading-hooks is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * sc4-resource-loading-hooks is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with sc4-resource-loading-hooks.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#include "cRZBaseUnknown.h"
+#include "cGZPersistResourceKey.h"
+#include "cIGZPersistResource.h"
+#include "cISCPropertyHolder.h"
+#include "cISCResExemplar.h"
+#include "cISCResExemplarCohort.h"
+#include "cRZAutoRefCount.h"
+#include <cstddef>
+#include <vector>
+
+using MockPropertyList = std::vector<cRZAutoRefCount<cISCProperty>>;
+
+// An exemplar or cohort resource. The properties are kept sorted by ID.
+class MockExemplar final
+	: public cRZBaseUnknown,
+	  public cISCResExemplar,
+	  public cISCResExemplarCohort,
+	  public cISCPropertyHolder,
+	  public cIGZPersistResource
+{
+public:
+
+	MockExemplar();
+	MockExemplar(const cGZPersistResourceKey& key, const MockPropertyList& properties);
+
+	bool QueryInterface(uint32_t riid, void** ppvObj) override;
+	uint32_t AddRef() override;
+	uint32_t Release() override;
+
+	// cISCResExemplar and cISCResExemplarCohort
+
+	cISCPropertyHolder* AsISCPropertyHolder() override;
+
+	// cISCPropertyHolder
+
+	bool HasProperty(uint32_t id) override;
+	cISCProperty* GetProperty(uint32_t id) override;
+	const cISCProperty* GetProperty(uint32_t id) const override;
+	bool AddProperty(cISCProperty* pProperty, bool bSendMsg) override;
+	bool RemoveProperty(uint32_t id) override;
+	void EnumProperties(FunctionPtr1 pCallback, void* pContext) const override;
+
+	// cIGZPersistResource
+
+	void GetKey(cGZPersistResourceKey& key) override;
+	void SetKey(const cGZPersistResourceKey& key) override;
+
+	size_t GetPropertyCount() const;
+
+private:
+
+	MockPropertyList::const_iterator FindProperty(uint32_t id) const;
+
+	cGZPersistResourceKey key;
+	MockPropertyList properties;
+};
@@ -0,0 +1,49 @@
+/*
+ * This file is part of sc4-resource-loading-hooks, a DLL Plugin for SimCity 4
+ * that allows other DLLs to modify resources as the game loads them.
+ *
+ * Copyright (C) 2024, 2025 Nicholas Hayes
+ *
+ * sc4-resource-loading-hooks is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * sc4-resource-loading-hooks is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with sc4-resource-loading-hooks.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#include "cRZBaseUnknown.h"
+#include "cIGZPersistResourceFactory.h"
+#include <atomic>
+
+// Stands in for the game's exemplar and cohort factories.
+// Every load creates new property objects from the record, like the game parsing the record data.
+class MockExemplarFactory final : public cRZBaseUnknown, public cIGZPersistResourceFactory
+{
+public:
+
+	MockExemplarFactory();
+
+	bool QueryInterface(uint32_t riid, void** ppvObj) override;
+	uint32_t AddRef() override;
+	uint32_t Release() override;
+
+	bool CreateInstance(uint32_t type, uint32_t riid, void** ppvObj, uint32_t unknown1, cIGZUnknown* unknown2) override;
+	bool CreateInstance(cIGZPersistDBRecord& record, uint32_t riid, void** ppvObj, uint32_t unknown1, cIGZUnknown* unknown2) override;
+	bool Read(cIGZPersistResource& resource, cIGZPersistDBRecord& record) override;
+	bool Write(const cIGZPersistResource& resource, cIGZPersistDBRecord& record) override;
+
+	uint64_t GetCreatedInstanceCount() const;
+
+private:
+
+	std::atomic<uint64_t> createdInstanceCount;
+};
@@ -0,0 +1,74 @@
+/*
+ * This file is part of sc4-resource-loading-hooks, a DLL Plugin for SimCity 4
+ * that allows other DLLs to modify resources as the game loads them.
+ *
+ * Copyright (C) 2024, 2025 Nicholas Hayes
+ *
+ * sc4-resource-loading-hooks is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * sc4-resource-loading-hooks is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with sc4-resource-loading-hooks.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#include "cRZBaseUnknown.h"
+#include "cIGZFrameWork.h"
+#include "cIGZSystemService.h"
+#include "cRZAutoRefCount.h"
+#include "MockCOM.h"
+#include "MockCommandLine.h"
+#include <vector>
+
+// An in-memory framework for the tests, benchmarks and tools.
+// The system services are ticked when Tick is called, on the calling thread.
+class MockFrameWork final : public cRZBaseUnknown, public cIGZFrameWork
+{
+public:
+
+	MockFrameWork();
+	explicit MockFrameWork(const std::vector<std::string>& arguments);
+	~MockFrameWork();
+
+	bool QueryInterface(uint32_t riid, void** ppvObj) override;
+	uint32_t AddRef() override;
+	uint32_t Release() override;
+
+	cIGZCmdLine* CommandLine() override;
+	cIGZCOM* GetCOMObject() override;
+	bool GetSystemService(uint32_t serviceID, uint32_t riid, void** ppvObj) override;
+	bool AddSystemService(cIGZSystemService* pService) override;
+	bool RemoveSystemService(cIGZSystemService* pService) override;
+	bool AddHook(cIGZFrameWorkHooks* pHooks) override;
+	bool RemoveHook(cIGZFrameWorkHooks* pHooks) override;
+	bool AddToTick(cIGZSystemService* pService) override;
+	bool RemoveFromTick(cIGZSystemService* pService) override;
+	State GetState() const override;
+
+	MockCOM& GetCOM();
+	MockCommandLine& GetCommandLine();
+	void SetState(State value);
+
+	// Calls Init on the system services in priority order, highest first.
+	bool InitServices();
+	// Calls Shutdown on the system services in the reverse order of InitServices.
+	void ShutdownServices();
+	void Tick();
+
+private:
+
+	cRZAutoRefCount<MockCommandLine> commandLine;
+	cRZAutoRefCount<MockCOM> com;
+	std::vector<cRZAutoRefCount<cIGZSystemService>> services;
+	std::vector<cRZAutoRefCount<cIGZSystemService>> tickServices;
+	std::vector<cRZAutoRefCount<cIGZFrameWorkHooks>> hooks;
+	State state;
+};
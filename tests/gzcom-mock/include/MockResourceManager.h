@@ -0,0 +1,89 @@
+/*
+ * This file is part of sc4-resource-loading-hooks, a DLL Plugin for SimCity 4
+ * that allows other DLLs to modify resources as the game loads them.
+ *
+ * Copyright (C) 2024, 2025 Nicholas Hayes
+ *
+ * sc4-resource-loading-hooks is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * sc4-resource-loading-hooks is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with sc4-resource-loading-hooks.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#include "cRZBaseUnknown.h"
+#include "cRZBaseSystemService.h"
+#include "cIGZPersistResourceManager.h"
+#include "cRZAutoRefCount.h"
+#include "MockExemplar.h"
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class cIGZPersistResourceFactory;
+
+// An in-memory resource manager system service.
+// The resources are listed in the order they were added, a resource that is added
+// again replaces the earlier one like a plugin that loads later.
+// Every GetResource call creates a new resource through the factory, there is no cache.
+class MockResourceManager final
+	: public cRZBaseUnknown,
+	  public cRZBaseSystemService,
+	  public cIGZPersistResourceManager
+{
+public:
+
+	MockResourceManager();
+
+	bool QueryInterface(uint32_t riid, void** ppvObj) override;
+	uint32_t AddRef() override;
+	uint32_t Release() override;
+
+	// cIGZPersistResourceManager
+
+	uint32_t GetAvailableResourceList(cIGZPersistResourceKeyList** ppList, cIGZPersistResourceKeyFilter* pFilter) override;
+	bool GetResource(const cGZPersistResourceKey& key, uint32_t riid, void** ppvObj, uint32_t unknown1, cIGZUnknown* unknown2) override;
+	bool FindDBSegment(const cGZPersistResourceKey& key, cIGZPersistDBSegment** ppSegment) override;
+	bool FindObjectFactory(uint32_t type, cIGZPersistResourceFactory** ppFactory) override;
+	// A null factory is created through GZCOM from its class ID, like the game does.
+	bool RegisterObjectFactory(uint32_t clsid, uint32_t type, cIGZPersistResourceFactory* pFactory) override;
+
+	// The segment path is optional, the resources without one are only available through GetResource.
+	void AddResource(const cGZPersistResourceKey& key, const MockPropertyList& properties, const std::string& segmentPath = std::string());
+	bool RemoveResource(const cGZPersistResourceKey& key);
+	bool HasResource(const cGZPersistResourceKey& key) const;
+
+	size_t GetResourceCount() const;
+	uint64_t GetResourceLoadCount() const;
+
+private:
+
+	struct KeyHash
+	{
+		size_t operator()(const cGZPersistResourceKey& key) const noexcept;
+	};
+
+	struct Resource
+	{
+		cGZPersistResourceKey key;
+		MockPropertyList properties;
+		uint32_t segmentIndex;
+	};
+
+	static constexpr uint32_t NoSegment = UINT32_MAX;
+
+	std::vector<Resource> resources;
+	std::unordered_map<cGZPersistResourceKey, size_t, KeyHash> resourceIndices;
+	std::vector<std::string> segmentPaths;
+	std::unordered_map<uint32_t, cRZAutoRefCount<cIGZPersistResourceFactory>> factories;
+	uint64_t resourceLoadCount;
+};
@@ -0,0 +1,56 @@
+/*
+ * This file is part of sc4-resource-loading-hooks, a DLL Plugin for SimCity 4
+ * that allows other DLLs to modify resources as the game loads them.
+ *
+ * Copyright (C) 2024, 2025 Nicholas Hayes
+ *
+ * sc4-resource-loading-hooks is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * sc4-resource-loading-hooks is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with sc4-resource-loading-hooks.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#include "cIGZUnknown.h"
+
+class cIGZCmdLine;
+class cIGZCOM;
+class cIGZFrameWorkHooks;
+class cIGZSystemService;
+
+static const uint32_t GZIID_cIGZFrameWork = 0x00000065;
+
+class cIGZFrameWork : public cIGZUnknown
+{
+public:
+	enum State
+	{
+		kStatePreFrameWorkInit = 0,
+		kStateFrameWorkInit = 1,
+		kStatePreAppInit = 3,
+		kStateAppInit = 4,
+		kStatePostAppInit = 5,
+		kStateRunning = 6,
+		kStatePreAppShutdown = 7,
+	};
+
+	virtual cIGZCmdLine* CommandLine() = 0;
+	virtual cIGZCOM* GetCOMObject() = 0;
+	virtual bool GetSystemService(uint32_t serviceID, uint32_t riid, void** ppvObj) = 0;
+	virtual bool AddSystemService(cIGZSystemService* pService) = 0;
+	virtual bool RemoveSystemService(cIGZSystemService* pService) = 0;
+	virtual bool AddHook(cIGZFrameWorkHooks* pHooks) = 0;
+	virtual bool RemoveHook(cIGZFrameWorkHooks* pHooks) = 0;
+	virtual bool AddToTick(cIGZSystemService* pService) = 0;
+	virtual bool RemoveFromTick(cIGZSystemService* pService) = 0;
+	virtual State GetState() const = 0;
+};
@@ -0,0 +1,34 @@
+/*
+ * This file is part of sc4-resource-loading-hooks, a DLL Plugin for SimCity 4
+ * that allows other DLLs to modify resources as the game loads them.
+ *
+ * Copyright (C) 2024, 2025 Nicholas Hayes
+ *
+ * sc4-resource-loading-hooks is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * sc4-resource-loading-hooks is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with sc4-resource-loading-hooks.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#include "cIGZUnknown.h"
+#include "cGZPersistResourceKey.h"
+
+static const uint32_t GZIID_cIGZPersistDBRecord = 0xE56B8F03;
+
+class cIGZPersistDBRecord : public cIGZUnknown
+{
+public:
+	virtual bool GetKey(cGZPersistResourceKey& key) = 0;
+	virtual uint32_t GetSize() = 0;
+	virtual bool GetFieldVoid(void* pBuffer, uint32_t size) = 0;
+};
@@ -0,0 +1,37 @@
+/*
+ * This file is part of sc4-resource-loading-hooks, a DLL Plugin for SimCity 4
+ * that allows other DLLs to modify resources as the game loads them.
+ *
+ * Copyright (C) 2024, 2025 Nicholas Hayes
+ *
+ * sc4-resource-loading-hooks is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * sc4-resource-loading-hooks is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with sc4-resource-loading-hooks.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#include "cIGZUnknown.h"
+#include "cGZPersistResourceKey.h"
+
+static const uint32_t GZIID_cIGZPersistResourceKeyList = 0x456B8F28;
+
+class cIGZPersistResourceKeyList : public cIGZUnknown
+{
+public:
+	typedef void (*EnumKeysCallback)(const cGZPersistResourceKey& key, void* pContext);
+
+	virtual uint32_t Size() = 0;
+	virtual void EnumKeys(EnumKeysCallback pCallback, void* pContext) = 0;
+	virtual cGZPersistResourceKey GetKey(uint32_t index) = 0;
+	virtual bool IsPresent(const cGZPersistResourceKey& key) = 0;
+};
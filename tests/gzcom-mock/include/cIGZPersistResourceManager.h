@@ -0,0 +1,43 @@
+/*
+ * This file is part of sc4-resource-loading-hooks, a DLL Plugin for SimCity 4
+ * that allows other DLLs to modify resources as the game loads them.
+ *
+ * Copyright (C) 2024, 2025 Nicholas Hayes
+ *
+ * sc4-resource-loading-hooks is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * sc4-resource-loading-hooks is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with sc4-resource-loading-hooks.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#include "cIGZUnknown.h"
+#include "cGZPersistResourceKey.h"
+
+class cIGZPersistDBSegment;
+class cIGZPersistResourceFactory;
+class cIGZPersistResourceKeyFilter;
+class cIGZPersistResourceKeyList;
+
+static const uint32_t GZIID_cIGZPersistResourceManager = 0xC56B8F08;
+static const uint32_t kGZPersistResourceManagerServiceID = 0xC4920EAF;
+
+class cIGZPersistResourceManager : public cIGZUnknown
+{
+public:
+	// Returns the number of keys in the list, the list is created when it is null.
+	virtual uint32_t GetAvailableResourceList(cIGZPersistResourceKeyList** ppList, cIGZPersistResourceKeyFilter* pFilter) = 0;
+	virtual bool GetResource(const cGZPersistResourceKey& key, uint32_t riid, void** ppvObj, uint32_t unknown1, cIGZUnknown* unknown2) = 0;
+	virtual bool FindDBSegment(const cGZPersistResourceKey& key, cIGZPersistDBSegment** ppSegment) = 0;
+	virtual bool FindObjectFactory(uint32_t type, cIGZPersistResourceFactory** ppFactory) = 0;
+	virtual bool RegisterObjectFactory(uint32_t clsid, uint32_t type, cIGZPersistResourceFactory* pFactory) = 0;
+};
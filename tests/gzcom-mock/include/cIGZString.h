@@ -0,0 +1,36 @@
+/*
+ * This file is part of sc4-resource-loading-hooks, a DLL Plugin for SimCity 4
+ * that allows other DLLs to modify resources as the game loads them.
+ *
+ * Copyright (C) 2024, 2025 Nicholas Hayes
+ *
+ * sc4-resource-loading-hooks is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * sc4-resource-loading-hooks is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with sc4-resource-loading-hooks.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#include "cIGZUnknown.h"
+
+static const uint32_t GZIID_cIGZString = 0x089B7DC8;
+
+class cIGZString : public cIGZUnknown
+{
+public:
+	virtual bool FromChar(const char* pszSource) = 0;
+	virtual bool FromChar(const char* pszSource, uint32_t length) = 0;
+	virtual const char* ToChar() const = 0;
+	virtual const char* Data() const = 0;
+	virtual uint32_t Strlen() const = 0;
+	virtual bool IsEqual(const cIGZString& other, bool caseSensitive) const = 0;
+};
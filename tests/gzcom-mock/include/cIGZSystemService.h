@@ -0,0 +1,40 @@
+/*
+ * This file is part of sc4-resource-loading-hooks, a DLL Plugin for SimCity 4
+ * that allows other DLLs to modify resources as the game loads them.
+ *
+ * Copyright (C) 2024, 2025 Nicholas Hayes
+ *
+ * sc4-resource-loading-hooks is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * sc4-resource-loading-hooks is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with sc4-resource-loading-hooks.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#include "cIGZUnknown.h"
+
+static const uint32_t GZIID_cIGZSystemService = 0x287FB697;
+
+class cIGZSystemService : public cIGZUnknown
+{
+public:
+	virtual uint32_t GetServiceID() = 0;
+	virtual cIGZSystemService* SetServiceID(uint32_t id) = 0;
+	virtual int32_t GetServicePriority() = 0;
+	virtual bool IsServiceRunning() = 0;
+	virtual cIGZSystemService* SetServiceRunning(bool running) = 0;
+	virtual bool Init() = 0;
+	virtual bool Shutdown() = 0;
+	virtual bool OnTick(uint32_t unknown1) = 0;
+	virtual bool OnIdle(uint32_t unknown1) = 0;
+	virtual int32_t GetServiceTickPriority() = 0;
+};
@@ -0,0 +1,106 @@
+/*
+ * This file is part of sc4-resource-loading-hooks, a DLL Plugin for SimCity 4
+ * that allows other DLLs to modify resources as the game loads them.
+ *
+ * Copyright (C) 2024, 2025 Nicholas Hayes
+ *
+ * sc4-resource-loading-hooks is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * sc4-resource-loading-hooks is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with sc4-resource-loading-hooks.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#include "cIGZUnknown.h"
+
+static const uint32_t GZIID_cIGZVariant = 0x2A13C2C2;
+
+// A typed value or array of values. The array types set the 0x80 bit of the scalar type.
+class cIGZVariant : public cIGZUnknown
+{
+public:
+	enum Type : uint16_t
+	{
+		Void = 0x00,
+		Bool = 0x01,
+		Uint8 = 0x02,
+		Sint8 = 0x03,
+		Uint16 = 0x04,
+		Sint16 = 0x05,
+		Uint32 = 0x06,
+		Sint32 = 0x07,
+		Uint64 = 0x08,
+		Sint64 = 0x09,
+		Float32 = 0x0A,
+		Float64 = 0x0B,
+		RZString = 0x0C,
+		GZString = 0x0D,
+		RZChar = 0x0E,
+		Unknown = 0x0F,
+		BoolArray = 0x81,
+		Uint8Array = 0x82,
+		Sint8Array = 0x83,
+		Uint16Array = 0x84,
+		Sint16Array = 0x85,
+		Uint32Array = 0x86,
+		Sint32Array = 0x87,
+		Uint64Array = 0x88,
+		Sint64Array = 0x89,
+		Float32Array = 0x8A,
+		Float64Array = 0x8B,
+		RZCharArray = 0x8E,
+	};
+
+	virtual uint16_t GetType() const = 0;
+	virtual uint32_t GetCount() const = 0;
+
+	virtual void* RefVoid() const = 0;
+	virtual bool* RefBool() const = 0;
+	virtual uint8_t* RefUint8() const = 0;
+	virtual int8_t* RefSint8() const = 0;
+	virtual uint16_t* RefUint16() const = 0;
+	virtual int16_t* RefSint16() const = 0;
+	virtual uint32_t* RefUint32() const = 0;
+	virtual int32_t* RefSint32() const = 0;
+	virtual uint64_t* RefUint64() const = 0;
+	virtual int64_t* RefSint64() const = 0;
+	virtual float* RefFloat32() const = 0;
+	virtual double* RefFloat64() const = 0;
+	virtual char* RefRZChar() const = 0;
+
+	virtual bool GetValUint32(uint32_t& value) const = 0;
+
+	virtual void SetValBool(bool value) = 0;
+	virtual void SetValUint8(uint8_t value) = 0;
+	virtual void SetValSint8(int8_t value) = 0;
+	virtual void SetValUint16(uint16_t value) = 0;
+	virtual void SetValSint16(int16_t value) = 0;
+	virtual void SetValUint32(uint32_t value) = 0;
+	virtual void SetValSint32(int32_t value) = 0;
+	virtual void SetValUint64(uint64_t value) = 0;
+	virtual void SetValSint64(int64_t value) = 0;
+	virtual void SetValFloat32(float value) = 0;
+	virtual void SetValFloat64(double value) = 0;
+
+	virtual void SetValBool(const bool* values, uint32_t count) = 0;
+	virtual void SetValUint8(const uint8_t* values, uint32_t count) = 0;
+	virtual void SetValSint8(const int8_t* values, uint32_t count) = 0;
+	virtual void SetValUint16(const uint16_t* values, uint32_t count) = 0;
+	virtual void SetValSint16(const int16_t* values, uint32_t count) = 0;
+	virtual void SetValUint32(const uint32_t* values, uint32_t count) = 0;
+	virtual void SetValSint32(const int32_t* values, uint32_t count) = 0;
+	virtual void SetValUint64(const uint64_t* values, uint32_t count) = 0;
+	virtual void SetValSint64(const int64_t* values, uint32_t count) = 0;
+	virtual void SetValFloat32(const float* values, uint32_t count) = 0;
+	virtual void SetValFloat64(const double* values, uint32_t count) = 0;
+	virtual void SetValRZChar(const char* values, uint32_t count) = 0;
+};
@@ -0,0 +1,40 @@
+/*
+ * This file is part of sc4-resource-loading-hooks, a DLL Plugin for SimCity 4
+ * that allows other DLLs to modify resources as the game loads them.
+ *
+ * Copyright (C) 2024, 2025 Nicholas Hayes
+ *
+ * sc4-resource-loading-hooks is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * sc4-resource-loading-hooks is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with sc4-resource-loading-hooks.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#include "cIGZUnknown.h"
+#include "cISCProperty.h"
+
+static const uint32_t GZIID_cISCPropertyHolder = 0x25DF12E2;
+
+typedef void (*FunctionPtr1)(cISCProperty* pProperty, void* pContext);
+
+class cISCPropertyHolder : public cIGZUnknown
+{
+public:
+	virtual bool HasProperty(uint32_t id) = 0;
+	virtual cISCProperty* GetProperty(uint32_t id) = 0;
+	virtual const cISCProperty* GetProperty(uint32_t id) const = 0;
+	// Replaces the property that has the same id.
+	virtual bool AddProperty(cISCProperty* pProperty, bool bSendMsg) = 0;
+	virtual bool RemoveProperty(uint32_t id) = 0;
+	virtual void EnumProperties(FunctionPtr1 pCallback, void* pContext) const = 0;
+};
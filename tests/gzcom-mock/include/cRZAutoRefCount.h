@@ -0,0 +1,134 @@
+/*
+ * This file is part of sc4-resource-loading-hooks, a DLL Plugin for SimCity 4
+ * that allows other DLLs to modify resources as the game loads them.
+ *
+ * Copyright (C) 2024, 2025 Nicholas Hayes
+ *
+ * sc4-resource-loading-hooks is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * sc4-resource-loading-hooks is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with sc4-resource-loading-hooks.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#include <utility>
+
+// A smart pointer that releases the interface it holds.
+// The plain pointer constructor adopts a reference, kAddRef adds one.
+template<class T> class cRZAutoRefCount
+{
+public:
+	enum AddRefMode
+	{
+		kAddRef
+	};
+
+	cRZAutoRefCount() : p(nullptr)
+	{
+	}
+
+	cRZAutoRefCount(T* pObj) : p(pObj)
+	{
+	}
+
+	cRZAutoRefCount(T* pObj, AddRefMode) : p(pObj)
+	{
+		if (p)
+		{
+			p->AddRef();
+		}
+	}
+
+	cRZAutoRefCount(const cRZAutoRefCount& other) : p(other.p)
+	{
+		if (p)
+		{
+			p->AddRef();
+		}
+	}
+
+	cRZAutoRefCount(cRZAutoRefCount&& other) noexcept : p(std::exchange(other.p, nullptr))
+	{
+	}
+
+	~cRZAutoRefCount()
+	{
+		if (p)
+		{
+			p->Release();
+		}
+	}
+
+	cRZAutoRefCount& operator=(const cRZAutoRefCount& other)
+	{
+		if (other.p)
+		{
+			other.p->AddRef();
+		}
+
+		if (p)
+		{
+			p->Release();
+		}
+
+		p = other.p;
+		return *this;
+	}
+
+	cRZAutoRefCount& operator=(cRZAutoRefCount&& other) noexcept
+	{
+		if (this != &other)
+		{
+			if (p)
+			{
+				p->Release();
+			}
+
+			p = std::exchange(other.p, nullptr);
+		}
+
+		return *this;
+	}
+
+	T* operator->() const
+	{
+		return p;
+	}
+
+	operator T*() const
+	{
+		return p;
+	}
+
+	T** AsPPObj()
+	{
+		Reset();
+		return &p;
+	}
+
+	void** AsPPVoid()
+	{
+		Reset();
+		return reinterpret_cast<void**>(&p);
+	}
+
+	void Reset()
+	{
+		if (p)
+		{
+			p->Release();
+			p = nullptr;
+		}
+	}
+
+	T* p;
+};
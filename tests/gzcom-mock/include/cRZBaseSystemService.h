@@ -0,0 +1,52 @@
+/*
+ * This file is part of sc4-resource-loading-hooks, a DLL Plugin for SimCity 4
+ * that allows other DLLs to modify resources as the game loads them.
+ *
+ * Copyright (C) 2024, 2025 Nicholas Hayes
+ *
+ * sc4-resource-loading-hooks is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * sc4-resource-loading-hooks is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with sc4-resource-loading-hooks.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#include "cIGZSystemService.h"
+
+class cRZBaseSystemService : public cIGZSystemService
+{
+public:
+	cRZBaseSystemService(uint32_t serviceID, int32_t servicePriority);
+	virtual ~cRZBaseSystemService();
+
+	bool QueryInterface(uint32_t riid, void** ppvObj) override;
+	uint32_t AddRef() override;
+	uint32_t Release() override;
+
+	uint32_t GetServiceID() override;
+	cIGZSystemService* SetServiceID(uint32_t id) override;
+	int32_t GetServicePriority() override;
+	bool IsServiceRunning() override;
+	cIGZSystemService* SetServiceRunning(bool running) override;
+	bool Init() override;
+	bool Shutdown() override;
+	bool OnTick(uint32_t unknown1) override;
+	bool OnIdle(uint32_t unknown1) override;
+	int32_t GetServiceTickPriority() override;
+
+protected:
+	uint32_t refCount;
+	uint32_t serviceID;
+	int32_t servicePriority;
+	int32_t tickPriority;
+	bool serviceRunning;
+};
@@ -0,0 +1,94 @@
+/*
+ * This file is part of sc4-resource-loading-hooks, a DLL Plugin for SimCity 4
+ * that allows other DLLs to modify resources as the game loads them.
+ *
+ * Copyright (C) 2024, 2025 Nicholas Hayes
+ *
+ * sc4-resource-loading-hooks is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * sc4-resource-loading-hooks is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with sc4-resource-loading-hooks.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#include "cIGZVariant.h"
+#include <cstddef>
+#include <vector>
+
+// Owns a copy of the values that it is set to.
+class cRZBaseVariant : public cIGZVariant
+{
+public:
+	cRZBaseVariant();
+	cRZBaseVariant(const cIGZVariant& other);
+	virtual ~cRZBaseVariant();
+
+	cRZBaseVariant& operator=(const cIGZVariant& other);
+
+	bool QueryInterface(uint32_t riid, void** ppvObj) override;
+	uint32_t AddRef() override;
+	uint32_t Release() override;
+
+	uint16_t GetType() const override;
+	uint32_t GetCount() const override;
+
+	void* RefVoid() const override;
+	bool* RefBool() const override;
+	uint8_t* RefUint8() const override;
+	int8_t* RefSint8() const override;
+	uint16_t* RefUint16() const override;
+	int16_t* RefSint16() const override;
+	uint32_t* RefUint32() const override;
+	int32_t* RefSint32() const override;
+	uint64_t* RefUint64() const override;
+	int64_t* RefSint64() const override;
+	float* RefFloat32() const override;
+	double* RefFloat64() const override;
+	char* RefRZChar() const override;
+
+	bool GetValUint32(uint32_t& value) const override;
+
+	void SetValBool(bool value) override;
+	void SetValUint8(uint8_t value) override;
+	void SetValSint8(int8_t value) override;
+	void SetValUint16(uint16_t value) override;
+	void SetValSint16(int16_t value) override;
+	void SetValUint32(uint32_t value) override;
+	void SetValSint32(int32_t value) override;
+	void SetValUint64(uint64_t value) override;
+	void SetValSint64(int64_t value) override;
+	void SetValFloat32(float value) override;
+	void SetValFloat64(double value) override;
+
+	void SetValBool(const bool* values, uint32_t count) override;
+	void SetValUint8(const uint8_t* values, uint32_t count) override;
+	void SetValSint8(const int8_t* values, uint32_t count) override;
+	void SetValUint16(const uint16_t* values, uint32_t count) override;
+	void SetValSint16(const int16_t* values, uint32_t count) override;
+	void SetValUint32(const uint32_t* values, uint32_t count) override;
+	void SetValSint32(const int32_t* values, uint32_t count) override;
+	void SetValUint64(const uint64_t* values, uint32_t count) override;
+	void SetValSint64(const int64_t* values, uint32_t count) override;
+	void SetValFloat32(const float* values, uint32_t count) override;
+	void SetValFloat64(const double* values, uint32_t count) override;
+	void SetValRZChar(const char* values, uint32_t count) override;
+
+private:
+	void SetValues(uint16_t newType, const void* values, uint32_t newCount, size_t valueSize);
+	void* RefValues(uint16_t scalarType) const;
+
+	// The values are stored in 8 byte units to keep every value type aligned.
+	std::vector<uint64_t> storage;
+	uint16_t type;
+	uint32_t count;
+	uint32_t refCount;
+};
@@ -0,0 +1,85 @@
+/*
+ * This file is part of sc4-resource-loading-hooks, a DLL Plugin for SimCity 4
+ * that allows other DLLs to modify resources as the game loads them.
+ *
+ * Copyright (C) 2024, 2025 Nicholas Hayes
+ *
+ * sc4-resource-loading-hooks is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * sc4-resource-loading-hooks is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with sc4-resource-loading-hooks.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "MockCOM.h"
+
+MockCOM::MockCOM(cIGZFrameWork* pFrameWork) : pFrameWork(pFrameWork), classes()
+{
+}
+
+bool MockCOM::QueryInterface(uint32_t riid, void** ppvObj)
+{
+	if (riid == GZIID_cIGZCOM)
+	{
+		*ppvObj = static_cast<cIGZCOM*>(this);
+		AddRef();
+
+		return true;
+	}
+
+	return cRZBaseUnknown::QueryInterface(riid, ppvObj);
+}
+
+uint32_t MockCOM::AddRef()
+{
+	return cRZBaseUnknown::AddRef();
+}
+
+uint32_t MockCOM::Release()
+{
+	return cRZBaseUnknown::Release();
+}
+
+bool MockCOM::GetClassObject(uint32_t clsid, uint32_t riid, void** ppvObj)
+{
+	const auto it = classes.find(clsid);
+
+	if (it == classes.end())
+	{
+		*ppvObj = nullptr;
+		return false;
+	}
+
+	cIGZUnknown* pObject = it->second();
+
+	if (!pObject)
+	{
+		*ppvObj = nullptr;
+		return false;
+	}
+
+	// The temporary reference deletes the object when it does not implement the interface.
+	pObject->AddRef();
+	const bool result = pObject->QueryInterface(riid, ppvObj);
+	pObject->Release();
+
+	return result;
+}
+
+cIGZFrameWork* MockCOM::FrameWork()
+{
+	return pFrameWork;
+}
+
+void MockCOM::RegisterClass(uint32_t clsid, CreateFunction createFunction)
+{
+	classes[clsid] = std::move(createFunction);
+}
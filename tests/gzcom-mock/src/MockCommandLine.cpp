@@ -0,0 +1,135 @@
+/*
+ * This file is part of sc4-resource-loading-hooks, a DLL Plugin for SimCity 4
+ * that allows other DLLs to modify resources as the game loads them.
+ *
+ * Copyright (C) 2024, 2025 Nicholas Hayes
+ *
+ * sc4-resource-loading-hooks is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * sc4-resource-loading-hooks is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with sc4-resource-loading-hooks.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "MockCommandLine.h"
+#include <algorithm>
+#include <cctype>
+#include <string_view>
+
+namespace
+{
+	bool EqualsIgnoreCase(std::string_view lhs, std::string_view rhs)
+	{
+		return std::equal(
+			lhs.begin(),
+			lhs.end(),
+			rhs.begin(),
+			rhs.end(),
+			[](char a, char b)
+			{
+				return std::tolower(static_cast<unsigned char>(a)) == std::tolower(static_cast<unsigned char>(b));
+			});
+	}
+
+	std::string_view GetSwitchName(std::string_view argument)
+	{
+		const size_t separator = argument.find(':');
+
+		return separator == std::string_view::npos ? argument : argument.substr(0, separator);
+	}
+}
+
+MockCommandLine::MockCommandLine() : arguments()
+{
+}
+
+MockCommandLine::MockCommandLine(const std::vector<std::string>& arguments) : arguments()
+{
+	for (const std::string& argument : arguments)
+	{
+		AddArgument(argument);
+	}
+}
+
+bool MockCommandLine::QueryInterface(uint32_t riid, void** ppvObj)
+{
+	if (riid == GZIID_cIGZCmdLine)
+	{
+		*ppvObj = static_cast<cIGZCmdLine*>(this);
+		AddRef();
+
+		return true;
+	}
+
+	return cRZBaseUnknown::QueryInterface(riid, ppvObj);
+}
+
+uint32_t MockCommandLine::AddRef()
+{
+	return cRZBaseUnknown::AddRef();
+}
+
+uint32_t MockCommandLine::Release()
+{
+	return cRZBaseUnknown::Release();
+}
+
+bool MockCommandLine::IsSwitchPresent(const cIGZString& name)
+{
+	return FindSwitch(name) != nullptr;
+}
+
+bool MockCommandLine::IsSwitchPresent(const cIGZString& name, cIGZString& value, bool requireValue)
+{
+	const std::string* argument = FindSwitch(name);
+
+	if (!argument)
+	{
+		return false;
+	}
+
+	const size_t separator = argument->find(':');
+
+	if (separator == std::string::npos)
+	{
+		value.FromChar("");
+		return !requireValue;
+	}
+
+	value.FromChar(argument->data() + separator + 1, static_cast<uint32_t>(argument->size() - separator - 1));
+	return true;
+}
+
+void MockCommandLine::AddArgument(const std::string& argument)
+{
+	// The switch prefix is optional.
+	const size_t start = argument.find_first_not_of("-/");
+
+	if (start != std::string::npos)
+	{
+		arguments.push_back(argument.substr(start));
+	}
+}
+
+const std::string* MockCommandLine::FindSwitch(const cIGZString& name) const
+{
+	const std::string_view switchName(name.Data(), name.Strlen());
+
+	for (const std::string& argument : arguments)
+	{
+		if (EqualsIgnoreCase(GetSwitchName(argument), switchName))
+		{
+			return &argument;
+		}
+	}
+
+	return nullptr;
+}
@@ -0,0 +1,82 @@
+/*
+ * This file is part of sc4-resource-loading-hooks, a DLL Plugin for SimCity 4
+ * that allows other DLLs to modify resources as the game loads them.
+ *
+ * Copyright (C) 2024, 2025 Nicholas Hayes
+ *
+ * sc4-resource-loading-hooks is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * sc4-resource-loading-hooks is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with sc4-resource-loading-hooks.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "MockDBRecord.h"
+
+MockDBRecord::MockDBRecord(const cGZPersistResourceKey& key, const MockPropertyList& properties)
+	: key(key), properties(properties), damaged(false)
+{
+}
+
+bool MockDBRecord::QueryInterface(uint32_t riid, void** ppvObj)
+{
+	if (riid == GZIID_cIGZPersistDBRecord)
+	{
+		*ppvObj = static_cast<cIGZPersistDBRecord*>(this);
+		AddRef();
+
+		return true;
+	}
+
+	return cRZBaseUnknown::QueryInterface(riid, ppvObj);
+}
+
+uint32_t MockDBRecord::AddRef()
+{
+	return cRZBaseUnknown::AddRef();
+}
+
+uint32_t MockDBRecord::Release()
+{
+	return cRZBaseUnknown::Release();
+}
+
+bool MockDBRecord::GetKey(cGZPersistResourceKey& key)
+{
+	key = this->key;
+	return true;
+}
+
+uint32_t MockDBRecord::GetSize()
+{
+	// The record does not have serialized data.
+	return 0;
+}
+
+bool MockDBRecord::GetFieldVoid(void* pBuffer, uint32_t size)
+{
+	return false;
+}
+
+const MockPropertyList& MockDBRecord::GetProperties() const
+{
+	return properties;
+}
+
+bool MockDBRecord::IsDamaged() const
+{
+	return damaged;
+}
+
+void MockDBRecord::SetDamaged(bool value)
+{
+	damaged = value;
+}
@@ -0,0 +1,61 @@
+/*
+ * This file is part of sc4-resource-loading-hooks, a DLL Plugin for SimCity 4
+ * that allows other DLLs to modify resources as the game loads them.
+ *
+ * Copyright (C) 2024, 2025 Nicholas Hayes
+ *
+ * sc4-resource-loading-hooks is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * sc4-resource-loading-hooks is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with sc4-resource-loading-hooks.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "MockDBSegment.h"
+#include "cIGZString.h"
+
+MockDBSegment::MockDBSegment(const std::string& path, uint32_t segmentID)
+	: path(path), segmentID(segmentID)
+{
+}
+
+bool MockDBSegment::QueryInterface(uint32_t riid, void** ppvObj)
+{
+	if (riid == GZIID_cIGZPersistDBSegment)
+	{
+		*ppvObj = static_cast<cIGZPersistDBSegment*>(this);
+		AddRef();
+
+		return true;
+	}
+
+	return cRZBaseUnknown::QueryInterface(riid, ppvObj);
+}
+
+uint32_t MockDBSegment::AddRef()
+{
+	return cRZBaseUnknown::AddRef();
+}
+
+uint32_t MockDBSegment::Release()
+{
+	return cRZBaseUnknown::Release();
+}
+
+void MockDBSegment::GetPath(cIGZString& path)
+{
+	path.FromChar(this->path.data(), static_cast<uint32_t>(this->path.size()));
+}
+
+uint32_t MockDBSegment::GetSegmentID()
+{
+	return segmentID;
+}
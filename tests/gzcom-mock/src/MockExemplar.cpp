@@ -0,0 +1,180 @@
+/*
+ * This file is part of sc4-resource-loading-hooks, a DLL Plugin for SimCity 4
+ * that allows other DLLs to modify resources as the game loads them.
+ *
+ * Copyright (C) 2024, 2025 Nicholas Hayes
+ *
+ * sc4-resource-loading-hooks is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * sc4-resource-loading-hooks is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with sc4-resource-loading-hooks.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "MockExemplar.h"
+#include <algorithm>
+
+namespace
+{
+	bool PropertyIDLess(const cRZAutoRefCount<cISCProperty>& property, uint32_t id)
+	{
+		return property->GetPropertyID() < id;
+	}
+}
+
+MockExemplar::MockExemplar() : key(), properties()
+{
+}
+
+MockExemplar::MockExemplar(const cGZPersistResourceKey& key, const MockPropertyList& properties)
+	: key(key), properties()
+{
+	this->properties.reserve(properties.size());
+
+	for (const auto& property : properties)
+	{
+		AddProperty(property, false);
+	}
+}
+
+bool MockExemplar::QueryInterface(uint32_t riid, void** ppvObj)
+{
+	if (riid == GZIID_cISCResExemplar)
+	{
+		*ppvObj = static_cast<cISCResExemplar*>(this);
+		AddRef();
+
+		return true;
+	}
+	else if (riid == GZIID_cISCResExemplarCohort)
+	{
+		*ppvObj = static_cast<cISCResExemplarCohort*>(this);
+		AddRef();
+
+		return true;
+	}
+	else if (riid == GZIID_cISCPropertyHolder)
+	{
+		*ppvObj = static_cast<cISCPropertyHolder*>(this);
+		AddRef();
+
+		return true;
+	}
+	else if (riid == GZIID_cIGZPersistResource)
+	{
+		*ppvObj = static_cast<cIGZPersistResource*>(this);
+		AddRef();
+
+		return true;
+	}
+
+	return cRZBaseUnknown::QueryInterface(riid, ppvObj);
+}
+
+uint32_t MockExemplar::AddRef()
+{
+	return cRZBaseUnknown::AddRef();
+}
+
+uint32_t MockExemplar::Release()
+{
+	return cRZBaseUnknown::Release();
+}
+
+cISCPropertyHolder* MockExemplar::AsISCPropertyHolder()
+{
+	return this;
+}
+
+bool MockExemplar::HasProperty(uint32_t id)
+{
+	return GetProperty(id) != nullptr;
+}
+
+cISCProperty* MockExemplar::GetProperty(uint32_t id)
+{
+	const auto it = FindProperty(id);
+
+	return it != properties.end() ? static_cast<cISCProperty*>(*it) : nullptr;
+}
+
+const cISCProperty* MockExemplar::GetProperty(uint32_t id) const
+{
+	const auto it = FindProperty(id);
+
+	return it != properties.end() ? static_cast<const cISCProperty*>(*it) : nullptr;
+}
+
+bool MockExemplar::AddProperty(cISCProperty* pProperty, bool bSendMsg)
+{
+	if (!pProperty)
+	{
+		return false;
+	}
+
+	const uint32_t id = pProperty->GetPropertyID();
+	const auto it = std::lower_bound(properties.begin(), properties.end(), id, PropertyIDLess);
+
+	if (it != properties.end() && (*it)->GetPropertyID() == id)
+	{
+		// The holder keeps the property object it is given, like the game does.
+		*it = cRZAutoRefCount<cISCProperty>(pProperty, cRZAutoRefCount<cISCProperty>::kAddRef);
+	}
+	else
+	{
+		properties.emplace(it, pProperty, cRZAutoRefCount<cISCProperty>::kAddRef);
+	}
+
+	return true;
+}
+
+bool MockExemplar::RemoveProperty(uint32_t id)
+{
+	const auto it = FindProperty(id);
+
+	if (it == properties.end())
+	{
+		return false;
+	}
+
+	properties.erase(it);
+	return true;
+}
+
+void MockExemplar::EnumProperties(FunctionPtr1 pCallback, void* pContext) const
+{
+	for (const auto& property : properties)
+	{
+		pCallback(property, pContext);
+	}
+}
+
+void MockExemplar::GetKey(cGZPersistResourceKey& key)
+{
+	key = this->key;
+}
+
+void MockExemplar::SetKey(const cGZPersistResourceKey& key)
+{
+	this->key = key;
+}
+
+size_t MockExemplar::GetPropertyCount() const
+{
+	return properties.size();
+}
+
+MockPropertyList::const_iterator MockExemplar::FindProperty(uint32_t id) const
+{
+	const auto it = std::lower_bound(properties.begin(), properties.end(), id, PropertyIDLess);
+
+	return it != properties.end() && (*it)->GetPropertyID() == id ? it : properties.end();
+}
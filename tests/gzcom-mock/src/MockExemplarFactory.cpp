@@ -0,0 +1,132 @@
+/*
+ * This file is part of sc4-resource-loading-hooks, a DLL Plugin for SimCity 4
+ * that allows other DLLs to modify resources as the game loads them.
+ *
+ * Copyright (C) 2024, 2025 Nicholas Hayes
+ *
+ * sc4-resource-loading-hooks is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * sc4-resource-loading-hooks is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with sc4-resource-loading-hooks.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "MockExemplarFactory.h"
+#include "cIGZPersistDBRecord.h"
+#include "cSCBaseProperty.h"
+#include "MockDBRecord.h"
+#include "MockExemplar.h"
+
+MockExemplarFactory::MockExemplarFactory() : createdInstanceCount(0)
+{
+}
+
+bool MockExemplarFactory::QueryInterface(uint32_t riid, void** ppvObj)
+{
+	if (riid == GZIID_cIGZPersistResourceFactory)
+	{
+		*ppvObj = static_cast<cIGZPersistResourceFactory*>(this);
+		AddRef();
+
+		return true;
+	}
+
+	return cRZBaseUnknown::QueryInterface(riid, ppvObj);
+}
+
+uint32_t MockExemplarFactory::AddRef()
+{
+	return cRZBaseUnknown::AddRef();
+}
+
+uint32_t MockExemplarFactory::Release()
+{
+	return cRZBaseUnknown::Release();
+}
+
+bool MockExemplarFactory::CreateInstance(
+	uint32_t type,
+	uint32_t riid,
+	void** ppvObj,
+	uint32_t unknown1,
+	cIGZUnknown* unknown2)
+{
+	MockExemplar* exemplar = new MockExemplar();
+
+	exemplar->AddRef();
+	const bool result = exemplar->QueryInterface(riid, ppvObj);
+	exemplar->Release();
+
+	if (result)
+	{
+		createdInstanceCount++;
+	}
+
+	return result;
+}
+
+bool MockExemplarFactory::CreateInstance(
+	cIGZPersistDBRecord& record,
+	uint32_t riid,
+	void** ppvObj,
+	uint32_t unknown1,
+	cIGZUnknown* unknown2)
+{
+	MockDBRecord* mockRecord = dynamic_cast<MockDBRecord*>(&record);
+
+	if (!mockRecord || mockRecord->IsDamaged())
+	{
+		*ppvObj = nullptr;
+		return false;
+	}
+
+	cGZPersistResourceKey key;
+	record.GetKey(key);
+
+	// Each load has its own copy of the properties.
+	MockPropertyList properties;
+	properties.reserve(mockRecord->GetProperties().size());
+
+	for (const auto& property : mockRecord->GetProperties())
+	{
+		properties.emplace_back(
+			new cSCBaseProperty(property->GetPropertyID(), property->GetPropertyValue()),
+			cRZAutoRefCount<cISCProperty>::kAddRef);
+	}
+
+	MockExemplar* exemplar = new MockExemplar(key, properties);
+
+	exemplar->AddRef();
+	const bool result = exemplar->QueryInterface(riid, ppvObj);
+	exemplar->Release();
+
+	if (result)
+	{
+		createdInstanceCount++;
+	}
+
+	return result;
+}
+
+bool MockExemplarFactory::Read(cIGZPersistResource& resource, cIGZPersistDBRecord& record)
+{
+	return false;
+}
+
+bool MockExemplarFactory::Write(const cIGZPersistResource& resource, cIGZPersistDBRecord& record)
+{
+	return false;
+}
+
+uint64_t MockExemplarFactory::GetCreatedInstanceCount() const
+{
+	return createdInstanceCount.load();
+}
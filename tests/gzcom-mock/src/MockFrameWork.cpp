@@ -0,0 +1,234 @@
+/*
+ * This file is part of sc4-resource-loading-hooks, a DLL Plugin for SimCity 4
+ * that allows other DLLs to modify resources as the game loads them.
+ *
+ * Copyright (C) 2024, 2025 Nicholas Hayes
+ *
+ * sc4-resource-loading-hooks is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * sc4-resource-loading-hooks is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with sc4-resource-loading-hooks.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "MockFrameWork.h"
+#include "cIGZFrameWorkHooks.h"
+#include <algorithm>
+
+MockFrameWork::MockFrameWork() : MockFrameWork(std::vector<std::string>())
+{
+}
+
+MockFrameWork::MockFrameWork(const std::vector<std::string>& arguments)
+	: commandLine(new MockCommandLine(arguments), cRZAutoRefCount<MockCommandLine>::kAddRef),
+	  com(new MockCOM(this), cRZAutoRefCount<MockCOM>::kAddRef),
+	  services(),
+	  tickServices(),
+	  hooks(),
+	  state(kStatePreFrameWorkInit)
+{
+}
+
+MockFrameWork::~MockFrameWork()
+{
+}
+
+bool MockFrameWork::QueryInterface(uint32_t riid, void** ppvObj)
+{
+	if (riid == GZIID_cIGZFrameWork)
+	{
+		*ppvObj = static_cast<cIGZFrameWork*>(this);
+		AddRef();
+
+		return true;
+	}
+
+	return cRZBaseUnknown::QueryInterface(riid, ppvObj);
+}
+
+uint32_t MockFrameWork::AddRef()
+{
+	return cRZBaseUnknown::AddRef();
+}
+
+uint32_t MockFrameWork::Release()
+{
+	return cRZBaseUnknown::Release();
+}
+
+cIGZCmdLine* MockFrameWork::CommandLine()
+{
+	return commandLine;
+}
+
+cIGZCOM* MockFrameWork::GetCOMObject()
+{
+	return com;
+}
+
+bool MockFrameWork::GetSystemService(uint32_t serviceID, uint32_t riid, void** ppvObj)
+{
+	for (const auto& service : services)
+	{
+		if (service->GetServiceID() == serviceID)
+		{
+			return service->QueryInterface(riid, ppvObj);
+		}
+	}
+
+	*ppvObj = nullptr;
+	return false;
+}
+
+bool MockFrameWork::AddSystemService(cIGZSystemService* pService)
+{
+	if (!pService)
+	{
+		return false;
+	}
+
+	for (const auto& service : services)
+	{
+		if (service->GetServiceID() == pService->GetServiceID())
+		{
+			return false;
+		}
+	}
+
+	services.emplace_back(pService, cRZAutoRefCount<cIGZSystemService>::kAddRef);
+	return true;
+}
+
+bool MockFrameWork::RemoveSystemService(cIGZSystemService* pService)
+{
+	const auto it = std::find(services.begin(), services.end(), pService);
+
+	if (it == services.end())
+	{
+		return false;
+	}
+
+	services.erase(it);
+	return true;
+}
+
+bool MockFrameWork::AddHook(cIGZFrameWorkHooks* pHooks)
+{
+	if (!pHooks)
+	{
+		return false;
+	}
+
+	hooks.emplace_back(pHooks, cRZAutoRefCount<cIGZFrameWorkHooks>::kAddRef);
+	return true;
+}
+
+bool MockFrameWork::RemoveHook(cIGZFrameWorkHooks* pHooks)
+{
+	const auto it = std::find(hooks.begin(), hooks.end(), pHooks);
+
+	if (it == hooks.end())
+	{
+		return false;
+	}
+
+	hooks.erase(it);
+	return true;
+}
+
+bool MockFrameWork::AddToTick(cIGZSystemService* pService)
+{
+	if (!pService || std::find(tickServices.begin(), tickServices.end(), pService) != tickServices.end())
+	{
+		return false;
+	}
+
+	tickServices.emplace_back(pService, cRZAutoRefCount<cIGZSystemService>::kAddRef);
+	return true;
+}
+
+bool MockFrameWork::RemoveFromTick(cIGZSystemService* pService)
+{
+	const auto it = std::find(tickServices.begin(), tickServices.end(), pService);
+
+	if (it == tickServices.end())
+	{
+		return false;
+	}
+
+	tickServices.erase(it);
+	return true;
+}
+
+cIGZFrameWork::State MockFrameWork::GetState() const
+{
+	return state;
+}
+
+MockCOM& MockFrameWork::GetCOM()
+{
+	return *com;
+}
+
+MockCommandLine& MockFrameWork::GetCommandLine()
+{
+	return *commandLine;
+}
+
+void MockFrameWork::SetState(State value)
+{
+	state = value;
+}
+
+bool MockFrameWork::InitServices()
+{
+	std::vector<cRZAutoRefCount<cIGZSystemService>> ordered = services;
+
+	std::stable_sort(
+		ordered.begin(),
+		ordered.end(),
+		[](const cRZAutoRefCount<cIGZSystemService>& lhs, const cRZAutoRefCount<cIGZSystemService>& rhs)
+		{
+			return lhs->GetServicePriority() > rhs->GetServicePriority();
+		});
+
+	for (const auto& service : ordered)
+	{
+		if (!service->Init())
+		{
+			return false;
+		}
+	}
+
+	services = std::move(ordered);
+	return true;
+}
+
+void MockFrameWork::ShutdownServices()
+{
+	for (auto it = services.rbegin(); it != services.rend(); ++it)
+	{
+		(*it)->Shutdown();
+	}
+
+	tickServices.clear();
+}
+
+void MockFrameWork::Tick()
+{
+	// A service can remove itself from the tick list in OnTick.
+	const std::vector<cRZAutoRefCount<cIGZSystemService>> currentTickServices = tickServices;
+
+	for (const auto& service : currentTickServices)
+	{
+		service->OnTick(0);
+	}
+}
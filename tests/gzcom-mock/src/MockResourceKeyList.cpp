@@ -0,0 +1,78 @@
+/*
+ * This file is part of sc4-resource-loading-hooks, a DLL Plugin for SimCity 4
+ * that allows other DLLs to modify resources as the game loads them.
+ *
+ * Copyright (C) 2024, 2025 Nicholas Hayes
+ *
+ * sc4-resource-loading-hooks is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * sc4-resource-loading-hooks is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with sc4-resource-loading-hooks.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "MockResourceKeyList.h"
+#include <algorithm>
+
+MockResourceKeyList::MockResourceKeyList() : keys()
+{
+}
+
+bool MockResourceKeyList::QueryInterface(uint32_t riid, void** ppvObj)
+{
+	if (riid == GZIID_cIGZPersistResourceKeyList)
+	{
+		*ppvObj = static_cast<cIGZPersistResourceKeyList*>(this);
+		AddRef();
+
+		return true;
+	}
+
+	return cRZBaseUnknown::QueryInterface(riid, ppvObj);
+}
+
+uint32_t MockResourceKeyList::AddRef()
+{
+	return cRZBaseUnknown::AddRef();
+}
+
+uint32_t MockResourceKeyList::Release()
+{
+	return cRZBaseUnknown::Release();
+}
+
+uint32_t MockResourceKeyList::Size()
+{
+	return static_cast<uint32_t>(keys.size());
+}
+
+void MockResourceKeyList::EnumKeys(EnumKeysCallback pCallback, void* pContext)
+{
+	for (const cGZPersistResourceKey& key : keys)
+	{
+		pCallback(key, pContext);
+	}
+}
+
+cGZPersistResourceKey MockResourceKeyList::GetKey(uint32_t index)
+{
+	return index < keys.size() ? keys[index] : cGZPersistResourceKey();
+}
+
+bool MockResourceKeyList::IsPresent(const cGZPersistResourceKey& key)
+{
+	return std::find(keys.begin(), keys.end(), key) != keys.end();
+}
+
+void MockResourceKeyList::Add(const cGZPersistResourceKey& key)
+{
+	keys.push_back(key);
+}
@@ -0,0 +1,289 @@
+/*
+ * This file is part of sc4-resource-loading-hooks, a DLL Plugin for SimCity 4
+ * that allows other DLLs to modify resources as the game loads them.
+ *
+ * Copyright (C) 2024, 2025 Nicholas Hayes
+ *
+ * sc4-resource-loading-hooks is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * sc4-resource-loading-hooks is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with sc4-resource-loading-hooks.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "MockResourceManager.h"
+#include "cIGZPersistResource.h"
+#include "cIGZPersistResourceFactory.h"
+#include "cIGZPersistResourceKeyFilter.h"
+#include "cRZCOMDllDirector.h"
+#include "MockDBRecord.h"
+#include "MockDBSegment.h"
+#include "MockResourceKeyList.h"
+#include <algorithm>
+
+size_t MockResourceManager::KeyHash::operator()(const cGZPersistResourceKey& key) const noexcept
+{
+	uint64_t value = (static_cast<uint64_t>(key.type) << 32) ^ (static_cast<uint64_t>(key.group) << 16) ^ key.instance;
+	value ^= value >> 33;
+	value *= 0xff51afd7ed558ccdULL;
+	value ^= value >> 33;
+
+	return static_cast<size_t>(value);
+}
+
+MockResourceManager::MockResourceManager()
+	: cRZBaseSystemService(kGZPersistResourceManagerServiceID, 0),
+	  resources(),
+	  resourceIndices(),
+	  segmentPaths(),
+	  factories(),
+	  resourceLoadCount(0)
+{
+}
+
+bool MockResourceManager::QueryInterface(uint32_t riid, void** ppvObj)
+{
+	if (riid == GZIID_cIGZPersistResourceManager)
+	{
+		*ppvObj = static_cast<cIGZPersistResourceManager*>(this);
+		AddRef();
+
+		return true;
+	}
+	else if (riid == GZIID_cIGZSystemService)
+	{
+		*ppvObj = static_cast<cIGZSystemService*>(this);
+		AddRef();
+
+		return true;
+	}
+
+	return cRZBaseUnknown::QueryInterface(riid, ppvObj);
+}
+
+uint32_t MockResourceManager::AddRef()
+{
+	return cRZBaseUnknown::AddRef();
+}
+
+uint32_t MockResourceManager::Release()
+{
+	return cRZBaseUnknown::Release();
+}
+
+uint32_t MockResourceManager::GetAvailableResourceList(
+	cIGZPersistResourceKeyList** ppList,
+	cIGZPersistResourceKeyFilter* pFilter)
+{
+	if (!ppList)
+	{
+		return 0;
+	}
+
+	MockResourceKeyList* list = nullptr;
+
+	if (*ppList)
+	{
+		list = dynamic_cast<MockResourceKeyList*>(*ppList);
+
+		if (!list)
+		{
+			return 0;
+		}
+	}
+	else
+	{
+		list = new MockResourceKeyList();
+		list->AddRef();
+		*ppList = list;
+	}
+
+	uint32_t count = 0;
+
+	for (const Resource& resource : resources)
+	{
+		if (!pFilter || pFilter->IsKeyIncluded(resource.key))
+		{
+			list->Add(resource.key);
+			count++;
+		}
+	}
+
+	return count;
+}
+
+bool MockResourceManager::GetResource(
+	const cGZPersistResourceKey& key,
+	uint32_t riid,
+	void** ppvObj,
+	uint32_t unknown1,
+	cIGZUnknown* unknown2)
+{
+	*ppvObj = nullptr;
+
+	const auto resourceIt = resourceIndices.find(key);
+	const auto factoryIt = factories.find(key.type);
+
+	if (resourceIt == resourceIndices.end() || factoryIt == factories.end())
+	{
+		return false;
+	}
+
+	resourceLoadCount++;
+
+	MockDBRecord* record = new MockDBRecord(key, resources[resourceIt->second].properties);
+	record->AddRef();
+
+	// The game creates every resource as a cIGZPersistResource and then queries
+	// it for the requested interface, the factory proxies depend on that.
+	cRZAutoRefCount<cIGZPersistResource> resource;
+	bool result = factoryIt->second->CreateInstance(*record, GZIID_cIGZPersistResource, resource.AsPPVoid(), unknown1, unknown2);
+
+	record->Release();
+
+	if (result)
+	{
+		result = resource->QueryInterface(riid, ppvObj);
+	}
+
+	return result;
+}
+
+bool MockResourceManager::FindDBSegment(const cGZPersistResourceKey& key, cIGZPersistDBSegment** ppSegment)
+{
+	*ppSegment = nullptr;
+
+	const auto it = resourceIndices.find(key);
+
+	if (it == resourceIndices.end())
+	{
+		return false;
+	}
+
+	const uint32_t segmentIndex = resources[it->second].segmentIndex;
+
+	if (segmentIndex == NoSegment)
+	{
+		return false;
+	}
+
+	MockDBSegment* segment = new MockDBSegment(segmentPaths[segmentIndex], segmentIndex);
+	segment->AddRef();
+	*ppSegment = segment;
+
+	return true;
+}
+
+bool MockResourceManager::FindObjectFactory(uint32_t type, cIGZPersistResourceFactory** ppFactory)
+{
+	const auto it = factories.find(type);
+
+	if (it == factories.end())
+	{
+		*ppFactory = nullptr;
+		return false;
+	}
+
+	*ppFactory = it->second;
+	(*ppFactory)->AddRef();
+
+	return true;
+}
+
+bool MockResourceManager::RegisterObjectFactory(uint32_t clsid, uint32_t type, cIGZPersistResourceFactory* pFactory)
+{
+	cRZAutoRefCount<cIGZPersistResourceFactory> factory(pFactory, cRZAutoRefCount<cIGZPersistResourceFactory>::kAddRef);
+
+	if (!factory)
+	{
+		cIGZCOM* const pCOM = GZCOM();
+
+		if (!pCOM || !pCOM->GetClassObject(clsid, GZIID_cIGZPersistResourceFactory, factory.AsPPVoid()))
+		{
+			return false;
+		}
+	}
+
+	factories[type] = std::move(factory);
+	return true;
+}
+
+void MockResourceManager::AddResource(
+	const cGZPersistResourceKey& key,
+	const MockPropertyList& properties,
+	const std::string& segmentPath)
+{
+	uint32_t segmentIndex = NoSegment;
+
+	if (!segmentPath.empty())
+	{
+		const auto it = std::find(segmentPaths.begin(), segmentPaths.end(), segmentPath);
+
+		segmentIndex = static_cast<uint32_t>(it - segmentPaths.begin());
+
+		if (it == segmentPaths.end())
+		{
+			segmentPaths.push_back(segmentPath);
+		}
+	}
+
+	const auto result = resourceIndices.try_emplace(key, resources.size());
+
+	if (result.second)
+	{
+		resources.push_back(Resource{ key, properties, segmentIndex });
+	}
+	else
+	{
+		Resource& resource = resources[result.first->second];
+		resource.properties = properties;
+		resource.segmentIndex = segmentIndex;
+	}
+}
+
+bool MockResourceManager::RemoveResource(const cGZPersistResourceKey& key)
+{
+	const auto it = resourceIndices.find(key);
+
+	if (it == resourceIndices.end())
+	{
+		return false;
+	}
+
+	const size_t index = it->second;
+	resourceIndices.erase(it);
+	resources.erase(resources.begin() + static_cast<ptrdiff_t>(index));
+
+	for (auto& item : resourceIndices)
+	{
+		if (item.second > index)
+		{
+			item.second--;
+		}
+	}
+
+	return true;
+}
+
+bool MockResourceManager::HasResource(const cGZPersistResourceKey& key) const
+{
+	return resourceIndices.contains(key);
+}
+
+size_t MockResourceManager::GetResourceCount() const
+{
+	return resources.size();
+}
+
+uint64_t MockResourceManager::GetResourceLoadCount() const
+{
+	return resourceLoadCount;
+}
@@ -0,0 +1,46 @@
+/*
+ * This file is part of sc4-resource-loading-hooks, a DLL Plugin for SimCity 4
+ * that allows other DLLs to modify resources as the game loads them.
+ *
+ * Copyright (C) 2024, 2025 Nicholas Hayes
+ *
+ * sc4-resource-loading-hooks is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * sc4-resource-loading-hooks is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with sc4-resource-loading-hooks.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "SCPropertyUtil.h"
+#include "cIGZString.h"
+#include "cIGZVariant.h"
+#include "cISCPropertyHolder.h"
+
+bool SCPropertyUtil::GetPropertyValue(const cISCPropertyHolder* pHolder, uint32_t id, uint32_t& value)
+{
+	const cISCProperty* property = pHolder ? pHolder->GetProperty(id) : nullptr;
+	const cIGZVariant* variant = property ? property->GetPropertyValue() : nullptr;
+
+	return variant && variant->GetValUint32(value);
+}
+
+bool SCPropertyUtil::GetPropertyValue(const cISCPropertyHolder* pHolder, uint32_t id, cIGZString& value)
+{
+	const cISCProperty* property = pHolder ? pHolder->GetProperty(id) : nullptr;
+	const cIGZVariant* variant = property ? property->GetPropertyValue() : nullptr;
+
+	if (!variant || (variant->GetType() & ~0x80) != cIGZVariant::Type::RZChar)
+	{
+		return false;
+	}
+
+	return value.FromChar(variant->RefRZChar(), variant->GetCount());
+}
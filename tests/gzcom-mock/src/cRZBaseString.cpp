@@ -0,0 +1,130 @@
+/*
+ * This file is part of sc4-resource-loading-hooks, a DLL Plugin for SimCity 4
+ * that allows other DLLs to modify resources as the game loads them.
+ *
+ * Copyright (C) 2024, 2025 Nicholas Hayes
+ *
+ * sc4-resource-loading-hooks is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * sc4-resource-loading-hooks is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with sc4-resource-loading-hooks.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "cRZBaseString.h"
+#include <algorithm>
+#include <cctype>
+#include <string_view>
+
+cRZBaseString::cRZBaseString() : value(), refCount(0)
+{
+}
+
+cRZBaseString::cRZBaseString(const char* pszSource) : value(pszSource ? pszSource : ""), refCount(0)
+{
+}
+
+cRZBaseString::cRZBaseString(const char* pszSource, uint32_t length) : value(pszSource, length), refCount(0)
+{
+}
+
+cRZBaseString::cRZBaseString(const cIGZString& other) : value(other.Data(), other.Strlen()), refCount(0)
+{
+}
+
+cRZBaseString::~cRZBaseString()
+{
+}
+
+bool cRZBaseString::QueryInterface(uint32_t riid, void** ppvObj)
+{
+	if (riid == GZIID_cIGZString)
+	{
+		*ppvObj = static_cast<cIGZString*>(this);
+		AddRef();
+
+		return true;
+	}
+	else if (riid == GZIID_cIGZUnknown)
+	{
+		*ppvObj = static_cast<cIGZUnknown*>(this);
+		AddRef();
+
+		return true;
+	}
+
+	*ppvObj = nullptr;
+	return false;
+}
+
+uint32_t cRZBaseString::AddRef()
+{
+	return ++refCount;
+}
+
+uint32_t cRZBaseString::Release()
+{
+	// The strings are used as values on the stack, a release never deletes them.
+	if (refCount > 0)
+	{
+		--refCount;
+	}
+
+	return refCount;
+}
+
+bool cRZBaseString::FromChar(const char* pszSource)
+{
+	value.assign(pszSource ? pszSource : "");
+	return true;
+}
+
+bool cRZBaseString::FromChar(const char* pszSource, uint32_t length)
+{
+	value.assign(pszSource, length);
+	return true;
+}
+
+const char* cRZBaseString::ToChar() const
+{
+	return value.c_str();
+}
+
+const char* cRZBaseString::Data() const
+{
+	return value.data();
+}
+
+uint32_t cRZBaseString::Strlen() const
+{
+	return static_cast<uint32_t>(value.size());
+}
+
+bool cRZBaseString::IsEqual(const cIGZString& other, bool caseSensitive) const
+{
+	const std::string_view lhs(value);
+	const std::string_view rhs(other.Data(), other.Strlen());
+
+	if (caseSensitive)
+	{
+		return lhs == rhs;
+	}
+
+	return std::equal(
+		lhs.begin(),
+		lhs.end(),
+		rhs.begin(),
+		rhs.end(),
+		[](char a, char b)
+		{
+			return std::tolower(static_cast<unsigned char>(a)) == std::tolower(static_cast<unsigned char>(b));
+		});
+}
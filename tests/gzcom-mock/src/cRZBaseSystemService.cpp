@@ -0,0 +1,124 @@
+/*
+ * This file is part of sc4-resource-loading-hooks, a DLL Plugin for SimCity 4
+ * that allows other DLLs to modify resources as the game loads them.
+ *
+ * Copyright (C) 2024, 2025 Nicholas Hayes
+ *
+ * sc4-resource-loading-hooks is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * sc4-resource-loading-hooks is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with sc4-resource-loading-hooks.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "cRZBaseSystemService.h"
+
+cRZBaseSystemService::cRZBaseSystemService(uint32_t serviceID, int32_t servicePriority)
+	: refCount(0),
+	  serviceID(serviceID),
+	  servicePriority(servicePriority),
+	  tickPriority(servicePriority),
+	  serviceRunning(false)
+{
+}
+
+cRZBaseSystemService::~cRZBaseSystemService()
+{
+}
+
+bool cRZBaseSystemService::QueryInterface(uint32_t riid, void** ppvObj)
+{
+	if (riid == GZIID_cIGZSystemService)
+	{
+		*ppvObj = static_cast<cIGZSystemService*>(this);
+		AddRef();
+
+		return true;
+	}
+	else if (riid == GZIID_cIGZUnknown)
+	{
+		*ppvObj = static_cast<cIGZUnknown*>(this);
+		AddRef();
+
+		return true;
+	}
+
+	*ppvObj = nullptr;
+	return false;
+}
+
+uint32_t cRZBaseSystemService::AddRef()
+{
+	return ++refCount;
+}
+
+uint32_t cRZBaseSystemService::Release()
+{
+	// The services are owned by the code that creates them, like the game's static services.
+	if (refCount > 0)
+	{
+		--refCount;
+	}
+
+	return refCount;
+}
+
+uint32_t cRZBaseSystemService::GetServiceID()
+{
+	return serviceID;
+}
+
+cIGZSystemService* cRZBaseSystemService::SetServiceID(uint32_t id)
+{
+	serviceID = id;
+	return this;
+}
+
+int32_t cRZBaseSystemService::GetServicePriority()
+{
+	return servicePriority;
+}
+
+bool cRZBaseSystemService::IsServiceRunning()
+{
+	return serviceRunning;
+}
+
+cIGZSystemService* cRZBaseSystemService::SetServiceRunning(bool running)
+{
+	serviceRunning = running;
+	return this;
+}
+
+bool cRZBaseSystemService::Init()
+{
+	return true;
+}
+
+bool cRZBaseSystemService::Shutdown()
+{
+	return true;
+}
+
+bool cRZBaseSystemService::OnTick(uint32_t unknown1)
+{
+	return true;
+}
+
+bool cRZBaseSystemService::OnIdle(uint32_t unknown1)
+{
+	return true;
+}
+
+int32_t cRZBaseSystemService::GetServiceTickPriority()
+{
+	return tickPriority;
+}
@@ -0,0 +1,70 @@
+/*
+ * This file is part of sc4-resource-loading-hooks, a DLL Plugin for SimCity 4
+ * that allows other DLLs to modify resources as the game loads them.
+ *
+ * Copyright (C) 2024, 2025 Nicholas Hayes
+ *
+ * sc4-resource-loading-hooks is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * sc4-resource-loading-hooks is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with sc4-resource-loading-hooks.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "cRZBaseUnknown.h"
+
+cRZBaseUnknown::cRZBaseUnknown() : mnRefCount(0)
+{
+}
+
+cRZBaseUnknown::~cRZBaseUnknown()
+{
+}
+
+bool cRZBaseUnknown::QueryInterface(uint32_t riid, void** ppvObj)
+{
+	if (riid == GZIID_cIGZUnknown)
+	{
+		*ppvObj = static_cast<cIGZUnknown*>(this);
+		AddRef();
+
+		return true;
+	}
+
+	*ppvObj = nullptr;
+	return false;
+}
+
+uint32_t cRZBaseUnknown::AddRef()
+{
+	return ++mnRefCount;
+}
+
+uint32_t cRZBaseUnknown::Release()
+{
+	if (mnRefCount > 0)
+	{
+		--mnRefCount;
+	}
+
+	if (mnRefCount == 0)
+	{
+		delete this;
+		return 0;
+	}
+
+	return mnRefCount;
+}
+
+uint32_t cRZBaseUnknown::RefCount() const
+{
+	return mnRefCount;
+}
@@ -0,0 +1,409 @@
+/*
+ * This file is part of sc4-resource-loading-hooks, a DLL Plugin for SimCity 4
+ * that allows other DLLs to modify resources as the game loads them.
+ *
+ * Copyright (C) 2024, 2025 Nicholas Hayes
+ *
+ * sc4-resource-loading-hooks is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * sc4-resource-loading-hooks is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with sc4-resource-loading-hooks.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "cRZBaseVariant.h"
+#include <cstring>
+
+namespace
+{
+	constexpr uint16_t ArrayFlag = 0x80;
+}
+
+cRZBaseVariant::cRZBaseVariant() : storage(), type(Type::Void), count(0), refCount(0)
+{
+}
+
+cRZBaseVariant::cRZBaseVariant(const cIGZVariant& other) : cRZBaseVariant()
+{
+	*this = other;
+}
+
+cRZBaseVariant::~cRZBaseVariant()
+{
+}
+
+cRZBaseVariant& cRZBaseVariant::operator=(const cIGZVariant& other)
+{
+	if (this != &other)
+	{
+		const cRZBaseVariant* otherVariant = dynamic_cast<const cRZBaseVariant*>(&other);
+
+		if (otherVariant)
+		{
+			storage = otherVariant->storage;
+			type = otherVariant->type;
+			count = otherVariant->count;
+		}
+		else
+		{
+			// The other implementations are copied through the scalar types that this one stores.
+			storage.clear();
+			type = Type::Void;
+			count = 0;
+
+			const uint32_t otherCount = other.GetCount();
+
+			switch (other.GetType() & ~ArrayFlag)
+			{
+			case Type::Bool:
+				SetValBool(other.RefBool(), otherCount);
+				break;
+			case Type::Uint8:
+				SetValUint8(other.RefUint8(), otherCount);
+				break;
+			case Type::Sint8:
+				SetValSint8(other.RefSint8(), otherCount);
+				break;
+			case Type::Uint16:
+				SetValUint16(other.RefUint16(), otherCount);
+				break;
+			case Type::Sint16:
+				SetValSint16(other.RefSint16(), otherCount);
+				break;
+			case Type::Uint32:
+				SetValUint32(other.RefUint32(), otherCount);
+				break;
+			case Type::Sint32:
+				SetValSint32(other.RefSint32(), otherCount);
+				break;
+			case Type::Uint64:
+				SetValUint64(other.RefUint64(), otherCount);
+				break;
+			case Type::Sint64:
+				SetValSint64(other.RefSint64(), otherCount);
+				break;
+			case Type::Float32:
+				SetValFloat32(other.RefFloat32(), otherCount);
+				break;
+			case Type::Float64:
+				SetValFloat64(other.RefFloat64(), otherCount);
+				break;
+			case Type::RZChar:
+				SetValRZChar(other.RefRZChar(), otherCount);
+				break;
+			}
+
+			type = other.GetType();
+		}
+	}
+
+	return *this;
+}
+
+bool cRZBaseVariant::QueryInterface(uint32_t riid, void** ppvObj)
+{
+	if (riid == GZIID_cIGZVariant)
+	{
+		*ppvObj = static_cast<cIGZVariant*>(this);
+		AddRef();
+
+		return true;
+	}
+	else if (riid == GZIID_cIGZUnknown)
+	{
+		*ppvObj = static_cast<cIGZUnknown*>(this);
+		AddRef();
+
+		return true;
+	}
+
+	*ppvObj = nullptr;
+	return false;
+}
+
+uint32_t cRZBaseVariant::AddRef()
+{
+	return ++refCount;
+}
+
+uint32_t cRZBaseVariant::Release()
+{
+	// The variants are owned by the object that embeds them.
+	if (refCount > 0)
+	{
+		--refCount;
+	}
+
+	return refCount;
+}
+
+uint16_t cRZBaseVariant::GetType() const
+{
+	return type;
+}
+
+uint32_t cRZBaseVariant::GetCount() const
+{
+	return count;
+}
+
+void* cRZBaseVariant::RefVoid() const
+{
+	return storage.empty() ? nullptr : const_cast<uint64_t*>(storage.data());
+}
+
+bool* cRZBaseVariant::RefBool() const
+{
+	return static_cast<bool*>(RefValues(Type::Bool));
+}
+
+uint8_t* cRZBaseVariant::RefUint8() const
+{
+	return static_cast<uint8_t*>(RefValues(Type::Uint8));
+}
+
+int8_t* cRZBaseVariant::RefSint8() const
+{
+	return static_cast<int8_t*>(RefValues(Type::Sint8));
+}
+
+uint16_t* cRZBaseVariant::RefUint16() const
+{
+	return static_cast<uint16_t*>(RefValues(Type::Uint16));
+}
+
+int16_t* cRZBaseVariant::RefSint16() const
+{
+	return static_cast<int16_t*>(RefValues(Type::Sint16));
+}
+
+uint32_t* cRZBaseVariant::RefUint32() const
+{
+	return static_cast<uint32_t*>(RefValues(Type::Uint32));
+}
+
+int32_t* cRZBaseVariant::RefSint32() const
+{
+	return static_cast<int32_t*>(RefValues(Type::Sint32));
+}
+
+uint64_t* cRZBaseVariant::RefUint64() const
+{
+	return static_cast<uint64_t*>(RefValues(Type::Uint64));
+}
+
+int64_t* cRZBaseVariant::RefSint64() const
+{
+	return static_cast<int64_t*>(RefValues(Type::Sint64));
+}
+
+float* cRZBaseVariant::RefFloat32() const
+{
+	return static_cast<float*>(RefValues(Type::Float32));
+}
+
+double* cRZBaseVariant::RefFloat64() const
+{
+	return static_cast<double*>(RefValues(Type::Float64));
+}
+
+char* cRZBaseVariant::RefRZChar() const
+{
+	return static_cast<char*>(RefValues(Type::RZChar));
+}
+
+bool cRZBaseVariant::GetValUint32(uint32_t& value) const
+{
+	if (count == 0)
+	{
+		return false;
+	}
+
+	switch (type & ~ArrayFlag)
+	{
+	case Type::Bool:
+		value = *RefBool() ? 1 : 0;
+		return true;
+	case Type::Uint8:
+		value = *RefUint8();
+		return true;
+	case Type::Sint8:
+		value = static_cast<uint32_t>(*RefSint8());
+		return true;
+	case Type::Uint16:
+		value = *RefUint16();
+		return true;
+	case Type::Sint16:
+		value = static_cast<uint32_t>(*RefSint16());
+		return true;
+	case Type::Uint32:
+		value = *RefUint32();
+		return true;
+	case Type::Sint32:
+		value = static_cast<uint32_t>(*RefSint32());
+		return true;
+	case Type::Uint64:
+		value = static_cast<uint32_t>(*RefUint64());
+		return true;
+	case Type::Sint64:
+		value = static_cast<uint32_t>(*RefSint64());
+		return true;
+	case Type::Float32:
+		value = static_cast<uint32_t>(*RefFloat32());
+		return true;
+	case Type::Float64:
+		value = static_cast<uint32_t>(*RefFloat64());
+		return true;
+	default:
+		return false;
+	}
+}
+
+void cRZBaseVariant::SetValBool(bool value)
+{
+	SetValues(Type::Bool, &value, 1, sizeof(value));
+}
+
+void cRZBaseVariant::SetValUint8(uint8_t value)
+{
+	SetValues(Type::Uint8, &value, 1, sizeof(value));
+}
+
+void cRZBaseVariant::SetValSint8(int8_t value)
+{
+	SetValues(Type::Sint8, &value, 1, sizeof(value));
+}
+
+void cRZBaseVariant::SetValUint16(uint16_t value)
+{
+	SetValues(Type::Uint16, &value, 1, sizeof(value));
+}
+
+void cRZBaseVariant::SetValSint16(int16_t value)
+{
+	SetValues(Type::Sint16, &value, 1, sizeof(value));
+}
+
+void cRZBaseVariant::SetValUint32(uint32_t value)
+{
+	SetValues(Type::Uint32, &value, 1, sizeof(value));
+}
+
+void cRZBaseVariant::SetValSint32(int32_t value)
+{
+	SetValues(Type::Sint32, &value, 1, sizeof(value));
+}
+
+void cRZBaseVariant::SetValUint64(uint64_t value)
+{
+	SetValues(Type::Uint64, &value, 1, sizeof(value));
+}
+
+void cRZBaseVariant::SetValSint64(int64_t value)
+{
+	SetValues(Type::Sint64, &value, 1, sizeof(value));
+}
+
+void cRZBaseVariant::SetValFloat32(float value)
+{
+	SetValues(Type::Float32, &value, 1, sizeof(value));
+}
+
+void cRZBaseVariant::SetValFloat64(double value)
+{
+	SetValues(Type::Float64, &value, 1, sizeof(value));
+}
+
+void cRZBaseVariant::SetValBool(const bool* values, uint32_t count)
+{
+	SetValues(Type::BoolArray, values, count, sizeof(bool));
+}
+
+void cRZBaseVariant::SetValUint8(const uint8_t* values, uint32_t count)
+{
+	SetValues(Type::Uint8Array, values, count, sizeof(uint8_t));
+}
+
+void cRZBaseVariant::SetValSint8(const int8_t* values, uint32_t count)
+{
+	SetValues(Type::Sint8Array, values, count, sizeof(int8_t));
+}
+
+void cRZBaseVariant::SetValUint16(const uint16_t* values, uint32_t count)
+{
+	SetValues(Type::Uint16Array, values, count, sizeof(uint16_t));
+}
+
+void cRZBaseVariant::SetValSint16(const int16_t* values, uint32_t count)
+{
+	SetValues(Type::Sint16Array, values, count, sizeof(int16_t));
+}
+
+void cRZBaseVariant::SetValUint32(const uint32_t* values, uint32_t count)
+{
+	SetValues(Type::Uint32Array, values, count, sizeof(uint32_t));
+}
+
+void cRZBaseVariant::SetValSint32(const int32_t* values, uint32_t count)
+{
+	SetValues(Type::Sint32Array, values, count, sizeof(int32_t));
+}
+
+void cRZBaseVariant::SetValUint64(const uint64_t* values, uint32_t count)
+{
+	SetValues(Type::Uint64Array, values, count, sizeof(uint64_t));
+}
+
+void cRZBaseVariant::SetValSint64(const int64_t* values, uint32_t count)
+{
+	SetValues(Type::Sint64Array, values, count, sizeof(int64_t));
+}
+
+void cRZBaseVariant::SetValFloat32(const float* values, uint32_t count)
+{
+	SetValues(Type::Float32Array, values, count, sizeof(float));
+}
+
+void cRZBaseVariant::SetValFloat64(const double* values, uint32_t count)
+{
+	SetValues(Type::Float64Array, values, count, sizeof(double));
+}
+
+void cRZBaseVariant::SetValRZChar(const char* values, uint32_t count)
+{
+	// The strings are always stored as a character array, a one character string included.
+	SetValues(Type::RZCharArray, values, count, sizeof(char));
+}
+
+void cRZBaseVariant::SetValues(uint16_t newType, const void* values, uint32_t newCount, size_t valueSize)
+{
+	const size_t byteCount = static_cast<size_t>(newCount) * valueSize;
+
+	storage.assign((byteCount + sizeof(uint64_t) - 1) / sizeof(uint64_t), 0);
+
+	if (byteCount > 0 && values)
+	{
+		std::memcpy(storage.data(), values, byteCount);
+	}
+
+	type = newType;
+	count = values ? newCount : 0;
+}
+
+void* cRZBaseVariant::RefValues(uint16_t scalarType) const
+{
+	if ((type & ~ArrayFlag) != scalarType || storage.empty())
+	{
+		return nullptr;
+	}
+
+	return const_cast<uint64_t*>(storage.data());
+}
@@ -0,0 +1,245 @@
+/*
+ * This file is part of sc4-resource-loading-hooks, a DLL Plugin for SimCity 4
+ * that allows other DLLs to modify resources as the game loads them.
+ *
+ * Copyright (C) 2024, 2025 Nicholas Hayes
+ *
+ * sc4-resource-loading-hooks is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * sc4-resource-loading-hooks is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with sc4-resource-loading-hooks.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ExemplarLoadTraceReader.h"
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <unordered_set>
+
+namespace
+{
+	// Reads the little-endian values that the trace recorder writes.
+	class TraceCursor
+	{
+	public:
+
+		TraceCursor(const std::vector<char>& data) : data(data), position(0)
+		{
+		}
+
+		size_t GetRemaining() const
+		{
+			return data.size() - position;
+		}
+
+		template<typename T> bool Read(T& value)
+		{
+			if (GetRemaining() < sizeof(T))
+			{
+				return false;
+			}
+
+			std::memcpy(&value, data.data() + position, sizeof(T));
+			position += sizeof(T);
+
+			return true;
+		}
+
+		bool ReadString(uint16_t length, std::string& value)
+		{
+			if (GetRemaining() < length)
+			{
+				return false;
+			}
+
+			value.assign(data.data() + position, length);
+			position += length;
+
+			return true;
+		}
+
+	private:
+
+		const std::vector<char>& data;
+		size_t position;
+	};
+
+	bool ReadKey(TraceCursor& cursor, cGZPersistResourceKey& key)
+	{
+		return cursor.Read(key.type) && cursor.Read(key.group) && cursor.Read(key.instance);
+	}
+}
+
+ExemplarLoadTraceReader::ExemplarLoadTraceReader()
+	: functionNames(),
+	  recordOverloads(),
+	  records(),
+	  startTime(0),
+	  truncated(false)
+{
+}
+
+bool ExemplarLoadTraceReader::Open(const std::filesystem::path& path, std::string& error)
+{
+	functionNames.clear();
+	recordOverloads.clear();
+	records.clear();
+	startTime = 0;
+	truncated = false;
+
+	std::ifstream file(path, std::ifstream::in | std::ifstream::binary);
+
+	if (!file)
+	{
+		error = "Failed to open " + path.string();
+		return false;
+	}
+
+	const std::vector<char> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+	TraceCursor cursor(data);
+
+	uint64_t signature = 0;
+	uint32_t version = 0;
+	uint32_t reserved = 0;
+
+	if (!cursor.Read(signature)
+		|| !cursor.Read(version)
+		|| !cursor.Read(reserved)
+		|| !cursor.Read(startTime)
+		|| signature != ExemplarLoadTraceFormat::Signature)
+	{
+		error = path.string() + " is not an exemplar load trace.";
+		return false;
+	}
+
+	if (version != ExemplarLoadTraceFormat::Version)
+	{
+		error = path.string() + " has an unsupported trace version: " + std::to_string(version);
+		return false;
+	}
+
+	while (cursor.GetRemaining() > 0)
+	{
+		uint8_t type = 0;
+		cursor.Read(type);
+
+		const ExemplarLoadTraceFormat::RecordType recordType = static_cast<ExemplarLoadTraceFormat::RecordType>(type);
+
+		if (recordType == ExemplarLoadTraceFormat::RecordType::String)
+		{
+			uint16_t index = 0;
+			uint16_t length = 0;
+			std::string name;
+
+			if (!cursor.Read(index) || !cursor.Read(length) || !cursor.ReadString(length, name))
+			{
+				truncated = true;
+				break;
+			}
+
+			if (index != functionNames.size())
+			{
+				error = path.string() + " has a string table entry that is out of order.";
+				return false;
+			}
+
+			recordOverloads.push_back(name.find("cIGZPersistDBRecord") != std::string::npos);
+			functionNames.push_back(std::move(name));
+		}
+		else if (recordType == ExemplarLoadTraceFormat::RecordType::Load
+			|| recordType == ExemplarLoadTraceFormat::RecordType::LoadError
+			|| recordType == ExemplarLoadTraceFormat::RecordType::LoadErrorWithKey)
+		{
+			ExemplarLoadTraceRecord record{};
+			record.type = recordType;
+
+			bool complete = cursor.Read(record.functionNameIndex)
+				&& cursor.Read(record.threadID)
+				&& cursor.Read(record.timestampNanoseconds);
+
+			if (complete)
+			{
+				switch (recordType)
+				{
+				case ExemplarLoadTraceFormat::RecordType::Load:
+					complete = ReadKey(cursor, record.key);
+					break;
+				case ExemplarLoadTraceFormat::RecordType::LoadError:
+					complete = cursor.Read(record.riid);
+					break;
+				case ExemplarLoadTraceFormat::RecordType::LoadErrorWithKey:
+				default:
+					complete = cursor.Read(record.riid) && ReadKey(cursor, record.key);
+					break;
+				}
+			}
+
+			if (!complete)
+			{
+				truncated = true;
+				break;
+			}
+
+			if (record.functionNameIndex >= functionNames.size())
+			{
+				error = path.string() + " has a record that references an unknown function name.";
+				return false;
+			}
+
+			records.push_back(record);
+		}
+		else
+		{
+			error = path.string() + " has an unknown record type: " + std::to_string(type);
+			return false;
+		}
+	}
+
+	return true;
+}
+
+uint64_t ExemplarLoadTraceReader::GetStartTime() const
+{
+	return startTime;
+}
+
+const std::vector<ExemplarLoadTraceRecord>& ExemplarLoadTraceReader::GetRecords() const
+{
+	return records;
+}
+
+const std::string& ExemplarLoadTraceReader::GetFunctionName(const ExemplarLoadTraceRecord& record) const
+{
+	return functionNames[record.functionNameIndex];
+}
+
+bool ExemplarLoadTraceReader::IsRecordOverload(const ExemplarLoadTraceRecord& record) const
+{
+	return recordOverloads[record.functionNameIndex];
+}
+
+size_t ExemplarLoadTraceReader::GetThreadCount() const
+{
+	std::unordered_set<uint32_t> threads;
+
+	for (const ExemplarLoadTraceRecord& record : records)
+	{
+		threads.insert(record.threadID);
+	}
+
+	return threads.size();
+}
+
+bool ExemplarLoadTraceReader::IsTruncated() const
+{
+	return truncated;
+}
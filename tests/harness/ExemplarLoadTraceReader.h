@@ -0,0 +1,80 @@
+/*
+ * This file is part of sc4-resource-loading-hooks, a DLL Plugin for SimCity 4
+ * that allows other DLLs to modify resources as the game loads them.
+ *
+ * Copyright (C) 2024, 2025 Nicholas Hayes
+ *
+ * sc4-resource-loading-hooks is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * sc4-resource-loading-hooks is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with sc4-resource-loading-hooks.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#include "cGZPersistResourceKey.h"
+#include "ExemplarLoadTraceFormat.h"
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+struct ExemplarLoadTraceRecord
+{
+	// Load, LoadError or LoadErrorWithKey, the string records are read into the function name table.
+	ExemplarLoadTraceFormat::RecordType type;
+	uint16_t functionNameIndex;
+	uint32_t threadID;
+	// The time since the trace started.
+	uint64_t timestampNanoseconds;
+	// Only set for the load error records.
+	uint32_t riid;
+	// Not set for the LoadError records.
+	cGZPersistResourceKey key;
+};
+
+// Reads the binary trace files that the -exemplar-load-trace switch writes.
+class ExemplarLoadTraceReader
+{
+public:
+
+	ExemplarLoadTraceReader();
+
+	// Returns false and sets the error message if the file is not a valid trace.
+	// A trace that ends with an incomplete record, e.g. because the game crashed,
+	// is read up to that record.
+	bool Open(const std::filesystem::path& path, std::string& error);
+
+	// The trace start time in milliseconds since the Unix epoch.
+	uint64_t GetStartTime() const;
+
+	const std::vector<ExemplarLoadTraceRecord>& GetRecords() const;
+
+	// The name of the proxy function that reported the record.
+	const std::string& GetFunctionName(const ExemplarLoadTraceRecord& record) const;
+
+	// True if the record was reported by the CreateInstance overload that loads
+	// a resource from a DBPF record, the other overload creates an empty resource.
+	bool IsRecordOverload(const ExemplarLoadTraceRecord& record) const;
+
+	// The number of distinct thread IDs in the records.
+	size_t GetThreadCount() const;
+
+	bool IsTruncated() const;
+
+private:
+
+	std::vector<std::string> functionNames;
+	std::vector<bool> recordOverloads;
+	std::vector<ExemplarLoadTraceRecord> records;
+	uint64_t startTime;
+	bool truncated;
+};
@@ -0,0 +1,138 @@
+/*
+ * This file is part of sc4-resource-loading-hooks, a DLL Plugin for SimCity 4
+ * that allows other DLLs to modify resources as the game loads them.
+ *
+ * Copyright (C) 2024, 2025 Nicholas Hayes
+ *
+ * sc4-resource-loading-hooks is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * sc4-resource-loading-hooks is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with sc4-resource-loading-hooks.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ExemplarLoadTraceReplayer.h"
+#include "cIGZPersistResource.h"
+#include "ExemplarResourceFactoryProxy.h"
+#include "MockDBRecord.h"
+#include <chrono>
+
+ExemplarLoadTraceReplayer::ExemplarLoadTraceReplayer(ExemplarPatchingHarness& harness, const ExemplarLoadTraceReader& trace)
+	: harness(harness),
+	  trace(trace),
+	  loadedKeys(),
+	  loadedKeyIndices()
+{
+	for (const ExemplarLoadTraceRecord& record : trace.GetRecords())
+	{
+		if (record.type == ExemplarLoadTraceFormat::RecordType::Load
+			&& trace.IsRecordOverload(record)
+			&& loadedKeyIndices.try_emplace(record.key, loadedKeys.size()).second)
+		{
+			loadedKeys.push_back(record.key);
+		}
+	}
+}
+
+const std::vector<cGZPersistResourceKey>& ExemplarLoadTraceReplayer::GetLoadedKeys() const
+{
+	return loadedKeys;
+}
+
+bool ExemplarLoadTraceReplayer::IsLoadedKey(const cGZPersistResourceKey& key) const
+{
+	return loadedKeyIndices.find(key) != loadedKeyIndices.end();
+}
+
+size_t ExemplarLoadTraceReplayer::AddMissingExemplars()
+{
+	MockResourceManager& resourceManager = harness.GetResourceManager();
+	size_t addedCount = 0;
+
+	for (const cGZPersistResourceKey& key : loadedKeys)
+	{
+		if (!resourceManager.HasResource(key))
+		{
+			resourceManager.AddResource(key, MockPropertyList());
+			addedCount++;
+		}
+	}
+
+	return addedCount;
+}
+
+ExemplarLoadTraceReplayResult ExemplarLoadTraceReplayer::Replay()
+{
+	ExemplarLoadTraceReplayResult result;
+
+	const auto start = std::chrono::steady_clock::now();
+
+	for (const ExemplarLoadTraceRecord& record : trace.GetRecords())
+	{
+		if (!ReplayRecord(record, result))
+		{
+			result.mismatchCount++;
+		}
+	}
+
+	result.elapsedNanoseconds = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+		std::chrono::steady_clock::now() - start).count());
+
+	return result;
+}
+
+bool ExemplarLoadTraceReplayer::ReplayRecord(const ExemplarLoadTraceRecord& record, ExemplarLoadTraceReplayResult& result)
+{
+	cIGZPersistResourceFactory* const proxy = harness.GetExemplarFactoryProxy();
+
+	switch (record.type)
+	{
+	case ExemplarLoadTraceFormat::RecordType::Load:
+		if (trace.IsRecordOverload(record))
+		{
+			result.recordOverloadLoadCount++;
+
+			return harness.LoadExemplar(record.key) != nullptr;
+		}
+		else
+		{
+			result.typeOverloadLoadCount++;
+
+			cRZAutoRefCount<cIGZPersistResource> resource;
+
+			return proxy->CreateInstance(ExemplarTypeID, GZIID_cIGZPersistResource, resource.AsPPVoid(), 0, nullptr);
+		}
+	case ExemplarLoadTraceFormat::RecordType::LoadError:
+	{
+		result.loadErrorCount++;
+
+		cRZAutoRefCount<cIGZUnknown> resource;
+
+		return !proxy->CreateInstance(ExemplarTypeID, record.riid, resource.AsPPVoid(), 0, nullptr);
+	}
+	case ExemplarLoadTraceFormat::RecordType::LoadErrorWithKey:
+	{
+		result.loadErrorCount++;
+
+		const MockPropertyList properties;
+		cRZAutoRefCount<MockDBRecord> dbRecord(
+			new MockDBRecord(record.key, properties),
+			cRZAutoRefCount<MockDBRecord>::kAddRef);
+		dbRecord->SetDamaged(true);
+
+		cRZAutoRefCount<cIGZUnknown> resource;
+
+		return !proxy->CreateInstance(*dbRecord, record.riid, resource.AsPPVoid(), 0, nullptr);
+	}
+	default:
+		return false;
+	}
+}
@@ -0,0 +1,78 @@
+/*
+ * This file is part of sc4-resource-loading-hooks, a DLL Plugin for SimCity 4
+ * that allows other DLLs to modify resources as the game loads them.
+ *
+ * Copyright (C) 2024, 2025 Nicholas Hayes
+ *
+ * sc4-resource-loading-hooks is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * sc4-resource-loading-hooks is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with sc4-resource-loading-hooks.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#include "ExemplarLoadTraceReader.h"
+#include "ExemplarPatchingHarness.h"
+#include "PersistResourceKeyBoostHash.h"
+#include <cstdint>
+#include <vector>
+
+#include "boost/unordered/unordered_flat_map.hpp"
+
+struct ExemplarLoadTraceReplayResult
+{
+	// The load records, split by the CreateInstance overload that reported them.
+	uint64_t recordOverloadLoadCount = 0;
+	uint64_t typeOverloadLoadCount = 0;
+	// The LoadError and LoadErrorWithKey records.
+	uint64_t loadErrorCount = 0;
+	// The loads that failed in the replay and the load errors that did not fail.
+	uint64_t mismatchCount = 0;
+	uint64_t elapsedNanoseconds = 0;
+};
+
+// Replays the exemplar loads of a recorded trace through the exemplar factory proxy
+// of a running harness, in the recorded order on the calling thread.
+//
+// The loads from a DBPF record go through the resource manager like in the game,
+// the empty exemplars that the other CreateInstance overload creates are requested
+// from the proxy directly. The load errors with a key are replayed with a damaged
+// record, the load errors without a key with the recorded interface ID.
+class ExemplarLoadTraceReplayer
+{
+public:
+
+	ExemplarLoadTraceReplayer(ExemplarPatchingHarness& harness, const ExemplarLoadTraceReader& trace);
+
+	// The distinct exemplar keys that the trace loads from a DBPF record, in the order they are first loaded.
+	const std::vector<cGZPersistResourceKey>& GetLoadedKeys() const;
+
+	bool IsLoadedKey(const cGZPersistResourceKey& key) const;
+
+	// Adds an exemplar without properties for every loaded key that the resource manager
+	// does not have, e.g. when the plugins of the recorded game are not available.
+	// Returns the number of exemplars that were added.
+	size_t AddMissingExemplars();
+
+	// Replays every record once, the harness must be started.
+	ExemplarLoadTraceReplayResult Replay();
+
+private:
+
+	bool ReplayRecord(const ExemplarLoadTraceRecord& record, ExemplarLoadTraceReplayResult& result);
+
+	ExemplarPatchingHarness& harness;
+	const ExemplarLoadTraceReader& trace;
+	std::vector<cGZPersistResourceKey> loadedKeys;
+	// The index of each key in loadedKeys.
+	boost::unordered_flat_map<const cGZPersistResourceKey, size_t> loadedKeyIndices;
+};
@@ -0,0 +1,170 @@
+/*
+ * This file is part of sc4-resource-loading-hooks, a DLL Plugin for SimCity 4
+ * that allows other DLLs to modify resources as the game loads them.
+ *
+ * Copyright (C) 2024, 2025 Nicholas Hayes
+ *
+ * sc4-resource-loading-hooks is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * sc4-resource-loading-hooks is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with sc4-resource-loading-hooks.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ExemplarPatchingHarness.h"
+#include "cIExemplarPatchingServer.h"
+#include "cRZCOMDllDirector.h"
+#include "ExemplarPatchingServer.h"
+#include "ExemplarResourceFactoryProxy.h"
+
+namespace
+{
+	// The class ID that the exemplar factory proxy uses to create the game's exemplar factory.
+	static constexpr uint32_t GZCLSID_SCResExemplarFactory = 0x453429B3;
+	static constexpr uint32_t GZCLSID_MockCohortFactory = 0x453429B4;
+	static constexpr uint32_t CohortTypeID = 0x05342861;
+}
+
+ExemplarPatchingHarness::ExemplarPatchingHarness(const std::vector<std::string>& arguments)
+	: frameWork(new MockFrameWork(arguments), cRZAutoRefCount<MockFrameWork>::kAddRef),
+	  resourceManager(new MockResourceManager(), cRZAutoRefCount<MockResourceManager>::kAddRef),
+	  exemplarFactory(new MockExemplarFactory(), cRZAutoRefCount<MockExemplarFactory>::kAddRef),
+	  cohortFactory(new MockExemplarFactory(), cRZAutoRefCount<MockExemplarFactory>::kAddRef),
+	  patchingServer(),
+	  exemplarFactoryProxy(),
+	  loadHookServer(),
+	  started(false)
+{
+	GZCOMSetFrameWork(frameWork);
+
+	frameWork->AddSystemService(resourceManager);
+
+	MockCOM& com = frameWork->GetCOM();
+
+	MockExemplarFactory* const pExemplarFactory = exemplarFactory;
+	com.RegisterClass(GZCLSID_SCResExemplarFactory, [pExemplarFactory]() { return static_cast<cIGZPersistResourceFactory*>(pExemplarFactory); });
+	com.RegisterClass(GZCLSID_ExemplarFactoryProxy, []() { return static_cast<cIGZPersistResourceFactory*>(new ExemplarResourceFactoryProxy()); });
+
+	// Like the DLL director, the load hook server class returns the exemplar factory proxy
+	// that the resource manager created. The resource manager keeps the proxy alive.
+	MockResourceManager* const pResourceManager = resourceManager;
+	com.RegisterClass(GZCLSID_cIExemplarLoadHookServer, [pResourceManager]() -> cIGZUnknown*
+	{
+		cRZAutoRefCount<cIGZPersistResourceFactory> proxy;
+
+		if (!pResourceManager->FindObjectFactory(ExemplarTypeID, proxy.AsPPObj()))
+		{
+			return nullptr;
+		}
+
+		return static_cast<cIGZPersistResourceFactory*>(proxy);
+	});
+
+	resourceManager->RegisterObjectFactory(GZCLSID_MockCohortFactory, CohortTypeID, cohortFactory);
+}
+
+ExemplarPatchingHarness::~ExemplarPatchingHarness()
+{
+	Stop();
+
+	loadHookServer = cRZAutoRefCount<cIExemplarLoadHookServer>();
+	exemplarFactoryProxy = cRZAutoRefCount<cIGZPersistResourceFactory>();
+	patchingServer = cRZAutoRefCount<cIExemplarPatchingServer2>();
+	resourceManager = cRZAutoRefCount<MockResourceManager>();
+	frameWork = cRZAutoRefCount<MockFrameWork>();
+
+	GZCOMSetFrameWork(nullptr);
+}
+
+MockFrameWork& ExemplarPatchingHarness::GetFrameWork()
+{
+	return *frameWork;
+}
+
+MockResourceManager& ExemplarPatchingHarness::GetResourceManager()
+{
+	return *resourceManager;
+}
+
+bool ExemplarPatchingHarness::Start()
+{
+	if (started)
+	{
+		return true;
+	}
+
+	// The same order as the DLL director: the exemplar patching service must be
+	// present before the exemplar factory proxy is registered.
+	cRZAutoRefCount<cIGZSystemService> service(
+		new ExemplarPatchingServer(),
+		cRZAutoRefCount<cIGZSystemService>::kAddRef);
+
+	if (!frameWork->AddSystemService(service)
+		|| !service->QueryInterface(GZIID_cIExemplarPatchingServer2, patchingServer.AsPPVoid()))
+	{
+		return false;
+	}
+
+	if (!resourceManager->RegisterObjectFactory(GZCLSID_ExemplarFactoryProxy, ExemplarTypeID, nullptr))
+	{
+		return false;
+	}
+
+	if (!resourceManager->FindObjectFactory(ExemplarTypeID, exemplarFactoryProxy.AsPPObj())
+		|| !exemplarFactoryProxy->QueryInterface(GZIID_cIExemplarLoadHookServer, loadHookServer.AsPPVoid()))
+	{
+		return false;
+	}
+
+	frameWork->SetState(cIGZFrameWork::kStatePreAppInit);
+	started = frameWork->InitServices();
+	frameWork->SetState(cIGZFrameWork::kStateRunning);
+
+	return started;
+}
+
+void ExemplarPatchingHarness::Stop()
+{
+	if (started)
+	{
+		frameWork->ShutdownServices();
+		started = false;
+	}
+}
+
+cIExemplarPatchingServer2* ExemplarPatchingHarness::GetPatchingServer() const
+{
+	return patchingServer;
+}
+
+cIExemplarLoadHookServer* ExemplarPatchingHarness::GetLoadHookServer() const
+{
+	return loadHookServer;
+}
+
+cIGZPersistResourceFactory* ExemplarPatchingHarness::GetExemplarFactoryProxy() const
+{
+	return exemplarFactoryProxy;
+}
+
+cRZAutoRefCount<cISCResExemplar> ExemplarPatchingHarness::LoadExemplar(const cGZPersistResourceKey& key)
+{
+	cRZAutoRefCount<cISCResExemplar> exemplar;
+
+	resourceManager->GetResource(key, GZIID_cISCResExemplar, exemplar.AsPPVoid(), 0, nullptr);
+
+	return exemplar;
+}
+
+uint64_t ExemplarPatchingHarness::GetCreatedResourceCount() const
+{
+	return exemplarFactory->GetCreatedInstanceCount() + cohortFactory->GetCreatedInstanceCount();
+}
@@ -0,0 +1,82 @@
+/*
+ * This file is part of sc4-resource-loading-hooks, a DLL Plugin for SimCity 4
+ * that allows other DLLs to modify resources as the game loads them.
+ *
+ * Copyright (C) 2024, 2025 Nicholas Hayes
+ *
+ * sc4-resource-loading-hooks is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * sc4-resource-loading-hooks is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with sc4-resource-loading-hooks.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#include "cGZPersistResourceKey.h"
+#include "cIExemplarLoadHookServer.h"
+#include "cIExemplarPatchingServer2.h"
+#include "cISCResExemplar.h"
+#include "cRZAutoRefCount.h"
+#include "MockExemplarFactory.h"
+#include "MockFrameWork.h"
+#include "MockResourceManager.h"
+#include <string>
+#include <vector>
+
+// Runs the exemplar patching server and the exemplar factory proxy on the in-memory
+// GZCOM services, wired up the same way as the DLL director does in the game.
+// Only one harness can be running at a time, it installs its framework for RZGetFrameWork.
+class ExemplarPatchingHarness
+{
+public:
+
+	// The arguments are the game's command line switches, e.g. -exemplar-patch-skip-identical.
+	explicit ExemplarPatchingHarness(const std::vector<std::string>& arguments = std::vector<std::string>());
+	~ExemplarPatchingHarness();
+
+	ExemplarPatchingHarness(const ExemplarPatchingHarness&) = delete;
+	ExemplarPatchingHarness& operator=(const ExemplarPatchingHarness&) = delete;
+
+	MockFrameWork& GetFrameWork();
+	MockResourceManager& GetResourceManager();
+
+	// Registers the services and factories and initializes the services.
+	// The patching server starts its initial scan, the first exemplar load or
+	// a framework tick finishes it.
+	bool Start();
+
+	// Shuts down the services, also called by the destructor.
+	void Stop();
+
+	cIExemplarPatchingServer2* GetPatchingServer() const;
+	cIExemplarLoadHookServer* GetLoadHookServer() const;
+
+	// The exemplar factory proxy that the resource manager loads the exemplars with.
+	cIGZPersistResourceFactory* GetExemplarFactoryProxy() const;
+
+	// Loads an exemplar through the resource manager and the exemplar factory proxy,
+	// which applies the patches and notifies the load subscribers.
+	cRZAutoRefCount<cISCResExemplar> LoadExemplar(const cGZPersistResourceKey& key);
+
+	// The number of exemplars and cohorts that the original factories created.
+	uint64_t GetCreatedResourceCount() const;
+
+private:
+
+	cRZAutoRefCount<MockFrameWork> frameWork;
+	cRZAutoRefCount<MockResourceManager> resourceManager;
+	cRZAutoRefCount<MockExemplarFactory> exemplarFactory;
+	cRZAutoRefCount<MockExemplarFactory> cohortFactory;
+	cRZAutoRefCount<cIExemplarPatchingServer2> patchingServer;
+	cRZAutoRefCount<cIGZPersistResourceFactory> exemplarFactoryProxy;
+	cRZAutoRefCount<cIExemplarLoadHookServer> loadHookServer;
+	bool started;
+};
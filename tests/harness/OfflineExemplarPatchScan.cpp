@@ -0,0 +1,145 @@
+/*
+ * This file is part of sc4-resource-loading-hooks, a DLL Plugin for SimCity 4
+ * that allows other DLLs to modify resources as the game loads them.
+ *
+ * Copyright (C) 2024, 2025 Nicholas Hayes
+ *
+ * sc4-resource-loading-hooks is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * sc4-resource-loading-hooks is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with sc4-resource-loading-hooks.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "OfflineExemplarPatchScan.h"
+#include "ExemplarPatchBaker.h"
+#include "ExemplarPatchBundle.h"
+#include "ExemplarResourceFactoryProxy.h"
+
+namespace
+{
+	static constexpr uint32_t CohortTypeID = 0x05342861;
+	static constexpr uint32_t ExemplarPatchGroupID = 0xb03697d1;
+}
+
+OfflineExemplarPatchScan::OfflineExemplarPatchScan()
+	: harness(),
+	  pluginLoader(harness.GetResourceManager()),
+	  scanner(),
+	  index(),
+	  fingerprint(0),
+	  hasBakedFile(false)
+{
+}
+
+bool OfflineExemplarPatchScan::Scan(const std::vector<std::filesystem::path>& pluginPaths, std::string& error)
+{
+	// The scanner reads the exemplar patches from the plugin files, the cohort properties
+	// are only used for the patches that it loads through the resource manager.
+	// The baker only needs the files that the exemplars are loaded from.
+	// An installed baked file is not added, the scanner would rename it when it is stale.
+	pluginLoader.Load(pluginPaths, [this](const cGZPersistResourceKey& key)
+	{
+		if (key.type == CohortTypeID && key.group == ExemplarPatchGroupID)
+		{
+			return PluginResourceLoader::RecordContent::Properties;
+		}
+		else if (key.type == ExemplarTypeID)
+		{
+			return PluginResourceLoader::RecordContent::FileOnly;
+		}
+		else if (key == ExemplarPatchBaker::FingerprintRecordKey)
+		{
+			hasBakedFile = true;
+		}
+
+		return PluginResourceLoader::RecordContent::None;
+	});
+
+	scanner = std::make_unique<ExemplarPatchScanner>(&harness.GetResourceManager(), false);
+
+	if (!scanner->Scan(index))
+	{
+		error = "The plugins do not contain any Exemplar patches.";
+		return false;
+	}
+
+	if (!scanner->TryGetFingerprint(fingerprint))
+	{
+		error = "The Exemplar patch files could not be fingerprinted.";
+		return false;
+	}
+
+	return true;
+}
+
+const ExemplarPatchIndex& OfflineExemplarPatchScan::GetIndex() const
+{
+	return index;
+}
+
+uint32_t OfflineExemplarPatchScan::GetPatchCount() const
+{
+	return scanner ? scanner->GetLoadedExemplarPatchCount() : 0;
+}
+
+uint64_t OfflineExemplarPatchScan::GetFingerprint() const
+{
+	return fingerprint;
+}
+
+const PluginLoadStatistics& OfflineExemplarPatchScan::GetPluginStatistics() const
+{
+	return pluginLoader.GetStatistics();
+}
+
+bool OfflineExemplarPatchScan::WriteBundle(const std::filesystem::path& path, std::string& error) const
+{
+	if (!ExemplarPatchBundle::Write(path, fingerprint, index))
+	{
+		error = "Failed to write the Exemplar patch bundle: " + path.string();
+		return false;
+	}
+
+	return true;
+}
+
+bool OfflineExemplarPatchScan::Bake(
+	const std::filesystem::path& path,
+	uint32_t& bakedExemplarCount,
+	uint32_t& skippedExemplarCount,
+	std::string& error)
+{
+	// The same checks as ExemplarPatchingServer::BakeExemplarPatches.
+	if (hasBakedFile)
+	{
+		error = "The plugins contain a baked Exemplar patch file, the target exemplars would be read from it.";
+		return false;
+	}
+
+	if (!index.GetTypeTargets().Empty())
+	{
+		error = "The patches that target an Exemplar type cannot be baked.";
+		return false;
+	}
+
+	ExemplarPatchBaker baker(&harness.GetResourceManager());
+
+	if (!baker.Bake(index, fingerprint, path))
+	{
+		error = "Failed to write the baked Exemplar patch file: " + path.string();
+		return false;
+	}
+
+	bakedExemplarCount = baker.GetBakedExemplarCount();
+	skippedExemplarCount = baker.GetSkippedExemplarCount();
+	return true;
+}
@@ -0,0 +1,79 @@
+/*
+ * This file is part of sc4-resource-loading-hooks, a DLL Plugin for SimCity 4
+ * that allows other DLLs to modify resources as the game loads them.
+ *
+ * Copyright (C) 2024, 2025 Nicholas Hayes
+ *
+ * sc4-resource-loading-hooks is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * sc4-resource-loading-hooks is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with sc4-resource-loading-hooks.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#include "ExemplarPatchIndex.h"
+#include "ExemplarPatchingHarness.h"
+#include "ExemplarPatchScanner.h"
+#include "PluginResourceLoader.h"
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Scans the exemplar patches of DBPF plugin files outside of the game, with the same
+// scanner that the exemplar patching server uses in the game.
+//
+// The game only uses the files that are built from the scan when they have the fingerprint
+// of the plugins that it loaded: the same exemplar patch records, listed in the same order,
+// from files with the same paths, sizes and modification times. The plugins must be passed
+// in the game's load order with the paths that the game uses, otherwise the game scans
+// the plugins again and replaces the files.
+// Only one scan can exist at a time, it runs on an exemplar patching harness.
+class OfflineExemplarPatchScan
+{
+public:
+
+	OfflineExemplarPatchScan();
+
+	OfflineExemplarPatchScan(const OfflineExemplarPatchScan&) = delete;
+	OfflineExemplarPatchScan& operator=(const OfflineExemplarPatchScan&) = delete;
+
+	// The plugin paths use the load order of PluginResourceLoader.
+	bool Scan(const std::vector<std::filesystem::path>& pluginPaths, std::string& error);
+
+	const ExemplarPatchIndex& GetIndex() const;
+	uint32_t GetPatchCount() const;
+	uint64_t GetFingerprint() const;
+	const PluginLoadStatistics& GetPluginStatistics() const;
+
+	// Writes the exemplar patch bundle that the -exemplar-patch-bundle switch loads.
+	bool WriteBundle(const std::filesystem::path& path, std::string& error) const;
+
+	// Writes the baked exemplar patch file that the -exemplar-patch-bake switch writes.
+	// The target exemplars are read from the last plugin file that contains them, the
+	// game's own DBPF files must be passed first when the patches target their exemplars.
+	bool Bake(
+		const std::filesystem::path& path,
+		uint32_t& bakedExemplarCount,
+		uint32_t& skippedExemplarCount,
+		std::string& error);
+
+private:
+
+	ExemplarPatchingHarness harness;
+	PluginResourceLoader pluginLoader;
+	std::unique_ptr<ExemplarPatchScanner> scanner;
+	ExemplarPatchIndex index;
+	uint64_t fingerprint;
+	bool hasBakedFile;
+};
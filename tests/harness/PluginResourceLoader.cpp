@@ -0,0 +1,159 @@
+/*
+ * This file is part of sc4-resource-loading-hooks, a DLL Plugin for SimCity 4
+ * that allows other DLLs to modify resources as the game loads them.
+ *
+ * Copyright (C) 2024, 2025 Nicholas Hayes
+ *
+ * sc4-resource-loading-hooks is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * sc4-resource-loading-hooks is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with sc4-resource-loading-hooks.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "PluginResourceLoader.h"
+#include "DBPFFile.h"
+#include "ExemplarFormat.h"
+#include "ExemplarResourceFactoryProxy.h"
+#include <algorithm>
+
+namespace
+{
+	static constexpr uint32_t CohortTypeID = 0x05342861;
+}
+
+PluginResourceLoader::PluginResourceLoader(MockResourceManager& resourceManager)
+	: resourceManager(resourceManager),
+	  propertyFactory(),
+	  textParser(),
+	  binaryParser(),
+	  recordBuffer(),
+	  statistics()
+{
+}
+
+std::vector<std::filesystem::path> PluginResourceLoader::GetPluginFiles(const std::vector<std::filesystem::path>& pluginPaths)
+{
+	std::vector<std::filesystem::path> files;
+
+	for (const std::filesystem::path& path : pluginPaths)
+	{
+		std::error_code ec;
+
+		if (std::filesystem::is_directory(path, ec))
+		{
+			std::vector<std::filesystem::path> folderFiles;
+
+			for (const auto& entry : std::filesystem::recursive_directory_iterator(path, ec))
+			{
+				if (entry.is_regular_file(ec))
+				{
+					folderFiles.push_back(entry.path());
+				}
+			}
+
+			std::sort(folderFiles.begin(), folderFiles.end());
+			files.insert(files.end(), folderFiles.begin(), folderFiles.end());
+		}
+		else
+		{
+			files.push_back(path);
+		}
+	}
+
+	return files;
+}
+
+template<typename TParser>
+bool PluginResourceLoader::ReadProperties(TParser& parser, std::span<const uint8_t> data, MockPropertyList& properties)
+{
+	if (!parser.Open(data.data(), data.size()))
+	{
+		return false;
+	}
+
+	parser.EnumProperties([&](const ExemplarPropertyView& view)
+	{
+		properties.push_back(propertyFactory.Create(view));
+	});
+
+	return true;
+}
+
+void PluginResourceLoader::Load(const std::vector<std::filesystem::path>& pluginPaths, const RecordFilter& filter)
+{
+	for (const std::filesystem::path& path : GetPluginFiles(pluginPaths))
+	{
+		DBPFFile file;
+
+		if (!file.Open(path))
+		{
+			statistics.skippedFileCount++;
+			continue;
+		}
+
+		statistics.fileCount++;
+
+		const std::string segmentPath = path.string();
+
+		for (size_t i = 0; i < file.GetIndexEntryCount(); i++)
+		{
+			const DBPFFile::IndexEntry entry = file.GetIndexEntry(i);
+			const RecordContent content = filter(entry.key);
+
+			if (content == RecordContent::None)
+			{
+				continue;
+			}
+
+			MockPropertyList properties;
+
+			if (content == RecordContent::Properties)
+			{
+				std::span<const uint8_t> data;
+				bool loaded = false;
+
+				if (file.ReadRecord(entry, recordBuffer, data))
+				{
+					loaded = ExemplarFormat::IsTextFormat(data.data(), data.size())
+						? ReadProperties(textParser, data, properties)
+						: ReadProperties(binaryParser, data, properties);
+				}
+
+				if (!loaded)
+				{
+					statistics.invalidRecordCount++;
+					continue;
+				}
+			}
+
+			resourceManager.AddResource(entry.key, properties, segmentPath);
+
+			if (entry.key.type == CohortTypeID)
+			{
+				statistics.cohortCount++;
+			}
+			else if (entry.key.type == ExemplarTypeID)
+			{
+				statistics.exemplarCount++;
+			}
+			else
+			{
+				statistics.otherRecordCount++;
+			}
+		}
+	}
+}
+
+const PluginLoadStatistics& PluginResourceLoader::GetStatistics() const
+{
+	return statistics;
+}
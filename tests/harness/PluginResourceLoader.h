@@ -0,0 +1,86 @@
+/*
+ * This file is part of sc4-resource-loading-hooks, a DLL Plugin for SimCity 4
+ * that allows other DLLs to modify resources as the game loads them.
+ *
+ * Copyright (C) 2024, 2025 Nicholas Hayes
+ *
+ * sc4-resource-loading-hooks is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * sc4-resource-loading-hooks is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with sc4-resource-loading-hooks.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#include "cGZPersistResourceKey.h"
+#include "ExemplarBinaryParser.h"
+#include "ExemplarPropertyFactory.h"
+#include "ExemplarTextParser.h"
+#include "MockResourceManager.h"
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <span>
+#include <vector>
+
+struct PluginLoadStatistics
+{
+	uint32_t fileCount = 0;
+	uint32_t skippedFileCount = 0;
+	uint64_t exemplarCount = 0;
+	uint64_t cohortCount = 0;
+	// The records of the other types, e.g. the fingerprint record of a baked exemplar patch file.
+	uint64_t otherRecordCount = 0;
+	// The records that are not valid exemplars or cohorts.
+	uint64_t invalidRecordCount = 0;
+};
+
+// Adds the records of DBPF plugin files to a resource manager, with the plugin file
+// as their DB segment. The exemplar patch scanner and baker read the records from
+// the files that the resource manager reports, like they do in the game.
+class PluginResourceLoader
+{
+public:
+
+	enum class RecordContent
+	{
+		// The record is not added.
+		None,
+		// The record is added without properties, only its file is used.
+		FileOnly,
+		// The exemplar or cohort properties are read from the record.
+		Properties,
+	};
+
+	using RecordFilter = std::function<RecordContent(const cGZPersistResourceKey& key)>;
+
+	explicit PluginResourceLoader(MockResourceManager& resourceManager);
+
+	// The files load in argument order, the files in a folder in path order,
+	// and a later file replaces the resources of an earlier one.
+	static std::vector<std::filesystem::path> GetPluginFiles(const std::vector<std::filesystem::path>& pluginPaths);
+
+	void Load(const std::vector<std::filesystem::path>& pluginPaths, const RecordFilter& filter);
+
+	const PluginLoadStatistics& GetStatistics() const;
+
+private:
+
+	template<typename TParser>
+	bool ReadProperties(TParser& parser, std::span<const uint8_t> data, MockPropertyList& properties);
+
+	MockResourceManager& resourceManager;
+	ExemplarPropertyFactory propertyFactory;
+	ExemplarTextParser textParser;
+	ExemplarBinaryParser binaryParser;
+	std::vector<uint8_t> recordBuffer;
+	PluginLoadStatistics statistics;
+};
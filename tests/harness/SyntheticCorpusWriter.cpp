@@ -0,0 +1,315 @@
+/*
+ * This file is part of sc4-resource-loading-hooks, a DLL Plugin for SimCity 4
+ * that allows other DLLs to modify resources as the game loads them.
+ *
+ * Copyright (C) 2024, 2025 Nicholas Hayes
+ *
+ * sc4-resource-loading-hooks is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * sc4-resource-loading-hooks is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with sc4-resource-loading-hooks.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "SyntheticCorpusWriter.h"
+#include "DBPFWriter.h"
+#include "ExemplarBinaryWriter.h"
+#include "MockResourceManager.h"
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <memory>
+
+namespace
+{
+	std::filesystem::path FormatFileName(const char* prefix, uint32_t fileIndex)
+	{
+		char buffer[128]{};
+		std::snprintf(buffer, sizeof(buffer), "%s %04u.dat", prefix, fileIndex + 1);
+
+		return buffer;
+	}
+
+	// The resources are split into contiguous ranges, so the load order of the patches
+	// follows the file names.
+	uint32_t GetFileIndex(uint32_t index, uint32_t count, uint32_t fileCount)
+	{
+		return static_cast<uint32_t>(static_cast<uint64_t>(index) * fileCount / count);
+	}
+
+	std::string EscapeJson(const std::string& value)
+	{
+		std::string escaped;
+
+		for (char c : value)
+		{
+			if (c == '"' || c == '\\')
+			{
+				escaped += '\\';
+			}
+
+			escaped += c;
+		}
+
+		return escaped;
+	}
+
+	// Writes the records of one file and updates its statistics.
+	class FileBuilder
+	{
+	public:
+
+		explicit FileBuilder(SyntheticCorpusFile& file) : file(file), buffer()
+		{
+		}
+
+		bool Open(std::string& error)
+		{
+			if (!writer.Open(file.path))
+			{
+				error = "Failed to create " + file.path.string();
+				return false;
+			}
+
+			return true;
+		}
+
+		bool Add(const SyntheticResource& resource, ExemplarBinaryWriter::FileKind kind, bool compress, std::string& error)
+		{
+			if (!ExemplarBinaryWriter::Write(resource.properties, resource.parentCohortKey, kind, buffer))
+			{
+				error = "Failed to serialize a resource for " + file.path.string();
+				return false;
+			}
+
+			if (!writer.AddRecord(resource.key, buffer.data(), buffer.size(), compress))
+			{
+				// DBPF 1.0 uses 32-bit offsets.
+				error = "Failed to write to " + file.path.string() + ", use more files if it is larger than 4 GiB";
+				return false;
+			}
+
+			file.recordCount++;
+
+			if (compress)
+			{
+				file.compressedRecordCount++;
+			}
+
+			return true;
+		}
+
+		bool Close(std::string& error)
+		{
+			if (!writer.Close())
+			{
+				error = "Failed to finish " + file.path.string();
+				return false;
+			}
+
+			std::error_code ec;
+			file.size = std::filesystem::file_size(file.path, ec);
+
+			return true;
+		}
+
+	private:
+
+		SyntheticCorpusFile& file;
+		DBPFWriter writer;
+		std::vector<uint8_t> buffer;
+	};
+}
+
+SyntheticCorpusWriter::SyntheticCorpusWriter(const SyntheticExemplarPopulation& population, const SyntheticCorpusOptions& options)
+	: population(population),
+	  options(options),
+	  files()
+{
+	this->options.exemplarFileCount = std::clamp(options.exemplarFileCount, 1u, std::max(1u, population.GetExemplarCount()));
+	this->options.patchFileCount = std::clamp(options.patchFileCount, 1u, std::max(1u, population.GetPatchCount()));
+	this->options.compressedFraction = std::clamp(options.compressedFraction, 0.0, 1.0);
+}
+
+bool SyntheticCorpusWriter::Write(const std::filesystem::path& directory, std::string& error)
+{
+	files.clear();
+
+	std::error_code ec;
+	std::filesystem::create_directories(directory, ec);
+
+	if (ec)
+	{
+		error = "Failed to create " + directory.string() + ": " + ec.message();
+		return false;
+	}
+
+	// Writes the resources [0, count) to the files that the file name function selects.
+	const auto writeResources = [&](
+		uint32_t count,
+		ExemplarBinaryWriter::FileKind kind,
+		const std::function<std::filesystem::path(uint32_t)>& getFileName,
+		const std::function<SyntheticResource(uint32_t)>& createResource)
+	{
+		std::unique_ptr<FileBuilder> builder;
+		std::filesystem::path currentFileName;
+
+		for (uint32_t i = 0; i < count; i++)
+		{
+			const std::filesystem::path fileName = getFileName(i);
+
+			if (!builder || fileName != currentFileName)
+			{
+				if (builder && !builder->Close(error))
+				{
+					return false;
+				}
+
+				SyntheticCorpusFile& file = files.emplace_back();
+				file.path = directory / fileName;
+				currentFileName = fileName;
+
+				builder = std::make_unique<FileBuilder>(file);
+
+				if (!builder->Open(error))
+				{
+					return false;
+				}
+			}
+
+			const SyntheticResource resource = createResource(i);
+
+			if (!builder->Add(resource, kind, IsCompressed(resource.key), error))
+			{
+				return false;
+			}
+		}
+
+		return !builder || builder->Close(error);
+	};
+
+	// The file list is reserved so the builders can keep a reference to their entry.
+	files.reserve(1 + options.exemplarFileCount + options.patchFileCount);
+
+	return writeResources(
+			population.GetParentCohortCount(),
+			ExemplarBinaryWriter::FileKind::Cohort,
+			[this](uint32_t) { return GetParentCohortFileName(); },
+			[this](uint32_t i) { return population.CreateParentCohort(i); })
+		&& writeResources(
+			population.GetExemplarCount(),
+			ExemplarBinaryWriter::FileKind::Exemplar,
+			[this](uint32_t i) { return GetExemplarFileName(i); },
+			[this](uint32_t i) { return population.CreateExemplar(i); })
+		&& writeResources(
+			population.GetPatchCount(),
+			ExemplarBinaryWriter::FileKind::Cohort,
+			[this](uint32_t i) { return GetPatchFileName(i); },
+			[this](uint32_t i) { return population.CreatePatch(i); });
+}
+
+const std::vector<SyntheticCorpusFile>& SyntheticCorpusWriter::GetFiles() const
+{
+	return files;
+}
+
+bool SyntheticCorpusWriter::WriteManifest(const std::filesystem::path& path) const
+{
+	const SyntheticPopulationOptions& populationOptions = population.GetOptions();
+
+	std::ofstream stream(path, std::ofstream::out | std::ofstream::trunc);
+
+	stream << "{\n";
+	stream << "  \"seed\": " << populationOptions.seed << ",\n";
+	stream << "  \"exemplars\": " << populationOptions.exemplarCount << ",\n";
+	stream << "  \"exemplar_properties\": " << populationOptions.exemplarPropertyCount << ",\n";
+	stream << "  \"parent_cohorts\": " << populationOptions.parentCohortCount << ",\n";
+	stream << "  \"patches\": " << population.GetPatchCount() << ",\n";
+	stream << "  \"patch_targets\": " << populationOptions.patchTargetCount << ",\n";
+	stream << "  \"overlap\": " << populationOptions.targetOverlap << ",\n";
+	stream << "  \"patch_properties\": " << populationOptions.patchPropertyCount << ",\n";
+	stream << "  \"compressed_fraction\": " << options.compressedFraction << ",\n";
+	stream << "  \"files\": [";
+
+	for (size_t i = 0; i < files.size(); i++)
+	{
+		const SyntheticCorpusFile& file = files[i];
+
+		stream << (i == 0 ? "\n" : ",\n");
+		stream << "    { \"name\": \"" << EscapeJson(file.path.filename().string())
+			<< "\", \"records\": " << file.recordCount
+			<< ", \"compressed_records\": " << file.compressedRecordCount
+			<< ", \"size\": " << file.size << " }";
+	}
+
+	stream << "\n  ]\n}\n";
+
+	return stream.good();
+}
+
+std::filesystem::path SyntheticCorpusWriter::GetParentCohortFileName() const
+{
+	return "Synthetic Parent Cohorts.dat";
+}
+
+std::filesystem::path SyntheticCorpusWriter::GetExemplarFileName(uint32_t exemplarIndex) const
+{
+	return FormatFileName(
+		"Synthetic Exemplars",
+		GetFileIndex(exemplarIndex, population.GetExemplarCount(), options.exemplarFileCount));
+}
+
+std::filesystem::path SyntheticCorpusWriter::GetPatchFileName(uint32_t patchIndex) const
+{
+	return FormatFileName(
+		"zzz Synthetic Exemplar Patches",
+		GetFileIndex(patchIndex, population.GetPatchCount(), options.patchFileCount));
+}
+
+void SyntheticCorpusWriter::AddTo(MockResourceManager& resourceManager, const std::filesystem::path& directory) const
+{
+	for (uint32_t i = 0; i < population.GetParentCohortCount(); i++)
+	{
+		const SyntheticResource cohort = population.CreateParentCohort(i);
+		resourceManager.AddResource(cohort.key, cohort.properties, (directory / GetParentCohortFileName()).string());
+	}
+
+	for (uint32_t i = 0; i < population.GetExemplarCount(); i++)
+	{
+		const SyntheticResource exemplar = population.CreateExemplar(i);
+		resourceManager.AddResource(exemplar.key, exemplar.properties, (directory / GetExemplarFileName(i)).string());
+	}
+
+	for (uint32_t i = 0; i < population.GetPatchCount(); i++)
+	{
+		const SyntheticResource patch = population.CreatePatch(i);
+		resourceManager.AddResource(patch.key, patch.properties, (directory / GetPatchFileName(i)).string());
+	}
+}
+
+bool SyntheticCorpusWriter::IsCompressed(const cGZPersistResourceKey& key) const
+{
+	if (options.compressedFraction <= 0.0)
+	{
+		return false;
+	}
+
+	// The choice only depends on the key and the seed, not on how the records are split into files.
+	uint64_t z = population.GetOptions().seed
+		^ (static_cast<uint64_t>(key.type) << 32 | key.instance)
+		^ (static_cast<uint64_t>(key.group) * 0x9e3779b97f4a7c15ULL);
+	z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+	z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+	z ^= z >> 31;
+
+	return static_cast<double>(z >> 11) * (1.0 / 9007199254740992.0) < options.compressedFraction;
+}
@@ -0,0 +1,86 @@
+/*
+ * This file is part of sc4-resource-loading-hooks, a DLL Plugin for SimCity 4
+ * that allows other DLLs to modify resources as the game loads them.
+ *
+ * Copyright (C) 2024, 2025 Nicholas Hayes
+ *
+ * sc4-resource-loading-hooks is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * sc4-resource-loading-hooks is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with sc4-resource-loading-hooks.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#include "SyntheticExemplarPopulation.h"
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+struct SyntheticCorpusOptions
+{
+	// The exemplars are split into this many plugin files.
+	uint32_t exemplarFileCount = 1;
+	// The exemplar patches are split into this many plugin files, which load after the exemplars.
+	uint32_t patchFileCount = 1;
+	// The fraction of the records, from 0 to 1, that are written with QFS/RefPack compression.
+	// A record is stored uncompressed if it does not get smaller.
+	double compressedFraction = 0.0;
+};
+
+struct SyntheticCorpusFile
+{
+	std::filesystem::path path;
+	uint32_t recordCount = 0;
+	// The records that were requested to be compressed.
+	uint32_t compressedRecordCount = 0;
+	uint64_t size = 0;
+};
+
+// Writes a synthetic exemplar population to DBPF plugin files.
+//
+// The game loads the plugins in alphabetical order, the parent cohorts are written to
+// "Synthetic Parent Cohorts.dat", the exemplars to "Synthetic Exemplars 0001.dat" and so on,
+// and the exemplar patches to "zzz Synthetic Exemplar Patches 0001.dat" and so on.
+class SyntheticCorpusWriter
+{
+public:
+
+	SyntheticCorpusWriter(const SyntheticExemplarPopulation& population, const SyntheticCorpusOptions& options);
+
+	// Writes the files to the directory, which is created if it does not exist.
+	// Returns false and sets the error message if a file could not be written.
+	bool Write(const std::filesystem::path& directory, std::string& error);
+
+	// The files that the last Write call created.
+	const std::vector<SyntheticCorpusFile>& GetFiles() const;
+
+	// Writes the options, the population and the file list as JSON.
+	bool WriteManifest(const std::filesystem::path& path) const;
+
+	// The file names that the resources are written to, relative to the directory.
+	std::filesystem::path GetParentCohortFileName() const;
+	std::filesystem::path GetExemplarFileName(uint32_t exemplarIndex) const;
+	std::filesystem::path GetPatchFileName(uint32_t patchIndex) const;
+
+	// Adds the population to the resource manager with the paths of the files that
+	// the resources were written to, the patch scanner then reads the patches from the files.
+	void AddTo(MockResourceManager& resourceManager, const std::filesystem::path& directory) const;
+
+private:
+
+	bool IsCompressed(const cGZPersistResourceKey& key) const;
+
+	const SyntheticExemplarPopulation& population;
+	SyntheticCorpusOptions options;
+	std::vector<SyntheticCorpusFile> files;
+};
@@ -0,0 +1,322 @@
+/*
+ * This file is part of sc4-resource-loading-hooks, a DLL Plugin for SimCity 4
+ * that allows other DLLs to modify resources as the game loads them.
+ *
+ * Copyright (C) 2024, 2025 Nicholas Hayes
+ *
+ * sc4-resource-loading-hooks is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * sc4-resource-loading-hooks is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with sc4-resource-loading-hooks.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "SyntheticExemplarPopulation.h"
+#include "cRZBaseVariant.h"
+#include "cSCBaseProperty.h"
+#include "MockResourceManager.h"
+#include <algorithm>
+#include <cstdio>
+
+namespace
+{
+	static constexpr uint32_t ExemplarGroupID = 0x5A000000;
+	static constexpr uint32_t ParentCohortGroupID = 0x5B000000;
+	static constexpr uint32_t ExemplarInstanceBase = 0x10000000;
+	static constexpr uint32_t ParentCohortInstanceBase = 0x20000000;
+	static constexpr uint32_t PatchInstanceBase = 0x30000000;
+	// The exemplars are split over a few groups, like the exemplars of different plugins.
+	static constexpr uint32_t ExemplarsPerGroup = 4096;
+	// The patch properties use a few more IDs than the exemplars, so that some are added
+	// instead of replaced.
+	static constexpr uint32_t ExtraPatchPropertyIDs = 4;
+
+	// SplitMix64, the standard library distributions are not the same on every platform.
+	class Random
+	{
+	public:
+
+		explicit Random(uint64_t seed) : state(seed)
+		{
+		}
+
+		uint64_t Next()
+		{
+			uint64_t z = (state += 0x9e3779b97f4a7c15ULL);
+			z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+			z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+			return z ^ (z >> 31);
+		}
+
+		uint32_t NextBelow(uint32_t limit)
+		{
+			return static_cast<uint32_t>((Next() >> 32) * limit >> 32);
+		}
+
+		double NextUnit()
+		{
+			return static_cast<double>(Next() >> 11) * (1.0 / 9007199254740992.0);
+		}
+
+	private:
+
+		uint64_t state;
+	};
+
+	enum class ResourceKind : uint64_t
+	{
+		Exemplar = 1,
+		ParentCohort = 2,
+		PatchTargets = 3
+	};
+
+	// Every resource has its own random sequence, so it can be created without the others.
+	uint64_t MixSeed(uint64_t seed, ResourceKind kind, uint32_t index)
+	{
+		return seed ^ (static_cast<uint64_t>(kind) << 56) ^ (static_cast<uint64_t>(index) << 8);
+	}
+
+	cRZAutoRefCount<cISCProperty> CreateUint32Property(uint32_t id, uint32_t value)
+	{
+		cRZBaseVariant variant;
+		variant.SetValUint32(value);
+
+		return cRZAutoRefCount<cISCProperty>(new cSCBaseProperty(id, &variant), cRZAutoRefCount<cISCProperty>::kAddRef);
+	}
+
+	cRZAutoRefCount<cISCProperty> CreateUint32ArrayProperty(uint32_t id, const std::vector<uint32_t>& values)
+	{
+		cRZBaseVariant variant;
+		variant.SetValUint32(values.data(), static_cast<uint32_t>(values.size()));
+
+		return cRZAutoRefCount<cISCProperty>(new cSCBaseProperty(id, &variant), cRZAutoRefCount<cISCProperty>::kAddRef);
+	}
+
+	cRZAutoRefCount<cISCProperty> CreateFloat32ArrayProperty(uint32_t id, const std::vector<float>& values)
+	{
+		cRZBaseVariant variant;
+		variant.SetValFloat32(values.data(), static_cast<uint32_t>(values.size()));
+
+		return cRZAutoRefCount<cISCProperty>(new cSCBaseProperty(id, &variant), cRZAutoRefCount<cISCProperty>::kAddRef);
+	}
+
+	cRZAutoRefCount<cISCProperty> CreateStringProperty(uint32_t id, const std::string& value)
+	{
+		cRZBaseVariant variant;
+		variant.SetValRZChar(value.data(), static_cast<uint32_t>(value.size()));
+
+		return cRZAutoRefCount<cISCProperty>(new cSCBaseProperty(id, &variant), cRZAutoRefCount<cISCProperty>::kAddRef);
+	}
+
+	std::string FormatName(const char* prefix, uint32_t index)
+	{
+		char buffer[64]{};
+		std::snprintf(buffer, sizeof(buffer), "%s %u", prefix, index);
+
+		return buffer;
+	}
+}
+
+SyntheticExemplarPopulation::SyntheticExemplarPopulation(const SyntheticPopulationOptions& options)
+	: options(options),
+	  patchTargets(),
+	  patchesByExemplar()
+{
+	Random random(MixSeed(options.seed, ResourceKind::PatchTargets, 0));
+
+	patchesByExemplar.resize(options.exemplarCount);
+	patchTargets.resize(options.exemplarCount > 0 ? options.patchCount : 0);
+
+	const uint32_t targetCount = std::min(options.patchTargetCount, options.exemplarCount);
+	const uint32_t sharedExemplarCount = std::max(1u, options.exemplarCount / 100);
+
+	for (uint32_t i = 0; i < patchTargets.size(); i++)
+	{
+		std::vector<uint32_t>& targetIndices = patchTargets[i];
+		targetIndices.reserve(targetCount);
+
+		while (targetIndices.size() < targetCount)
+		{
+			const uint32_t index = random.NextUnit() < options.targetOverlap
+				? random.NextBelow(sharedExemplarCount)
+				: random.NextBelow(options.exemplarCount);
+
+			if (std::find(targetIndices.begin(), targetIndices.end(), index) == targetIndices.end())
+			{
+				targetIndices.push_back(index);
+			}
+			else if (targetIndices.size() >= sharedExemplarCount && options.targetOverlap >= 1.0)
+			{
+				// Every shared exemplar is already a target.
+				break;
+			}
+		}
+
+		for (uint32_t index : targetIndices)
+		{
+			patchesByExemplar[index].push_back(i);
+		}
+	}
+}
+
+const SyntheticPopulationOptions& SyntheticExemplarPopulation::GetOptions() const
+{
+	return options;
+}
+
+uint32_t SyntheticExemplarPopulation::GetExemplarCount() const
+{
+	return options.exemplarCount;
+}
+
+cGZPersistResourceKey SyntheticExemplarPopulation::GetExemplarKey(uint32_t index) const
+{
+	return cGZPersistResourceKey(ExemplarTypeID, ExemplarGroupID + index / ExemplarsPerGroup, ExemplarInstanceBase + index);
+}
+
+SyntheticResource SyntheticExemplarPopulation::CreateExemplar(uint32_t index) const
+{
+	Random random(MixSeed(options.seed, ResourceKind::Exemplar, index));
+
+	SyntheticResource exemplar;
+	exemplar.key = GetExemplarKey(index);
+
+	if (options.parentCohortCount > 0)
+	{
+		exemplar.parentCohortKey = GetParentCohortKey(index % options.parentCohortCount);
+	}
+
+	exemplar.properties.reserve(options.exemplarPropertyCount + 2);
+
+	// The Exemplar Type values cycle through the common building and prop types.
+	exemplar.properties.push_back(CreateUint32Property(ExemplarTypePropertyID, 1 + index % 32));
+	exemplar.properties.push_back(CreateStringProperty(ExemplarNamePropertyID, FormatName("Synthetic exemplar", index)));
+
+	for (uint32_t j = 0; j < options.exemplarPropertyCount; j++)
+	{
+		const uint32_t id = PropertyIDBase + j;
+
+		if (j % 4 == 3)
+		{
+			std::vector<float> values(1 + random.NextBelow(8));
+
+			for (float& value : values)
+			{
+				value = static_cast<float>(random.NextBelow(10000)) / 16.0f;
+			}
+
+			exemplar.properties.push_back(CreateFloat32ArrayProperty(id, values));
+		}
+		else
+		{
+			exemplar.properties.push_back(CreateUint32Property(id, random.NextBelow(UINT32_MAX)));
+		}
+	}
+
+	return exemplar;
+}
+
+uint32_t SyntheticExemplarPopulation::GetParentCohortCount() const
+{
+	return options.parentCohortCount;
+}
+
+cGZPersistResourceKey SyntheticExemplarPopulation::GetParentCohortKey(uint32_t index) const
+{
+	return cGZPersistResourceKey(CohortTypeID, ParentCohortGroupID, ParentCohortInstanceBase + index);
+}
+
+SyntheticResource SyntheticExemplarPopulation::CreateParentCohort(uint32_t index) const
+{
+	Random random(MixSeed(options.seed, ResourceKind::ParentCohort, index));
+
+	SyntheticResource cohort;
+	cohort.key = GetParentCohortKey(index);
+	cohort.properties.push_back(CreateStringProperty(ExemplarNamePropertyID, FormatName("Synthetic parent cohort", index)));
+	cohort.properties.push_back(CreateUint32Property(PropertyIDBase, random.NextBelow(1000)));
+
+	return cohort;
+}
+
+uint32_t SyntheticExemplarPopulation::GetPatchCount() const
+{
+	return static_cast<uint32_t>(patchTargets.size());
+}
+
+cGZPersistResourceKey SyntheticExemplarPopulation::GetPatchKey(uint32_t index) const
+{
+	return cGZPersistResourceKey(CohortTypeID, ExemplarPatchGroupID, PatchInstanceBase + index);
+}
+
+SyntheticResource SyntheticExemplarPopulation::CreatePatch(uint32_t index) const
+{
+	const std::vector<uint32_t>& targetIndices = patchTargets[index];
+
+	std::vector<uint32_t> targetValues;
+	targetValues.reserve(targetIndices.size() * 2);
+
+	for (uint32_t target : targetIndices)
+	{
+		const cGZPersistResourceKey key = GetExemplarKey(target);
+
+		targetValues.push_back(key.group);
+		targetValues.push_back(key.instance);
+	}
+
+	const uint32_t patchPropertyIDCount = options.exemplarPropertyCount + ExtraPatchPropertyIDs;
+	const uint32_t patchPropertyCount = std::min(options.patchPropertyCount, patchPropertyIDCount);
+
+	SyntheticResource patch;
+	patch.key = GetPatchKey(index);
+	patch.properties.reserve(patchPropertyCount + 1);
+	patch.properties.push_back(CreateUint32ArrayProperty(ExemplarPatchTargetsPropertyID, targetValues));
+
+	// Consecutive patches change overlapping sets of properties.
+	for (uint32_t k = 0; k < patchPropertyCount; k++)
+	{
+		const uint32_t id = PropertyIDBase + (index * 3 + k) % patchPropertyIDCount;
+
+		patch.properties.push_back(CreateUint32Property(id, (index << 8) | k));
+	}
+
+	return patch;
+}
+
+const std::vector<uint32_t>& SyntheticExemplarPopulation::GetPatchTargets(uint32_t patchIndex) const
+{
+	return patchTargets[patchIndex];
+}
+
+const std::vector<std::vector<uint32_t>>& SyntheticExemplarPopulation::GetPatchesByExemplar() const
+{
+	return patchesByExemplar;
+}
+
+void SyntheticExemplarPopulation::AddTo(MockResourceManager& resourceManager, const std::string& segmentPath) const
+{
+	for (uint32_t i = 0; i < GetParentCohortCount(); i++)
+	{
+		const SyntheticResource cohort = CreateParentCohort(i);
+		resourceManager.AddResource(cohort.key, cohort.properties, segmentPath);
+	}
+
+	for (uint32_t i = 0; i < GetExemplarCount(); i++)
+	{
+		const SyntheticResource exemplar = CreateExemplar(i);
+		resourceManager.AddResource(exemplar.key, exemplar.properties, segmentPath);
+	}
+
+	for (uint32_t i = 0; i < GetPatchCount(); i++)
+	{
+		const SyntheticResource patch = CreatePatch(i);
+		resourceManager.AddResource(patch.key, patch.properties, segmentPath);
+	}
+}
@@ -0,0 +1,107 @@
+/*
+ * This file is part of sc4-resource-loading-hooks, a DLL Plugin for SimCity 4
+ * that allows other DLLs to modify resources as the game loads them.
+ *
+ * Copyright (C) 2024, 2025 Nicholas Hayes
+ *
+ * sc4-resource-loading-hooks is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * sc4-resource-loading-hooks is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with sc4-resource-loading-hooks.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#include "cGZPersistResourceKey.h"
+#include "MockExemplar.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class MockResourceManager;
+
+struct SyntheticPopulationOptions
+{
+	uint32_t exemplarCount = 1000;
+	// The properties of each exemplar, not counting the Exemplar Type and Exemplar Name.
+	uint32_t exemplarPropertyCount = 16;
+	// The exemplars are spread over the parent cohorts, 0 for no parent cohorts.
+	uint32_t parentCohortCount = 0;
+	uint32_t patchCount = 100;
+	// The number of exemplars that each patch targets.
+	uint32_t patchTargetCount = 8;
+	// The fraction of the patch targets, from 0 to 1, that are picked from a small
+	// set of shared exemplars. Higher values put more patches on the same exemplars.
+	double targetOverlap = 0.0;
+	// The properties that each patch adds or replaces.
+	uint32_t patchPropertyCount = 4;
+	uint64_t seed = 1;
+};
+
+struct SyntheticResource
+{
+	cGZPersistResourceKey key;
+	// Zero for the resources that do not have a parent cohort.
+	cGZPersistResourceKey parentCohortKey;
+	MockPropertyList properties;
+};
+
+// A deterministic set of exemplars, parent cohorts and exemplar patch cohorts.
+// The same options produce the same resources on every platform.
+//
+// Only the patch targets are kept in memory, the resources are created when they are
+// requested so that populations with millions of exemplars can be written to disk.
+class SyntheticExemplarPopulation
+{
+public:
+
+	static constexpr uint32_t ExemplarTypeID = 0x6534284A;
+	static constexpr uint32_t CohortTypeID = 0x05342861;
+	static constexpr uint32_t ExemplarPatchGroupID = 0xB03697D1;
+	static constexpr uint32_t ExemplarPatchTargetsPropertyID = 0x0062E78A;
+	static constexpr uint32_t ExemplarTypePropertyID = 0x00000010;
+	static constexpr uint32_t ExemplarNamePropertyID = 0x00000020;
+	// The first ID of the generated properties.
+	static constexpr uint32_t PropertyIDBase = 0x4A000000;
+
+	explicit SyntheticExemplarPopulation(const SyntheticPopulationOptions& options);
+
+	const SyntheticPopulationOptions& GetOptions() const;
+
+	uint32_t GetExemplarCount() const;
+	cGZPersistResourceKey GetExemplarKey(uint32_t index) const;
+	SyntheticResource CreateExemplar(uint32_t index) const;
+
+	uint32_t GetParentCohortCount() const;
+	cGZPersistResourceKey GetParentCohortKey(uint32_t index) const;
+	SyntheticResource CreateParentCohort(uint32_t index) const;
+
+	// The exemplar patch cohorts are numbered in load order.
+	uint32_t GetPatchCount() const;
+	cGZPersistResourceKey GetPatchKey(uint32_t index) const;
+	SyntheticResource CreatePatch(uint32_t index) const;
+
+	// The indices of the exemplars that each patch targets.
+	const std::vector<uint32_t>& GetPatchTargets(uint32_t patchIndex) const;
+
+	// The indices of the patches that target each exemplar, in load order.
+	const std::vector<std::vector<uint32_t>>& GetPatchesByExemplar() const;
+
+	// Adds the parent cohorts, the exemplars and then the patches.
+	// The segment path is passed to MockResourceManager::AddResource.
+	void AddTo(MockResourceManager& resourceManager, const std::string& segmentPath = std::string()) const;
+
+private:
+
+	SyntheticPopulationOptions options;
+	std::vector<std::vector<uint32_t>> patchTargets;
+	std::vector<std::vector<uint32_t>> patchesByExemplar;
+};
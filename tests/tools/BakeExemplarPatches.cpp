@@ -0,0 +1,127 @@
+/*
+ * This file is part of sc4-resource-loading-hooks, a DLL Plugin for SimCity 4
+ * that allows other DLLs to modify resources as the game loads them.
+ *
+ * Copyright (C) 2024, 2025 Nicholas Hayes
+ *
+ * sc4-resource-loading-hooks is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * sc4-resource-loading-hooks is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with sc4-resource-loading-hooks.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Writes the baked exemplar patch file that the -exemplar-patch-bake switch writes, without
+// starting the game. The patches are scanned and baked with the same code as the DLL uses in the game.
+
+#include "OfflineExemplarPatchScan.h"
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+namespace
+{
+	void PrintUsage(const char* program)
+	{
+		std::fprintf(
+			stderr,
+			"Usage: %s --plugins=<path> [--plugins=<path>...] [options]\n"
+			"\n"
+			"  --plugins=<path>   A DBPF file or a folder that is searched recursively, can be repeated.\n"
+			"                     The files load in argument order, the files in a folder in path order.\n"
+			"                     Pass the game's DBPF files first when the patches target their exemplars.\n"
+			"  --output=<file>    The baked file, default SC4ExemplarPatches.baked.\n"
+			"\n"
+			"Install the baked file as a .dat plugin that loads after the patched plugins, and start the\n"
+			"game with -exemplar-patch-baked to skip the scan.\n"
+			"The game only uses the baked file when the plugins it loaded have the same fingerprint: the\n"
+			"same Exemplar patch records, in the same order, from files with the same paths, sizes\n"
+			"and modification times. Pass the plugins in the game's load order with the paths that\n"
+			"the game uses, otherwise the game disables the baked file as stale.\n",
+			program);
+	}
+
+	bool StartsWith(const char* argument, const char* prefix, const char*& value)
+	{
+		const size_t length = std::strlen(prefix);
+
+		if (std::strncmp(argument, prefix, length) == 0)
+		{
+			value = argument + length;
+			return true;
+		}
+
+		return false;
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	std::vector<std::filesystem::path> pluginPaths;
+	std::filesystem::path outputPath = "SC4ExemplarPatches.baked";
+
+	for (int i = 1; i < argc; i++)
+	{
+		const char* argument = argv[i];
+		const char* value = nullptr;
+		bool valid = true;
+
+		if (StartsWith(argument, "--plugins=", value))
+		{
+			pluginPaths.emplace_back(value);
+			valid = *value != '\0';
+		}
+		else if (StartsWith(argument, "--output=", value))
+		{
+			outputPath = value;
+			valid = !outputPath.empty();
+		}
+		else
+		{
+			valid = false;
+		}
+
+		if (!valid)
+		{
+			std::fprintf(stderr, "Invalid argument: %s\n\n", argument);
+			PrintUsage(argv[0]);
+			return 2;
+		}
+	}
+
+	if (pluginPaths.empty())
+	{
+		PrintUsage(argv[0]);
+		return 2;
+	}
+
+	OfflineExemplarPatchScan scan;
+	std::string error;
+	uint32_t bakedExemplarCount = 0;
+	uint32_t skippedExemplarCount = 0;
+
+	if (!scan.Scan(pluginPaths, error) || !scan.Bake(outputPath, bakedExemplarCount, skippedExemplarCount, error))
+	{
+		std::fprintf(stderr, "%s\n", error.c_str());
+		return 1;
+	}
+
+	std::printf(
+		"Baked %u patched Exemplar files from %u Exemplar patches to %s, skipped %u Exemplar files that are not in the plugins.\n",
+		bakedExemplarCount,
+		scan.GetPatchCount(),
+		outputPath.string().c_str(),
+		skippedExemplarCount);
+
+	return 0;
+}
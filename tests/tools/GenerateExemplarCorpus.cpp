@@ -0,0 +1,234 @@
+/*
+ * This file is part of sc4-resource-loading-hooks, a DLL Plugin for SimCity 4
+ * that allows other DLLs to modify resources as the game loads them.
+ *
+ * Copyright (C) 2024, 2025 Nicholas Hayes
+ *
+ * sc4-resource-loading-hooks is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * sc4-resource-loading-hooks is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with sc4-resource-loading-hooks.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Writes a synthetic plugin folder with exemplars, parent cohorts and exemplar patches
+// for the scan and load benchmarks. The same options always produce the same files.
+
+#include "SyntheticCorpusWriter.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+namespace
+{
+	void PrintUsage(const char* program)
+	{
+		std::fprintf(
+			stderr,
+			"Usage: %s --output=<directory> [options]\n"
+			"\n"
+			"  --exemplars=<count>            The number of exemplars, default 1000.\n"
+			"  --exemplar-properties=<count>  The generated properties of each exemplar, default 16.\n"
+			"  --parent-cohorts=<count>       The parent cohorts that the exemplars are spread over, default 0.\n"
+			"  --patches=<count>              The number of exemplar patches, default 100.\n"
+			"  --patch-targets=<count>        The exemplars that each patch targets (fan-out), default 8.\n"
+			"  --overlap=<0-1>                The fraction of the targets that are picked from a shared 1%%\n"
+			"                                 of the exemplars, default 0.\n"
+			"  --patch-properties=<count>     The properties that each patch sets, default 4.\n"
+			"  --exemplar-files=<count>       The plugin files that the exemplars are split into, default 1.\n"
+			"  --patch-files=<count>          The plugin files that the patches are split into, default 1.\n"
+			"  --compress=<0-1>               The fraction of the records that are compressed, default 0.\n"
+			"  --seed=<value>                 The random seed, default 1.\n",
+			program);
+	}
+
+	bool StartsWith(const char* argument, const char* prefix, const char*& value)
+	{
+		const size_t length = std::strlen(prefix);
+
+		if (std::strncmp(argument, prefix, length) == 0)
+		{
+			value = argument + length;
+			return true;
+		}
+
+		return false;
+	}
+
+	bool ParseUint32(const char* text, uint32_t& value)
+	{
+		char* end = nullptr;
+		const unsigned long long result = std::strtoull(text, &end, 0);
+
+		if (end == text || *end != '\0' || result > UINT32_MAX || text[0] == '-')
+		{
+			return false;
+		}
+
+		value = static_cast<uint32_t>(result);
+		return true;
+	}
+
+	bool ParseUint64(const char* text, uint64_t& value)
+	{
+		char* end = nullptr;
+		const unsigned long long result = std::strtoull(text, &end, 0);
+
+		if (end == text || *end != '\0' || text[0] == '-')
+		{
+			return false;
+		}
+
+		value = static_cast<uint64_t>(result);
+		return true;
+	}
+
+	bool ParseFraction(const char* text, double& value)
+	{
+		char* end = nullptr;
+		const double result = std::strtod(text, &end);
+
+		if (end == text || *end != '\0' || !(result >= 0.0 && result <= 1.0))
+		{
+			return false;
+		}
+
+		value = result;
+		return true;
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	SyntheticPopulationOptions populationOptions;
+	SyntheticCorpusOptions corpusOptions;
+	std::string outputDirectory;
+
+	for (int i = 1; i < argc; i++)
+	{
+		const char* argument = argv[i];
+		const char* value = nullptr;
+		bool valid = true;
+
+		if (StartsWith(argument, "--output=", value))
+		{
+			outputDirectory = value;
+			valid = !outputDirectory.empty();
+		}
+		else if (StartsWith(argument, "--exemplars=", value))
+		{
+			valid = ParseUint32(value, populationOptions.exemplarCount);
+		}
+		else if (StartsWith(argument, "--exemplar-properties=", value))
+		{
+			valid = ParseUint32(value, populationOptions.exemplarPropertyCount);
+		}
+		else if (StartsWith(argument, "--parent-cohorts=", value))
+		{
+			valid = ParseUint32(value, populationOptions.parentCohortCount);
+		}
+		else if (StartsWith(argument, "--patches=", value))
+		{
+			valid = ParseUint32(value, populationOptions.patchCount);
+		}
+		else if (StartsWith(argument, "--patch-targets=", value))
+		{
+			valid = ParseUint32(value, populationOptions.patchTargetCount);
+		}
+		else if (StartsWith(argument, "--overlap=", value))
+		{
+			valid = ParseFraction(value, populationOptions.targetOverlap);
+		}
+		else if (StartsWith(argument, "--patch-properties=", value))
+		{
+			valid = ParseUint32(value, populationOptions.patchPropertyCount);
+		}
+		else if (StartsWith(argument, "--exemplar-files=", value))
+		{
+			valid = ParseUint32(value, corpusOptions.exemplarFileCount) && corpusOptions.exemplarFileCount > 0;
+		}
+		else if (StartsWith(argument, "--patch-files=", value))
+		{
+			valid = ParseUint32(value, corpusOptions.patchFileCount) && corpusOptions.patchFileCount > 0;
+		}
+		else if (StartsWith(argument, "--compress=", value))
+		{
+			valid = ParseFraction(value, corpusOptions.compressedFraction);
+		}
+		else if (StartsWith(argument, "--seed=", value))
+		{
+			valid = ParseUint64(value, populationOptions.seed);
+		}
+		else
+		{
+			valid = false;
+		}
+
+		if (!valid)
+		{
+			std::fprintf(stderr, "Invalid argument: %s\n\n", argument);
+			PrintUsage(argv[0]);
+			return 2;
+		}
+	}
+
+	if (outputDirectory.empty())
+	{
+		PrintUsage(argv[0]);
+		return 2;
+	}
+
+	const auto start = std::chrono::steady_clock::now();
+
+	const SyntheticExemplarPopulation population(populationOptions);
+	SyntheticCorpusWriter writer(population, corpusOptions);
+
+	std::string error;
+
+	if (!writer.Write(outputDirectory, error))
+	{
+		std::fprintf(stderr, "%s\n", error.c_str());
+		return 1;
+	}
+
+	const std::filesystem::path manifestPath = std::filesystem::path(outputDirectory) / "corpus.json";
+
+	if (!writer.WriteManifest(manifestPath))
+	{
+		std::fprintf(stderr, "Failed to write %s\n", manifestPath.string().c_str());
+		return 1;
+	}
+
+	uint64_t recordCount = 0;
+	uint64_t totalSize = 0;
+
+	for (const SyntheticCorpusFile& file : writer.GetFiles())
+	{
+		recordCount += file.recordCount;
+		totalSize += file.size;
+	}
+
+	const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	std::printf(
+		"Wrote %llu records (%u exemplars, %u parent cohorts, %u exemplar patches) to %zu files, %.1f MiB in %.2f seconds.\n",
+		static_cast<unsigned long long>(recordCount),
+		population.GetExemplarCount(),
+		population.GetParentCohortCount(),
+		population.GetPatchCount(),
+		writer.GetFiles().size(),
+		static_cast<double>(totalSize) / (1024.0 * 1024.0),
+		seconds);
+
+	return 0;
+}
@@ -0,0 +1,391 @@
+/*
+ * This file is part of sc4-resource-loading-hooks, a DLL Plugin for SimCity 4
+ * that allows other DLLs to modify resources as the game loads them.
+ *
+ * Copyright (C) 2024, 2025 Nicholas Hayes
+ *
+ * sc4-resource-loading-hooks is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * sc4-resource-loading-hooks is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with sc4-resource-loading-hooks.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Replays a trace that the DLL recorded with the -exemplar-load-trace switch through the
+// exemplar patching server and the exemplar factory proxy on the in-memory GZCOM services.
+// The same trace and plugins always produce the same sequence of loads, patches and
+// load notifications, which makes it possible to compare optimizations on a real city load.
+
+#include "ExemplarLoadTraceReader.h"
+#include "ExemplarLoadTraceReplayer.h"
+#include "ExemplarPatchingHarness.h"
+#include "ExemplarResourceFactoryProxy.h"
+#include "PerformanceCounters.h"
+#include "PluginResourceLoader.h"
+#include "cIExemplarLoadHookTarget.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+namespace
+{
+	static constexpr uint32_t CohortTypeID = 0x05342861;
+
+	// Counts the load notifications of a subscriber DLL.
+	class CountingLoadTarget : public cIExemplarLoadHookTarget
+	{
+	public:
+		bool QueryInterface(uint32_t riid, void** ppvObj) override
+		{
+			return false;
+		}
+
+		uint32_t AddRef() override
+		{
+			return 1;
+		}
+
+		uint32_t Release() override
+		{
+			return 1;
+		}
+
+		void ExemplarLoaded(
+			const char* const originalFunctionName,
+			const cGZPersistResourceKey& key,
+			cISCResExemplar* resExemplar) override
+		{
+			loadCount++;
+		}
+
+		uint64_t loadCount = 0;
+	};
+
+	void PrintUsage(const char* program)
+	{
+		std::fprintf(
+			stderr,
+			"Usage: %s --trace=<file> [options] [-<game switch>...]\n"
+			"\n"
+			"  --plugins=<path>        A DBPF file or a folder that is searched recursively, can be\n"
+			"                          repeated. The files load in argument order, the files in a folder\n"
+			"                          in path order, and a later file replaces the resources of an earlier one.\n"
+			"  --subscribers=<count>   The load notification subscribers, a mix of every exemplar, one group,\n"
+			"                          one exemplar and a group that is not loaded, default 0.\n"
+			"  --repeat=<count>        The number of times the trace is replayed, default 1.\n"
+			"  --output=<file>         Writes the replay summary as JSON.\n"
+			"  --perf-report=<file>    Enables the performance counters and writes their report.\n"
+			"\n"
+			"The other arguments that start with a single '-' are passed to the exemplar patching\n"
+			"server as game command line switches, e.g. -exemplar-patch-skip-identical.\n"
+			"The trace exemplars that are not in the plugins are replayed without properties.\n"
+			"The exit code is 3 if a replayed load did not have the recorded result.\n",
+			program);
+	}
+
+	bool StartsWith(const char* argument, const char* prefix, const char*& value)
+	{
+		const size_t length = std::strlen(prefix);
+
+		if (std::strncmp(argument, prefix, length) == 0)
+		{
+			value = argument + length;
+			return true;
+		}
+
+		return false;
+	}
+
+	bool ParseUint32(const char* text, uint32_t& value)
+	{
+		char* end = nullptr;
+		const unsigned long long result = std::strtoull(text, &end, 0);
+
+		if (end == text || *end != '\0' || result > UINT32_MAX || text[0] == '-')
+		{
+			return false;
+		}
+
+		value = static_cast<uint32_t>(result);
+		return true;
+	}
+
+	bool WriteSummary(
+		const std::filesystem::path& path,
+		const std::filesystem::path& tracePath,
+		const ExemplarLoadTraceReader& trace,
+		const PluginLoadStatistics& pluginStatistics,
+		size_t missingExemplarCount,
+		uint32_t subscriberCount,
+		uint64_t notificationCount,
+		uint32_t repeatCount,
+		const ExemplarLoadTraceReplayResult& result)
+	{
+		FILE* file = std::fopen(path.string().c_str(), "w");
+
+		if (!file)
+		{
+			return false;
+		}
+
+		const std::vector<ExemplarLoadTraceRecord>& records = trace.GetRecords();
+		const uint64_t traceDuration = records.empty() ? 0 : records.back().timestampNanoseconds;
+		const uint64_t replayedRecordCount = result.recordOverloadLoadCount + result.typeOverloadLoadCount + result.loadErrorCount;
+
+		std::string traceFile = tracePath.generic_string();
+		std::replace(traceFile.begin(), traceFile.end(), '"', '\'');
+
+		std::fprintf(file, "{\n");
+		std::fprintf(file, "  \"trace\": {\n");
+		std::fprintf(file, "    \"file\": \"%s\",\n", traceFile.c_str());
+		std::fprintf(file, "    \"start_time_ms\": %llu,\n", static_cast<unsigned long long>(trace.GetStartTime()));
+		std::fprintf(file, "    \"records\": %zu,\n", records.size());
+		std::fprintf(file, "    \"threads\": %zu,\n", trace.GetThreadCount());
+		std::fprintf(file, "    \"duration_ns\": %llu,\n", static_cast<unsigned long long>(traceDuration));
+		std::fprintf(file, "    \"truncated\": %s\n", trace.IsTruncated() ? "true" : "false");
+		std::fprintf(file, "  },\n");
+		std::fprintf(file, "  \"plugins\": {\n");
+		std::fprintf(file, "    \"files\": %u,\n", pluginStatistics.fileCount);
+		std::fprintf(file, "    \"skipped_files\": %u,\n", pluginStatistics.skippedFileCount);
+		std::fprintf(file, "    \"exemplars\": %llu,\n", static_cast<unsigned long long>(pluginStatistics.exemplarCount));
+		std::fprintf(file, "    \"cohorts\": %llu,\n", static_cast<unsigned long long>(pluginStatistics.cohortCount));
+		std::fprintf(file, "    \"invalid_records\": %llu,\n", static_cast<unsigned long long>(pluginStatistics.invalidRecordCount));
+		std::fprintf(file, "    \"missing_exemplars\": %zu\n", missingExemplarCount);
+		std::fprintf(file, "  },\n");
+		std::fprintf(file, "  \"replay\": {\n");
+		std::fprintf(file, "    \"repetitions\": %u,\n", repeatCount);
+		std::fprintf(file, "    \"record_loads\": %llu,\n", static_cast<unsigned long long>(result.recordOverloadLoadCount));
+		std::fprintf(file, "    \"type_loads\": %llu,\n", static_cast<unsigned long long>(result.typeOverloadLoadCount));
+		std::fprintf(file, "    \"load_errors\": %llu,\n", static_cast<unsigned long long>(result.loadErrorCount));
+		std::fprintf(file, "    \"mismatches\": %llu,\n", static_cast<unsigned long long>(result.mismatchCount));
+		std::fprintf(file, "    \"subscribers\": %u,\n", subscriberCount);
+		std::fprintf(file, "    \"notifications\": %llu,\n", static_cast<unsigned long long>(notificationCount));
+		std::fprintf(file, "    \"elapsed_ns\": %llu,\n", static_cast<unsigned long long>(result.elapsedNanoseconds));
+		std::fprintf(
+			file,
+			"    \"ns_per_record\": %.1f\n",
+			replayedRecordCount > 0 ? static_cast<double>(result.elapsedNanoseconds) / static_cast<double>(replayedRecordCount) : 0.0);
+		std::fprintf(file, "  }\n");
+		std::fprintf(file, "}\n");
+
+		const bool ok = std::ferror(file) == 0;
+
+		return std::fclose(file) == 0 && ok;
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	std::filesystem::path tracePath;
+	std::vector<std::filesystem::path> pluginPaths;
+	std::filesystem::path outputPath;
+	std::filesystem::path performanceReportPath;
+	std::vector<std::string> gameArguments;
+	uint32_t subscriberCount = 0;
+	uint32_t repeatCount = 1;
+
+	for (int i = 1; i < argc; i++)
+	{
+		const char* argument = argv[i];
+		const char* value = nullptr;
+		bool valid = true;
+
+		if (StartsWith(argument, "--trace=", value))
+		{
+			tracePath = value;
+			valid = !tracePath.empty();
+		}
+		else if (StartsWith(argument, "--plugins=", value))
+		{
+			pluginPaths.emplace_back(value);
+			valid = *value != '\0';
+		}
+		else if (StartsWith(argument, "--subscribers=", value))
+		{
+			valid = ParseUint32(value, subscriberCount);
+		}
+		else if (StartsWith(argument, "--repeat=", value))
+		{
+			valid = ParseUint32(value, repeatCount) && repeatCount > 0;
+		}
+		else if (StartsWith(argument, "--output=", value))
+		{
+			outputPath = value;
+			valid = !outputPath.empty();
+		}
+		else if (StartsWith(argument, "--perf-report=", value))
+		{
+			performanceReportPath = value;
+			valid = !performanceReportPath.empty();
+		}
+		else if (argument[0] == '-' && argument[1] != '-' && argument[1] != '\0')
+		{
+			gameArguments.push_back(argument);
+		}
+		else
+		{
+			valid = false;
+		}
+
+		if (!valid)
+		{
+			std::fprintf(stderr, "Invalid argument: %s\n\n", argument);
+			PrintUsage(argv[0]);
+			return 2;
+		}
+	}
+
+	if (tracePath.empty())
+	{
+		PrintUsage(argv[0]);
+		return 2;
+	}
+
+	ExemplarLoadTraceReader trace;
+	std::string error;
+
+	if (!trace.Open(tracePath, error))
+	{
+		std::fprintf(stderr, "%s\n", error.c_str());
+		return 1;
+	}
+
+	if (trace.IsTruncated())
+	{
+		std::fprintf(stderr, "The trace ends with an incomplete record, it is replayed up to that record.\n");
+	}
+
+	// The subscribers are declared before the harness, they must outlive the load hook server.
+	std::vector<CountingLoadTarget> subscribers(subscriberCount);
+
+	ExemplarPatchingHarness harness(gameArguments);
+	ExemplarLoadTraceReplayer replayer(harness, trace);
+
+	// The cohorts and the exemplars that the trace loads are added, the patching server
+	// reads the exemplar patches from the files when it scans them.
+	PluginResourceLoader pluginLoader(harness.GetResourceManager());
+	pluginLoader.Load(pluginPaths, [&](const cGZPersistResourceKey& key)
+	{
+		return key.type == CohortTypeID || (key.type == ExemplarTypeID && replayer.IsLoadedKey(key))
+			? PluginResourceLoader::RecordContent::Properties
+			: PluginResourceLoader::RecordContent::None;
+	});
+
+	const PluginLoadStatistics& pluginStatistics = pluginLoader.GetStatistics();
+
+	const size_t missingExemplarCount = replayer.AddMissingExemplars();
+
+	// The counters are enabled after the plugins are loaded, the replay tool creates
+	// the exemplar properties with the same factory as the exemplar patches.
+	if (!performanceReportPath.empty())
+	{
+		PerformanceCounters::Enable();
+	}
+
+	if (!harness.Start())
+	{
+		std::fprintf(stderr, "Failed to start the exemplar patching server.\n");
+		return 1;
+	}
+
+	const std::vector<cGZPersistResourceKey>& loadedKeys = replayer.GetLoadedKeys();
+	cIExemplarLoadHookServer* const loadHookServer = harness.GetLoadHookServer();
+
+	for (uint32_t i = 0; i < subscriberCount; i++)
+	{
+		const cGZPersistResourceKey key = loadedKeys.empty() ? cGZPersistResourceKey() : loadedKeys[i % loadedKeys.size()];
+
+		switch (i % 4)
+		{
+		case 0:
+			loadHookServer->AddLoadNotification(&subscribers[i]);
+			break;
+		case 1:
+			loadHookServer->AddLoadNotification(&subscribers[i], key.group);
+			break;
+		case 2:
+			loadHookServer->AddLoadNotification(&subscribers[i], key.group, key.instance);
+			break;
+		case 3:
+			loadHookServer->AddLoadNotification(&subscribers[i], 0x7A000000 + i);
+			break;
+		}
+	}
+
+	ExemplarLoadTraceReplayResult total;
+
+	for (uint32_t i = 0; i < repeatCount; i++)
+	{
+		const ExemplarLoadTraceReplayResult result = replayer.Replay();
+
+		total.recordOverloadLoadCount += result.recordOverloadLoadCount;
+		total.typeOverloadLoadCount += result.typeOverloadLoadCount;
+		total.loadErrorCount += result.loadErrorCount;
+		total.mismatchCount += result.mismatchCount;
+		total.elapsedNanoseconds += result.elapsedNanoseconds;
+	}
+
+	uint64_t notificationCount = 0;
+
+	for (const CountingLoadTarget& subscriber : subscribers)
+	{
+		notificationCount += subscriber.loadCount;
+	}
+
+	harness.Stop();
+
+	std::printf(
+		"Replayed %zu records from %zu threads %u time(s): %llu record loads, %llu type loads, %llu load errors,"
+		" %llu mismatches, %llu notifications in %.3f ms.\n",
+		trace.GetRecords().size(),
+		trace.GetThreadCount(),
+		repeatCount,
+		static_cast<unsigned long long>(total.recordOverloadLoadCount),
+		static_cast<unsigned long long>(total.typeOverloadLoadCount),
+		static_cast<unsigned long long>(total.loadErrorCount),
+		static_cast<unsigned long long>(total.mismatchCount),
+		static_cast<unsigned long long>(notificationCount),
+		static_cast<double>(total.elapsedNanoseconds) / 1e6);
+	std::printf(
+		"Plugins: %u files, %llu exemplars, %llu cohorts, %llu invalid records, %zu trace exemplars without a plugin record.\n",
+		pluginStatistics.fileCount,
+		static_cast<unsigned long long>(pluginStatistics.exemplarCount),
+		static_cast<unsigned long long>(pluginStatistics.cohortCount),
+		static_cast<unsigned long long>(pluginStatistics.invalidRecordCount),
+		missingExemplarCount);
+
+	if (!outputPath.empty()
+		&& !WriteSummary(
+			outputPath,
+			tracePath,
+			trace,
+			pluginStatistics,
+			missingExemplarCount,
+			subscriberCount,
+			notificationCount,
+			repeatCount,
+			total))
+	{
+		std::fprintf(stderr, "Failed to write %s\n", outputPath.string().c_str());
+		return 1;
+	}
+
+	if (!performanceReportPath.empty() && !PerformanceCounters::WriteReport(performanceReportPath))
+	{
+		std::fprintf(stderr, "Failed to write %s\n", performanceReportPath.string().c_str());
+		return 1;
+	}
+
+	return total.mismatchCount == 0 ? 0 : 3;
+}